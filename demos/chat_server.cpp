@@ -5,13 +5,14 @@
  * This example implements a full chat server with:
  * - Multiple chat rooms
  * - User nicknames
- * - Join/leave notifications
+ * - Join/leave notifications as batched presence deltas (PresenceService)
  * - Private messaging
  * - User list management
  */
 
 #include "api/ServerAPI.hpp"
 #include "utils/Logger.hpp"
+#include "core/PresenceService.hpp"
 #include "common/Types.hpp"
 #include <iostream>
 #include <unordered_map>
@@ -44,11 +45,21 @@ private:
     std::unordered_map<ClientID, ChatUser> users_;
     std::unordered_map<std::string, ChatRoom> rooms_;
 
+    // Room member lists, sent as a snapshot on join and deltas afterwards
+    PresenceService presence_;
+
     // Server statistics
     std::atomic<int> totalMessages_{ 0 };
 
 public:
-    ChatServer() : server_(std::make_shared<WebSocketServer>()) {
+    ChatServer()
+        : server_(std::make_shared<WebSocketServer>()),
+        presence_([this](const PresenceService::Delta& delta, const std::vector<ClientID>& recipients) {
+            Message msg(PresenceService::toJson(delta));
+            for (ClientID memberId : recipients) {
+                server_->sendMessage(memberId, msg);
+            }
+            }) {
         setupHandlers();
         createDefaultRooms();
     }
@@ -96,9 +107,10 @@ public:
             rooms_["general"].members.insert(clientId);
         }
 
-        // Send welcome message and room list
+        // Send welcome message, room list and the room's members
         sendWelcomeMessage(clientId);
         sendRoomList(clientId);
+        sendPresenceSnapshot(clientId, presence_.join("general", clientId, nickname));
 
         std::cout << "User " << nickname << " (" << clientId << ") connected" << std::endl;
     }
@@ -120,12 +132,12 @@ public:
                 auto roomIt = rooms_.find(room);
                 if (roomIt != rooms_.end()) {
                     roomIt->second.members.erase(clientId);
-
-                    // Notify room members about user leaving
-                    broadcastToRoom(room, nickname + " has left the room", true);
                 }
             }
 
+            // Room members learn about the departure from the next presence delta
+            presence_.leaveAll(clientId);
+
             // Remove user
             users_.erase(userIt);
 
@@ -181,6 +193,7 @@ public:
                 // Notify room about nickname change
                 broadcastToRoom(user.currentRoom,
                     oldNick + " is now known as " + newNick, true);
+                presence_.update(user.currentRoom, clientId, newNick);
 
                 sendSystemMessage(clientId, "Nickname changed to: " + newNick);
             }
@@ -271,18 +284,15 @@ public:
         // Leave old room if different
         if (user.currentRoom != roomName) {
             oldRoom.members.erase(user.clientId);
-            broadcastToRoom(user.currentRoom,
-                user.nickname + " has left the room", true);
+            presence_.leave(user.currentRoom, user.clientId);
         }
 
-        // Join new room
+        // Join new room; both rooms see the change in their next presence delta
         user.currentRoom = roomName;
         newRoom.members.insert(user.clientId);
 
-        // Notify new room and user
-        broadcastToRoom(roomName, user.nickname + " has joined the room", true);
         sendSystemMessage(user.clientId, "Joined room: " + roomName);
-        sendUserList(user.clientId, roomName);
+        sendPresenceSnapshot(user.clientId, presence_.join(roomName, user.clientId, user.nickname));
     }
 
     /**
@@ -385,6 +395,20 @@ Chat Server Commands:
         sendSystemMessage(clientId, ss.str());
     }
 
+    /**
+     * @brief Send a room's member list to one client
+     */
+    void sendPresenceSnapshot(ClientID clientId, const PresenceService::Snapshot& snapshot) {
+        server_->sendMessage(clientId, Message(PresenceService::toJson(snapshot)));
+    }
+
+    /**
+     * @brief Publish pending presence deltas (call periodically)
+     */
+    void tick() {
+        presence_.tick();
+    }
+
     /**
      * @brief Send private message to specific user
      */
@@ -503,10 +527,13 @@ int main(int argc, char* argv[]) {
         std::cout << "Connect using: ws://localhost:" << port << "/" << std::endl;
         std::cout << "Press Ctrl+C to stop..." << std::endl;
 
-        // Main server loop
-        while (chatServer.isRunning()) {
-            std::this_thread::sleep_for(std::chrono::seconds(10));
-            chatServer.printStats();
+        // Main server loop: presence deltas every 250 ms, statistics every 10 s
+        for (int ticks = 1; chatServer.isRunning(); ++ticks) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+            chatServer.tick();
+            if (ticks % 40 == 0) {
+                chatServer.printStats();
+            }
         }
 
         std::cout << "Chat server shutdown complete" << std::endl;
@@ -129,6 +129,18 @@ WEBSOCKET_NAMESPACE_BEGIN
 #endif
     }
 
+    /**
+     * @brief Check if compiled with zstd dictionary compression
+     * @return true if the x-cppws-zstd extension is available
+     */
+    static bool hasZstdSupport() {
+#ifdef WEBSOCKET_ZSTD_SUPPORT
+        return true;
+#else
+        return false;
+#endif
+    }
+
     /**
      * @brief Check if compiled with metrics support
      * @return true if metrics collection enabled
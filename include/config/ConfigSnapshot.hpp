@@ -0,0 +1,182 @@
+#pragma once
+#ifndef WEBSOCKET_CONFIG_SNAPSHOT_HPP
+#define WEBSOCKET_CONFIG_SNAPSHOT_HPP
+
+#include "../common/Types.hpp"
+#include "../common/Macros.hpp"
+#include "../constants/Limits.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @struct ServerConfigSnapshot
+ * @brief Immutable, strongly typed view of the server configuration
+ *
+ * Built once at load or reload time and never modified afterwards, so hot
+ * paths can read any field without locks, map lookups or any_cast.
+ */
+struct ServerConfigSnapshot {
+    uint64_t version{ 0 };                  ///< Publication counter, assigned by the publisher
+
+    // Server
+    uint16_t port{ 8080 };                  ///< Listen port
+    size_t thread_pool_size{ 0 };           ///< Worker threads (0 = auto-detect)
+    size_t max_connections{ Limits::DEFAULT_MAX_CONNECTIONS }; ///< Connection limit
+    std::chrono::milliseconds connection_timeout{ 30000 };     ///< Idle connection timeout
+
+    // Performance
+    size_t buffer_size{ Limits::DEFAULT_BUFFER_SIZE };         ///< I/O buffer size in bytes
+    size_t max_frame_size{ Limits::DEFAULT_MAX_FRAME_SIZE };   ///< Largest accepted frame
+    size_t max_message_size{ Limits::DEFAULT_MAX_MESSAGE_SIZE }; ///< Largest reassembled message
+    bool compression_enabled{ false };      ///< permessage-deflate negotiation
+
+    // Timeouts
+    std::chrono::milliseconds handshake_timeout{ Limits::DEFAULT_HANDSHAKE_TIMEOUT }; ///< Upgrade deadline
+    std::chrono::milliseconds ping_interval{ Limits::DEFAULT_PING_INTERVAL };         ///< Heartbeat interval
+    std::chrono::milliseconds pong_timeout{ Limits::DEFAULT_PONG_TIMEOUT };           ///< Heartbeat deadline
+    std::chrono::milliseconds close_timeout{ Limits::DEFAULT_CLOSE_TIMEOUT };         ///< Close handshake deadline
+
+    // Security
+    bool ssl_enabled{ false };              ///< TLS enabled
+    std::string ssl_cert_path;              ///< Certificate file
+    std::string ssl_key_path;               ///< Private key file
+
+    // Logging
+    std::string log_level{ "INFO" };        ///< Log level name
+    std::string log_file{ "websocket_server.log" }; ///< Log file path
+};
+
+/**
+ * @class ConfigSnapshotPublisher
+ * @brief Publishes ServerConfigSnapshot instances through an atomic pointer swap
+ *
+ * Writers (load, reload, hot config) build a complete snapshot and publish it;
+ * readers never block writers and never see a half-applied update. Old
+ * snapshots stay alive for as long as a reader holds them.
+ *
+ * For the hottest paths use a Reader per event loop: it caches the current
+ * snapshot and only re-fetches it when the publication version changes, so a
+ * steady-state read costs one relaxed-order atomic load.
+ */
+class ConfigSnapshotPublisher {
+public:
+    using SnapshotPtr = std::shared_ptr<const ServerConfigSnapshot>;
+    using Listener = std::function<void(const SnapshotPtr& oldSnapshot, const SnapshotPtr& newSnapshot)>;
+
+    /**
+     * @brief Construct with a default snapshot
+     */
+    ConfigSnapshotPublisher()
+        : current_(std::make_shared<const ServerConfigSnapshot>()) {
+    }
+
+    WEBSOCKET_DISABLE_COPY(ConfigSnapshotPublisher)
+    WEBSOCKET_DISABLE_MOVE(ConfigSnapshotPublisher)
+
+    /**
+     * @brief Get the current snapshot
+     * @return Shared pointer to the latest published snapshot (never null)
+     */
+    SnapshotPtr current() const {
+        return current_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Get the current publication version
+     * @return Version of the latest published snapshot
+     */
+    uint64_t version() const {
+        return version_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Publish a new snapshot and notify listeners
+     * @param snapshot Fully built configuration
+     * @return Published snapshot (with its version assigned)
+     *
+     * @note Listeners run on the publishing thread after the publish lock is
+     *       released, so they may read or publish configuration themselves.
+     *       Concurrent publishers can notify out of order; compare versions.
+     */
+    SnapshotPtr publish(ServerConfigSnapshot snapshot) {
+        SnapshotPtr previous;
+        SnapshotPtr next;
+        std::vector<Listener> listeners;
+        {
+            std::lock_guard lock(publish_mutex_);
+
+            snapshot.version = version_.load(std::memory_order_relaxed) + 1;
+            next = std::make_shared<const ServerConfigSnapshot>(std::move(snapshot));
+            previous = current_.exchange(next, std::memory_order_acq_rel);
+            // Pointer first, then version: a reader that sees the new version finds the new pointer
+            version_.store(next->version, std::memory_order_release);
+            listeners = listeners_;
+        }
+
+        for (const auto& listener : listeners) {
+            listener(previous, next);
+        }
+        return next;
+    }
+
+    /**
+     * @brief Register a listener for snapshot changes
+     * @param listener Called with the old and new snapshot after each publish
+     */
+    void addListener(Listener listener) {
+        std::lock_guard lock(publish_mutex_);
+        listeners_.push_back(std::move(listener));
+    }
+
+    /**
+     * @class Reader
+     * @brief Per-thread cached view of the published snapshot
+     *
+     * Not thread-safe; keep one per event loop or worker thread.
+     */
+    class Reader {
+    public:
+        explicit Reader(const ConfigSnapshotPublisher& publisher)
+            : publisher_(&publisher),
+            cached_(publisher.current()),
+            cached_version_(cached_->version) {
+        }
+
+        /**
+         * @brief Get the latest snapshot, refreshing the cache if needed
+         * @return Reference valid until the next call to get()
+         */
+        const ServerConfigSnapshot& get() {
+            const uint64_t latest = publisher_->version();
+            if (latest != cached_version_) {
+                cached_ = publisher_->current();
+                cached_version_ = latest;
+            }
+            return *cached_;
+        }
+
+        const ServerConfigSnapshot* operator->() { return &get(); }
+
+    private:
+        const ConfigSnapshotPublisher* publisher_;
+        SnapshotPtr cached_;
+        uint64_t cached_version_;
+    };
+
+private:
+    std::atomic<SnapshotPtr> current_;
+    std::atomic<uint64_t> version_{ 0 };
+    std::mutex publish_mutex_;
+    std::vector<Listener> listeners_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_CONFIG_SNAPSHOT_HPP
@@ -0,0 +1,379 @@
+#pragma once
+#ifndef WEBSOCKET_CONFIG_WATCHER_HPP
+#define WEBSOCKET_CONFIG_WATCHER_HPP
+
+#include "../common/Types.hpp"
+#include "../common/Macros.hpp"
+#include "../utils/FileUtils.hpp"
+#include "ConfigManager.hpp"
+#include "ConfigParser.hpp"
+#include "ConfigValidator.hpp"
+#include "RuntimeConfig.hpp"
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class ConfigWatcher
+ * @brief Watches the configuration file and applies changes without a restart
+ *
+ * On Linux the watcher blocks on inotify for the file's directory, so editor
+ * saves (write in place or write-and-rename) are seen immediately without
+ * polling. Elsewhere it falls back to FileUtils::hasFileChanged() on an
+ * interval.
+ *
+ * Each reload is all-or-nothing up to the point of publication:
+ * 1. Read the file once, parse it and validate it with ConfigValidator
+ * 2. Load that same text into ConfigManager and publish a new RuntimeConfig snapshot
+ * 3. Hand old and new snapshot to every registered subsystem
+ *
+ * Subsystems (IOThreadPool size, BufferPool classes, ConnectionPool config,
+ * limits) confirm by returning true. A subsystem that cannot apply a value
+ * live reports an error; the rest of the reload still takes effect and the
+ * failure is listed in the ReloadReport. Subsystems must apply changes to
+ * existing connections in place, never by closing them.
+ */
+class ConfigWatcher {
+public:
+    /**
+     * @brief Subsystem apply hook
+     * @param oldConfig Snapshot before the reload
+     * @param newConfig Snapshot after the reload
+     * @param error Set to a description when returning false
+     * @return true if the subsystem applied the new configuration
+     */
+    using ApplyFunction = std::function<bool(const ServerConfigSnapshot& oldConfig,
+        const ServerConfigSnapshot& newConfig, std::string& error)>;
+
+    /**
+     * @brief Outcome of one reload attempt
+     */
+    struct ReloadReport {
+        bool accepted{ false };                 ///< Passed parsing and validation
+        uint64_t version{ 0 };                  ///< Published snapshot version (0 if rejected)
+        std::vector<std::string> errors;        ///< Parse, validation or subsystem errors
+        std::vector<std::string> applied;       ///< Subsystems that confirmed
+        std::vector<std::string> failed;        ///< Subsystems that could not apply
+        std::chrono::microseconds duration{ 0 }; ///< Time spent reloading
+    };
+
+    using ReportCallback = std::function<void(const ReloadReport&)>;
+
+    /**
+     * @brief Watcher options
+     */
+    struct Options {
+        std::chrono::milliseconds debounce{ 250 };          ///< Quiet period before reloading
+        std::chrono::milliseconds poll_interval{ 1000 };    ///< Fallback polling interval (non-Linux)
+    };
+
+    /**
+     * @brief Construct watcher
+     * @param path Configuration file to watch
+     * @param manager Configuration manager to reload
+     * @param runtime Runtime configuration to republish
+     * @param options Watcher options
+     */
+    ConfigWatcher(std::string path, ConfigManager& manager, RuntimeConfig& runtime,
+        const Options& options)
+        : path_(std::move(path)),
+        manager_(manager),
+        runtime_(runtime),
+        options_(options) {
+    }
+
+    /**
+     * @brief Construct watcher with default options
+     * @param path Configuration file to watch
+     * @param manager Configuration manager to reload
+     * @param runtime Runtime configuration to republish
+     */
+    ConfigWatcher(std::string path, ConfigManager& manager, RuntimeConfig& runtime)
+        : ConfigWatcher(std::move(path), manager, runtime, Options{}) {
+    }
+
+    ~ConfigWatcher() {
+        stop();
+    }
+
+    WEBSOCKET_DISABLE_COPY(ConfigWatcher)
+    WEBSOCKET_DISABLE_MOVE(ConfigWatcher)
+
+    /**
+     * @brief Register a subsystem that applies configuration live
+     * @param name Subsystem name (for reports)
+     * @param apply Apply hook
+     *
+     * @note Subsystems are applied in registration order
+     */
+    void addSubsystem(const std::string& name, ApplyFunction apply) {
+        std::lock_guard lock(mutex_);
+        subsystems_.push_back({ name, std::move(apply) });
+    }
+
+    /**
+     * @brief Set callback invoked after every reload attempt
+     * @param callback Report callback
+     */
+    void onReload(ReportCallback callback) {
+        std::lock_guard lock(mutex_);
+        report_callback_ = std::move(callback);
+    }
+
+    /**
+     * @brief Start watching in a background thread
+     * @return true if the watcher started
+     */
+    bool start() {
+        if (running_.exchange(true)) {
+            return false;
+        }
+#ifdef __linux__
+        if (!openInotify()) {
+            running_ = false;
+            return false;
+        }
+#endif
+        thread_ = std::thread([this] { watchLoop(); });
+        return true;
+    }
+
+    /**
+     * @brief Stop watching and join the background thread
+     */
+    void stop() {
+        if (!running_.exchange(false)) {
+            return;
+        }
+#ifdef __linux__
+        // Wake poll() so the loop observes running_ == false
+        const uint64_t one = 1;
+        [[maybe_unused]] auto written = ::write(wake_pipe_[1], &one, sizeof(one));
+#endif
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+#ifdef __linux__
+        closeInotify();
+#endif
+    }
+
+    /**
+     * @brief Reload immediately (e.g. on SIGHUP)
+     * @return Report describing the outcome
+     *
+     * @note Subsystem hooks and the report callback run without the
+     *       registration lock held, so they may call addSubsystem() or
+     *       onReload(); they must not call reloadNow()
+     */
+    ReloadReport reloadNow() {
+        std::lock_guard reload_lock(reload_mutex_);
+        const auto started = std::chrono::steady_clock::now();
+        ReloadReport report;
+
+        std::vector<Subsystem> subsystems;
+        ReportCallback report_callback;
+        {
+            std::lock_guard lock(mutex_);
+            subsystems = subsystems_;
+            report_callback = report_callback_;
+        }
+
+        // Parse once and hand the validated text itself to ConfigManager:
+        // re-reading the file would race with an editor still writing it
+        std::string text;
+        std::unordered_map<std::string, std::any> values;
+        if (parseAndValidate(text, values, report.errors) && manager_.loadFromString(text)) {
+            report.accepted = true;
+
+            auto previous = runtime_.getSnapshot();
+            runtime_.applyHotConfig(values);
+            auto current = runtime_.getSnapshot();
+            report.version = current->version;
+
+            for (const auto& subsystem : subsystems) {
+                std::string error;
+                if (subsystem.apply(*previous, *current, error)) {
+                    report.applied.push_back(subsystem.name);
+                }
+                else {
+                    report.failed.push_back(subsystem.name);
+                    report.errors.push_back(subsystem.name + ": " + error);
+                }
+            }
+        }
+        else if (report.errors.empty()) {
+            report.errors.push_back("ConfigManager::loadFromString() failed");
+        }
+
+        report.duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - started);
+        reloads_++;
+        if (!report.accepted) {
+            rejected_++;
+        }
+        if (report_callback) {
+            report_callback(report);
+        }
+        return report;
+    }
+
+    /**
+     * @brief Get number of reload attempts
+     * @return Reloads attempted since construction
+     */
+    uint64_t getReloadCount() const { return reloads_.load(); }
+
+    /**
+     * @brief Get number of rejected reloads
+     * @return Reloads that failed parsing or validation
+     */
+    uint64_t getRejectedCount() const { return rejected_.load(); }
+
+    /**
+     * @brief Check if watcher is running
+     * @return true if the background thread is active
+     */
+    bool isRunning() const { return running_.load(); }
+
+private:
+    struct Subsystem {
+        std::string name;
+        ApplyFunction apply;
+    };
+
+    /**
+     * @brief Parse the file and validate it without touching live configuration
+     * @param text Receives the file contents that were validated
+     */
+    bool parseAndValidate(std::string& text, std::unordered_map<std::string, std::any>& values,
+        std::vector<std::string>& errors) {
+        text = FileUtils::readTextFile(path_);
+        if (text.empty()) {
+            errors.push_back("cannot read " + path_);
+            return false;
+        }
+        auto parser = ConfigParserFactory::createAutoParser(text);
+        if (!parser || !parser->parse(text, values)) {
+            errors.push_back("cannot parse " + path_);
+            return false;
+        }
+        ConfigValidator validator;
+        validator.applyDefaults(values);
+        if (!validator.validate(values)) {
+            errors = validator.getErrors();
+            return false;
+        }
+        return true;
+    }
+
+    void watchLoop() {
+#ifdef __linux__
+        const std::string file_name = std::filesystem::path(path_).filename().string();
+        alignas(inotify_event) char events[4096];
+        bool pending = false;
+
+        while (running_) {
+            pollfd fds[2] = { { inotify_fd_, POLLIN, 0 }, { wake_pipe_[0], POLLIN, 0 } };
+            // While a change is pending, wait only for the debounce period
+            const int timeout = pending ? static_cast<int>(options_.debounce.count()) : -1;
+            const int ready = ::poll(fds, 2, timeout);
+            if (!running_) {
+                break;
+            }
+            if (ready == 0 && pending) {
+                pending = false;
+                reloadNow();
+                continue;
+            }
+            if (ready < 0 || !(fds[0].revents & POLLIN)) {
+                continue;
+            }
+
+            const ssize_t length = ::read(inotify_fd_, events, sizeof(events));
+            for (ssize_t offset = 0; offset < length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(events + offset);
+                if (event->len > 0 && file_name == event->name) {
+                    pending = true;
+                }
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            }
+        }
+#else
+        std::time_t last_check = std::time(nullptr);
+        while (running_) {
+            std::this_thread::sleep_for(options_.poll_interval);
+            if (running_ && FileUtils::hasFileChanged(path_, last_check)) {
+                reloadNow();
+            }
+        }
+#endif
+    }
+
+#ifdef __linux__
+    bool openInotify() {
+        inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd_ < 0) {
+            return false;
+        }
+        // Watch the directory: editors often replace the file via rename,
+        // which would silently drop a watch on the file itself
+        std::string directory = std::filesystem::path(path_).parent_path().string();
+        if (directory.empty()) {
+            directory = ".";
+        }
+        if (::inotify_add_watch(inotify_fd_, directory.c_str(),
+            IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0 || ::pipe2(wake_pipe_, O_CLOEXEC) != 0) {
+            closeInotify();
+            return false;
+        }
+        return true;
+    }
+
+    void closeInotify() {
+        for (int* fd : { &inotify_fd_, &wake_pipe_[0], &wake_pipe_[1] }) {
+            if (*fd >= 0) {
+                ::close(*fd);
+                *fd = -1;
+            }
+        }
+    }
+
+    int inotify_fd_{ -1 };
+    int wake_pipe_[2]{ -1, -1 };
+#endif
+
+    std::string path_;
+    ConfigManager& manager_;
+    RuntimeConfig& runtime_;
+    Options options_;
+
+    std::mutex reload_mutex_;       ///< Serializes reloads
+    std::mutex mutex_;              ///< Guards subsystems_ and report_callback_
+    std::vector<Subsystem> subsystems_;
+    ReportCallback report_callback_;
+
+    std::thread thread_;
+    std::atomic<bool> running_{ false };
+    std::atomic<uint64_t> reloads_{ 0 };
+    std::atomic<uint64_t> rejected_{ 0 };
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_CONFIG_WATCHER_HPP
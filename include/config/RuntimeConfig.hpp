@@ -4,6 +4,7 @@
 
 #include "../common/Types.hpp"
 #include "../common/Macros.hpp"
+#include "ConfigSnapshot.hpp"
 #include <atomic>
 #include <shared_mutex>
 #include <string>
@@ -63,6 +64,42 @@ WEBSOCKET_NAMESPACE_BEGIN
          */
         void setThreadPoolSize(size_t size);
 
+        /**
+         * @brief Get lower bound for autoscaled thread pools
+         * @return Minimum worker threads
+         */
+        size_t getThreadPoolMinSize() const;
+
+        /**
+         * @brief Set lower bound for autoscaled thread pools
+         * @param size Minimum worker threads
+         */
+        void setThreadPoolMinSize(size_t size);
+
+        /**
+         * @brief Get upper bound for autoscaled thread pools
+         * @return Maximum worker threads
+         */
+        size_t getThreadPoolMaxSize() const;
+
+        /**
+         * @brief Set upper bound for autoscaled thread pools
+         * @param size Maximum worker threads
+         */
+        void setThreadPoolMaxSize(size_t size);
+
+        /**
+         * @brief Check if thread pool autoscaling is enabled
+         * @return true if PoolAutoscaler resizes pools at runtime
+         */
+        bool getAutoscaleEnabled() const;
+
+        /**
+         * @brief Enable or disable thread pool autoscaling
+         * @param enabled true to let PoolAutoscaler resize pools
+         */
+        void setAutoscaleEnabled(bool enabled);
+
         /**
          * @brief Get maximum connections
          * @return Maximum concurrent connections
@@ -237,6 +274,30 @@ WEBSOCKET_NAMESPACE_BEGIN
          */
         std::unordered_map<std::string, std::any> getAllValues() const;
 
+        // ============================================================================
+        // TYPED SNAPSHOT
+        // ============================================================================
+
+        /**
+         * @brief Get the current typed configuration snapshot
+         * @return Immutable snapshot, republished after every change
+         */
+        ConfigSnapshotPublisher::SnapshotPtr getSnapshot() const { return snapshotPublisher_.current(); }
+
+        /**
+         * @brief Get the snapshot publisher
+         * @return Publisher, e.g. to construct a per-thread ConfigSnapshotPublisher::Reader
+         */
+        const ConfigSnapshotPublisher& getSnapshotPublisher() const { return snapshotPublisher_; }
+
+        /**
+         * @brief Add listener for snapshot changes
+         * @param listener Called with the old and new snapshot after each change
+         */
+        void addSnapshotListener(ConfigSnapshotPublisher::Listener listener) {
+            snapshotPublisher_.addListener(std::move(listener));
+        }
+
     private:
         /**
          * @brief Private constructor for singleton
@@ -256,12 +317,23 @@ WEBSOCKET_NAMESPACE_BEGIN
          */
         void notifyChangeListeners(const std::string& key, const std::any& oldValue, const std::any& newValue);
 
+        /**
+         * @brief Build a snapshot from the current values and publish it
+         *
+         * Called by every setter and once per applyHotConfig() batch, so a
+         * multi-key reload produces a single snapshot.
+         */
+        void publishSnapshot();
+
         // Member variables
         mutable std::shared_mutex mutex_;
 
         // Server configuration (atomic for lock-free reads)
         std::atomic<uint16_t> port_{ 8080 };
-        std::atomic<size_t> threadPoolSize_{ 0 }; // 0 = auto-detect
+        std::atomic<size_t> threadPoolSize_{ 0 }; // 0 = auto-detect (initial size when autoscaling)
+        std::atomic<size_t> threadPoolMinSize_{ 1 };
+        std::atomic<size_t> threadPoolMaxSize_{ 64 };
+        std::atomic<bool> autoscaleEnabled_{ false };
         std::atomic<size_t> maxConnections_{ 10000 };
         std::atomic<uint32_t> connectionTimeout_{ 30000 };
 
@@ -283,6 +355,9 @@ WEBSOCKET_NAMESPACE_BEGIN
         std::unordered_map<std::string, std::vector<ChangeCallback>> changeListeners_;
         std::atomic<bool> dirty_{ false };
 
+        // Typed snapshot for hot-path readers
+        ConfigSnapshotPublisher snapshotPublisher_;
+
         // Singleton instance
         static std::unique_ptr<RuntimeConfig> instance_;
         static std::once_flag initFlag_;
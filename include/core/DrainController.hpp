@@ -0,0 +1,248 @@
+#pragma once
+#ifndef WEBSOCKET_DRAIN_CONTROLLER_HPP
+#define WEBSOCKET_DRAIN_CONTROLLER_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include "../constants/Limits.hpp"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class DrainController
+ * @brief Paces session closure during a graceful drain
+ *
+ * Closing every session at once makes all clients reconnect to the remaining
+ * instances in the same second. The drain controller instead releases closes
+ * at a configured rate (or spread over a window), attaches a randomized
+ * reconnect hint to each close reason, and reports sessions that did not
+ * finish the close handshake in time so they can be force-closed.
+ *
+ * Usage (driven by WebSocketServer::drain()):
+ * - begin() with the currently connected sessions
+ * - on a periodic timer, close every session from takeDue()
+ * - call onClosed() from the disconnect path
+ * - drop every connection returned by takeStragglers()
+ */
+class DrainController : public NonCopyable {
+public:
+    /**
+     * @brief Drain configuration
+     */
+    struct Options {
+        double closes_per_second{ 0.0 };                    ///< Close rate (0 = use spread_window)
+        std::chrono::milliseconds spread_window{ 30000 };   ///< Window to spread closes over (0 = close all at once)
+        uint16_t close_code{ static_cast<uint16_t>(CloseCode::SERVICE_RESTART) }; ///< Close code sent to clients
+        std::chrono::milliseconds reconnect_delay_min{ 0 };    ///< Lower bound of suggested reconnect delay
+        std::chrono::milliseconds reconnect_delay_max{ 5000 }; ///< Upper bound of suggested reconnect delay
+        std::chrono::milliseconds force_close_timeout{ Limits::DEFAULT_CLOSE_TIMEOUT }; ///< Close handshake deadline
+    };
+
+    /**
+     * @brief Drain progress snapshot
+     */
+    struct Progress {
+        size_t total{ 0 };          ///< Sessions present when the drain began
+        size_t close_sent{ 0 };     ///< Sessions sent a close frame
+        size_t closed{ 0 };         ///< Sessions fully closed
+        size_t forced{ 0 };         ///< Sessions force-closed after the deadline
+        Timestamp started{};        ///< Drain start time
+        bool complete{ false };     ///< All sessions closed
+    };
+
+    /**
+     * @brief Prefix of the reconnect hint in close reasons
+     */
+    static constexpr const char* RECONNECT_HINT_KEY = "retry-after-ms=";
+
+    DrainController() : rng_(std::random_device{}()) {}
+
+    /**
+     * @brief Format a close reason carrying a reconnect hint
+     * @param delay Suggested reconnect delay
+     * @return Close reason, e.g. "service restart; retry-after-ms=1500"
+     */
+    static std::string formatCloseReason(std::chrono::milliseconds delay) {
+        return std::string("service restart; ") + RECONNECT_HINT_KEY + std::to_string(delay.count());
+    }
+
+    /**
+     * @brief Extract the reconnect hint from a close reason
+     * @param reason Close reason received by a client
+     * @return Suggested delay, or empty if the reason carries no hint
+     */
+    static std::optional<std::chrono::milliseconds> parseReconnectDelay(const std::string& reason) {
+        auto pos = reason.find(RECONNECT_HINT_KEY);
+        if (pos == std::string::npos) {
+            return std::nullopt;
+        }
+        pos += std::char_traits<char>::length(RECONNECT_HINT_KEY);
+        int64_t value = 0;
+        size_t digits = 0;
+        while (pos < reason.size() && reason[pos] >= '0' && reason[pos] <= '9' && digits < 18) {
+            value = value * 10 + (reason[pos++] - '0');
+            ++digits;
+        }
+        if (digits == 0) {
+            return std::nullopt;
+        }
+        return std::chrono::milliseconds(value);
+    }
+
+    /**
+     * @brief Start a drain
+     * @param sessions Sessions to close
+     * @param options Drain configuration
+     * @param now Start time
+     */
+    void begin(std::vector<ClientID> sessions, const Options& options,
+        Timestamp now = std::chrono::steady_clock::now()) {
+        std::lock_guard lock(mutex_);
+        options_ = options;
+        pending_ = std::move(sessions);
+        // Close in random order so no client population is systematically last
+        std::shuffle(pending_.begin(), pending_.end(), rng_);
+        next_index_ = 0;
+        close_deadlines_.clear();
+        progress_ = Progress{};
+        progress_.total = pending_.size();
+        progress_.started = now;
+        progress_.complete = pending_.empty();
+    }
+
+    /**
+     * @brief Get sessions whose close is due
+     * @param now Current time
+     * @return Sessions to close now, each with its close reason
+     */
+    std::vector<std::pair<ClientID, std::string>> takeDue(Timestamp now = std::chrono::steady_clock::now()) {
+        std::lock_guard lock(mutex_);
+        std::vector<std::pair<ClientID, std::string>> due;
+
+        const size_t allowed = std::min(pending_.size(), closesAllowedBy(now));
+        std::uniform_int_distribution<int64_t> delay(options_.reconnect_delay_min.count(),
+            std::max(options_.reconnect_delay_min.count(), options_.reconnect_delay_max.count()));
+
+        while (next_index_ < allowed) {
+            ClientID id = pending_[next_index_++];
+            due.emplace_back(id, formatCloseReason(std::chrono::milliseconds(delay(rng_))));
+            close_deadlines_[id] = now + options_.force_close_timeout;
+        }
+        progress_.close_sent = next_index_;
+        return due;
+    }
+
+    /**
+     * @brief Record that a session finished closing
+     * @param id Session identifier
+     */
+    void onClosed(ClientID id) {
+        std::lock_guard lock(mutex_);
+        if (close_deadlines_.erase(id) > 0) {
+            progress_.closed++;
+        }
+        else {
+            // Disconnected on its own before we got to it
+            auto it = std::find(pending_.begin() + next_index_, pending_.end(), id);
+            if (it == pending_.end()) {
+                return;
+            }
+            pending_.erase(it);
+            progress_.closed++;
+        }
+        updateComplete();
+    }
+
+    /**
+     * @brief Get sessions that missed the close handshake deadline
+     * @param now Current time
+     * @return Sessions that must be force-closed
+     */
+    std::vector<ClientID> takeStragglers(Timestamp now = std::chrono::steady_clock::now()) {
+        std::lock_guard lock(mutex_);
+        std::vector<ClientID> stragglers;
+        for (auto it = close_deadlines_.begin(); it != close_deadlines_.end();) {
+            if (it->second <= now) {
+                stragglers.push_back(it->first);
+                it = close_deadlines_.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        progress_.forced += stragglers.size();
+        progress_.closed += stragglers.size();
+        updateComplete();
+        return stragglers;
+    }
+
+    /**
+     * @brief Get time at which the next close is due
+     * @return Time of next close, or empty if every close has been sent
+     */
+    std::optional<Timestamp> nextCloseTime() const {
+        std::lock_guard lock(mutex_);
+        if (next_index_ >= pending_.size()) {
+            return std::nullopt;
+        }
+        return closeTimeFor(next_index_);
+    }
+
+    /**
+     * @brief Get drain progress
+     * @return Progress snapshot
+     */
+    Progress getProgress() const {
+        std::lock_guard lock(mutex_);
+        return progress_;
+    }
+
+private:
+    Timestamp closeTimeFor(size_t index) const {
+        if (options_.closes_per_second > 0.0) {
+            return progress_.started + std::chrono::duration_cast<Duration>(
+                std::chrono::duration<double>(index / options_.closes_per_second));
+        }
+        if (options_.spread_window.count() > 0 && !pending_.empty()) {
+            return progress_.started + std::chrono::duration_cast<Duration>(
+                options_.spread_window * (static_cast<double>(index) / pending_.size()));
+        }
+        return progress_.started;
+    }
+
+    size_t closesAllowedBy(Timestamp now) const {
+        const double elapsed = std::chrono::duration<double>(now - progress_.started).count();
+        if (options_.closes_per_second > 0.0) {
+            return static_cast<size_t>(elapsed * options_.closes_per_second) + 1;
+        }
+        const double window = std::chrono::duration<double>(options_.spread_window).count();
+        if (window > 0.0) {
+            return static_cast<size_t>(pending_.size() * (elapsed / window)) + 1;
+        }
+        return pending_.size();
+    }
+
+    void updateComplete() {
+        progress_.complete = next_index_ >= pending_.size() && close_deadlines_.empty();
+    }
+
+    mutable std::mutex mutex_;
+    Options options_;
+    std::vector<ClientID> pending_;
+    size_t next_index_{ 0 };
+    std::unordered_map<ClientID, Timestamp> close_deadlines_;
+    Progress progress_;
+    std::mt19937_64 rng_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_DRAIN_CONTROLLER_HPP
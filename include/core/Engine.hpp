@@ -6,6 +6,7 @@
 #include "../common/NonCopyable.hpp"
 #include "ServiceLocator.hpp"
 #include "LifecycleManager.hpp"
+#include "PoolAutoscaler.hpp"
 #include <memory>
 #include <vector>
 #include <string>
@@ -75,6 +76,8 @@ public:
     /**
      * @brief Start all engine services and components
      * @return true if startup successful
+     *
+     * @note Freezes the service locator once startup completes
      */
     bool start();
 
@@ -122,6 +125,18 @@ public:
         return service_locator_.resolve<T>(name);
     }
 
+    /**
+     * @brief Get default service by type
+     * @tparam T Service type
+     * @return Shared pointer to service, nullptr if not found
+     *
+     * @note Lock-free indexed lookup once start() has frozen the locator
+     */
+    template<typename T>
+    std::shared_ptr<T> getService() {
+        return service_locator_.get<T>();
+    }
+
     /**
      * @brief Get service locator for dependency injection
      * @return Reference to service locator
@@ -134,6 +149,12 @@ public:
      */
     LifecycleManager& getLifecycleManager();
 
+    /**
+     * @brief Get pool autoscaler
+     * @return Reference to autoscaler evaluated from the maintenance timer
+     */
+    PoolAutoscaler& getPoolAutoscaler();
+
     /**
      * @brief Set engine operational mode
      * @param mode New operational mode
@@ -218,6 +239,7 @@ private:
 
     ServiceLocator service_locator_;               ///< Dependency injection container
     LifecycleManager lifecycle_manager_;           ///< Lifecycle sequencing
+    PoolAutoscaler pool_autoscaler_;               ///< Worker pool sizing
     std::atomic<State> state_{ State::UNINITIALIZED }; ///< Current engine state
     std::atomic<Mode> mode_{ Mode::PRODUCTION };     ///< Operational mode
     std::vector<std::shared_ptr<IService>> services_; ///< Registered services
@@ -4,6 +4,8 @@
 
 #include "../common/Types.hpp"
 #include "../common/NonCopyable.hpp"
+#include "StartupScheduler.hpp"
+#include "WarmupRunner.hpp"
 #include <vector>
 #include <memory>
 #include <functional>
@@ -37,7 +39,9 @@ public:
         INITIALIZING,   ///< Initialization in progress
         INITIALIZED,    ///< Successfully initialized
         STARTING,       ///< Startup in progress
+        WARMING_UP,     ///< Started, warm-up running; not yet ready
         RUNNING,        ///< Component running
+        DRAINING,       ///< Running but shedding load ahead of shutdown
         STOPPING,       ///< Shutdown in progress
         STOPPED         ///< Component fully stopped
     };
@@ -73,6 +77,7 @@ public:
         std::vector<std::string> dependencies;  ///< Required components
         State state{ State::UNINITIALIZED };      ///< Current state
         std::string error_message;              ///< Last error message
+        uint64_t timeout_ms{ 0 };               ///< Initialization timeout (0 = manager default)
     };
 
     /**
@@ -102,13 +107,20 @@ public:
      * @brief Initialize all registered components
      * @return true if all components initialized successfully
      *
-     * @note Components are initialized in dependency order within their phases
+     * @note Phases run in order. Within a phase, components are initialized
+     *       in parallel, each as soon as its dependencies are INITIALIZED
+     *       (see setParallelInitialization). Timing per component and the
+     *       critical path are available from getStartupReport().
      */
     bool initializeAll();
 
     /**
      * @brief Start all registered components
      * @return true if all components started successfully
+     *
+     * @note Once every component has started, components move to WARMING_UP
+     *       and the warm-up steps run. Components are reported RUNNING only
+     *       after a successful warm-up.
      */
     bool startAll();
 
@@ -141,6 +153,23 @@ public:
      */
     bool stopComponent(const std::string& name, bool graceful = true);
 
+    /**
+     * @brief Transition a component into DRAINING
+     * @param name Component name
+     * @param message Drain description
+     * @return true if component was RUNNING and is now DRAINING
+     */
+    bool beginDrain(const std::string& name, const std::string& message = "");
+
+    /**
+     * @brief Record a progress event without a state change
+     * @param name Component name
+     * @param message Progress description (e.g. "drain: 400/1000 closed")
+     *
+     * @note Delivered to event listeners with old_state == new_state
+     */
+    void reportProgress(const std::string& name, const std::string& message);
+
     /**
      * @brief Get component current state
      * @param name Component name
@@ -172,6 +201,39 @@ public:
      */
     void setInitializationTimeout(uint64_t timeout);
 
+    /**
+     * @brief Set initialization timeout for one component
+     * @param name Component name
+     * @param timeout Timeout duration in milliseconds (0 = manager default)
+     * @return true if component found
+     */
+    bool setInitializationTimeout(const std::string& name, uint64_t timeout);
+
+    /**
+     * @brief Configure parallel initialization
+     * @param enabled false to initialize one component at a time
+     * @param max_parallel Concurrent initializations (0 = hardware concurrency)
+     */
+    void setParallelInitialization(bool enabled, size_t max_parallel = 0);
+
+    /**
+     * @brief Get timing of the last initializeAll()
+     * @return Per-component durations and the critical path
+     */
+    StartupScheduler::Report getStartupReport() const;
+
+    /**
+     * @brief Get warm-up runner
+     * @return Runner whose steps execute between start and RUNNING
+     */
+    WarmupRunner& getWarmupRunner();
+
+    /**
+     * @brief Get result of the last warm-up
+     * @return Per-step warm-up results
+     */
+    WarmupRunner::Report getWarmupReport() const;
+
     /**
      * @brief Set shutdown timeout
      * @param timeout Timeout duration in milliseconds
@@ -247,12 +309,23 @@ private:
      */
     bool waitForComponentState(const std::string& name, State target_state, uint64_t timeout_ms);
 
+    /**
+     * @brief Build the startup DAG and run it on the StartupScheduler
+     * @return true if every component initialized
+     */
+    bool initializeParallel();
+
     // Member variables
     std::vector<ComponentInfo> components_;
     std::vector<LifecycleEvent> event_history_;
     std::vector<std::function<void(const LifecycleEvent&)>> event_listeners_;
     uint64_t initialization_timeout_{ 30000 };  ///< 30 seconds default
     uint64_t shutdown_timeout_{ 30000 };        ///< 30 seconds default
+    bool parallel_initialization_{ true };      ///< Run independent components concurrently
+    size_t max_parallel_initialization_{ 0 };   ///< 0 = hardware concurrency
+    StartupScheduler::Report startup_report_;   ///< Timing of the last initializeAll()
+    WarmupRunner warmup_runner_;                ///< Steps run before reporting RUNNING
+    WarmupRunner::Report warmup_report_;        ///< Result of the last warm-up
     mutable std::mutex mutex_;
 };
 
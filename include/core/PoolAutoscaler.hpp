@@ -0,0 +1,203 @@
+#pragma once
+#ifndef WEBSOCKET_POOL_AUTOSCALER_HPP
+#define WEBSOCKET_POOL_AUTOSCALER_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class PoolAutoscaler
+ * @brief Grows and shrinks worker pools from observed load
+ *
+ * Periodically samples each registered pool (worker count, queue depth,
+ * utilisation and handler latency) and resizes it within configured bounds.
+ * Hysteresis keeps pools from flapping:
+ * - scale up only after several consecutive hot samples
+ * - scale down only after a longer run of cold samples
+ * - no decision during a cooldown after any resize
+ *
+ * The autoscaler owns no thread; the Engine calls evaluate() from its
+ * maintenance timer. Pools are bound through a Target, so the same logic
+ * drives ThreadPool::resize() and IOThreadPool::resize().
+ */
+class PoolAutoscaler : public NonCopyable {
+public:
+    /**
+     * @brief Load sample for a pool
+     */
+    struct Signals {
+        size_t workers{ 0 };            ///< Current worker count
+        size_t queue_depth{ 0 };        ///< Pending tasks across the pool
+        double utilization{ 0.0 };      ///< Busy fraction of workers, 0.0 - 1.0
+        double latency_ms{ 0.0 };       ///< Recent handler latency (e.g. p99)
+    };
+
+    /**
+     * @brief Scaling policy for a pool
+     */
+    struct Policy {
+        size_t min_workers{ 1 };                ///< Lower bound
+        size_t max_workers{ 64 };               ///< Upper bound
+        double scale_up_utilization{ 0.85 };    ///< Hot if utilisation above this
+        double scale_down_utilization{ 0.30 };  ///< Cold if utilisation below this
+        double queue_per_worker_high{ 4.0 };    ///< Hot if queue depth per worker above this
+        double latency_high_ms{ 0.0 };          ///< Hot if latency above this (0 = ignore)
+        size_t scale_up_samples{ 3 };           ///< Consecutive hot samples before growing
+        size_t scale_down_samples{ 30 };        ///< Consecutive cold samples before shrinking
+        size_t step_up{ 2 };                    ///< Workers added per decision
+        size_t step_down{ 1 };                  ///< Workers removed per decision
+        std::chrono::milliseconds cooldown{ 10000 }; ///< Minimum time between resizes
+    };
+
+    /**
+     * @brief Binding to a concrete pool
+     */
+    struct Target {
+        std::function<Signals()> sample;        ///< Read current load
+        std::function<bool(size_t)> resize;     ///< Apply new worker count
+    };
+
+    /**
+     * @brief Record of a resize decision
+     */
+    struct Decision {
+        std::string pool;               ///< Pool name
+        size_t from{ 0 };               ///< Worker count before
+        size_t to{ 0 };                 ///< Worker count after
+        Signals signals;                ///< Sample that triggered the decision
+        Timestamp timestamp{};          ///< Decision time
+    };
+
+    /**
+     * @brief Make a policy's bounds consistent
+     * @param policy Scaling policy
+     * @return Policy with max_workers raised to min_workers if it was lower
+     */
+    static Policy normalize(Policy policy) {
+        policy.max_workers = std::max(policy.max_workers, policy.min_workers);
+        return policy;
+    }
+
+    /**
+     * @brief Register a pool
+     * @param name Pool name (for metrics and logging)
+     * @param target Pool binding
+     * @param policy Scaling policy (bounds are normalized)
+     */
+    void addPool(const std::string& name, Target target, const Policy& policy) {
+        std::lock_guard lock(mutex_);
+        pools_.push_back(PoolState{ name, std::move(target), normalize(policy) });
+    }
+
+    /**
+     * @brief Register a pool with the default policy
+     * @param name Pool name (for metrics and logging)
+     * @param target Pool binding
+     */
+    void addPool(const std::string& name, Target target) {
+        addPool(name, std::move(target), Policy{});
+    }
+
+    /**
+     * @brief Compute the desired worker count for a sample
+     * @param policy Scaling policy
+     * @param signals Current load sample
+     * @param hot_streak Consecutive hot samples (updated)
+     * @param cold_streak Consecutive cold samples (updated)
+     * @return Desired worker count (equal to signals.workers for no change)
+     */
+    static size_t desiredWorkers(const Policy& policy, const Signals& signals,
+        size_t& hot_streak, size_t& cold_streak) {
+        const size_t workers = std::max<size_t>(signals.workers, 1);
+        const double queue_per_worker = static_cast<double>(signals.queue_depth) / workers;
+
+        const bool hot = signals.utilization > policy.scale_up_utilization ||
+            queue_per_worker > policy.queue_per_worker_high ||
+            (policy.latency_high_ms > 0.0 && signals.latency_ms > policy.latency_high_ms);
+        const bool cold = !hot && signals.utilization < policy.scale_down_utilization &&
+            signals.queue_depth == 0;
+
+        hot_streak = hot ? hot_streak + 1 : 0;
+        cold_streak = cold ? cold_streak + 1 : 0;
+
+        size_t desired = signals.workers;
+        if (hot_streak >= policy.scale_up_samples) {
+            desired = signals.workers + policy.step_up;
+        }
+        else if (cold_streak >= policy.scale_down_samples) {
+            desired = signals.workers > policy.step_down ? signals.workers - policy.step_down : 0;
+        }
+        // std::clamp requires min <= max; tolerate a policy that was not normalized
+        return std::clamp(desired, policy.min_workers, std::max(policy.min_workers, policy.max_workers));
+    }
+
+    /**
+     * @brief Sample every pool and resize where the policy says so
+     * @param now Current time
+     * @return Resizes applied in this evaluation
+     */
+    std::vector<Decision> evaluate(Timestamp now = std::chrono::steady_clock::now()) {
+        std::lock_guard lock(mutex_);
+        std::vector<Decision> decisions;
+
+        for (auto& pool : pools_) {
+            if (!pool.target.sample || !pool.target.resize) {
+                continue;
+            }
+            Signals signals = pool.target.sample();
+            size_t desired = desiredWorkers(pool.policy, signals, pool.hot_streak, pool.cold_streak);
+
+            if (desired == signals.workers || now - pool.last_resize < pool.policy.cooldown) {
+                continue;
+            }
+            if (pool.target.resize(desired)) {
+                decisions.push_back(Decision{ pool.name, signals.workers, desired, signals, now });
+                history_.push_back(decisions.back());
+                if (history_.size() > MAX_HISTORY) {
+                    history_.erase(history_.begin());
+                }
+                pool.last_resize = now;
+                pool.hot_streak = 0;
+                pool.cold_streak = 0;
+            }
+        }
+        return decisions;
+    }
+
+    /**
+     * @brief Get recent resize decisions
+     * @return Up to the last 100 decisions, oldest first
+     */
+    std::vector<Decision> getHistory() const {
+        std::lock_guard lock(mutex_);
+        return history_;
+    }
+
+private:
+    static constexpr size_t MAX_HISTORY = 100;
+
+    struct PoolState {
+        std::string name;
+        Target target;
+        Policy policy;
+        size_t hot_streak{ 0 };
+        size_t cold_streak{ 0 };
+        Timestamp last_resize{};
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<PoolState> pools_;
+    std::vector<Decision> history_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_POOL_AUTOSCALER_HPP
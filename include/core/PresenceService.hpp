@@ -0,0 +1,444 @@
+#pragma once
+#ifndef WEBSOCKET_PRESENCE_SERVICE_HPP
+#define WEBSOCKET_PRESENCE_SERVICE_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class PresenceService
+ * @brief Room membership with batched join/leave deltas
+ *
+ * Sending every member the full member list on every change costs
+ * O(room size) per change, O(n^2) over a busy room's life. Here each room
+ * keeps its membership (with an opaque metadata string per member, e.g. a
+ * nickname) and a version:
+ *
+ * - join() returns a snapshot of the room at its current version, to be
+ *   sent to the new member only
+ * - changes are collected and published every Config::interval as one
+ *   delta per room (joins, metadata updates and leaves since the last
+ *   version); a member who joins and leaves within an interval never
+ *   appears in a delta
+ *
+ * so member-list traffic scales with churn rather than room size.
+ *
+ * Clients apply a delta when its "from" equals their version, drop it when
+ * "to" is not newer, and ask for a new snapshot() if they fell behind
+ * (deltas and a join's snapshot travel separately and may cross).
+ *
+ * Thread-safe. The publisher is called outside the service's lock, one
+ * flush at a time, so deltas for a room are published in version order.
+ */
+class PresenceService : public NonCopyable {
+public:
+    using Timestamp = std::chrono::steady_clock::time_point;
+
+    /**
+     * @brief Member and metadata
+     */
+    struct Member {
+        ClientID id{ 0 };
+        std::string metadata;
+    };
+
+    /**
+     * @brief Room state at a version
+     */
+    struct Snapshot {
+        std::string room;
+        uint64_t version{ 0 };
+        std::vector<Member> members;    ///< In ClientID order
+    };
+
+    /**
+     * @brief Net changes between two versions of a room
+     */
+    struct Delta {
+        std::string room;
+        uint64_t from_version{ 0 };
+        uint64_t to_version{ 0 };
+        std::vector<Member> joined;     ///< New members
+        std::vector<Member> updated;    ///< Members whose metadata changed
+        std::vector<ClientID> left;     ///< Members gone
+    };
+
+    /**
+     * @brief Delivers a delta
+     * @param delta Changes to send
+     * @param recipients Room members at delta.to_version
+     */
+    using Publisher = std::function<void(const Delta& delta, const std::vector<ClientID>& recipients)>;
+
+    /**
+     * @brief Service configuration
+     */
+    struct Config {
+        std::chrono::milliseconds interval{ 250 };      ///< Delta publication period used by tick()
+        std::function<Timestamp()> clock;               ///< Time source (empty = steady_clock)
+    };
+
+    /**
+     * @brief Counters
+     */
+    struct Stats {
+        size_t rooms{ 0 };                  ///< Non-empty rooms
+        size_t members{ 0 };                ///< Memberships across all rooms
+        uint64_t deltas{ 0 };               ///< Deltas published
+        uint64_t changes{ 0 };              ///< Member changes in published deltas
+        uint64_t coalesced{ 0 };            ///< Changes cancelled out before publication
+        uint64_t snapshots{ 0 };            ///< Snapshots handed out
+    };
+
+    /**
+     * @brief Create a presence service
+     * @param publisher Called with each delta
+     */
+    explicit PresenceService(Publisher publisher) : PresenceService(std::move(publisher), Config{}) {}
+
+    /**
+     * @brief Create a presence service
+     * @param publisher Called with each delta
+     * @param config Publication interval and clock
+     */
+    PresenceService(Publisher publisher, Config config)
+        : publisher_(std::move(publisher)), config_(std::move(config)), last_flush_(now()) {
+    }
+
+    /**
+     * @brief Add a member to a room (or update its metadata if already there)
+     * @param room Room name (created on first join)
+     * @param client Member
+     * @param metadata Opaque member data published to the room
+     * @return Room snapshot for the new member
+     *
+     * @note The member itself appears in the snapshot only once a delta has
+     *       published its join; that delta is also sent to the member.
+     */
+    Snapshot join(const std::string& room, ClientID client, std::string metadata) {
+        std::lock_guard lock(mutex_);
+        Room& state = rooms_[room];
+        setPending(room, state, client, std::move(metadata));
+        auto& memberships = memberships_[client];
+        if (std::find(memberships.begin(), memberships.end(), room) == memberships.end()) {
+            memberships.push_back(room);
+        }
+        ++snapshots_;
+        return snapshotOf(room, state);
+    }
+
+    /**
+     * @brief Change a member's metadata
+     * @param room Room name
+     * @param client Member
+     * @param metadata New metadata
+     * @return false if the client is not in the room
+     */
+    bool update(const std::string& room, ClientID client, std::string metadata) {
+        std::lock_guard lock(mutex_);
+        auto found = rooms_.find(room);
+        if (found == rooms_.end() || !isMember(found->second, client)) {
+            return false;
+        }
+        setPending(room, found->second, client, std::move(metadata));
+        return true;
+    }
+
+    /**
+     * @brief Remove a member from a room
+     * @param room Room name
+     * @param client Member
+     * @return false if the client was not in the room
+     */
+    bool leave(const std::string& room, ClientID client) {
+        std::lock_guard lock(mutex_);
+        auto found = rooms_.find(room);
+        if (found == rooms_.end() || !isMember(found->second, client)) {
+            return false;
+        }
+        setPending(room, found->second, client, std::nullopt);
+        auto memberships = memberships_.find(client);
+        if (memberships != memberships_.end()) {
+            auto& rooms = memberships->second;
+            rooms.erase(std::remove(rooms.begin(), rooms.end(), room), rooms.end());
+            if (rooms.empty()) {
+                memberships_.erase(memberships);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Remove a client from every room (call on disconnect)
+     * @param client Client
+     * @return Number of rooms left
+     */
+    size_t leaveAll(ClientID client) {
+        std::lock_guard lock(mutex_);
+        auto memberships = memberships_.find(client);
+        if (memberships == memberships_.end()) {
+            return 0;
+        }
+        const size_t count = memberships->second.size();
+        for (const std::string& room : memberships->second) {
+            auto found = rooms_.find(room);
+            if (found != rooms_.end()) {
+                setPending(room, found->second, client, std::nullopt);
+            }
+        }
+        memberships_.erase(memberships);
+        return count;
+    }
+
+    /**
+     * @brief Get a room's state at its current version (for resynchronising a client)
+     * @param room Room name
+     * @return Snapshot (version 0 and no members if the room does not exist)
+     */
+    Snapshot snapshot(const std::string& room) const {
+        std::lock_guard lock(mutex_);
+        ++snapshots_;
+        auto found = rooms_.find(room);
+        if (found == rooms_.end()) {
+            Snapshot empty;
+            empty.room = room;
+            return empty;
+        }
+        return snapshotOf(room, found->second);
+    }
+
+    /**
+     * @brief Publish deltas if the interval has elapsed
+     * @return Number of deltas published
+     *
+     * @note Call from a timer running at least as often as the interval
+     */
+    size_t tick() {
+        {
+            std::lock_guard lock(mutex_);
+            const Timestamp current = now();
+            if (current - last_flush_ < config_.interval) {
+                return 0;
+            }
+            last_flush_ = current;
+        }
+        return flush();
+    }
+
+    /**
+     * @brief Publish deltas for every room that changed, now
+     * @return Number of deltas published
+     */
+    size_t flush() {
+        std::lock_guard publishing(publish_mutex_);
+        std::vector<std::pair<Delta, std::vector<ClientID>>> ready;
+        {
+            std::lock_guard lock(mutex_);
+            for (const std::string& name : dirty_) {
+                auto found = rooms_.find(name);
+                if (found == rooms_.end()) {
+                    continue;
+                }
+                Room& room = found->second;
+                Delta delta = applyPending(name, room);
+                if (!delta.joined.empty() || !delta.updated.empty() || !delta.left.empty()) {
+                    changes_ += delta.joined.size() + delta.updated.size() + delta.left.size();
+                    std::vector<ClientID> recipients;
+                    recipients.reserve(room.members.size());
+                    for (const auto& member : room.members) {
+                        recipients.push_back(member.first);
+                    }
+                    ready.emplace_back(std::move(delta), std::move(recipients));
+                }
+                if (room.members.empty()) {
+                    rooms_.erase(found);
+                }
+            }
+            dirty_.clear();
+            deltas_ += ready.size();
+        }
+        for (const auto& [delta, recipients] : ready) {
+            if (publisher_ && !recipients.empty()) {
+                publisher_(delta, recipients);
+            }
+        }
+        return ready.size();
+    }
+
+    /**
+     * @brief Get counters
+     */
+    Stats getStats() const {
+        std::lock_guard lock(mutex_);
+        Stats stats;
+        for (const auto& entry : rooms_) {
+            stats.rooms += entry.second.members.empty() ? 0 : 1;
+            stats.members += entry.second.members.size();
+        }
+        stats.deltas = deltas_;
+        stats.changes = changes_;
+        stats.coalesced = coalesced_;
+        stats.snapshots = snapshots_;
+        return stats;
+    }
+
+    /**
+     * @brief Encode a delta as a JSON text message
+     * @param delta Delta
+     * @return {"type":"presence.delta","room":..,"from":..,"to":..,"joined":[{"id":..,"meta":..}],"updated":[..],"left":[ids]}
+     */
+    static std::string toJson(const Delta& delta) {
+        std::string json = "{\"type\":\"presence.delta\",\"room\":";
+        appendJsonString(json, delta.room);
+        json += ",\"from\":" + std::to_string(delta.from_version) + ",\"to\":" + std::to_string(delta.to_version);
+        json += ",\"joined\":";
+        appendMembers(json, delta.joined);
+        json += ",\"updated\":";
+        appendMembers(json, delta.updated);
+        json += ",\"left\":[";
+        for (size_t i = 0; i < delta.left.size(); ++i) {
+            json += (i == 0 ? "" : ",") + std::to_string(delta.left[i]);
+        }
+        json += "]}";
+        return json;
+    }
+
+    /**
+     * @brief Encode a snapshot as a JSON text message
+     * @param snapshot Snapshot
+     * @return {"type":"presence.snapshot","room":..,"version":..,"members":[{"id":..,"meta":..}]}
+     */
+    static std::string toJson(const Snapshot& snapshot) {
+        std::string json = "{\"type\":\"presence.snapshot\",\"room\":";
+        appendJsonString(json, snapshot.room);
+        json += ",\"version\":" + std::to_string(snapshot.version) + ",\"members\":";
+        appendMembers(json, snapshot.members);
+        json += "}";
+        return json;
+    }
+
+private:
+    struct Room {
+        uint64_t version{ 0 };
+        std::map<ClientID, std::string> members;                            ///< Published membership
+        std::unordered_map<ClientID, std::optional<std::string>> pending;   ///< Current state of changed members (nullopt = gone)
+    };
+
+    Timestamp now() const {
+        return config_.clock ? config_.clock() : std::chrono::steady_clock::now();
+    }
+
+    static bool isMember(const Room& room, ClientID client) {
+        auto pending = room.pending.find(client);
+        return pending != room.pending.end() ? pending->second.has_value() : room.members.count(client) != 0;
+    }
+
+    void setPending(const std::string& name, Room& room, ClientID client, std::optional<std::string> state) {
+        if (room.pending.empty()) {
+            dirty_.push_back(name);
+        }
+        room.pending[client] = std::move(state);
+    }
+
+    /// Fold pending changes into the published membership and describe them
+    Delta applyPending(const std::string& name, Room& room) {
+        Delta delta;
+        delta.room = name;
+        delta.from_version = room.version;
+        for (auto& [client, state] : room.pending) {
+            auto published = room.members.find(client);
+            if (state && published == room.members.end()) {
+                delta.joined.push_back(Member{ client, *state });
+                room.members.emplace(client, std::move(*state));
+            } else if (state && published->second != *state) {
+                published->second = std::move(*state);
+                delta.updated.push_back(Member{ client, published->second });
+            } else if (!state && published != room.members.end()) {
+                room.members.erase(published);
+                delta.left.push_back(client);
+            } else {
+                ++coalesced_;
+            }
+        }
+        room.pending.clear();
+        if (!delta.joined.empty() || !delta.updated.empty() || !delta.left.empty()) {
+            ++room.version;
+        }
+        delta.to_version = room.version;
+        return delta;
+    }
+
+    Snapshot snapshotOf(const std::string& name, const Room& room) const {
+        Snapshot snapshot;
+        snapshot.room = name;
+        snapshot.version = room.version;
+        snapshot.members.reserve(room.members.size());
+        for (const auto& [client, metadata] : room.members) {
+            snapshot.members.push_back(Member{ client, metadata });
+        }
+        return snapshot;
+    }
+
+    static void appendMembers(std::string& json, const std::vector<Member>& members) {
+        json += '[';
+        for (size_t i = 0; i < members.size(); ++i) {
+            json += i == 0 ? "{\"id\":" : ",{\"id\":";
+            json += std::to_string(members[i].id);
+            json += ",\"meta\":";
+            appendJsonString(json, members[i].metadata);
+            json += '}';
+        }
+        json += ']';
+    }
+
+    static void appendJsonString(std::string& json, const std::string& text) {
+        json += '"';
+        for (const char c : text) {
+            switch (c) {
+            case '"': json += "\\\""; break;
+            case '\\': json += "\\\\"; break;
+            case '\n': json += "\\n"; break;
+            case '\r': json += "\\r"; break;
+            case '\t': json += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    json += escaped;
+                } else {
+                    json += c;
+                }
+            }
+        }
+        json += '"';
+    }
+
+    Publisher publisher_;
+    Config config_;
+    mutable std::mutex mutex_;
+    std::mutex publish_mutex_;                                  ///< Serialises publication across flushes
+    std::unordered_map<std::string, Room> rooms_;
+    std::unordered_map<ClientID, std::vector<std::string>> memberships_;   ///< Rooms per client, for leaveAll()
+    std::vector<std::string> dirty_;                            ///< Rooms with pending changes
+    Timestamp last_flush_;
+    uint64_t deltas_{ 0 };
+    uint64_t changes_{ 0 };
+    uint64_t coalesced_{ 0 };
+    mutable uint64_t snapshots_{ 0 };
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_PRESENCE_SERVICE_HPP
@@ -0,0 +1,624 @@
+#pragma once
+#ifndef WEBSOCKET_RPC_SERVER_HPP
+#define WEBSOCKET_RPC_SERVER_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include "../protocol/BinaryCodec.hpp"
+#include "../utils/Metrics.hpp"
+#include "../utils/ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @brief RPC call outcome carried in every response
+ */
+enum class RpcStatus : uint8_t {
+    OK = 0,                 ///< Result (or stream chunk) in the body
+    FAILED = 1,             ///< Handler failed; body is the error text
+    NOT_FOUND = 2,          ///< No such method
+    DEADLINE_EXCEEDED = 3,  ///< Deadline passed before the handler finished
+    CANCELLED = 4,          ///< Cancelled by the client
+    OVERLOADED = 5          ///< Too many calls in flight; retry later
+};
+
+/**
+ * @brief Client -> server: start a call
+ */
+struct RpcRequest {
+    uint64_t id;                        ///< Correlation ID, unique among the client's calls in flight
+    uint32_t timeout_ms;                ///< Deadline from receipt (0 = server default)
+    std::string_view method;
+    std::span<const uint8_t> body;
+    WEBSOCKET_MESSAGE(0xFFF0, id, timeout_ms, method, body)
+};
+
+/**
+ * @brief Client -> server: cancel a call
+ */
+struct RpcCancel {
+    uint64_t id;
+    WEBSOCKET_MESSAGE(0xFFF1, id)
+};
+
+/**
+ * @brief Server -> client: result, stream chunk or error
+ */
+struct RpcResponse {
+    static constexpr uint8_t FLAG_MORE = 0x01;  ///< Stream chunk; more responses follow
+
+    uint64_t id;
+    RpcStatus status;
+    uint8_t flags;
+    std::span<const uint8_t> body;
+    WEBSOCKET_MESSAGE(0xFFF2, id, status, flags, body)
+};
+
+/**
+ * @class RpcServer
+ * @brief Pipelined request/response calls over a client's WebSocket
+ *
+ * Clients send RpcRequest messages (BinaryCodec ids 0xFFF0-0xFFF2 are
+ * reserved for RPC) with their own correlation IDs and may have many in
+ * flight at once. Each call runs on the server's handler pool, so a slow
+ * call does not hold up the others, and its response is sent as soon as it
+ * is ready, tagged with the request's ID.
+ *
+ * - Deadlines: per request (timeout_ms) capped by Config; tick() answers
+ *   overdue calls with DEADLINE_EXCEEDED
+ * - Cancellation: RpcCancel, a missed deadline or the client disconnecting
+ *   ends the call; the handler sees Call::cancelled() and its later writes
+ *   are dropped
+ * - Streaming: Call::write() sends chunks with FLAG_MORE before the final
+ *   finish()/fail()
+ * - Calls in flight are kept per client in a flat open-addressed table keyed
+ *   by correlation ID; handlers hold a Call value, not a table entry
+ * - Latency per method goes to a local histogram (getStats) and to Metrics
+ *   as "rpc.<method>.latency_us"
+ *
+ * Usage:
+ * RpcServer rpc([&](ClientID client, const Buffer& data) { return server.sendBinary(client, data); });
+ * rpc.on("echo", [](RpcServer::Call& call) { call.finish(call.body()); });
+ * server.onMessage([&](ClientID client, const Message& message) { rpc.dispatch(client, message); });
+ * server.onDisconnect([&](ClientID client) { rpc.disconnect(client); });
+ */
+class RpcServer : public NonCopyable {
+private:
+    struct SharedState;
+
+public:
+    using Sender = std::function<bool(ClientID, const Buffer&)>;
+
+    /**
+     * @brief One call, handed to the method handler
+     *
+     * Move it into a continuation to answer asynchronously. A call that is
+     * destroyed without finish() or fail() is answered with FAILED.
+     */
+    class Call {
+    public:
+        Call(Call&& other) noexcept { *this = std::move(other); }
+
+        Call& operator=(Call&& other) noexcept {
+            if (this != &other) {
+                abandon();
+                state_ = std::move(other.state_);
+                client_ = other.client_;
+                id_ = other.id_;
+                token_ = other.token_;
+                method_ = other.method_;
+                body_ = std::move(other.body_);
+                deadline_ = other.deadline_;
+                done_ = other.done_;
+                other.done_ = true;
+            }
+            return *this;
+        }
+
+        Call(const Call&) = delete;
+        Call& operator=(const Call&) = delete;
+
+        ~Call() { abandon(); }
+
+        ClientID client() const { return client_; }
+        uint64_t id() const { return id_; }
+        const Buffer& body() const { return body_; }
+        Timestamp deadline() const { return deadline_; }
+
+        /**
+         * @brief Check if the call has ended (cancelled, overdue or client gone)
+         */
+        bool cancelled() const {
+            auto state = state_.lock();
+            return done_ || !state || !state->isLive(client_, id_, token_);
+        }
+
+        /**
+         * @brief Send a stream chunk
+         * @return false if the call has ended
+         */
+        bool write(const Buffer& chunk) {
+            auto state = state_.lock();
+            if (done_ || !state || !state->isLive(client_, id_, token_)) {
+                return false;
+            }
+            return state->send(client_, id_, RpcStatus::OK, RpcResponse::FLAG_MORE, chunk);
+        }
+
+        /**
+         * @brief Send the final result
+         */
+        void finish(const Buffer& result = Buffer{}) {
+            complete(RpcStatus::OK, result);
+        }
+
+        /**
+         * @brief Fail the call
+         * @param error Error text for the client
+         */
+        void fail(const std::string& error) {
+            complete(RpcStatus::FAILED, Buffer(error.begin(), error.end()));
+        }
+
+    private:
+        friend class RpcServer;
+
+        Call(std::weak_ptr<SharedState> state, ClientID client, uint64_t id, uint64_t token,
+            size_t method, Buffer body, Timestamp deadline)
+            : state_(std::move(state)), client_(client), id_(id), token_(token),
+            method_(method), body_(std::move(body)), deadline_(deadline), done_(false) {
+        }
+
+        void complete(RpcStatus status, const Buffer& body) {
+            if (done_) {
+                return;
+            }
+            done_ = true;
+            auto state = state_.lock();
+            if (state && state->finish(client_, id_, token_, method_, status)) {
+                state->send(client_, id_, status, 0, body);
+            }
+        }
+
+        void abandon() {
+            if (!done_) {
+                fail("handler returned without a response");
+            }
+        }
+
+        std::weak_ptr<SharedState> state_;
+        ClientID client_{ 0 };
+        uint64_t id_{ 0 };
+        uint64_t token_{ 0 };
+        size_t method_{ 0 };
+        Buffer body_;
+        Timestamp deadline_{};
+        bool done_{ true };
+    };
+
+    using Handler = std::function<void(Call& call)>;
+
+    /**
+     * @brief Server configuration
+     */
+    struct Config {
+        size_t threads{ 4 };                                        ///< Handler pool size
+        size_t max_in_flight_per_client{ 256 };                     ///< Further calls get OVERLOADED
+        Duration default_deadline{ std::chrono::seconds(30) };      ///< When the request gives none
+        Duration max_deadline{ std::chrono::minutes(5) };           ///< Cap on requested deadlines
+        std::function<Timestamp()> clock;                           ///< Time source (empty = steady_clock)
+    };
+
+    /**
+     * @brief Per-method statistics
+     */
+    struct Stats {
+        uint64_t calls{ 0 };                ///< Calls started
+        uint64_t succeeded{ 0 };            ///< Finished with OK
+        uint64_t failed{ 0 };               ///< Finished with FAILED
+        uint64_t cancelled{ 0 };            ///< Cancelled by the client or by disconnecting
+        uint64_t deadline_exceeded{ 0 };    ///< Answered by tick() with DEADLINE_EXCEEDED
+        uint64_t overloaded{ 0 };           ///< Refused for the in-flight limit or a full pool
+        int64_t latency_p50_us{ 0 };        ///< Median latency (bucket upper bound)
+        int64_t latency_p99_us{ 0 };        ///< 99th percentile latency (bucket upper bound)
+    };
+
+    explicit RpcServer(Sender sender) : RpcServer(std::move(sender), Config{}) {}
+
+    /**
+     * @brief Construct server
+     * @param sender Sends a binary message to a client; called from handler threads
+     * @param config Server configuration
+     */
+    RpcServer(Sender sender, const Config& config)
+        : state_(std::make_shared<SharedState>(std::move(sender), config)),
+        pool_(std::make_unique<ThreadPool>(std::max<size_t>(config.threads, 1))) {
+    }
+
+    ~RpcServer() {
+        pool_.reset(); // Finish queued calls while the state is still alive
+    }
+
+    /**
+     * @brief Register a method
+     * @param method Method name
+     * @param handler Handler, run on the handler pool
+     *
+     * @note Register methods before calls start arriving
+     */
+    void on(const std::string& method, Handler handler) {
+        std::lock_guard lock(state_->mutex);
+        auto found = state_->method_index.find(method);
+        if (found != state_->method_index.end()) {
+            state_->methods[found->second]->handler = std::move(handler);
+            return;
+        }
+        auto entry = std::make_unique<Method>();
+        entry->name = method;
+        entry->metric_name = "rpc." + method + ".latency_us";
+        entry->handler = std::move(handler);
+        state_->method_index.emplace(method, state_->methods.size());
+        state_->methods.push_back(std::move(entry));
+    }
+
+    /**
+     * @brief Handle an inbound message
+     * @param client_id Sending client
+     * @param message Received message
+     * @return true if it was an RPC message (handled), false to pass it on
+     */
+    bool dispatch(ClientID client_id, const Message& message) {
+        if (message.isText) {
+            return false;
+        }
+        const auto type = BinaryCodec::peekId(message.data.data(), message.data.size());
+        if (type == RpcRequest::MESSAGE_ID) {
+            RpcRequest request{};
+            if (BinaryCodec::decode(message.data, request)) {
+                startCall(client_id, request);
+            }
+            return true;
+        }
+        if (type == RpcCancel::MESSAGE_ID) {
+            RpcCancel cancel{};
+            if (BinaryCodec::decode(message.data, cancel)) {
+                cancelCall(client_id, cancel.id);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Drop a client's calls in flight (call on disconnect)
+     */
+    void disconnect(ClientID client_id) {
+        std::lock_guard lock(state_->mutex);
+        auto found = state_->sessions.find(client_id);
+        if (found == state_->sessions.end()) {
+            return;
+        }
+        for (const auto& slot : found->second.slots) {
+            if (slot.used) {
+                state_->methods[slot.method]->stats.cancelled++;
+            }
+        }
+        state_->sessions.erase(found);
+    }
+
+    /**
+     * @brief Answer overdue calls with DEADLINE_EXCEEDED
+     *
+     * Call periodically (e.g. from the server's timer).
+     */
+    void tick() {
+        std::vector<std::pair<ClientID, uint64_t>> expired;
+        {
+            std::lock_guard lock(state_->mutex);
+            const Timestamp now = state_->now();
+            for (auto& [client, session] : state_->sessions) {
+                for (size_t i = 0; i < session.slots.size();) {
+                    CallSlot& slot = session.slots[i];
+                    if (slot.used && slot.deadline <= now) {
+                        state_->methods[slot.method]->stats.deadline_exceeded++;
+                        expired.emplace_back(client, slot.id);
+                        session.erase(i); // Backward shift may refill slot i
+                        continue;
+                    }
+                    ++i;
+                }
+            }
+        }
+        for (const auto& [client, id] : expired) {
+            state_->send(client, id, RpcStatus::DEADLINE_EXCEEDED, 0, Buffer{});
+        }
+    }
+
+    /**
+     * @brief Get statistics for a method
+     * @return Stats (zeroed for unknown methods)
+     */
+    Stats getStats(const std::string& method) const {
+        std::lock_guard lock(state_->mutex);
+        auto found = state_->method_index.find(method);
+        if (found == state_->method_index.end()) {
+            return Stats{};
+        }
+        const Method& entry = *state_->methods[found->second];
+        Stats stats = entry.stats;
+        stats.latency_p50_us = entry.latency.percentile(50.0);
+        stats.latency_p99_us = entry.latency.percentile(99.0);
+        return stats;
+    }
+
+    /**
+     * @brief Get the number of calls in flight for a client
+     */
+    size_t getInFlight(ClientID client_id) const {
+        std::lock_guard lock(state_->mutex);
+        auto found = state_->sessions.find(client_id);
+        return found == state_->sessions.end() ? 0 : found->second.count;
+    }
+
+private:
+    struct Method {
+        std::string name;
+        std::string metric_name;
+        Handler handler;
+        Stats stats;
+        Metrics::HistogramStats latency;
+    };
+
+    struct CallSlot {
+        uint64_t id{ 0 };               ///< Client's correlation ID
+        uint64_t token{ 0 };            ///< Distinguishes reuse of the same ID
+        size_t method{ 0 };
+        Timestamp started{};
+        Timestamp deadline{};
+        bool used{ false };
+    };
+
+    /**
+     * @brief A client's calls in flight: open addressing, linear probing,
+     *        backward-shift deletion (no tombstones)
+     */
+    struct Session {
+        std::vector<CallSlot> slots;
+        size_t count{ 0 };
+
+        Session() : slots(16) {}
+
+        size_t home(uint64_t id) const {
+            return static_cast<size_t>((id * 0x9E3779B97F4A7C15ULL) >> 32) & (slots.size() - 1);
+        }
+
+        CallSlot* find(uint64_t id) {
+            for (size_t i = home(id);; i = (i + 1) & (slots.size() - 1)) {
+                if (!slots[i].used) {
+                    return nullptr;
+                }
+                if (slots[i].id == id) {
+                    return &slots[i];
+                }
+            }
+        }
+
+        CallSlot* insert(uint64_t id) {
+            if ((count + 1) * 2 > slots.size()) {
+                grow();
+            }
+            size_t i = home(id);
+            while (slots[i].used) {
+                i = (i + 1) & (slots.size() - 1);
+            }
+            slots[i] = CallSlot{};
+            slots[i].id = id;
+            slots[i].used = true;
+            ++count;
+            return &slots[i];
+        }
+
+        void erase(size_t hole) {
+            const size_t mask = slots.size() - 1;
+            slots[hole].used = false;
+            --count;
+            for (size_t i = (hole + 1) & mask; slots[i].used; i = (i + 1) & mask) {
+                // Move back entries whose home is not in (hole, i]
+                const size_t h = home(slots[i].id);
+                if (((i - h) & mask) >= ((i - hole) & mask)) {
+                    slots[hole] = slots[i];
+                    slots[i].used = false;
+                    hole = i;
+                }
+            }
+        }
+
+        void erase(CallSlot* slot) {
+            erase(static_cast<size_t>(slot - slots.data()));
+        }
+
+        /// Double the table; keeps the load factor at or below one half
+        void grow() {
+            std::vector<CallSlot> old(slots.size() * 2);
+            old.swap(slots);
+            count = 0;
+            for (const auto& slot : old) {
+                if (slot.used) {
+                    *insert(slot.id) = slot;
+                }
+            }
+        }
+    };
+
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+
+    /// State shared with handler threads and Call objects
+    struct SharedState {
+        SharedState(Sender s, const Config& cfg) : sender(std::move(s)), config(cfg) {
+            config.max_in_flight_per_client = std::max<size_t>(config.max_in_flight_per_client, 1);
+        }
+
+        Timestamp now() const {
+            return config.clock ? config.clock() : std::chrono::steady_clock::now();
+        }
+
+        bool isLive(ClientID client, uint64_t id, uint64_t token) {
+            std::lock_guard lock(mutex);
+            auto found = sessions.find(client);
+            if (found == sessions.end()) {
+                return false;
+            }
+            const CallSlot* slot = found->second.find(id);
+            return slot && slot->token == token;
+        }
+
+        /// Remove a call and record its outcome; false if it already ended
+        bool finish(ClientID client, uint64_t id, uint64_t token, size_t method, RpcStatus status) {
+            int64_t latency_us = 0;
+            {
+                std::lock_guard lock(mutex);
+                auto found = sessions.find(client);
+                if (found == sessions.end()) {
+                    return false;
+                }
+                CallSlot* slot = found->second.find(id);
+                if (!slot || slot->token != token) {
+                    return false;
+                }
+                latency_us = std::chrono::duration_cast<std::chrono::microseconds>(now() - slot->started).count();
+                found->second.erase(slot);
+                Method& entry = *methods[method];
+                (status == RpcStatus::OK ? entry.stats.succeeded : entry.stats.failed)++;
+                entry.latency.record(latency_us);
+            }
+            Metrics::getInstance().recordHistogram(methods[method]->metric_name, latency_us);
+            return true;
+        }
+
+        bool send(ClientID client, uint64_t id, RpcStatus status, uint8_t flags, const Buffer& body) {
+            return sender(client, BinaryCodec::encode(RpcResponse{ id, status, flags, body }));
+        }
+
+        mutable std::mutex mutex;
+        Sender sender;
+        Config config;
+        std::vector<std::unique_ptr<Method>> methods;
+        std::unordered_map<std::string, size_t, NameHash, std::equal_to<>> method_index;
+        std::unordered_map<ClientID, Session> sessions;
+        uint64_t next_token{ 1 };
+    };
+
+    void startCall(ClientID client_id, const RpcRequest& request) {
+        RpcStatus refusal = RpcStatus::OK;
+        std::string error;
+        size_t method = 0;
+        uint64_t token = 0;
+        Timestamp deadline{};
+        {
+            std::lock_guard lock(state_->mutex);
+            auto found = state_->method_index.find(request.method);
+            if (found == state_->method_index.end()) {
+                refusal = RpcStatus::NOT_FOUND;
+            }
+            else {
+                method = found->second;
+                Method& entry = *state_->methods[method];
+                auto session = state_->sessions.try_emplace(client_id).first;
+                if (session->second.find(request.id)) {
+                    refusal = RpcStatus::FAILED;
+                    error = "duplicate call id";
+                }
+                else if (session->second.count >= state_->config.max_in_flight_per_client) {
+                    refusal = RpcStatus::OVERLOADED;
+                    entry.stats.overloaded++;
+                }
+                else {
+                    const Timestamp now = state_->now();
+                    Duration timeout = request.timeout_ms ?
+                        std::chrono::duration_cast<Duration>(std::chrono::milliseconds(request.timeout_ms)) :
+                        state_->config.default_deadline;
+                    deadline = now + std::min(timeout, state_->config.max_deadline);
+                    token = state_->next_token++;
+                    CallSlot* slot = session->second.insert(request.id);
+                    slot->token = token;
+                    slot->method = method;
+                    slot->started = now;
+                    slot->deadline = deadline;
+                    entry.stats.calls++;
+                }
+            }
+        }
+        if (refusal != RpcStatus::OK) {
+            state_->send(client_id, request.id, refusal, 0, Buffer(error.begin(), error.end()));
+            return;
+        }
+
+        // Shared with the task so a refused enqueue leaves it here to be retired quietly
+        std::shared_ptr<Call> call(new Call(state_, client_id, request.id, token, method,
+            Buffer(request.body.begin(), request.body.end()), deadline));
+        try {
+            pool_->enqueue([call, state = std::weak_ptr<SharedState>(state_)] {
+                auto shared = state.lock();
+                if (!shared || call->cancelled()) {
+                    call->done_ = true; // Already answered (cancel, deadline) or client gone
+                    return;
+                }
+                shared->methods[call->method_]->handler(*call);
+            });
+        }
+        catch (const std::exception&) {
+            // Pool queue full or stopping
+            call->done_ = true;
+            {
+                std::lock_guard lock(state_->mutex);
+                auto session = state_->sessions.find(client_id);
+                if (session != state_->sessions.end()) {
+                    CallSlot* slot = session->second.find(request.id);
+                    if (slot && slot->token == token) {
+                        session->second.erase(slot);
+                    }
+                }
+                state_->methods[method]->stats.calls--;
+                state_->methods[method]->stats.overloaded++;
+            }
+            state_->send(client_id, request.id, RpcStatus::OVERLOADED, 0, Buffer{});
+        }
+    }
+
+    void cancelCall(ClientID client_id, uint64_t id) {
+        {
+            std::lock_guard lock(state_->mutex);
+            auto session = state_->sessions.find(client_id);
+            if (session == state_->sessions.end()) {
+                return;
+            }
+            CallSlot* slot = session->second.find(id);
+            if (!slot) {
+                return;
+            }
+            state_->methods[slot->method]->stats.cancelled++;
+            session->second.erase(slot);
+        }
+        state_->send(client_id, id, RpcStatus::CANCELLED, 0, Buffer{});
+    }
+
+    std::shared_ptr<SharedState> state_;
+    std::unique_ptr<ThreadPool> pool_;      ///< Declared after state_: destroyed first
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_RPC_SERVER_HPP
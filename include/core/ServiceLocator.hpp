@@ -4,11 +4,15 @@
 
 #include "../common/Types.hpp"
 #include "../common/NonCopyable.hpp"
+#include "../common/Macros.hpp"
 #include <memory>
 #include <unordered_map>
 #include <string>
 #include <typeindex>
 #include <mutex>
+#include <atomic>
+#include <vector>
+#include <functional>
 
 WEBSOCKET_NAMESPACE_BEGIN
 
@@ -22,6 +26,12 @@ WEBSOCKET_NAMESPACE_BEGIN
  * - Scoped service lifetimes
  * - Thread-safe service access
  * - Service dependency resolution
+ * - Lock-free typed resolution after freeze()
+ *
+ * Every service type gets a process-wide slot index the first time it is
+ * used. Once startup is complete, freeze() copies default (unnamed)
+ * registrations into a slot table; get<T>() is then an indexed load with no
+ * locking and no string keys. Named services stay on the resolve() path.
  *
  * Design Pattern: Service Locator + Dependency Injection Container
  */
@@ -45,8 +55,25 @@ WEBSOCKET_NAMESPACE_BEGIN
             Lifetime lifetime;              ///< Service lifetime
             std::function<std::shared_ptr<void>()> factory; ///< Instance factory
             std::shared_ptr<void> instance; ///< Cached instance (for singletons)
+            size_t slot{ NO_SLOT };         ///< Typed slot (default registrations only)
         };
 
+        /**
+         * @brief Slot value for named registrations
+         */
+        static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+
+        /**
+         * @brief Get the typed slot index of a service type
+         * @tparam T Service type
+         * @return Process-wide index, assigned on first use
+         */
+        template<typename T>
+        static size_t slotOf() {
+            static const size_t index = next_slot_.fetch_add(1, std::memory_order_relaxed);
+            return index;
+        }
+
         /**
          * @brief Default constructor
          */
@@ -71,6 +98,9 @@ WEBSOCKET_NAMESPACE_BEGIN
                 "Implementation must derive from Interface");
 
             std::lock_guard lock(mutex_);
+            if (frozen_.load(std::memory_order_relaxed)) {
+                return false; // Registrations are fixed after freeze()
+            }
 
             std::type_index type = typeid(Interface);
             std::string service_name = name.empty() ? type.name() : name;
@@ -93,6 +123,7 @@ WEBSOCKET_NAMESPACE_BEGIN
                 nullptr
             };
 
+            registration.slot = name.empty() ? slotOf<Interface>() : NO_SLOT;
             services_.emplace(key, std::move(registration));
             return true;
         }
@@ -110,6 +141,9 @@ WEBSOCKET_NAMESPACE_BEGIN
             const std::string& name = "",
             Lifetime lifetime = Lifetime::SINGLETON) {
             std::lock_guard lock(mutex_);
+            if (frozen_.load(std::memory_order_relaxed)) {
+                return false; // Registrations are fixed after freeze()
+            }
 
             std::type_index type = typeid(Interface);
             std::string service_name = name.empty() ? type.name() : name;
@@ -129,6 +163,7 @@ WEBSOCKET_NAMESPACE_BEGIN
                 nullptr
             };
 
+            registration.slot = name.empty() ? slotOf<Interface>() : NO_SLOT;
             services_.emplace(key, std::move(registration));
             return true;
         }
@@ -143,6 +178,9 @@ WEBSOCKET_NAMESPACE_BEGIN
         template<typename Interface>
         bool registerInstance(std::shared_ptr<Interface> instance, const std::string& name = "") {
             std::lock_guard lock(mutex_);
+            if (frozen_.load(std::memory_order_relaxed)) {
+                return false; // Registrations are fixed after freeze()
+            }
 
             std::type_index type = typeid(Interface);
             std::string service_name = name.empty() ? type.name() : name;
@@ -160,6 +198,7 @@ WEBSOCKET_NAMESPACE_BEGIN
                 std::static_pointer_cast<void>(instance)
             };
 
+            registration.slot = name.empty() ? slotOf<Interface>() : NO_SLOT;
             services_.emplace(key, std::move(registration));
             return true;
         }
@@ -230,6 +269,9 @@ WEBSOCKET_NAMESPACE_BEGIN
         template<typename T>
         bool unregister(const std::string& name = "") {
             std::lock_guard lock(mutex_);
+            if (frozen_.load(std::memory_order_relaxed)) {
+                return false;
+            }
 
             std::type_index type = typeid(T);
             std::string service_name = name.empty() ? type.name() : name;
@@ -238,10 +280,97 @@ WEBSOCKET_NAMESPACE_BEGIN
             return services_.erase(key) > 0;
         }
 
+        /**
+         * @brief Resolve a default service through its typed slot
+         * @tparam T Service type to resolve
+         * @return Shared pointer to service instance, nullptr if not found
+         *
+         * @note Lock-free once frozen; before freeze() this forwards to resolve()
+         */
+        template<typename T>
+        std::shared_ptr<T> get() {
+            if (!frozen_.load(std::memory_order_acquire)) {
+                return resolve<T>();
+            }
+            const size_t index = slotOf<T>();
+            if (index >= slots_.size()) {
+                return nullptr;
+            }
+            const auto& slot = slots_[index];
+            if (slot.instance) {
+                return std::static_pointer_cast<T>(slot.instance);
+            }
+            return slot.factory ? std::static_pointer_cast<T>(slot.factory()) : nullptr;
+        }
+
+        /**
+         * @brief Get a raw pointer to a default singleton through its typed slot
+         * @tparam T Service type
+         * @return Pointer owned by the locator, nullptr if not frozen or not a singleton
+         *
+         * @note Avoids the reference count update of get(); valid for the locator's lifetime
+         */
+        template<typename T>
+        T* getUnowned() const {
+            if (!frozen_.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+            const size_t index = slotOf<T>();
+            return index < slots_.size() ? static_cast<T*>(slots_[index].instance.get()) : nullptr;
+        }
+
+        /**
+         * @brief Freeze registrations and build the typed slot table
+         *
+         * Instantiates default singletons, copies them (and transient
+         * factories) into their slots and rejects further registrations.
+         * Call once after startup, before request paths resolve services.
+         */
+        void freeze() {
+            std::lock_guard lock(mutex_);
+            if (frozen_.load(std::memory_order_relaxed)) {
+                return;
+            }
+            slots_.assign(next_slot_.load(std::memory_order_relaxed), Slot{});
+            for (auto& [key, registration] : services_) {
+                if (registration.slot == NO_SLOT) {
+                    continue;
+                }
+                auto& slot = slots_[registration.slot];
+                if (registration.lifetime == Lifetime::SINGLETON) {
+                    if (!registration.instance) {
+                        registration.instance = registration.factory();
+                    }
+                    slot.instance = registration.instance;
+                }
+                else {
+                    slot.factory = registration.factory;
+                }
+            }
+            frozen_.store(true, std::memory_order_release);
+        }
+
+        /**
+         * @brief Check if registrations are frozen
+         * @return true after freeze()
+         */
+        bool isFrozen() const { return frozen_.load(std::memory_order_acquire); }
+
         /**
          * @brief Clear all service registrations
+         *
+         * @note Only allowed before freeze(): get() reads the slot table
+         *       without a lock once frozen, so it is never mutated again.
+         *       Asserts in debug builds and does nothing in release builds.
          */
-        void clear();
+        void clear() {
+            std::lock_guard lock(mutex_);
+            WEBSOCKET_ASSERT(!frozen_.load(std::memory_order_relaxed), "ServiceLocator::clear() after freeze()");
+            if (frozen_.load(std::memory_order_relaxed)) {
+                return;
+            }
+            services_.clear();
+        }
 
         /**
          * @brief Get number of registered services
@@ -260,9 +389,20 @@ WEBSOCKET_NAMESPACE_BEGIN
             return std::string(type.name()) + ":" + name;
         }
 
+        /**
+         * @brief Typed slot, immutable after freeze()
+         */
+        struct Slot {
+            std::shared_ptr<void> instance;                 ///< Singleton instance
+            std::function<std::shared_ptr<void>()> factory; ///< Transient/scoped factory
+        };
+
         // Member variables
         mutable std::mutex mutex_;
         std::unordered_map<std::string, ServiceRegistration> services_;
+        std::vector<Slot> slots_;                   ///< Indexed by slotOf<T>()
+        std::atomic<bool> frozen_{ false };         ///< Slot table published
+        static inline std::atomic<size_t> next_slot_{ 0 };
 };
 
 WEBSOCKET_NAMESPACE_END
@@ -0,0 +1,382 @@
+#pragma once
+#ifndef WEBSOCKET_STARTUP_SCHEDULER_HPP
+#define WEBSOCKET_STARTUP_SCHEDULER_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class StartupScheduler
+ * @brief Runs a dependency DAG of startup tasks in parallel, phase by phase
+ *
+ * Phases run strictly in ascending order. Within a phase every task starts as
+ * soon as all of its dependencies have finished, on a bounded set of worker
+ * threads. Dependencies on tasks of earlier phases are satisfied by the phase
+ * barrier.
+ *
+ * Each task has its own timeout. A task that fails or times out aborts the
+ * run: no further tasks are started and run() returns once the tasks already
+ * executing have finished (a timed-out task is abandoned, not waited for).
+ *
+ * The report lists per-task timing and the critical path, i.e. the chain of
+ * tasks that determined total startup time.
+ */
+class StartupScheduler : public NonCopyable {
+public:
+    /**
+     * @brief Startup task
+     */
+    struct Task {
+        std::string name;                       ///< Unique task name
+        int phase{ 0 };                         ///< Phase (lower runs first)
+        std::vector<std::string> dependencies;  ///< Tasks that must finish first
+        std::function<bool(std::string& error)> run; ///< Task body; false on failure
+        std::chrono::milliseconds timeout{ 30000 }; ///< Time allowed for this task
+    };
+
+    /**
+     * @brief Timing of one task
+     */
+    struct TaskTiming {
+        std::string name;                       ///< Task name
+        int phase{ 0 };                         ///< Task phase
+        Duration start_offset{ 0 };             ///< Start relative to run() start
+        Duration duration{ 0 };                 ///< Execution time
+        bool started{ false };                  ///< Task was started
+        bool success{ false };                  ///< Task completed successfully
+        bool timed_out{ false };                ///< Task exceeded its timeout
+        bool critical{ false };                 ///< Task is on the critical path
+        std::string error;                      ///< Failure description
+    };
+
+    /**
+     * @brief Result of a run
+     */
+    struct Report {
+        bool success{ false };                  ///< All tasks completed
+        Duration total{ 0 };                    ///< Wall time of run()
+        Duration critical_path_duration{ 0 };   ///< Sum of critical task durations
+        std::vector<std::string> critical_path; ///< Critical tasks, first to last
+        std::vector<TaskTiming> tasks;          ///< Per-task timing, in registration order
+        std::string failed_task;                ///< First task that failed (if any)
+    };
+
+    /**
+     * @brief Construct scheduler
+     * @param max_parallel Worker threads (0 = hardware concurrency)
+     */
+    explicit StartupScheduler(size_t max_parallel = 0)
+        : max_parallel_(max_parallel > 0 ? max_parallel
+            : std::max<size_t>(std::thread::hardware_concurrency(), 1)) {
+    }
+
+    /**
+     * @brief Add a task
+     * @param task Task to run
+     */
+    void addTask(Task task) {
+        tasks_.push_back(std::move(task));
+    }
+
+    /**
+     * @brief Run every task
+     * @return Report with per-task timing and the critical path
+     */
+    Report run() {
+        auto state = std::make_shared<State>();
+        state->tasks = tasks_;
+        state->timings.resize(tasks_.size());
+        state->status.assign(tasks_.size(), Status::PENDING);
+        state->finished_at.resize(tasks_.size());
+        state->started = std::chrono::steady_clock::now();
+
+        Report report;
+        for (size_t i = 0; i < tasks_.size(); ++i) {
+            state->timings[i].name = tasks_[i].name;
+            state->timings[i].phase = tasks_[i].phase;
+            state->index[tasks_[i].name] = i;
+        }
+
+        std::string error;
+        if (!buildGraph(*state, error)) {
+            report.failed_task = error;
+            report.tasks = state->timings;
+            return report;
+        }
+
+        std::vector<std::thread> workers;
+        const size_t worker_count = std::min(max_parallel_, std::max<size_t>(tasks_.size(), 1));
+        for (size_t i = 0; i < worker_count; ++i) {
+            workers.emplace_back([state] { workerLoop(*state); });
+        }
+
+        std::vector<int> phases;
+        for (const auto& task : tasks_) {
+            phases.push_back(task.phase);
+        }
+        std::sort(phases.begin(), phases.end());
+        phases.erase(std::unique(phases.begin(), phases.end()), phases.end());
+
+        {
+            std::unique_lock lock(state->mutex);
+            for (int phase : phases) {
+                if (!runPhase(*state, lock, phase)) {
+                    break;
+                }
+            }
+            // Let tasks already in flight finish; only timed-out ones are abandoned
+            state->cv.wait(lock, [&] { return state->executing == state->abandoned; });
+            state->stop = true;
+        }
+        state->cv.notify_all();
+
+        // A timed-out task may never return; its worker keeps the shared state alive
+        const bool abandoned = [&] { std::lock_guard lock(state->mutex); return state->abandoned > 0; }();
+        for (auto& worker : workers) {
+            if (abandoned) {
+                worker.detach();
+            }
+            else {
+                worker.join();
+            }
+        }
+
+        std::lock_guard lock(state->mutex);
+        report.total = std::chrono::steady_clock::now() - state->started;
+        report.failed_task = state->failed_task;
+        report.success = state->failed_task.empty();
+        markCriticalPath(*state, report);
+        report.tasks = state->timings;
+        return report;
+    }
+
+private:
+    enum class Status : uint8_t { PENDING, READY, RUNNING, DONE, FAILED };
+
+    struct State {
+        std::vector<Task> tasks;
+        std::vector<TaskTiming> timings;
+        std::vector<Status> status;
+        std::vector<Timestamp> finished_at;
+        std::vector<std::vector<size_t>> dependents;    ///< Same-phase dependents
+        std::vector<size_t> waiting_on;                 ///< Unfinished same-phase dependencies
+        std::unordered_map<std::string, size_t> index;
+        std::deque<size_t> ready;
+        std::mutex mutex;
+        std::condition_variable cv;
+        Timestamp started{};
+        size_t executing{ 0 };
+        size_t abandoned{ 0 };                          ///< Timed-out tasks still executing
+        size_t finished_in_phase{ 0 };
+        std::string failed_task;
+        bool stop{ false };
+    };
+
+    static bool buildGraph(State& state, std::string& error) {
+        const size_t count = state.tasks.size();
+        state.dependents.assign(count, {});
+        state.waiting_on.assign(count, 0);
+        if (state.index.size() != count) {
+            error = "duplicate task name";
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            for (const auto& dependency : state.tasks[i].dependencies) {
+                auto it = state.index.find(dependency);
+                if (it == state.index.end()) {
+                    error = state.tasks[i].name + ": unknown dependency " + dependency;
+                    return false;
+                }
+                const auto& target = state.tasks[it->second];
+                if (target.phase > state.tasks[i].phase) {
+                    error = state.tasks[i].name + ": depends on later phase " + dependency;
+                    return false;
+                }
+                if (target.phase == state.tasks[i].phase) {
+                    state.dependents[it->second].push_back(i);
+                    state.waiting_on[i]++;
+                }
+            }
+        }
+        return true;
+    }
+
+    static bool runPhase(State& state, std::unique_lock<std::mutex>& lock, int phase) {
+        size_t phase_size = 0;
+        state.finished_in_phase = 0;
+        for (size_t i = 0; i < state.tasks.size(); ++i) {
+            if (state.tasks[i].phase != phase) {
+                continue;
+            }
+            phase_size++;
+            if (state.waiting_on[i] == 0) {
+                state.status[i] = Status::READY;
+                state.ready.push_back(i);
+            }
+        }
+        state.cv.notify_all();
+
+        while (state.finished_in_phase < phase_size && state.failed_task.empty()) {
+            if (state.ready.empty() && state.executing == 0) {
+                state.failed_task = "dependency cycle in phase " + std::to_string(phase);
+                return false;
+            }
+
+            Timestamp deadline = Timestamp::max();
+            for (size_t i = 0; i < state.tasks.size(); ++i) {
+                if (state.status[i] == Status::RUNNING) {
+                    deadline = std::min(deadline, taskDeadline(state, i));
+                }
+            }
+            state.cv.wait_until(lock, deadline);
+
+            const auto now = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < state.tasks.size(); ++i) {
+                if (state.status[i] == Status::RUNNING && now >= taskDeadline(state, i)) {
+                    auto& timing = state.timings[i];
+                    timing.timed_out = true;
+                    state.abandoned++;
+                    timing.duration = now - state.started - timing.start_offset;
+                    timing.error = "timed out after " + std::to_string(state.tasks[i].timeout.count()) + " ms";
+                    state.status[i] = Status::FAILED;
+                    state.finished_at[i] = now;
+                    if (state.failed_task.empty()) {
+                        state.failed_task = state.tasks[i].name;
+                    }
+                }
+            }
+        }
+        // Do not start anything else once a task failed
+        state.ready.clear();
+        return state.failed_task.empty();
+    }
+
+    static Timestamp taskDeadline(const State& state, size_t i) {
+        return state.started + state.timings[i].start_offset + state.tasks[i].timeout;
+    }
+
+    static void workerLoop(State& state) {
+        std::unique_lock lock(state.mutex);
+        while (true) {
+            state.cv.wait(lock, [&] { return state.stop || !state.ready.empty(); });
+            if (state.stop) {
+                return;
+            }
+            const size_t i = state.ready.front();
+            state.ready.pop_front();
+            state.status[i] = Status::RUNNING;
+            state.timings[i].started = true;
+            state.timings[i].start_offset = std::chrono::steady_clock::now() - state.started;
+            state.executing++;
+            // The phase loop recomputes its deadline from the running tasks
+            state.cv.notify_all();
+            lock.unlock();
+
+            std::string error;
+            bool ok = false;
+            try {
+                ok = state.tasks[i].run ? state.tasks[i].run(error) : true;
+            }
+            catch (const std::exception& e) {
+                error = e.what();
+            }
+            const auto finished = std::chrono::steady_clock::now();
+
+            lock.lock();
+            state.executing--;
+            if (state.timings[i].timed_out) {
+                state.abandoned--;
+            }
+            if (state.status[i] == Status::RUNNING) {
+                auto& timing = state.timings[i];
+                timing.duration = finished - state.started - timing.start_offset;
+                timing.success = ok;
+                timing.error = error;
+                state.finished_at[i] = finished;
+                state.finished_in_phase++;
+                if (ok) {
+                    state.status[i] = Status::DONE;
+                    for (size_t dependent : state.dependents[i]) {
+                        if (--state.waiting_on[dependent] == 0 && state.failed_task.empty()) {
+                            state.status[dependent] = Status::READY;
+                            state.ready.push_back(dependent);
+                        }
+                    }
+                }
+                else {
+                    state.status[i] = Status::FAILED;
+                    if (state.failed_task.empty()) {
+                        state.failed_task = state.tasks[i].name;
+                    }
+                }
+            }
+            state.cv.notify_all();
+        }
+    }
+
+    /**
+     * @brief Walk back from the last task to finish, always via the latest-finishing predecessor
+     */
+    static void markCriticalPath(State& state, Report& report) {
+        auto finished = [&](size_t i) {
+            return state.status[i] == Status::DONE || state.status[i] == Status::FAILED;
+        };
+
+        std::optional<size_t> current;
+        for (size_t i = 0; i < state.tasks.size(); ++i) {
+            if (finished(i) && (!current || state.finished_at[i] > state.finished_at[*current])) {
+                current = i;
+            }
+        }
+
+        std::vector<std::string> path;
+        while (current) {
+            const size_t i = *current;
+            state.timings[i].critical = true;
+            path.push_back(state.tasks[i].name);
+            report.critical_path_duration += state.timings[i].duration;
+
+            std::optional<size_t> predecessor;
+            auto consider = [&](size_t candidate) {
+                if (finished(candidate) && !state.timings[candidate].critical &&
+                    (!predecessor || state.finished_at[candidate] > state.finished_at[*predecessor])) {
+                    predecessor = candidate;
+                }
+            };
+            for (const auto& dependency : state.tasks[i].dependencies) {
+                consider(state.index[dependency]);
+            }
+            if (!predecessor) {
+                // No explicit dependency: the phase barrier was the predecessor
+                for (size_t j = 0; j < state.tasks.size(); ++j) {
+                    if (state.tasks[j].phase < state.tasks[i].phase) {
+                        consider(j);
+                    }
+                }
+            }
+            current = predecessor;
+        }
+        report.critical_path.assign(path.rbegin(), path.rend());
+    }
+
+    size_t max_parallel_;
+    std::vector<Task> tasks_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_STARTUP_SCHEDULER_HPP
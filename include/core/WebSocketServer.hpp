@@ -7,10 +7,25 @@
 #include "../config/ServerConfig.hpp"
 #include "Engine.hpp"
 #include "ServiceLocator.hpp"
+#include "../network/RttEstimator.hpp"
+#include "DrainController.hpp"
+#include "WarmupRunner.hpp"
+#include "../config/ConfigWatcher.hpp"
+#include "../utils/TrafficCapture.hpp"
+#include "../network/WebSocketGateway.hpp"
+#include "WorkerHost.hpp"
+#include "../protocol/JsonRouter.hpp"
+#include "../protocol/BinaryCodec.hpp"
+#include "../protocol/MessageBatcher.hpp"
+#include "../protocol/ExtensionPipeline.hpp"
+#include "../protocol/ZstdDictionaryExtension.hpp"
+#include "../protocol/CompressionPolicy.hpp"
+#include "../network/Http2Transport.hpp"
 #include <memory>
 #include <functional>
 #include <atomic>
 #include <unordered_map>
+#include <optional>
 
 WEBSOCKET_NAMESPACE_BEGIN
 
@@ -87,6 +102,22 @@ public:
      */
     bool start(uint16_t port);
 
+    /**
+     * @brief Set warm-up options used by start()
+     * @param options Expected capacity and synthetic traffic per I/O thread
+     *
+     * @note Warm-up initialises Crypto, pre-sizes session tables and pools,
+     *       pre-faults buffer memory and runs a synthetic handshake and frame
+     *       round-trip on every I/O thread before the server reports ready.
+     */
+    void setWarmupOptions(const WarmupRunner::Options& options);
+
+    /**
+     * @brief Get result of the last warm-up
+     * @return Per-step warm-up results
+     */
+    WarmupRunner::Report getWarmupReport() const;
+
     /**
      * @brief Stop the server gracefully
      *
@@ -101,6 +132,176 @@ public:
      */
     void stopNow();
 
+    /**
+     * @brief Drain the server with paced session closure
+     * @param options Close rate or window, close code and reconnect hint range
+     * @return true if drain started, false if not running or already draining
+     *
+     * @note Stops accepting immediately, then closes sessions with
+     *       SERVICE_RESTART (1012) at the configured pace. Each close reason
+     *       carries a randomized "retry-after-ms=" hint. Sessions that have not
+     *       finished closing after options.force_close_timeout are dropped.
+     *       Progress is reported as LifecycleManager events for
+     *       "WebSocketServer"; the server stops once every session is closed.
+     */
+    bool drain(const DrainController::Options& options = DrainController::Options{});
+
+    /**
+     * @brief Watch the configuration file and apply changes live
+     * @param config_path Configuration file to watch
+     * @return true if the watcher started
+     *
+     * @note Registers IOThreadPool size, BufferPool sizes, ConnectionPool
+     *       config and connection/message limits as reload subsystems.
+     *       Connections on retired I/O threads are migrated, never closed.
+     *       Invalid files are rejected and the running config is kept.
+     */
+    bool enableConfigReload(const std::string& config_path);
+
+    /**
+     * @brief Get the configuration watcher
+     * @return Watcher, or nullptr if live reload is not enabled
+     */
+    ConfigWatcher* getConfigWatcher() const { return config_watcher_.get(); }
+
+    /**
+     * @brief Start capturing inbound traffic for later replay
+     * @param directory Capture directory (segment files are created here)
+     * @param options Segment size and count limit
+     * @return true if capture started
+     *
+     * @note Records each session's upgrade request, every inbound frame as
+     *       received and the close, with microsecond timing. Replay a capture
+     *       with tools/cppws-replay. Recording is one memcpy into a mapped
+     *       segment per frame; sessions already open are not captured.
+     */
+    bool enableCapture(const std::string& directory,
+        const TrafficCapture::Writer::Options& options = TrafficCapture::Writer::Options{});
+
+    /**
+     * @brief Stop capturing and flush the current segment
+     */
+    void disableCapture();
+
+    /**
+     * @brief Enable gateway (reverse-proxy) mode
+     * @param connector Opens byte streams to upstream servers
+     * @param config Warm pool size and relay limits
+     * @return Gateway to add routes to
+     *
+     * @note After the upgrade request is read and validated, requests whose
+     *       path or offered subprotocol match a route are relayed to the
+     *       upstream frame by frame; everything else is served locally.
+     *       Relayed connections bypass SessionManager and message handlers.
+     */
+    WebSocketGateway& enableGateway(WebSocketGateway::UpstreamConnector connector,
+        const WebSocketGateway::Config& config = WebSocketGateway::Config{});
+
+    /**
+     * @brief Get the gateway
+     * @return Gateway, or nullptr if gateway mode is not enabled
+     */
+    WebSocketGateway* getGateway() const { return gateway_.get(); }
+
+    /**
+     * @brief Run message handling in worker processes
+     * @param config Worker binary, process count and ring size
+     * @return Worker host, or nullptr if the workers could not be started
+     *
+     * @note Connects, disconnects and inbound messages go to the client's
+     *       worker over a shared-memory ring instead of the onMessage handler.
+     *       Sends and closes coming back from the workers are applied as if
+     *       the application had called send() and close(). Worker binaries
+     *       use WorkerProcess; see tools/cppws-workerbench for the cost.
+     */
+    WorkerHost* enableWorkers(const WorkerHost::Config& config);
+
+    /**
+     * @brief Get the worker host
+     * @return Worker host, or nullptr if worker mode is not enabled
+     */
+    WorkerHost* getWorkerHost() const { return worker_host_.get(); }
+
+    /**
+     * @brief Offer the message batching subprotocol
+     * @param config Batch size limit
+     * @param application_subprotocols Application subprotocols that may be layered under it
+     *
+     * @note Clients that offer "cppws.batch" (or "cppws.batch+<name>") get
+     *       batched sessions: outbound messages go out as one frame per
+     *       write flush and inbound batch frames are split, so handlers
+     *       still see one message at a time. Other clients are unaffected.
+     */
+    void enableBatching(const MessageBatcher::Config& config = MessageBatcher::Config{},
+        const std::vector<std::string>& application_subprotocols = {});
+
+    /**
+     * @brief Offer a WebSocket extension to connecting clients
+     * @param extension Extension (negotiated per connection, in the client's offer order)
+     *
+     * @note Call before start(). Extensions claiming the same RSV bits are
+     *       never negotiated together; the client's earlier offer wins.
+     */
+    void addExtension(std::shared_ptr<WebSocketExtension> extension);
+
+#ifdef WEBSOCKET_ZSTD_SUPPORT
+    /**
+     * @brief Offer x-cppws-zstd dictionary compression
+     * @param config Compression level and size limits
+     * @return Extension, to load dictionaries into before clients connect
+     *
+     * @note Registered through addExtension(). Clients offering a loaded
+     *       dictionary id get it. See tools/cppws-zstd-train.
+     */
+    ZstdDictionaryExtension& enableZstd(const ZstdDictionaryExtension::Config& config = ZstdDictionaryExtension::Config{});
+
+    /**
+     * @brief Get the zstd extension
+     * @return Extension, or nullptr if not enabled
+     */
+    ZstdDictionaryExtension* getZstd() const { return zstd_.get(); }
+#endif
+
+    /**
+     * @brief Decide per message whether to compress
+     * @param config Size and ratio thresholds, level range and utilisation bands
+     * @return Policy (its Stats report decisions and bytes saved)
+     *
+     * @note Applies while RuntimeConfig compression is enabled. The
+     *       maintenance timer feeds it IOThreadPool utilisation and exports
+     *       its "compression.*" metrics.
+     */
+    CompressionPolicy& enableCompressionPolicy(const CompressionPolicy::Config& config = CompressionPolicy::Config{});
+
+    /**
+     * @brief Get the compression policy
+     * @return Policy, or nullptr if not enabled
+     */
+    CompressionPolicy* getCompressionPolicy() const { return compression_policy_.get(); }
+
+    /**
+     * @brief Accept WebSockets over HTTP/2 (RFC 8441 extended CONNECT)
+     * @param config HTTP/2 windows and limits; accept is chained after the server's own checks
+     *
+     * @note TLS connections that negotiate ALPN "h2" get an Http2FrontEnd;
+     *       each WebSocket stream becomes a WebSocketSession through the
+     *       usual ProtocolHandler, origin check, subprotocol and extension
+     *       negotiation. HTTP/1.1 clients are unaffected.
+     */
+    void enableHttp2(const Http2FrontEnd::Config& config = Http2FrontEnd::Config{});
+
+    /**
+     * @brief Check if a drain is in progress
+     * @return true between drain() and the final session closing
+     */
+    bool isDraining() const;
+
+    /**
+     * @brief Get drain progress
+     * @return Progress of the current or last drain
+     */
+    DrainController::Progress getDrainProgress() const;
+
     /**
      * @brief Check if server is running
      * @return true if server is active and accepting connections
@@ -174,6 +375,32 @@ public:
      */
     void onMessage(MessageHandler handler);
 
+    /**
+     * @brief Route JSON text messages to per-type handlers
+     * @param router Router holding the type handlers
+     *
+     * @note Replaces the onMessage handler; messages the router has no
+     *       handler for go to its fallback handler.
+     */
+    void routeMessages(std::shared_ptr<JsonRouter> router) {
+        onMessage([router](ClientID client_id, const Message& message) {
+            router->dispatch(client_id, message);
+        });
+    }
+
+    /**
+     * @brief Route binary messages to typed handlers by message id
+     * @param router Router holding the typed handlers
+     *
+     * @note Replaces the onMessage handler; messages the router has no
+     *       handler for go to its fallback handler.
+     */
+    void routeMessages(std::shared_ptr<TypedMessageRouter> router) {
+        onMessage([router](ClientID client_id, const Message& message) {
+            router->dispatch(client_id, message);
+        });
+    }
+
     /**
      * @brief Set client connection event handler
      * @param handler Callback function for new connections
@@ -224,6 +451,15 @@ public:
      */
     bool isClientConnected(ClientID client_id) const;
 
+    /**
+     * @brief Get round-trip time estimates for a client
+     * @param client_id Client identifier
+     * @return RTT snapshot, or empty if client not found or not yet measured
+     *
+     * @note Measured from heartbeat pings; no application-level pings needed
+     */
+    std::optional<RttEstimator::Snapshot> getClientRtt(ClientID client_id) const;
+
     /**
      * @brief Wait for server to stop (blocking call)
      *
@@ -249,6 +485,16 @@ private:
      */
     void handleNewConnection(std::shared_ptr<WebSocketSession> session);
 
+    /**
+     * @brief Hand an upgrade request to the gateway if a route matches
+     * @param connection Client connection (no response sent yet)
+     * @param request Raw upgrade request
+     * @param handshake Parsed and validated handshake
+     * @return true if the connection is now relayed and needs no session
+     */
+    bool routeToGateway(std::shared_ptr<WebSocketConnection> connection,
+        const std::string& request, const WebSocketHandshake& handshake);
+
     /**
      * @brief Handle client disconnection
      * @param client_id Disconnected client identifier
@@ -262,6 +508,11 @@ private:
      */
     void handleClientMessage(ClientID client_id, const Message& message);
 
+    /**
+     * @brief Close due sessions and force-close stragglers (drain timer tick)
+     */
+    void onDrainTick();
+
     /**
      * @brief Handle client error
      * @param client_id Client identifier with error
@@ -272,6 +523,18 @@ private:
     // Member variables
     std::unique_ptr<class WebSocketServerImpl> impl_;  ///< Pimpl pattern implementation
     std::atomic<bool> running_{ false };                 ///< Server running state
+    std::atomic<bool> draining_{ false };                ///< Paced drain in progress
+    DrainController drain_controller_;                   ///< Drain pacing state
+    std::unique_ptr<ConfigWatcher> config_watcher_;      ///< Live config reload (optional)
+    std::shared_ptr<TrafficCapture::Writer> capture_;    ///< Traffic capture (optional)
+    std::unique_ptr<WebSocketGateway> gateway_;          ///< Reverse-proxy routes (optional)
+    std::unique_ptr<WorkerHost> worker_host_;            ///< Out-of-process handlers (optional)
+#ifdef WEBSOCKET_ZSTD_SUPPORT
+    std::shared_ptr<ZstdDictionaryExtension> zstd_;      ///< Dictionary compression (optional)
+#endif
+    std::vector<std::shared_ptr<WebSocketExtension>> extensions_; ///< Offered extensions, in registration order
+    std::unique_ptr<CompressionPolicy> compression_policy_; ///< Per-message compression decisions (optional)
+    WarmupRunner::Options warmup_options_;               ///< Warm-up sizing
 
     // Event handlers
     MessageHandler message_handler_;
@@ -0,0 +1,556 @@
+#pragma once
+#ifndef WEBSOCKET_WORKER_HOST_HPP
+#define WEBSOCKET_WORKER_HOST_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include "../network/SharedMemoryRing.hpp"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class WorkerHost
+ * @brief Server side of out-of-process application workers
+ *
+ * Runs the application's message handling in separate processes, so a crash,
+ * leak or long GC pause in business logic cannot take the I/O layer with it,
+ * without a socket hop between the two:
+ *
+ * - Each worker shares a SharedMemoryChannel (memfd + eventfds) with the
+ *   server; descriptors are passed in CPPWS_WORKER_CHANNEL
+ * - Inbound messages are written straight into the worker's ring; the worker
+ *   reads them in place and writes replies in place (see WorkerProcess)
+ * - Clients are pinned to a worker (client id modulo worker count), so a
+ *   worker sees every message of its clients in order
+ * - A worker that exits is restarted after restart_delay and told about its
+ *   clients again; records in flight to the dead worker are lost
+ *
+ * forward(), connect() and disconnect() may be called from any I/O thread;
+ * they never block. A message forward() cannot deliver is not dropped
+ * silently: the client is closed with 1009 (larger than a ring record) or
+ * 1013 (ring full or worker down) through the close handler, unless
+ * close_on_drop is off and the caller retries instead. The send and close
+ * handlers run on the host's reader thread.
+ */
+class WorkerHost : public NonCopyable {
+public:
+    /**
+     * @brief Worker configuration
+     */
+    struct Config {
+        std::string executable;                                 ///< Worker binary
+        std::vector<std::string> arguments;                     ///< Extra arguments
+        size_t workers{ 2 };                                    ///< Worker processes
+        size_t ring_capacity{ 16 * 1024 * 1024 };               ///< Bytes per direction per worker
+        bool restart{ true };                                   ///< Restart workers that exit
+        std::chrono::milliseconds restart_delay{ 200 };         ///< Pause before a restart
+        std::chrono::milliseconds shutdown_timeout{ 2000 };     ///< SIGTERM grace period on stop()
+        std::chrono::microseconds spin{ 20 };                   ///< Reader polls rings this long before sleeping
+        bool close_on_drop{ true };                             ///< Close clients whose message forward() drops
+    };
+
+    /**
+     * @brief Host statistics
+     */
+    struct Stats {
+        uint64_t forwarded{ 0 };    ///< Records written to workers
+        uint64_t sends{ 0 };        ///< Outbound messages received from workers
+        uint64_t closes{ 0 };       ///< Close requests received from workers
+        uint64_t dropped{ 0 };      ///< Records dropped (ring full or worker down)
+        uint64_t oversized{ 0 };    ///< Messages larger than a ring record
+        uint64_t drop_closes{ 0 };  ///< Clients closed because forward() dropped their message
+        uint64_t exits{ 0 };        ///< Worker exits and crashes
+        uint64_t restarts{ 0 };     ///< Workers restarted
+        size_t live_workers{ 0 };   ///< Workers currently running
+    };
+
+    using SendHandler = std::function<void(ClientID client, const uint8_t* data, size_t size, bool text)>;
+    using CloseHandler = std::function<void(ClientID client, uint16_t code, const std::string& reason)>;
+
+    /// Environment variable carrying "memfd,to_worker_fd,to_server_fd,ring_capacity,index"
+    static constexpr const char* CHANNEL_ENV = "CPPWS_WORKER_CHANNEL";
+
+    /**
+     * @brief Construct host
+     * @param config Worker configuration
+     * @param on_send Called with each outbound message; data points into shared memory
+     * @param on_close Called when a worker closes a client
+     */
+    WorkerHost(const Config& config, SendHandler on_send, CloseHandler on_close)
+        : config_(config), on_send_(std::move(on_send)), on_close_(std::move(on_close)) {
+        if (config_.workers == 0) {
+            config_.workers = 1;
+        }
+    }
+
+    ~WorkerHost() {
+        stop();
+    }
+
+    /**
+     * @brief Spawn the workers and start the reader thread
+     * @return false if a worker could not be started (see getLastError())
+     */
+    bool start() {
+        if (running_.exchange(true)) {
+            return true;
+        }
+        while (workers_.size() < config_.workers) {
+            workers_.push_back(std::make_unique<Worker>());
+            workers_.back()->index = workers_.size() - 1;
+        }
+        // PR_SET_PDEATHSIG fires when the forking thread exits, not the
+        // process, so every fork (restarts included) happens on the reader
+        // thread, which lives until stop()
+        std::promise<bool> spawned;
+        std::future<bool> result = spawned.get_future();
+        reader_ = std::thread([this, spawned = std::move(spawned)]() mutable {
+            for (auto& worker : workers_) {
+                if (!spawn(*worker)) {
+                    spawned.set_value(false);
+                    return;
+                }
+            }
+            spawned.set_value(true);
+            readerLoop();
+        });
+        if (!result.get()) {
+            stop();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Terminate the workers and stop the reader thread
+     */
+    void stop() {
+        if (!running_.exchange(false)) {
+            return;
+        }
+        if (reader_.joinable()) {
+            reader_.join();
+        }
+        for (auto& worker : workers_) {
+            if (worker->pid > 0) {
+                ::kill(worker->pid, SIGTERM);
+            }
+        }
+        const auto deadline = std::chrono::steady_clock::now() + config_.shutdown_timeout;
+        for (auto& worker : workers_) {
+            while (worker->pid > 0) {
+                if (::waitpid(worker->pid, nullptr, WNOHANG) != 0) {
+                    worker->pid = -1;
+                }
+                else if (std::chrono::steady_clock::now() >= deadline) {
+                    ::kill(worker->pid, SIGKILL);
+                    ::waitpid(worker->pid, nullptr, 0);
+                    worker->pid = -1;
+                }
+                else {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                }
+            }
+            std::lock_guard lock(worker->send_mutex);
+            if (worker->channel) {
+                worker->channel.reset();
+                live_workers_.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Tell the client's worker about a new connection
+     * @param client Client identifier
+     * @return false if the record was dropped
+     */
+    bool connect(ClientID client) {
+        Worker* worker = workerFor(client);
+        if (!worker) {
+            return false;
+        }
+        std::lock_guard lock(worker->send_mutex);
+        worker->clients.insert(client);
+        return writeLocked(*worker, SharedMemoryRing::RecordType::CONNECT, client, nullptr, 0, 0);
+    }
+
+    /**
+     * @brief Tell the client's worker a connection closed
+     * @param client Client identifier
+     * @return false if the record was dropped
+     */
+    bool disconnect(ClientID client) {
+        Worker* worker = workerFor(client);
+        if (!worker) {
+            return false;
+        }
+        std::lock_guard lock(worker->send_mutex);
+        worker->clients.erase(client);
+        return writeLocked(*worker, SharedMemoryRing::RecordType::DISCONNECT, client, nullptr, 0, 0);
+    }
+
+    /**
+     * @brief Forward an inbound message to the client's worker
+     * @param client Source client
+     * @param message Received message
+     * @return false if the message was dropped
+     */
+    bool forward(ClientID client, const Message& message) {
+        return forward(client, message.data.data(), message.data.size(), message.isText);
+    }
+
+    /**
+     * @brief Forward an inbound payload to the client's worker
+     * @param client Source client
+     * @param data Payload
+     * @param size Payload size
+     * @param text true for a TEXT message
+     * @return false if the message was dropped
+     *
+     * @note The payload is copied once, into the worker's ring
+     * @note A dropped message closes the client (see Config::close_on_drop)
+     */
+    bool forward(ClientID client, const uint8_t* data, size_t size, bool text) {
+        Worker* worker = workerFor(client);
+        if (!worker) {
+            return false;
+        }
+        CloseCode code = CloseCode::TRY_AGAIN_LATER;
+        {
+            std::lock_guard lock(worker->send_mutex);
+            if (writeLocked(*worker, SharedMemoryRing::RecordType::MESSAGE, client, data, size,
+                text ? SharedMemoryRing::FLAG_TEXT : 0)) {
+                return true;
+            }
+            if (worker->channel && size > worker->channel->send().maxPayloadSize()) {
+                code = CloseCode::MESSAGE_TOO_BIG;
+            }
+        }
+        if (config_.close_on_drop) {
+            queueClose(client, code);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Get host statistics
+     * @return Statistics snapshot
+     */
+    Stats getStats() const {
+        Stats stats;
+        stats.forwarded = counters_.forwarded.load(std::memory_order_relaxed);
+        stats.sends = counters_.sends.load(std::memory_order_relaxed);
+        stats.closes = counters_.closes.load(std::memory_order_relaxed);
+        stats.dropped = counters_.dropped.load(std::memory_order_relaxed);
+        stats.oversized = counters_.oversized.load(std::memory_order_relaxed);
+        stats.drop_closes = counters_.drop_closes.load(std::memory_order_relaxed);
+        stats.exits = counters_.exits.load(std::memory_order_relaxed);
+        stats.restarts = counters_.restarts.load(std::memory_order_relaxed);
+        stats.live_workers = live_workers_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    /**
+     * @brief Get the reason the last start() or restart failed
+     * @return Error message
+     */
+    std::string getLastError() const {
+        std::lock_guard lock(error_mutex_);
+        return last_error_;
+    }
+
+private:
+    /// Stats fields updated from I/O threads without a shared lock
+    struct Counters {
+        std::atomic<uint64_t> forwarded{ 0 };
+        std::atomic<uint64_t> sends{ 0 };
+        std::atomic<uint64_t> closes{ 0 };
+        std::atomic<uint64_t> dropped{ 0 };
+        std::atomic<uint64_t> oversized{ 0 };
+        std::atomic<uint64_t> drop_closes{ 0 };
+        std::atomic<uint64_t> exits{ 0 };
+        std::atomic<uint64_t> restarts{ 0 };
+    };
+
+    struct Worker {
+        size_t index{ 0 };
+        pid_t pid{ -1 };
+        std::mutex send_mutex;                          ///< Serialises producers into the ring
+        std::unique_ptr<SharedMemoryChannel> channel;   ///< Null while the worker is down
+        std::unordered_set<ClientID> clients;           ///< Replayed as CONNECT after a restart
+        std::chrono::steady_clock::time_point restart_at{};
+    };
+
+    Worker* workerFor(ClientID client) {
+        if (!running_.load(std::memory_order_acquire) || workers_.empty()) {
+            return nullptr;
+        }
+        return workers_[client % workers_.size()].get();
+    }
+
+    /// Ask the reader thread to close a client; repeated drops close it once
+    void queueClose(ClientID client, CloseCode code) {
+        std::lock_guard lock(close_mutex_);
+        for (const auto& pending : pending_closes_) {
+            if (pending.first == client) {
+                return;
+            }
+        }
+        pending_closes_.emplace_back(client, code);
+    }
+
+    /// Deliver queued closes on the reader thread, like worker-initiated ones
+    void flushCloses() {
+        std::vector<std::pair<ClientID, CloseCode>> closes;
+        {
+            std::lock_guard lock(close_mutex_);
+            closes.swap(pending_closes_);
+        }
+        for (const auto& [client, code] : closes) {
+            counters_.drop_closes.fetch_add(1, std::memory_order_relaxed);
+            if (on_close_) {
+                on_close_(client, static_cast<uint16_t>(code),
+                    code == CloseCode::MESSAGE_TOO_BIG ? "Message too big" : "Worker unavailable");
+            }
+        }
+    }
+
+    bool writeLocked(Worker& worker, SharedMemoryRing::RecordType type, ClientID client,
+        const uint8_t* data, size_t size, uint8_t flags) {
+        if (!worker.channel) {
+            counters_.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        SharedMemoryRing& ring = worker.channel->send();
+        if (size > ring.maxPayloadSize()) {
+            counters_.oversized.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        uint8_t* payload = ring.reserve(type, client, size, flags);
+        if (!payload) {
+            counters_.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (size > 0) {
+            std::memcpy(payload, data, size);
+        }
+        worker.channel->publish();
+        counters_.forwarded.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// Runs on the reader thread only; see start()
+    bool spawn(Worker& worker) {
+        std::string error;
+        auto channel = SharedMemoryChannel::create(config_.ring_capacity, error);
+        if (!channel) {
+            setError(error);
+            return false;
+        }
+
+        // Everything the child needs is built before fork(); after it only
+        // async-signal-safe calls are allowed
+        std::vector<std::string> args{ config_.executable };
+        args.insert(args.end(), config_.arguments.begin(), config_.arguments.end());
+        std::vector<char*> argv;
+        for (auto& arg : args) {
+            argv.push_back(arg.data());
+        }
+        argv.push_back(nullptr);
+
+        std::string channel_env = std::string(CHANNEL_ENV) + "=" +
+            std::to_string(channel->memoryFd()) + "," + std::to_string(channel->toWorkerEventFd()) + "," +
+            std::to_string(channel->toServerEventFd()) + "," + std::to_string(channel->ringCapacity()) + "," +
+            std::to_string(worker.index);
+        std::vector<char*> envp;
+        const size_t prefix = std::strlen(CHANNEL_ENV) + 1;
+        for (char** env = environ; env && *env; ++env) {
+            if (std::strncmp(*env, channel_env.c_str(), prefix) != 0) {
+                envp.push_back(*env);
+            }
+        }
+        envp.push_back(channel_env.data());
+        envp.push_back(nullptr);
+
+        const int inherited[] = { channel->memoryFd(), channel->toWorkerEventFd(), channel->toServerEventFd() };
+        const pid_t parent = ::getpid();
+        const pid_t pid = ::fork();
+        if (pid < 0) {
+            setError(std::string("fork: ") + std::strerror(errno));
+            return false;
+        }
+        if (pid == 0) {
+            ::prctl(PR_SET_PDEATHSIG, SIGTERM);
+            if (::getppid() != parent) {
+                ::_exit(1);
+            }
+            for (int fd : inherited) {
+                ::fcntl(fd, F_SETFD, 0);
+            }
+            ::execve(argv[0], argv.data(), envp.data());
+            ::_exit(127);
+        }
+
+        {
+            std::lock_guard lock(worker.send_mutex);
+            worker.pid = pid;
+            worker.channel = std::move(channel);
+            // A restarted worker starts empty; tell it who it is serving
+            for (ClientID client : worker.clients) {
+                if (!worker.channel->send().reserve(SharedMemoryRing::RecordType::CONNECT, client, 0)) {
+                    break;
+                }
+                worker.channel->publish();
+            }
+        }
+        live_workers_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void readerLoop() {
+        std::vector<pollfd> fds;
+        std::vector<Worker*> polled;
+        while (running_.load(std::memory_order_acquire)) {
+            fds.clear();
+            polled.clear();
+            int timeout = 50;
+            if (spinForRecords()) {
+                timeout = 0;
+            }
+            for (auto& worker : workers_) {
+                if (!worker->channel) {
+                    continue;
+                }
+                if (!worker->channel->receive().prepareWait()) {
+                    timeout = 0;
+                }
+                fds.push_back({ worker->channel->eventFd(), POLLIN, 0 });
+                polled.push_back(worker.get());
+            }
+            ::poll(fds.data(), fds.size(), timeout);
+            for (Worker* worker : polled) {
+                worker->channel->receive().finishWait();
+                worker->channel->drainEvent();
+                drain(*worker);
+            }
+            flushCloses();
+            superviseWorkers();
+        }
+    }
+
+    /// Poll every worker's ring for up to config_.spin before sleeping
+    bool spinForRecords() {
+        if (config_.spin.count() <= 0 || !SharedMemoryChannel::spinningHelps()) {
+            return false;
+        }
+        const auto deadline = std::chrono::steady_clock::now() + config_.spin;
+        do {
+            for (auto& worker : workers_) {
+                if (worker->channel && !worker->channel->receive().empty()) {
+                    return true;
+                }
+            }
+        } while (std::chrono::steady_clock::now() < deadline);
+        return false;
+    }
+
+    /// Hand every record the worker produced to the send/close handlers
+    void drain(Worker& worker) {
+        SharedMemoryRing& ring = worker.channel->receive();
+        SharedMemoryRing::Record record;
+        uint64_t sends = 0;
+        uint64_t closes = 0;
+        while (ring.peek(record)) {
+            if (record.type == SharedMemoryRing::RecordType::SEND) {
+                sends++;
+                if (on_send_) {
+                    on_send_(record.client, record.data, record.size, (record.flags & SharedMemoryRing::FLAG_TEXT) != 0);
+                }
+            }
+            else if (record.type == SharedMemoryRing::RecordType::CLOSE) {
+                closes++;
+                if (on_close_) {
+                    on_close_(record.client, record.code,
+                        std::string(reinterpret_cast<const char*>(record.data), record.size));
+                }
+            }
+            ring.release();
+        }
+        if (ring.isCorrupted()) {
+            // Whatever wrote this cannot be trusted to keep running
+            ::kill(worker.pid, SIGKILL);
+        }
+        counters_.sends.fetch_add(sends, std::memory_order_relaxed);
+        counters_.closes.fetch_add(closes, std::memory_order_relaxed);
+    }
+
+    void superviseWorkers() {
+        const auto now = std::chrono::steady_clock::now();
+        for (auto& worker : workers_) {
+            if (worker->pid > 0) {
+                int status = 0;
+                if (::waitpid(worker->pid, &status, WNOHANG) == worker->pid) {
+                    {
+                        std::lock_guard lock(worker->send_mutex);
+                        worker->pid = -1;
+                        worker->channel.reset();
+                    }
+                    live_workers_.fetch_sub(1, std::memory_order_relaxed);
+                    counters_.exits.fetch_add(1, std::memory_order_relaxed);
+                    worker->restart_at = now + config_.restart_delay;
+                }
+            }
+            else if (config_.restart && now >= worker->restart_at) {
+                if (spawn(*worker)) {
+                    counters_.restarts.fetch_add(1, std::memory_order_relaxed);
+                }
+                else {
+                    worker->restart_at = now + config_.restart_delay;
+                }
+            }
+        }
+    }
+
+    void setError(const std::string& error) {
+        std::lock_guard lock(error_mutex_);
+        last_error_ = error;
+    }
+
+    Config config_;
+    SendHandler on_send_;
+    CloseHandler on_close_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::thread reader_;
+    std::atomic<bool> running_{ false };
+    std::atomic<size_t> live_workers_{ 0 };
+    Counters counters_;
+    std::mutex close_mutex_;
+    std::vector<std::pair<ClientID, CloseCode>> pending_closes_;   ///< Closes queued by forward()
+    mutable std::mutex error_mutex_;
+    std::string last_error_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_WORKER_HOST_HPP
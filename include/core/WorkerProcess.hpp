@@ -0,0 +1,251 @@
+#pragma once
+#ifndef WEBSOCKET_WORKER_PROCESS_HPP
+#define WEBSOCKET_WORKER_PROCESS_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include "../network/SharedMemoryRing.hpp"
+#include "WorkerHost.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class WorkerProcess
+ * @brief Worker side of out-of-process application workers
+ *
+ * Linked into the worker binary that WorkerHost spawns. attach() maps the
+ * channel passed in CPPWS_WORKER_CHANNEL, run() delivers connect, disconnect
+ * and message events, and send()/close() go back to the server.
+ *
+ * Event payloads are views into shared memory, valid until the handler
+ * returns. beginSend()/endSend() let a reply be serialised directly into the
+ * ring, so neither direction copies payloads outside the one write into
+ * shared memory.
+ *
+ * Single-threaded: run(), send() and close() must be called from one thread
+ * (normally the handler itself).
+ *
+ * Usage:
+ * WorkerProcess worker;
+ * if (!worker.attach()) return 1;
+ * return worker.run([&](const WorkerProcess::Event& event) {
+ *     if (event.type == WorkerProcess::EventType::MESSAGE)
+ *         worker.send(event.client, event.data, event.size, event.text);
+ * });
+ */
+class WorkerProcess : public NonCopyable {
+public:
+    /**
+     * @brief Event types delivered to the handler
+     */
+    enum class EventType {
+        CONNECT,        ///< Client connected (or worker restarted)
+        DISCONNECT,     ///< Client disconnected
+        MESSAGE         ///< Message from the client
+    };
+
+    /**
+     * @brief Event view
+     */
+    struct Event {
+        EventType type{ EventType::MESSAGE };
+        ClientID client{ 0 };
+        const uint8_t* data{ nullptr };     ///< Payload in shared memory
+        size_t size{ 0 };
+        bool text{ false };                 ///< TEXT message
+    };
+
+    using Handler = std::function<void(const Event& event)>;
+
+    /**
+     * @brief Check if this process was started by a WorkerHost
+     * @return true if the channel environment variable is present
+     */
+    static bool isWorker() {
+        return std::getenv(WorkerHost::CHANNEL_ENV) != nullptr;
+    }
+
+    /**
+     * @brief Attach to the channel passed by the host
+     * @return false on failure (see getLastError())
+     */
+    bool attach() {
+        const char* env = std::getenv(WorkerHost::CHANNEL_ENV);
+        int memfd = -1;
+        int to_worker = -1;
+        int to_server = -1;
+        unsigned long long capacity = 0;
+        unsigned long index = 0;
+        if (!env || std::sscanf(env, "%d,%d,%d,%llu,%lu", &memfd, &to_worker, &to_server, &capacity, &index) != 5) {
+            error_ = std::string(WorkerHost::CHANNEL_ENV) + " missing or malformed";
+            return false;
+        }
+        channel_ = SharedMemoryChannel::attach(memfd, to_worker, to_server, static_cast<size_t>(capacity), error_);
+        index_ = index;
+        server_pid_ = ::getppid();
+        return channel_ != nullptr;
+    }
+
+    /**
+     * @brief Deliver events until stop() or the server goes away
+     * @param handler Event handler
+     * @return Process exit code (0 on stop(), 1 if the server vanished or the channel broke)
+     */
+    int run(Handler handler) {
+        if (!channel_) {
+            return 1;
+        }
+        SharedMemoryRing& ring = channel_->receive();
+        SharedMemoryRing::Record record;
+        Event event;
+        while (!stopping_.load(std::memory_order_relaxed)) {
+            while (ring.peek(record)) {
+                event.client = record.client;
+                event.data = record.data;
+                event.size = record.size;
+                event.text = (record.flags & SharedMemoryRing::FLAG_TEXT) != 0;
+                switch (record.type) {
+                case SharedMemoryRing::RecordType::CONNECT: event.type = EventType::CONNECT; break;
+                case SharedMemoryRing::RecordType::DISCONNECT: event.type = EventType::DISCONNECT; break;
+                default: event.type = EventType::MESSAGE; break;
+                }
+                handler(event);
+                ring.release();
+                if (stopping_.load(std::memory_order_relaxed)) {
+                    return 0;
+                }
+            }
+            if (ring.isCorrupted()) {
+                return 1;
+            }
+            if (!channel_->wait(200) && !serverAlive()) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Stop run() after the current event
+     */
+    void stop() {
+        stopping_.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Send a message to a client
+     * @param client Target client
+     * @param data Payload
+     * @param size Payload size
+     * @param text true for TEXT, false for BINARY
+     * @return false if the payload is too large or the server is gone
+     */
+    bool send(ClientID client, const void* data, size_t size, bool text = false) {
+        uint8_t* payload = beginSend(client, size, text);
+        if (!payload) {
+            return false;
+        }
+        std::memcpy(payload, data, size);
+        endSend();
+        return true;
+    }
+
+    /**
+     * @brief Send a text message to a client
+     * @param client Target client
+     * @param text Message text
+     * @return false if the message is too large or the server is gone
+     */
+    bool sendText(ClientID client, const std::string& text) {
+        return send(client, text.data(), text.size(), true);
+    }
+
+    /**
+     * @brief Reserve an outbound message to fill in place
+     * @param client Target client
+     * @param size Exact payload size
+     * @param text true for TEXT, false for BINARY
+     * @return Payload area in shared memory, or nullptr if too large or the server is gone
+     *
+     * @note Waits while the ring is full; call endSend() once filled
+     */
+    uint8_t* beginSend(ClientID client, size_t size, bool text = false) {
+        return reserve(SharedMemoryRing::RecordType::SEND, client, size, text ? SharedMemoryRing::FLAG_TEXT : 0, 0);
+    }
+
+    /**
+     * @brief Publish the message reserved by beginSend()
+     */
+    void endSend() {
+        channel_->publish();
+    }
+
+    /**
+     * @brief Close a client connection
+     * @param client Client to close
+     * @param code WebSocket close code
+     * @param reason Close reason
+     * @return false if the server is gone
+     */
+    bool close(ClientID client, uint16_t code = 1000, const std::string& reason = "") {
+        uint8_t* payload = reserve(SharedMemoryRing::RecordType::CLOSE, client, reason.size(), 0, code);
+        if (!payload) {
+            return false;
+        }
+        std::memcpy(payload, reason.data(), reason.size());
+        channel_->publish();
+        return true;
+    }
+
+    /**
+     * @brief Get this worker's index among the host's workers
+     */
+    size_t getIndex() const { return index_; }
+
+    /**
+     * @brief Get the reason attach() failed
+     */
+    const std::string& getLastError() const { return error_; }
+
+private:
+    uint8_t* reserve(SharedMemoryRing::RecordType type, ClientID client, size_t size, uint8_t flags, uint16_t code) {
+        if (!channel_ || size > channel_->send().maxPayloadSize()) {
+            return nullptr;
+        }
+        for (;;) {
+            uint8_t* payload = channel_->send().reserve(type, client, size, flags, code);
+            if (payload) {
+                return payload;
+            }
+            // Ring full: the server drains it continuously unless it is gone
+            if (!serverAlive()) {
+                return nullptr;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    bool serverAlive() const {
+        return ::getppid() == server_pid_;
+    }
+
+    std::unique_ptr<SharedMemoryChannel> channel_;
+    std::atomic<bool> stopping_{ false };
+    size_t index_{ 0 };
+    pid_t server_pid_{ -1 };
+    std::string error_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_WORKER_PROCESS_HPP
@@ -0,0 +1,366 @@
+#pragma once
+#ifndef WEBSOCKET_DNS_RESOLVER_HPP
+#define WEBSOCKET_DNS_RESOLVER_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include "../utils/ThreadPool.hpp"
+#include "EndPoint.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class DnsResolver
+ * @brief Asynchronous, caching hostname resolver
+ *
+ * Endpoint::resolve blocks the calling thread for as long as the system
+ * resolver takes, which must not happen on an I/O thread. This resolver runs
+ * lookups on its own small thread pool and caches the answers:
+ *
+ * - Fresh cache hits complete immediately on the calling thread
+ * - Concurrent lookups of the same name share one getaddrinfo() call
+ * - Expired entries are still served while a refresh runs in the background,
+ *   so a slow or briefly failing DNS server does not stall callers
+ * - Failures are cached for a short negative TTL
+ * - IP literals never reach the resolver
+ *
+ * Completion callbacks run on a resolver thread unless served from cache.
+ * The lookup function can be replaced (tests, simulations, service discovery).
+ */
+class DnsResolver : public NonCopyable {
+public:
+    /**
+     * @brief Resolver configuration
+     */
+    struct Config {
+        size_t worker_threads{ 2 };                             ///< Lookup threads
+        Duration positive_ttl{ std::chrono::seconds(30) };      ///< Lifetime of a successful answer
+        Duration negative_ttl{ std::chrono::seconds(5) };       ///< Lifetime of a failed lookup
+        size_t max_entries{ 4096 };                             ///< Cache capacity
+        bool prefer_ipv4{ true };                               ///< Order IPv4 addresses first
+    };
+
+    /**
+     * @brief Resolver statistics
+     */
+    struct Stats {
+        uint64_t hits{ 0 };         ///< Answered from a fresh cache entry
+        uint64_t stale_hits{ 0 };   ///< Answered from an expired entry while refreshing
+        uint64_t misses{ 0 };       ///< Lookups started
+        uint64_t coalesced{ 0 };    ///< Requests that joined a running lookup
+        uint64_t failures{ 0 };     ///< Lookups that returned no address
+        size_t entries{ 0 };        ///< Current cache size
+    };
+
+    using Callback = std::function<void(const std::vector<Endpoint>& endpoints, const std::string& error)>;
+    using LookupFunction = std::function<std::vector<Endpoint>(const std::string& host, uint16_t port, std::string& error)>;
+
+    DnsResolver() : DnsResolver(Config{}) {}
+
+    /**
+     * @brief Construct resolver
+     * @param config Resolver configuration
+     */
+    explicit DnsResolver(const Config& config)
+        : config_(config), state_(std::make_shared<SharedState>()),
+        pool_(std::make_unique<ThreadPool>(std::max<size_t>(config.worker_threads, 1))) {
+        const bool prefer_ipv4 = config.prefer_ipv4;
+        state_->lookup = [prefer_ipv4](const std::string& host, uint16_t port, std::string& error) {
+            return systemLookup(host, port, prefer_ipv4, error);
+        };
+    }
+
+    /**
+     * @brief Replace the lookup function
+     * @param lookup Blocking lookup, called on a resolver thread
+     *
+     * @note Call before the first resolve()
+     */
+    void setLookupFunction(LookupFunction lookup) {
+        std::lock_guard lock(state_->mutex);
+        state_->lookup = std::move(lookup);
+    }
+
+    /**
+     * @brief Resolve a host name
+     * @param host Host name or IP literal
+     * @param port Port for the returned endpoints
+     * @param callback Completion callback; endpoints are empty on failure
+     */
+    void resolve(const std::string& host, uint16_t port, Callback callback) {
+        if (isLiteral(host)) {
+            callback({ Endpoint(host, port) }, "");
+            return;
+        }
+
+        const std::string key = cacheKey(host, port);
+        const Timestamp now = std::chrono::steady_clock::now();
+        std::vector<Endpoint> cached;
+        std::string cached_error;
+        bool answered = false;
+        bool start_lookup = false;
+        {
+            std::lock_guard lock(state_->mutex);
+            auto it = state_->cache.find(key);
+            if (it == state_->cache.end()) {
+                evictIfFull(now);
+                it = state_->cache.emplace(key, Entry{}).first;
+            }
+            Entry& entry = it->second;
+            if (entry.resolved && now < entry.expires) {
+                state_->stats.hits++;
+                cached = entry.endpoints;
+                cached_error = entry.error;
+                answered = true;
+            }
+            else if (!entry.endpoints.empty()) {
+                // Serve the expired answer, refresh behind the caller's back
+                state_->stats.stale_hits++;
+                cached = entry.endpoints;
+                answered = true;
+                start_lookup = !entry.refreshing;
+            }
+            else {
+                if (entry.refreshing) {
+                    state_->stats.coalesced++;
+                }
+                entry.waiters.push_back(std::move(callback));
+                start_lookup = !entry.refreshing;
+            }
+            if (start_lookup) {
+                entry.refreshing = true;
+                state_->stats.misses++;
+            }
+        }
+
+        if (answered) {
+            callback(cached, cached.empty() ? cached_error : std::string());
+        }
+        if (start_lookup) {
+            startLookup(host, port, key);
+        }
+    }
+
+    /**
+     * @brief Look up a cached answer without resolving
+     * @param host Host name
+     * @param port Port
+     * @return Cached endpoints (possibly expired), empty if none
+     */
+    std::vector<Endpoint> lookupCached(const std::string& host, uint16_t port) const {
+        if (isLiteral(host)) {
+            return { Endpoint(host, port) };
+        }
+        std::lock_guard lock(state_->mutex);
+        auto it = state_->cache.find(cacheKey(host, port));
+        return it != state_->cache.end() ? it->second.endpoints : std::vector<Endpoint>{};
+    }
+
+    /**
+     * @brief Drop a cached answer (e.g. after every address refused connections)
+     * @param host Host name
+     * @param port Port
+     */
+    void invalidate(const std::string& host, uint16_t port) {
+        std::lock_guard lock(state_->mutex);
+        auto it = state_->cache.find(cacheKey(host, port));
+        if (it != state_->cache.end() && !it->second.refreshing) {
+            state_->cache.erase(it);
+        }
+    }
+
+    /**
+     * @brief Get resolver statistics
+     * @return Statistics snapshot
+     */
+    Stats getStats() const {
+        std::lock_guard lock(state_->mutex);
+        Stats stats = state_->stats;
+        stats.entries = state_->cache.size();
+        return stats;
+    }
+
+private:
+    struct Entry {
+        std::vector<Endpoint> endpoints;
+        std::string error;
+        Timestamp expires{};
+        bool resolved{ false };             ///< At least one lookup completed
+        bool refreshing{ false };           ///< Lookup in flight
+        std::vector<Callback> waiters;      ///< Callers with nothing to serve yet
+    };
+
+    /// State shared with lookups still running on the pool
+    struct SharedState {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Entry> cache;
+        LookupFunction lookup;
+        Stats stats;
+    };
+
+    void startLookup(const std::string& host, uint16_t port, const std::string& key) {
+        std::weak_ptr<SharedState> weak = state_;
+        const Duration positive_ttl = config_.positive_ttl;
+        const Duration negative_ttl = config_.negative_ttl;
+        auto task = [weak, host, port, key, positive_ttl, negative_ttl] {
+            LookupFunction lookup;
+            if (auto state = weak.lock()) {
+                std::lock_guard lock(state->mutex);
+                lookup = state->lookup;
+            }
+            if (!lookup) {
+                return;
+            }
+            std::string error;
+            std::vector<Endpoint> endpoints = lookup(host, port, error);
+            if (endpoints.empty() && error.empty()) {
+                error = "no addresses for " + host;
+            }
+            complete(weak, key, std::move(endpoints), error, positive_ttl, negative_ttl);
+        };
+
+        try {
+            pool_->enqueue(std::move(task));
+        }
+        catch (const std::exception& e) {
+            complete(state_, key, {}, std::string("resolver overloaded: ") + e.what(), config_.positive_ttl, Duration(0));
+        }
+    }
+
+    static void complete(const std::weak_ptr<SharedState>& weak, const std::string& key,
+        std::vector<Endpoint> endpoints, const std::string& error, Duration positive_ttl, Duration negative_ttl) {
+        auto state = weak.lock();
+        if (!state) {
+            return;
+        }
+        std::vector<Callback> waiters;
+        std::vector<Endpoint> answer;
+        {
+            std::lock_guard lock(state->mutex);
+            Entry& entry = state->cache[key];
+            entry.refreshing = false;
+            entry.resolved = true;
+            const Timestamp now = std::chrono::steady_clock::now();
+            if (!endpoints.empty()) {
+                entry.endpoints = std::move(endpoints);
+                entry.error.clear();
+                entry.expires = now + positive_ttl;
+            }
+            else {
+                state->stats.failures++;
+                entry.error = error;
+                if (entry.endpoints.empty()) {
+                    entry.expires = now + negative_ttl;
+                }
+                // else: keep serving the previous answer until it is replaced
+            }
+            waiters.swap(entry.waiters);
+            answer = entry.endpoints;
+        }
+        for (auto& waiter : waiters) {
+            if (waiter) {
+                waiter(answer, answer.empty() ? error : std::string());
+            }
+        }
+    }
+
+    void evictIfFull(Timestamp now) {
+        if (state_->cache.size() < config_.max_entries) {
+            return;
+        }
+        // Drop expired idle entries; if none, the one closest to expiry
+        auto oldest = state_->cache.end();
+        for (auto it = state_->cache.begin(); it != state_->cache.end();) {
+            if (it->second.refreshing) {
+                ++it;
+                continue;
+            }
+            if (it->second.expires <= now) {
+                it = state_->cache.erase(it);
+                continue;
+            }
+            if (oldest == state_->cache.end() || it->second.expires < oldest->second.expires) {
+                oldest = it;
+            }
+            ++it;
+        }
+        if (state_->cache.size() >= config_.max_entries && oldest != state_->cache.end()) {
+            state_->cache.erase(oldest);
+        }
+    }
+
+    static std::string cacheKey(const std::string& host, uint16_t port) {
+        std::string key;
+        key.reserve(host.size() + 6);
+        for (char c : host) {
+            key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        key += ':';
+        key += std::to_string(port);
+        return key;
+    }
+
+    static bool isLiteral(const std::string& host) {
+        unsigned char buffer[sizeof(in6_addr)];
+        return inet_pton(AF_INET, host.c_str(), buffer) == 1 || inet_pton(AF_INET6, host.c_str(), buffer) == 1;
+    }
+
+    static std::vector<Endpoint> systemLookup(const std::string& host, uint16_t port, bool prefer_ipv4, std::string& error) {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* result = nullptr;
+        const int rc = getaddrinfo(host.c_str(), nullptr, &hints, &result);
+        if (rc != 0) {
+            error = gai_strerror(rc);
+            return {};
+        }
+
+        std::vector<Endpoint> endpoints;
+        char text[INET6_ADDRSTRLEN];
+        for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+            const void* address = nullptr;
+            if (ai->ai_family == AF_INET) {
+                address = &reinterpret_cast<sockaddr_in*>(ai->ai_addr)->sin_addr;
+            }
+            else if (ai->ai_family == AF_INET6) {
+                address = &reinterpret_cast<sockaddr_in6*>(ai->ai_addr)->sin6_addr;
+            }
+            if (address && inet_ntop(ai->ai_family, address, text, sizeof(text))) {
+                Endpoint endpoint(text, port);
+                if (std::find(endpoints.begin(), endpoints.end(), endpoint) == endpoints.end()) {
+                    endpoints.push_back(endpoint);
+                }
+            }
+        }
+        freeaddrinfo(result);
+
+        if (prefer_ipv4) {
+            std::stable_partition(endpoints.begin(), endpoints.end(),
+                [](const Endpoint& endpoint) { return endpoint.isIPv4(); });
+        }
+        return endpoints;
+    }
+
+    Config config_;
+    std::shared_ptr<SharedState> state_;
+    std::unique_ptr<ThreadPool> pool_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_DNS_RESOLVER_HPP
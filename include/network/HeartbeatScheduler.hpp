@@ -0,0 +1,296 @@
+#pragma once
+#ifndef WEBSOCKET_HEARTBEAT_SCHEDULER_HPP
+#define WEBSOCKET_HEARTBEAT_SCHEDULER_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include "../constants/Limits.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class HeartbeatScheduler
+ * @brief Timing wheel that spreads session pings over the ping interval
+ *
+ * Replaces one steady_timer per session. Sessions created in a burst would
+ * otherwise ping in lockstep every DEFAULT_PING_INTERVAL; here each session
+ * gets a random phase within the interval and every subsequent ping is
+ * jittered, so load stays flat.
+ *
+ * Provides:
+ * - Uniform phase spreading plus per-ping jitter
+ * - Per-tick batches, flushed once so pings coalesce with pending writes
+ * - Skipping pings for sessions with recent inbound traffic
+ * - Pong deadlines tracked in the same wheel
+ *
+ * One scheduler exists per I/O thread and is only touched from that thread,
+ * so it needs no locking. The owning thread calls tick() from a periodic
+ * timer every Config::tick milliseconds.
+ */
+class HeartbeatScheduler : public NonCopyable {
+public:
+    /**
+     * @brief Scheduler configuration
+     */
+    struct Config {
+        std::chrono::milliseconds interval{ Limits::DEFAULT_PING_INTERVAL };    ///< Mean ping interval
+        std::chrono::milliseconds pong_timeout{ Limits::DEFAULT_PONG_TIMEOUT }; ///< Time allowed for a pong
+        std::chrono::milliseconds tick{ 100 };      ///< Wheel resolution
+        double jitter_ratio{ 0.1 };                 ///< +/- fraction of interval applied to each ping
+        bool skip_when_active{ true };              ///< Skip ping if inbound traffic within interval
+    };
+
+    /**
+     * @brief Callbacks into the owning I/O thread
+     */
+    struct Callbacks {
+        std::function<bool(ClientID)> send_ping;                        ///< Queue a ping; false if session is gone
+        std::function<void(const std::vector<ClientID>&)> flush_batch;  ///< Flush writes for sessions pinged this tick
+        std::function<void(ClientID)> on_pong_timeout;                  ///< Peer missed its pong deadline
+    };
+
+    /**
+     * @brief Scheduler statistics
+     */
+    struct Stats {
+        size_t sessions{ 0 };           ///< Sessions currently scheduled
+        uint64_t pings_sent{ 0 };       ///< Pings handed to send_ping
+        uint64_t pings_skipped{ 0 };    ///< Pings skipped due to inbound activity
+        uint64_t pong_timeouts{ 0 };    ///< Sessions that missed a pong deadline
+        uint64_t batches{ 0 };          ///< Non-empty ticks
+        size_t largest_batch{ 0 };      ///< Largest number of pings in one tick
+    };
+
+    /**
+     * @brief Construct scheduler
+     * @param config Scheduler configuration
+     * @param callbacks Callbacks into the owning thread
+     */
+    HeartbeatScheduler(const Config& config, Callbacks callbacks)
+        : config_(config),
+        callbacks_(std::move(callbacks)),
+        rng_(std::random_device{}()) {
+        if (config_.tick.count() <= 0) {
+            config_.tick = std::chrono::milliseconds(100);
+        }
+        const auto horizon = std::max(config_.interval + config_.interval * config_.jitter_ratio,
+            std::chrono::duration<double, std::milli>(config_.pong_timeout));
+        slots_.resize(static_cast<size_t>(horizon / config_.tick) + 2);
+    }
+
+    /**
+     * @brief Start scheduling heartbeats for a session
+     * @param id Session identifier
+     * @param now Current time
+     *
+     * @note The first ping fires at a uniformly random point within the interval
+     */
+    void add(ClientID id, Timestamp now = std::chrono::steady_clock::now()) {
+        auto& entry = entries_[id];
+        entry = Entry{};
+
+        std::uniform_int_distribution<int64_t> phase(0, std::max<int64_t>(config_.interval.count() - 1, 0));
+        schedulePing(id, entry, now + std::chrono::milliseconds(phase(rng_)));
+    }
+
+    /**
+     * @brief Stop scheduling heartbeats for a session
+     * @param id Session identifier
+     *
+     * @note Wheel slots are cleaned lazily on the next pass
+     */
+    void remove(ClientID id) {
+        entries_.erase(id);
+    }
+
+    /**
+     * @brief Record inbound traffic from a session
+     * @param id Session identifier
+     * @param now Receive time
+     *
+     * @note Any inbound frame proves liveness and satisfies a pending pong deadline
+     */
+    void onInboundActivity(ClientID id, Timestamp now = std::chrono::steady_clock::now()) {
+        auto it = entries_.find(id);
+        if (it != entries_.end()) {
+            it->second.last_inbound = now;
+            it->second.awaiting_pong = false;
+        }
+    }
+
+    /**
+     * @brief Record a pong from a session
+     * @param id Session identifier
+     * @param now Receive time
+     */
+    void onPong(ClientID id, Timestamp now = std::chrono::steady_clock::now()) {
+        onInboundActivity(id, now);
+    }
+
+    /**
+     * @brief Process all wheel slots that became due since the last call
+     * @param now Current time
+     * @return Number of pings sent in this tick
+     */
+    size_t tick(Timestamp now = std::chrono::steady_clock::now()) {
+        const int64_t target = tickIndex(now);
+        if (last_tick_ < 0) {
+            last_tick_ = target - 1;
+        }
+
+        batch_.clear();
+        // Never walk more than one full rotation, even after a long stall
+        int64_t first = std::max(last_tick_ + 1, target - static_cast<int64_t>(slots_.size()) + 1);
+        for (int64_t t = first; t <= target; ++t) {
+            processSlot(slots_[static_cast<size_t>(t) % slots_.size()], now);
+        }
+        last_tick_ = target;
+
+        if (!batch_.empty()) {
+            stats_.batches++;
+            stats_.largest_batch = std::max(stats_.largest_batch, batch_.size());
+            if (callbacks_.flush_batch) {
+                callbacks_.flush_batch(batch_);
+            }
+        }
+        return batch_.size();
+    }
+
+    /**
+     * @brief Get configured tick period
+     * @return Interval at which tick() should be called
+     */
+    std::chrono::milliseconds getTickPeriod() const { return config_.tick; }
+
+    /**
+     * @brief Get scheduler statistics
+     * @return Statistics snapshot
+     */
+    Stats getStats() const {
+        Stats stats = stats_;
+        stats.sessions = entries_.size();
+        return stats;
+    }
+
+private:
+    enum class EventKind : uint8_t {
+        PING,           ///< Ping due
+        PONG_DEADLINE   ///< Pong deadline expires
+    };
+
+    struct Event {
+        ClientID id;
+        uint32_t generation;
+        EventKind kind;
+    };
+
+    struct Entry {
+        Timestamp next_ping{};
+        Timestamp last_inbound{};
+        uint32_t ping_generation{ 0 };
+        uint32_t deadline_generation{ 0 };
+        bool awaiting_pong{ false };
+    };
+
+    int64_t tickIndex(Timestamp when) const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(when.time_since_epoch()).count()
+            / config_.tick.count();
+    }
+
+    void insert(Timestamp when, const Event& event) {
+        slots_[static_cast<size_t>(tickIndex(when)) % slots_.size()].push_back(event);
+    }
+
+    void schedulePing(ClientID id, Entry& entry, Timestamp when) {
+        entry.next_ping = when;
+        entry.ping_generation = ++generation_;
+        insert(when, Event{ id, entry.ping_generation, EventKind::PING });
+    }
+
+    Duration jitteredInterval() {
+        const double spread = config_.interval.count() * config_.jitter_ratio;
+        std::uniform_real_distribution<double> jitter(-spread, spread);
+        return std::chrono::duration_cast<Duration>(
+            std::chrono::duration<double, std::milli>(config_.interval.count() + jitter(rng_)));
+    }
+
+    void processSlot(std::vector<Event>& slot, Timestamp now) {
+        // Swap out first: callbacks and rescheduling may append to this slot
+        std::vector<Event> events;
+        events.swap(slot);
+
+        for (const auto& event : events) {
+            auto it = entries_.find(event.id);
+            if (it == entries_.end()) {
+                continue;
+            }
+            auto& entry = it->second;
+
+            if (event.kind == EventKind::PONG_DEADLINE) {
+                if (event.generation == entry.deadline_generation && entry.awaiting_pong) {
+                    stats_.pong_timeouts++;
+                    entries_.erase(it);
+                    if (callbacks_.on_pong_timeout) {
+                        callbacks_.on_pong_timeout(event.id);
+                    }
+                }
+                continue;
+            }
+
+            if (event.generation != entry.ping_generation) {
+                continue;
+            }
+            if (tickIndex(entry.next_ping) > tickIndex(now)) {
+                // Scheduled more than one rotation ahead; keep it moving
+                insert(entry.next_ping, event);
+                continue;
+            }
+            if (config_.skip_when_active && now - entry.last_inbound < config_.interval) {
+                stats_.pings_skipped++;
+                // Reschedule relative to now, not last_inbound, so the phase spread is kept
+                schedulePing(event.id, entry, now + jitteredInterval());
+                continue;
+            }
+            if (!callbacks_.send_ping || !callbacks_.send_ping(event.id)) {
+                entries_.erase(it);
+                continue;
+            }
+
+            stats_.pings_sent++;
+            batch_.push_back(event.id);
+            if (!entry.awaiting_pong) {
+                entry.awaiting_pong = true;
+                entry.deadline_generation = ++generation_;
+                insert(now + config_.pong_timeout,
+                    Event{ event.id, entry.deadline_generation, EventKind::PONG_DEADLINE });
+            }
+            schedulePing(event.id, entry, now + jitteredInterval());
+        }
+
+        if (slot.empty()) {
+            // Nothing was re-inserted here; keep the processed vector's capacity
+            events.clear();
+            slot.swap(events);
+        }
+    }
+
+    Config config_;
+    Callbacks callbacks_;
+    std::mt19937_64 rng_;
+    uint32_t generation_{ 0 };          ///< Shared by all entries, so events from an earlier add() never match
+    std::vector<std::vector<Event>> slots_;
+    std::unordered_map<ClientID, Entry> entries_;
+    std::vector<ClientID> batch_;
+    int64_t last_tick_{ -1 };
+    Stats stats_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_HEARTBEAT_SCHEDULER_HPP
@@ -0,0 +1,477 @@
+#pragma once
+#ifndef WEBSOCKET_HTTP2_TRANSPORT_HPP
+#define WEBSOCKET_HTTP2_TRANSPORT_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include "../protocol/Http2Connection.hpp"
+#include "Transport.hpp"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class Http2FrontEnd
+ * @brief Runs WebSockets over one HTTP/2 connection (RFC 8441)
+ *
+ * Owns the connection's byte-stream transport and an Http2Connection.
+ * Each accepted extended CONNECT with ":protocol: websocket" becomes an
+ * Http2StreamTransport handed to on_stream, which wraps it in a
+ * WebSocketConnection like any TCP transport; WebSocket frames then flow
+ * as the stream's DATA, unchanged. Many WebSocket sessions share one TCP
+ * and TLS connection this way.
+ *
+ * Backpressure crosses the layers both ways:
+ * - a stream's write() fails once its queue exceeds
+ *   Http2Connection::Config::stream_buffer_limit, the same contract a TCP
+ *   transport has with its send buffer
+ * - inbound data is credited back to the client (WINDOW_UPDATE) only
+ *   after the session has processed it, and only while the session's
+ *   outbound queue is below stream_high_water; a client that does not
+ *   read its replies runs out of window on that stream instead of filling
+ *   server memory, and the other streams are unaffected
+ *
+ * The front end keeps itself alive until its transport closes. Stream
+ * transports hold it weakly and report closed once it is gone.
+ *
+ * @note Stream transports may be written from any thread; the
+ *       connection's state is guarded by one mutex and stream callbacks
+ *       run outside it, one at a time.
+ */
+class Http2FrontEnd : public std::enable_shared_from_this<Http2FrontEnd>, public NonCopyable {
+public:
+    using Request = Http2Connection::Request;
+    using Response = Http2Connection::Response;
+    using StreamHandler = std::function<void(std::unique_ptr<Transport> transport, const Request& request)>;
+
+    /**
+     * @brief Front end configuration
+     */
+    struct Config {
+        Http2Connection::Config http2;                      ///< Windows and limits
+        std::function<bool(const Request&, Response&)> accept; ///< Vet a WebSocket request and add response headers (empty = accept all)
+    };
+
+    /**
+     * @brief Create a front end for an accepted connection
+     * @param transport Connection transport (after ALPN "h2", or h2c with prior knowledge)
+     * @param on_stream Called with each accepted WebSocket stream
+     * @param config Configuration
+     * @return Front end; call start()
+     */
+    static std::shared_ptr<Http2FrontEnd> create(std::unique_ptr<Transport> transport,
+        StreamHandler on_stream, const Config& config = Config{}) {
+        return std::shared_ptr<Http2FrontEnd>(new Http2FrontEnd(std::move(transport), std::move(on_stream), config));
+    }
+
+    /**
+     * @brief Send the server preface and start reading
+     */
+    void start() {
+        auto self = shared_from_this();
+        {
+            std::lock_guard lock(mutex_);
+            writeOutput();
+        }
+        transport_->startReading(
+            [self](const Buffer& data) { self->onReceive(data); },
+            [self]() { self->onTransportClosed(); });
+    }
+
+    /**
+     * @brief Stop accepting streams (GOAWAY); open streams keep running
+     */
+    void shutdown() {
+        std::lock_guard lock(mutex_);
+        connection_.goAway();
+        writeOutput();
+    }
+
+    /**
+     * @brief Get the number of streams still open
+     */
+    size_t activeStreams() const {
+        std::lock_guard lock(mutex_);
+        return connection_.activeStreams();
+    }
+
+    /**
+     * @brief Get HTTP/2 statistics
+     */
+    Http2Connection::Stats getStats() const {
+        std::lock_guard lock(mutex_);
+        return connection_.getStats();
+    }
+
+    /**
+     * @brief Render a request as the equivalent HTTP/1.1 upgrade request
+     * @param request Extended CONNECT request
+     * @return Request text for WebSocketHandshake::parseRequest()
+     *
+     * Lets the accept callback reuse the HTTP/1.1 handshake's validation
+     * and extension/subprotocol negotiation. HTTP/2 has no
+     * Sec-WebSocket-Key, so a fixed one is supplied; the resulting
+     * Sec-WebSocket-Accept is not sent (RFC 8441 5).
+     */
+    static std::string toUpgradeRequest(const Request& request) {
+        std::string text = "GET " + request.path + " HTTP/1.1\r\n"
+            "Host: " + request.authority + "\r\n"
+            "Upgrade: websocket\r\n"
+            "Connection: Upgrade\r\n"
+            "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n";
+        for (const auto& field : request.headers) {
+            if (field.first != "sec-websocket-key") {
+                text += field.first + ": " + field.second + "\r\n";
+            }
+        }
+        return text + "\r\n";
+    }
+
+private:
+    friend class Http2StreamTransport;
+
+    /**
+     * @brief Front end side of one WebSocket stream
+     */
+    struct StreamEntry {
+        Transport::ReceiveHandler on_data;
+        Transport::CloseHandler on_close;
+        Buffer backlog;                     ///< Data received before startReading()
+        size_t deferred_credit{ 0 };        ///< Processed bytes held back while the stream's output is backed up
+        bool reading{ false };
+        bool closed{ false };               ///< Peer ended or reset the stream
+    };
+
+    /**
+     * @brief Work for stream callbacks, run outside the mutex
+     */
+    struct Event {
+        enum class Kind { OPEN, DATA, CLOSE, WRITABLE } kind;
+        uint32_t stream;
+        Buffer data;
+        Request request;
+    };
+
+    Http2FrontEnd(std::unique_ptr<Transport> transport, StreamHandler on_stream, const Config& config)
+        : transport_(std::move(transport)), on_stream_(std::move(on_stream)), config_(config),
+        connection_(makeCallbacks(), config.http2) {
+    }
+
+    Http2Connection::Callbacks makeCallbacks() {
+        Http2Connection::Callbacks callbacks;
+        callbacks.on_request = [this](const Request& request) { return onRequest(request); };
+        callbacks.on_data = [this](uint32_t stream, const uint8_t* data, size_t size) {
+            events_.push_back(Event{ Event::Kind::DATA, stream, Buffer(data, data + size), {} });
+        };
+        callbacks.on_stream_close = [this](uint32_t stream, Http2Connection::ErrorCode) {
+            events_.push_back(Event{ Event::Kind::CLOSE, stream, {}, {} });
+        };
+        callbacks.on_writable = [this](uint32_t stream) {
+            events_.push_back(Event{ Event::Kind::WRITABLE, stream, {}, {} });
+        };
+        return callbacks;
+    }
+
+    Response onRequest(const Request& request) {
+        Response response;
+        if (request.method != "CONNECT" || request.protocol.empty()) {
+            response.status = request.method == "CONNECT" ? 501 : 404;
+            return response;
+        }
+        if (request.protocol != "websocket") {
+            response.status = 501;
+            return response;
+        }
+        if (request.header("sec-websocket-version") != "13") {
+            response.status = 400;
+            response.headers.emplace_back("sec-websocket-version", "13");
+            return response;
+        }
+        if (config_.accept && !config_.accept(request, response)) {
+            if (response.status < 300) {
+                response.status = 403;
+            }
+            return response;
+        }
+        response.status = 200;
+        streams_[request.stream_id] = StreamEntry{};
+        events_.push_back(Event{ Event::Kind::OPEN, request.stream_id, {}, request });
+        return response;
+    }
+
+    void onReceive(const Buffer& data) {
+        bool ok = true;
+        {
+            std::lock_guard lock(mutex_);
+            ok = connection_.receive(data.data(), data.size());
+            writeOutput();
+        }
+        if (!ok) {
+            transport_->close();    // GOAWAY is already written
+        }
+        dispatch();
+    }
+
+    void onTransportClosed() {
+        {
+            std::lock_guard lock(mutex_);
+            for (auto& entry : streams_) {
+                events_.push_back(Event{ Event::Kind::CLOSE, entry.first, {}, {} });
+            }
+            transport_closed_ = true;
+        }
+        dispatch();
+    }
+
+    /// Hand the connection's output to the transport (caller holds mutex_)
+    void writeOutput() {
+        if (connection_.hasOutput() && !transport_closed_) {
+            std::vector<Buffer> buffers;
+            buffers.push_back(connection_.takeOutput());
+            transport_->write(std::move(buffers));
+        }
+    }
+
+    /// Run queued stream callbacks; only one thread dispatches at a time
+    void dispatch() {
+        std::vector<Event> events;
+        {
+            std::lock_guard lock(mutex_);
+            if (dispatching_) {
+                return;     // the active dispatcher picks these events up
+            }
+            dispatching_ = true;
+        }
+        for (;;) {
+            {
+                std::lock_guard lock(mutex_);
+                events.clear();
+                events.swap(events_);
+                if (events.empty()) {
+                    dispatching_ = false;
+                    return;
+                }
+            }
+            for (Event& event : events) {
+                handleEvent(event);
+            }
+        }
+    }
+
+    void handleEvent(Event& event) {
+        switch (event.kind) {
+        case Event::Kind::OPEN:
+            openStream(event.stream, event.request);
+            break;
+        case Event::Kind::DATA: {
+            Transport::ReceiveHandler handler;
+            {
+                std::lock_guard lock(mutex_);
+                auto it = streams_.find(event.stream);
+                if (it == streams_.end()) {
+                    break;
+                }
+                if (!it->second.reading) {
+                    it->second.backlog.insert(it->second.backlog.end(), event.data.begin(), event.data.end());
+                    break;
+                }
+                handler = it->second.on_data;
+            }
+            handler(event.data);
+            credit(event.stream, event.data.size());
+            break;
+        }
+        case Event::Kind::CLOSE: {
+            Transport::CloseHandler handler;
+            {
+                std::lock_guard lock(mutex_);
+                auto it = streams_.find(event.stream);
+                if (it == streams_.end() || it->second.closed) {
+                    break;
+                }
+                it->second.closed = true;
+                if (!it->second.reading) {
+                    break;  // reported by startReading()
+                }
+                handler = std::move(it->second.on_close);
+                it->second.on_data = nullptr;
+            }
+            if (handler) {
+                handler();
+            }
+            break;
+        }
+        case Event::Kind::WRITABLE: {
+            std::lock_guard lock(mutex_);
+            auto it = streams_.find(event.stream);
+            if (it != streams_.end() && it->second.deferred_credit != 0) {
+                connection_.consume(event.stream, it->second.deferred_credit);
+                it->second.deferred_credit = 0;
+                writeOutput();
+            }
+            break;
+        }
+        }
+    }
+
+    /// Hand a new stream to on_stream (defined after Http2StreamTransport)
+    void openStream(uint32_t stream, const Request& request);
+
+    /// Return processed bytes to the client's window unless the stream's output is backed up
+    void credit(uint32_t stream, size_t size) {
+        std::lock_guard lock(mutex_);
+        auto it = streams_.find(stream);
+        if (it == streams_.end()) {
+            return;
+        }
+        if (connection_.pendingBytes(stream) >= config_.http2.stream_high_water) {
+            it->second.deferred_credit += size;
+            return;
+        }
+        connection_.consume(stream, size + it->second.deferred_credit);
+        it->second.deferred_credit = 0;
+        writeOutput();
+    }
+
+    // Called by Http2StreamTransport
+
+    void startStream(uint32_t stream, Transport::ReceiveHandler on_data, Transport::CloseHandler on_close) {
+        Buffer backlog;
+        bool closed = false;
+        {
+            std::lock_guard lock(mutex_);
+            auto it = streams_.find(stream);
+            if (it == streams_.end()) {
+                return;
+            }
+            StreamEntry& entry = it->second;
+            entry.reading = true;
+            closed = entry.closed;
+            backlog.swap(entry.backlog);
+            if (!closed) {
+                entry.on_data = on_data;
+                entry.on_close = on_close;
+            }
+        }
+        if (!backlog.empty()) {
+            on_data(backlog);
+            credit(stream, backlog.size());
+        }
+        if (closed && on_close) {
+            on_close();
+        }
+    }
+
+    bool writeStream(uint32_t stream, const std::vector<Buffer>& buffers) {
+        std::lock_guard lock(mutex_);
+        if (transport_closed_) {
+            return false;
+        }
+        for (const Buffer& buffer : buffers) {
+            if (!connection_.send(stream, buffer.data(), buffer.size())) {
+                writeOutput();
+                return false;
+            }
+        }
+        writeOutput();
+        return true;
+    }
+
+    void closeStream(uint32_t stream) {
+        {
+            std::lock_guard lock(mutex_);
+            auto it = streams_.find(stream);
+            if (it == streams_.end()) {
+                return;
+            }
+            streams_.erase(it);
+            connection_.closeStream(stream);
+            writeOutput();
+        }
+        dispatch();
+    }
+
+    bool isStreamOpen(uint32_t stream) const {
+        std::lock_guard lock(mutex_);
+        return !transport_closed_ && connection_.isOpen(stream);
+    }
+
+    std::unique_ptr<Transport> transport_;
+    StreamHandler on_stream_;
+    Config config_;
+    mutable std::mutex mutex_;
+    Http2Connection connection_;
+    std::unordered_map<uint32_t, StreamEntry> streams_;    ///< Streams whose transport is not closed
+    std::vector<Event> events_;                             ///< Pending stream callbacks
+    bool dispatching_{ false };
+    bool transport_closed_{ false };
+};
+
+/**
+ * @class Http2StreamTransport
+ * @brief Transport over one HTTP/2 stream, for WebSocketConnection
+ *
+ * Reading delivers the stream's DATA; close() ends the stream
+ * (END_STREAM) after queued data is sent.
+ */
+class Http2StreamTransport final : public Transport {
+public:
+    Http2StreamTransport(std::weak_ptr<Http2FrontEnd> front_end, uint32_t stream, Endpoint remote)
+        : front_end_(std::move(front_end)), stream_(stream), remote_(std::move(remote)) {
+    }
+
+    ~Http2StreamTransport() override {
+        close();
+    }
+
+    void startReading(ReceiveHandler on_data, CloseHandler on_close) override {
+        if (auto front_end = front_end_.lock()) {
+            front_end->startStream(stream_, std::move(on_data), std::move(on_close));
+        } else if (on_close) {
+            on_close();
+        }
+    }
+
+    bool write(std::vector<Buffer> buffers) override {
+        auto front_end = front_end_.lock();
+        return front_end && front_end->writeStream(stream_, buffers);
+    }
+
+    void close() override {
+        if (auto front_end = front_end_.lock()) {
+            front_end->closeStream(stream_);
+        }
+        front_end_.reset();
+    }
+
+    bool isOpen() const override {
+        auto front_end = front_end_.lock();
+        return front_end && front_end->isStreamOpen(stream_);
+    }
+
+    Endpoint getRemoteEndpoint() const override { return remote_; }
+
+    /**
+     * @brief Get the HTTP/2 stream id
+     */
+    uint32_t getStreamId() const { return stream_; }
+
+private:
+    std::weak_ptr<Http2FrontEnd> front_end_;
+    uint32_t stream_;
+    Endpoint remote_;
+};
+
+inline void Http2FrontEnd::openStream(uint32_t stream, const Request& request) {
+    on_stream_(std::make_unique<Http2StreamTransport>(weak_from_this(), stream, transport_->getRemoteEndpoint()), request);
+}
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_HTTP2_TRANSPORT_HPP
@@ -4,6 +4,7 @@
 
 #include "../common/Types.hpp"
 #include "../common/NonCopyable.hpp"
+#include "HeartbeatScheduler.hpp"
 #include <memory>
 #include <vector>
 #include <thread>
@@ -25,6 +26,7 @@ WEBSOCKET_NAMESPACE_BEGIN
  * - Work stealing for load balancing
  * - Graceful shutdown support
  * - Thread affinity configuration
+ * - Per-thread heartbeat scheduling
  */
     class IOThreadPool : public NonCopyable {
     public:
@@ -38,8 +40,15 @@ WEBSOCKET_NAMESPACE_BEGIN
             size_t queue_size_per_thread{ 1024 };  ///< Task queue size per thread
             bool enable_affinity{ false };         ///< Enable CPU affinity
             std::string name{ "IOThreadPool" };    ///< Pool name for logging
+            HeartbeatScheduler::Config heartbeat;  ///< Heartbeat wheel settings for each thread
         };
 
+        /**
+         * @brief Factory for per-thread heartbeat callbacks
+         * @note Invoked once per I/O thread with that thread's index
+         */
+        using HeartbeatCallbackFactory = std::function<HeartbeatScheduler::Callbacks(size_t thread_index)>;
+
         /**
          * @brief Construct a new IOThreadPool
          * @param config Thread pool configuration
@@ -70,6 +79,16 @@ WEBSOCKET_NAMESPACE_BEGIN
          */
         bool post(WorkHandler handler);
 
+        /**
+         * @brief Post work to one specific I/O thread
+         * @param thread_index Target thread (0 to getThreadCount() - 1)
+         * @param handler Work handler to execute
+         * @return true if work queued successfully
+         *
+         * @note Used by warm-up to touch every thread's code paths and arenas
+         */
+        bool postTo(size_t thread_index, WorkHandler handler);
+
         /**
          * @brief Get thread pool statistics
          * @return Thread pool statistics
@@ -94,6 +113,47 @@ WEBSOCKET_NAMESPACE_BEGIN
          */
         size_t getPendingTaskCount() const;
 
+        /**
+         * @brief Change the number of I/O threads while running
+         * @param thread_count New thread count (at least 1)
+         * @return true if resize applied
+         *
+         * @note Growing starts new io_context threads that receive new
+         *       connections. Shrinking retires the highest-index threads:
+         *       they stop receiving new connections, their connections are
+         *       handed to the migration handler, and the thread exits once
+         *       its io_context has no work left.
+         */
+        bool resize(size_t thread_count);
+
+        /**
+         * @brief Set handler that moves connections off a retiring thread
+         * @param handler Called on the retiring thread with its index and the
+         *                io_context connections should move to
+         */
+        void setMigrationHandler(std::function<void(size_t from_index, asio::io_context& to)> handler);
+
+        /**
+         * @brief Get average busy fraction of the I/O threads
+         * @return Utilisation in range 0.0 - 1.0 since the previous call
+         */
+        double getUtilization() const;
+
+        /**
+         * @brief Install heartbeat callbacks (must be called before start())
+         * @param factory Creates the callbacks used by each thread's scheduler
+         */
+        void setHeartbeatCallbacks(HeartbeatCallbackFactory factory);
+
+        /**
+         * @brief Get heartbeat scheduler of the calling I/O thread
+         * @return Scheduler pointer, or nullptr if not called from a pool thread
+         *
+         * @note Sessions register here from start() and report inbound
+         *       activity on every received frame
+         */
+        HeartbeatScheduler* getLocalHeartbeatScheduler();
+
         /**
          * @brief Get ASIO io_context for direct use
          * @return Reference to ASIO io_context
@@ -113,6 +173,18 @@ WEBSOCKET_NAMESPACE_BEGIN
          */
         void setupThreadAffinity(size_t thread_index);
 
+        /**
+         * @brief Stop a thread after migrating its connections
+         * @param thread_index Index of thread to retire
+         */
+        void retireThread(size_t thread_index);
+
+        /**
+         * @brief Arm the periodic tick timer of a thread's heartbeat scheduler
+         * @param thread_index Index of the owning thread
+         */
+        void scheduleHeartbeatTick(size_t thread_index);
+
         /**
          * @brief Initialize ASIO io_contexts
          */
@@ -130,6 +202,17 @@ WEBSOCKET_NAMESPACE_BEGIN
         std::vector<std::thread> threads_;
         std::atomic<bool> running_{ false };
         std::atomic<size_t> next_thread_index_{ 0 };
+        std::atomic<size_t> active_thread_count_{ 0 };   ///< Threads eligible for new work
+        std::function<void(size_t, asio::io_context&)> migration_handler_;
+
+        // Utilisation accounting (busy nanoseconds per thread)
+        std::vector<std::unique_ptr<std::atomic<uint64_t>>> busy_ns_;
+        mutable std::atomic<int64_t> last_utilization_sample_ns_{ 0 };
+
+        // Heartbeats (one scheduler and tick timer per thread)
+        HeartbeatCallbackFactory heartbeat_factory_;
+        std::vector<std::unique_ptr<HeartbeatScheduler>> heartbeat_schedulers_;
+        std::vector<std::unique_ptr<asio::steady_timer>> heartbeat_timers_;
 };
 
 WEBSOCKET_NAMESPACE_END
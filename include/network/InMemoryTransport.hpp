@@ -0,0 +1,290 @@
+#pragma once
+#ifndef WEBSOCKET_IN_MEMORY_TRANSPORT_HPP
+#define WEBSOCKET_IN_MEMORY_TRANSPORT_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include "../utils/VirtualClock.hpp"
+#include "Transport.hpp"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <utility>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class SimNetwork
+ * @brief Creates in-memory transport pairs that share one virtual clock and seed
+ *
+ * Each pair is a bidirectional pipe. Per direction, bytes are serialised at
+ * the configured bandwidth, then arrive after latency plus seeded jitter,
+ * always in order. Delivery happens from VirtualClock timers, so the whole
+ * simulation is deterministic for a given seed and runs without sockets or
+ * threads; a million simulated clients fit in one process.
+ *
+ * The network and clock must outlive every transport they create.
+ */
+class SimNetwork : public NonCopyable {
+public:
+    /**
+     * @brief One direction of a simulated link
+     */
+    struct LinkProfile {
+        Duration latency{ 0 };                  ///< One-way base latency
+        Duration jitter{ 0 };                   ///< Uniform extra latency, 0 - jitter
+        uint64_t bandwidth_bytes_per_sec{ 0 };  ///< Serialisation rate (0 = unlimited)
+    };
+
+    /**
+     * @brief Simulation statistics
+     */
+    struct Stats {
+        uint64_t pairs_created{ 0 };            ///< Transport pairs created
+        uint64_t writes{ 0 };                   ///< Accepted writes
+        uint64_t bytes_delivered{ 0 };          ///< Bytes handed to receivers
+        uint64_t bytes_dropped{ 0 };            ///< Bytes arriving at a closed end
+    };
+
+    /**
+     * @brief Construct network
+     * @param clock Clock that drives delivery
+     * @param seed Seed for jitter (same seed, same schedule)
+     */
+    SimNetwork(VirtualClock& clock, uint64_t seed)
+        : clock_(clock), rng_(seed) {
+    }
+
+    /**
+     * @brief Create a connected pair of transports
+     * @param client_to_server Link from the first to the second transport
+     * @param server_to_client Link from the second to the first transport
+     * @return {client end, server end}
+     */
+    std::pair<std::unique_ptr<Transport>, std::unique_ptr<Transport>> createPair(
+        const LinkProfile& client_to_server, const LinkProfile& server_to_client);
+
+    /**
+     * @brief Create a connected pair with the same profile in both directions
+     * @param profile Link profile
+     * @return {client end, server end}
+     */
+    std::pair<std::unique_ptr<Transport>, std::unique_ptr<Transport>> createPair(
+        const LinkProfile& profile) {
+        return createPair(profile, profile);
+    }
+
+    /**
+     * @brief Get the driving clock
+     * @return Virtual clock
+     */
+    VirtualClock& getClock() { return clock_; }
+
+    /**
+     * @brief Get simulation statistics
+     * @return Statistics snapshot
+     */
+    const Stats& getStats() const { return stats_; }
+
+private:
+    friend class InMemoryTransport;
+
+    /**
+     * @brief State shared by both ends of a pipe
+     */
+    struct Pipe {
+        struct End {
+            Transport::ReceiveHandler on_data;
+            Transport::CloseHandler on_close;
+            Buffer backlog;                     ///< Data received before startReading()
+            bool open{ true };
+            bool reading{ false };
+            bool flush_pending{ false };        ///< Backlog handover scheduled; later data queues behind it
+            bool close_pending{ false };
+        };
+        struct Direction {
+            LinkProfile profile;
+            Timestamp busy_until{};             ///< Sender serialisation finishes
+            Timestamp last_arrival{};           ///< Keeps delivery in order
+        };
+
+        End ends[2];
+        Direction directions[2];                ///< Indexed by sending side
+        uint16_t ports[2]{ 0, 0 };
+    };
+
+    Timestamp arrivalTime(Pipe::Direction& direction, size_t bytes) {
+        const Timestamp now = clock_.now();
+        Timestamp start = std::max(now, direction.busy_until);
+        if (direction.profile.bandwidth_bytes_per_sec > 0) {
+            start += std::chrono::duration_cast<Duration>(std::chrono::duration<double>(
+                static_cast<double>(bytes) / direction.profile.bandwidth_bytes_per_sec));
+        }
+        direction.busy_until = start;
+
+        Duration delay = direction.profile.latency;
+        if (direction.profile.jitter.count() > 0) {
+            std::uniform_int_distribution<Duration::rep> jitter(0, direction.profile.jitter.count());
+            delay += Duration(jitter(rng_));
+        }
+        direction.last_arrival = std::max(direction.last_arrival, start + delay);
+        return direction.last_arrival;
+    }
+
+    void deliver(Pipe& pipe, int side, const Buffer& data) {
+        auto& end = pipe.ends[side];
+        if (!end.open) {
+            stats_.bytes_dropped += data.size();
+            return;
+        }
+        stats_.bytes_delivered += data.size();
+        if (end.reading && !end.flush_pending && end.on_data) {
+            end.on_data(data);
+        }
+        else {
+            end.backlog.insert(end.backlog.end(), data.begin(), data.end());
+        }
+    }
+
+    void deliverClose(Pipe& pipe, int side) {
+        auto& end = pipe.ends[side];
+        if (!end.open) {
+            return;
+        }
+        if (!end.reading || end.flush_pending) {
+            end.close_pending = true;
+            return;
+        }
+        end.open = false;
+        auto on_close = std::move(end.on_close);
+        end.on_data = nullptr;
+        end.on_close = nullptr; // A closed end never fires again; don't keep its owners alive
+        if (on_close) {
+            on_close();
+        }
+    }
+
+    VirtualClock& clock_;
+    std::mt19937_64 rng_;
+    uint16_t next_port_{ 1024 };
+    Stats stats_;
+};
+
+/**
+ * @class InMemoryTransport
+ * @brief One end of a SimNetwork pipe
+ */
+class InMemoryTransport final : public Transport {
+public:
+    InMemoryTransport(SimNetwork& network, std::shared_ptr<SimNetwork::Pipe> pipe, int side)
+        : network_(network), pipe_(std::move(pipe)), side_(side) {
+    }
+
+    ~InMemoryTransport() override {
+        close();
+    }
+
+    void startReading(ReceiveHandler on_data, CloseHandler on_close) override {
+        auto& end = pipe_->ends[side_];
+        end.on_data = std::move(on_data);
+        end.on_close = std::move(on_close);
+        end.reading = true;
+        end.flush_pending = true;
+
+        // Hand over anything that arrived before the reader was ready; data
+        // delivered before this runs joins the backlog, so order is kept
+        auto pipe = pipe_;
+        const int side = side_;
+        SimNetwork* network = &network_;
+        network_.clock_.scheduleAfter(Duration(0), [network, pipe, side] {
+            auto& ready = pipe->ends[side];
+            ready.flush_pending = false;
+            if (!ready.backlog.empty() && ready.open) {
+                Buffer backlog;
+                backlog.swap(ready.backlog);
+                ready.on_data(backlog);
+            }
+            if (ready.close_pending) {
+                ready.close_pending = false;
+                network->deliverClose(*pipe, side);
+            }
+        });
+    }
+
+    bool write(std::vector<Buffer> buffers) override {
+        if (!isOpen()) {
+            return false;
+        }
+        Buffer data;
+        for (auto& buffer : buffers) {
+            data.insert(data.end(), buffer.begin(), buffer.end());
+        }
+        if (data.empty()) {
+            return true;
+        }
+        network_.stats_.writes++;
+
+        const Timestamp arrival = network_.arrivalTime(pipe_->directions[side_], data.size());
+        auto pipe = pipe_;
+        const int peer = 1 - side_;
+        SimNetwork* network = &network_;
+        network_.clock_.schedule(arrival, [network, pipe, peer, data = std::move(data)] {
+            network->deliver(*pipe, peer, data);
+        });
+        return true;
+    }
+
+    void close() override {
+        auto& end = pipe_->ends[side_];
+        if (!end.open) {
+            return;
+        }
+        end.open = false;
+        end.on_data = nullptr;
+        end.on_close = nullptr;
+
+        // FIN takes one latency, but never overtakes data still in flight
+        // (last_arrival already includes that data's latency)
+        auto& direction = pipe_->directions[side_];
+        const Timestamp arrival = std::max(network_.clock_.now() + direction.profile.latency,
+            direction.last_arrival);
+        direction.last_arrival = arrival;
+        auto pipe = pipe_;
+        const int peer = 1 - side_;
+        SimNetwork* network = &network_;
+        network_.clock_.schedule(arrival, [network, pipe, peer] {
+            network->deliverClose(*pipe, peer);
+        });
+    }
+
+    bool isOpen() const override {
+        return pipe_->ends[side_].open;
+    }
+
+    Endpoint getRemoteEndpoint() const override {
+        return Endpoint("127.0.0.1", pipe_->ports[1 - side_]);
+    }
+
+private:
+    SimNetwork& network_;
+    std::shared_ptr<SimNetwork::Pipe> pipe_;
+    int side_;
+};
+
+inline std::pair<std::unique_ptr<Transport>, std::unique_ptr<Transport>> SimNetwork::createPair(
+    const LinkProfile& client_to_server, const LinkProfile& server_to_client) {
+    auto pipe = std::make_shared<Pipe>();
+    pipe->directions[0].profile = client_to_server;
+    pipe->directions[1].profile = server_to_client;
+    pipe->ports[0] = next_port_;
+    pipe->ports[1] = 443;
+    next_port_ = static_cast<uint16_t>(next_port_ == 65535 ? 1024 : next_port_ + 1);
+    stats_.pairs_created++;
+
+    return { std::make_unique<InMemoryTransport>(*this, pipe, 0),
+             std::make_unique<InMemoryTransport>(*this, pipe, 1) };
+}
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_IN_MEMORY_TRANSPORT_HPP
@@ -0,0 +1,180 @@
+#pragma once
+#ifndef WEBSOCKET_NETWORK_IMPAIRMENT_HPP
+#define WEBSOCKET_NETWORK_IMPAIRMENT_HPP
+
+#include "../common/Types.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class NetworkImpairment
+ * @brief Seeded model of one direction of a degraded link
+ *
+ * Decides when each chunk written into a stream arrives at the other end:
+ * bandwidth serialisation, a base delay drawn from a configurable
+ * distribution, TCP-style loss recovery (a lost chunk costs a retransmission
+ * timeout and holds back everything behind it), occasional link stalls and
+ * connection resets. Delivery stays in order, as on a real TCP stream.
+ *
+ * Time is passed in, so the same model drives a real-time proxy
+ * (tools/cppws-impair) or a VirtualClock simulation. One instance per
+ * direction; not thread-safe.
+ */
+class NetworkImpairment {
+public:
+    /**
+     * @brief Delay distributions
+     */
+    enum class DelayDistribution {
+        CONSTANT,       ///< Always the base delay
+        UNIFORM,        ///< Base delay + uniform [0, jitter]
+        NORMAL,         ///< Normal around the base delay, jitter is the deviation
+        PARETO          ///< Base delay + heavy tail scaled by jitter (mobile-like)
+    };
+
+    /**
+     * @brief Impairment profile for one direction
+     */
+    struct Profile {
+        Duration delay{ 0 };                                    ///< Base one-way delay
+        Duration jitter{ 0 };                                   ///< Spread, meaning depends on distribution
+        DelayDistribution distribution{ DelayDistribution::CONSTANT };
+        double pareto_shape{ 1.5 };                             ///< Tail index for PARETO (lower is heavier)
+        uint64_t bandwidth_bytes_per_sec{ 0 };                  ///< Rate cap (0 = unlimited)
+        double loss_rate{ 0.0 };                                ///< Probability a chunk needs a retransmission
+        Duration retransmit_timeout{ std::chrono::milliseconds(200) }; ///< Cost of one loss
+        double stall_probability{ 0.0 };                        ///< Probability a chunk starts a link stall
+        Duration stall_duration{ std::chrono::seconds(1) };     ///< How long a stall freezes the link
+        double reset_probability{ 0.0 };                        ///< Probability a chunk resets the connection
+        uint64_t reset_after_bytes{ 0 };                        ///< Reset once this many bytes passed (0 = never)
+    };
+
+    /**
+     * @brief Fate of one chunk
+     */
+    struct Decision {
+        Timestamp deliver_at{};     ///< When the chunk reaches the peer
+        bool reset{ false };        ///< Connection is reset instead of delivering
+    };
+
+    /**
+     * @brief Impairment statistics
+     */
+    struct Stats {
+        uint64_t chunks{ 0 };       ///< Chunks scheduled
+        uint64_t bytes{ 0 };        ///< Bytes scheduled
+        uint64_t losses{ 0 };       ///< Simulated retransmissions
+        uint64_t stalls{ 0 };       ///< Link stalls started
+        uint64_t resets{ 0 };       ///< Resets injected
+    };
+
+    /**
+     * @brief Construct model
+     * @param profile Impairment profile
+     * @param seed Random seed (same seed, same schedule)
+     */
+    NetworkImpairment(const Profile& profile, uint64_t seed)
+        : profile_(profile), rng_(seed) {
+    }
+
+    /**
+     * @brief Decide the fate of a chunk written now
+     * @param bytes Chunk size
+     * @param now Current time
+     * @return Arrival time, or a reset
+     */
+    Decision schedule(size_t bytes, Timestamp now) {
+        Decision decision;
+        stats_.chunks++;
+        stats_.bytes += bytes;
+
+        if ((profile_.reset_after_bytes > 0 && stats_.bytes > profile_.reset_after_bytes) ||
+            chance(profile_.reset_probability)) {
+            stats_.resets++;
+            decision.reset = true;
+            decision.deliver_at = now;
+            return decision;
+        }
+
+        if (chance(profile_.stall_probability)) {
+            stats_.stalls++;
+            busy_until_ = std::max(busy_until_, now) + profile_.stall_duration;
+        }
+
+        // Serialisation on the bottleneck link
+        Timestamp sent = std::max(now, busy_until_);
+        if (profile_.bandwidth_bytes_per_sec > 0) {
+            sent += std::chrono::duration_cast<Duration>(std::chrono::duration<double>(
+                static_cast<double>(bytes) / profile_.bandwidth_bytes_per_sec));
+        }
+        busy_until_ = sent;
+
+        Duration delay = sampleDelay();
+        while (chance(profile_.loss_rate)) {
+            stats_.losses++;
+            delay += profile_.retransmit_timeout;
+        }
+
+        // Head-of-line blocking: nothing overtakes an earlier chunk
+        last_arrival_ = std::max(last_arrival_, sent + delay);
+        decision.deliver_at = last_arrival_;
+        return decision;
+    }
+
+    /**
+     * @brief Get the profile
+     * @return Impairment profile
+     */
+    const Profile& getProfile() const { return profile_; }
+
+    /**
+     * @brief Get statistics
+     * @return Statistics snapshot
+     */
+    const Stats& getStats() const { return stats_; }
+
+private:
+    bool chance(double probability) {
+        return probability > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < probability;
+    }
+
+    Duration sampleDelay() {
+        const double base = static_cast<double>(profile_.delay.count());
+        const double spread = static_cast<double>(profile_.jitter.count());
+        double delay = base;
+
+        switch (profile_.distribution) {
+        case DelayDistribution::CONSTANT:
+            break;
+        case DelayDistribution::UNIFORM:
+            delay += std::uniform_real_distribution<double>(0.0, spread)(rng_);
+            break;
+        case DelayDistribution::NORMAL:
+            if (spread > 0.0) {
+                delay = std::normal_distribution<double>(base, spread)(rng_);
+            }
+            break;
+        case DelayDistribution::PARETO: {
+            const double u = std::uniform_real_distribution<double>(1e-9, 1.0)(rng_);
+            const double shape = std::max(profile_.pareto_shape, 0.1);
+            delay += std::min(spread * (std::pow(u, -1.0 / shape) - 1.0), spread * 1000.0);
+            break;
+        }
+        }
+        return Duration(static_cast<Duration::rep>(std::max(delay, 0.0)));
+    }
+
+    Profile profile_;
+    std::mt19937_64 rng_;
+    Timestamp busy_until_{};
+    Timestamp last_arrival_{};
+    Stats stats_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_NETWORK_IMPAIRMENT_HPP
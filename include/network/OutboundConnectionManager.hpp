@@ -0,0 +1,949 @@
+#pragma once
+#ifndef WEBSOCKET_OUTBOUND_CONNECTION_MANAGER_HPP
+#define WEBSOCKET_OUTBOUND_CONNECTION_MANAGER_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include "../protocol/ClientHandshake.hpp"
+#include "../protocol/WebSocketFrame.hpp"
+#include "../utils/Metrics.hpp"
+#include "DnsResolver.hpp"
+#include "Transport.hpp"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class OutboundConnectionManager
+ * @brief Pooled, multiplexed connections from handlers to internal services
+ *
+ * Where ConnectionPool recycles inbound connection objects, this keeps
+ * outbound ones: per named upstream, a small set of warm connections over
+ * which many requests are in flight at once. Each request is tagged with a
+ * correlation ID and its response is matched by that ID, so responses may
+ * come back in any order and one slow call does not block the rest.
+ *
+ * - WEBSOCKET upstreams get a client handshake (ClientHandshake) and masked
+ *   frames, one request per message; TCP upstreams use a 4-byte length prefix
+ * - Requests go to the least-loaded ready connection; new connections are
+ *   opened up to max_connections, beyond that requests queue
+ * - Host names go through DnsResolver, never the blocking Endpoint::resolve
+ * - tick() expires requests, health-checks idle connections, closes dead or
+ *   surplus ones and keeps warm_connections open. WebSocket connections get
+ *   a ping; raw TCP has no ping, so a TCP connection is vouched for by a
+ *   probe connect to the same address, closed as soon as it opens
+ * - Latency per upstream goes to a local histogram (getStats) and to Metrics
+ *   as "outbound.<name>.latency_us"
+ *
+ * A request whose connection drops fails with an error rather than being
+ * retried: the upstream may already have acted on it.
+ *
+ * Handlers run on the thread that completed them (a transport, resolver or
+ * tick() thread), never under the manager's lock.
+ */
+class OutboundConnectionManager : public NonCopyable {
+public:
+    using TransportPtr = std::unique_ptr<Transport>;
+    using ConnectHandler = std::function<void(TransportPtr transport, const std::string& error)>;
+    using Connector = std::function<void(const Endpoint& endpoint, ConnectHandler handler)>;
+    using ResponseHandler = std::function<void(const Buffer& payload, const std::string& error)>;
+
+    /**
+     * @brief Upstream wire protocol
+     */
+    enum class Protocol {
+        WEBSOCKET,      ///< RFC 6455 client, binary messages
+        TCP             ///< Length-prefixed messages over a raw stream
+    };
+
+    /**
+     * @brief Upstream service
+     */
+    struct Upstream {
+        std::string name;               ///< Name used by request()
+        std::string host;               ///< Host name or IP literal
+        uint16_t port{ 0 };             ///< Port
+        Protocol protocol{ Protocol::WEBSOCKET };
+        std::string path{ "/" };        ///< WebSocket request target
+        std::string subprotocol;        ///< WebSocket subprotocol to offer (empty = none)
+    };
+
+    /**
+     * @brief Correlation ID framing inside each message
+     *
+     * The default prefixes the payload with the ID as 8 big-endian bytes and
+     * expects responses framed the same way.
+     */
+    struct CorrelationCodec {
+        std::function<Buffer(uint64_t id, const Buffer& payload)> encode;
+        std::function<bool(const Buffer& message, uint64_t& id, Buffer& payload)> decode;
+    };
+
+    /**
+     * @brief Manager configuration
+     */
+    struct Config {
+        size_t warm_connections{ 1 };                               ///< Connections kept per upstream when idle
+        size_t max_connections{ 8 };                                ///< Connections per upstream
+        size_t max_in_flight_per_connection{ 64 };                  ///< Multiplexing depth
+        size_t max_queued_requests{ 1024 };                         ///< Waiting for a connection, per upstream
+        size_t max_message_size{ 16 * 1024 * 1024 };                ///< Response size limit
+        Duration request_timeout{ std::chrono::seconds(5) };        ///< Default request deadline
+        Duration connect_timeout{ std::chrono::seconds(3) };        ///< Resolve + connect + handshake
+        Duration health_check_interval{ std::chrono::seconds(10) }; ///< Idle time before a ping or TCP probe
+        Duration health_check_timeout{ std::chrono::seconds(2) };   ///< Ping or probe deadline
+        Duration idle_timeout{ std::chrono::seconds(60) };          ///< Surplus connections close after this
+        Duration reconnect_delay{ std::chrono::seconds(1) };        ///< Pause before re-warming an unreachable upstream
+        std::function<Timestamp()> clock;                           ///< Time source (empty = steady_clock)
+    };
+
+    /**
+     * @brief Per-upstream statistics
+     */
+    struct Stats {
+        uint64_t requests{ 0 };             ///< Requests submitted
+        uint64_t responses{ 0 };            ///< Requests answered
+        uint64_t failures{ 0 };             ///< Requests failed (connection lost, refused, queue full)
+        uint64_t timeouts{ 0 };             ///< Requests that missed their deadline
+        uint64_t late_responses{ 0 };       ///< Responses with an unknown or expired ID
+        uint64_t connects{ 0 };             ///< Connections established
+        uint64_t connect_failures{ 0 };     ///< Resolve, connect or handshake failures
+        uint64_t health_check_failures{ 0 };///< Connections closed for a missed ping or failed probe
+        size_t connections{ 0 };            ///< Open or opening connections
+        size_t in_flight{ 0 };              ///< Requests awaiting a response
+        size_t queued{ 0 };                 ///< Requests waiting for a connection
+        int64_t latency_p50_us{ 0 };        ///< Median latency (bucket upper bound)
+        int64_t latency_p99_us{ 0 };        ///< 99th percentile latency (bucket upper bound)
+    };
+
+    /**
+     * @brief Construct manager
+     * @param connector Opens byte streams (TCP, TLS, InMemoryTransport...)
+     * @param resolver Resolver for upstream host names; must outlive the manager
+     * @param config Manager configuration
+     */
+    OutboundConnectionManager(Connector connector, DnsResolver& resolver, const Config& config)
+        : state_(std::make_shared<SharedState>(std::move(connector), resolver, config)) {
+        if (state_->config.max_connections == 0) {
+            state_->config.max_connections = 1;
+        }
+        if (state_->config.max_in_flight_per_connection == 0) {
+            state_->config.max_in_flight_per_connection = 1;
+        }
+    }
+
+    ~OutboundConnectionManager() {
+        shutdown();
+    }
+
+    /**
+     * @brief Replace the correlation ID framing
+     * @param codec Encoder and decoder (both must be set)
+     */
+    void setCorrelationCodec(CorrelationCodec codec) {
+        std::lock_guard lock(state_->mutex);
+        state_->codec = std::move(codec);
+    }
+
+    /**
+     * @brief Register an upstream and start warming its connections
+     * @param upstream Upstream service
+     * @return false if the name is taken or the upstream is incomplete
+     */
+    bool addUpstream(const Upstream& upstream) {
+        if (upstream.name.empty() || upstream.host.empty() || upstream.port == 0) {
+            return false;
+        }
+        Actions actions;
+        {
+            std::lock_guard lock(state_->mutex);
+            if (state_->upstreams.count(upstream.name)) {
+                return false;
+            }
+            auto& entry = state_->upstreams[upstream.name];
+            entry = std::make_unique<UpstreamEntry>();
+            entry->upstream = upstream;
+            entry->metric_name = "outbound." + upstream.name + ".latency_us";
+            topUp(*state_, *entry, actions);
+        }
+        actions.run();
+        return true;
+    }
+
+    /**
+     * @brief Send a request with the default timeout
+     * @param upstream Upstream name
+     * @param payload Request message (without correlation ID)
+     * @param handler Called once with the response or an error
+     */
+    void request(const std::string& upstream, const Buffer& payload, ResponseHandler handler) {
+        request(upstream, payload, std::move(handler), state_->config.request_timeout);
+    }
+
+    /**
+     * @brief Send a request
+     * @param upstream Upstream name
+     * @param payload Request message (without correlation ID)
+     * @param handler Called once with the response or an error
+     * @param timeout Deadline measured from now
+     */
+    void request(const std::string& upstream, const Buffer& payload, ResponseHandler handler, Duration timeout) {
+        Actions actions;
+        {
+            std::lock_guard lock(state_->mutex);
+            auto it = state_->upstreams.find(upstream);
+            if (state_->stopped || it == state_->upstreams.end()) {
+                actions.fail(std::move(handler), "unknown upstream " + upstream);
+            }
+            else {
+                UpstreamEntry& entry = *it->second;
+                entry.stats.requests++;
+
+                Pending pending;
+                pending.id = state_->next_request_id++;
+                pending.handler = std::move(handler);
+                pending.started = state_->now();
+                pending.deadline = pending.started + timeout;
+
+                Channel* channel = pickChannel(*state_, entry);
+                if (channel) {
+                    sendRequest(*state_, entry, *channel, std::move(pending), payload);
+                }
+                else if (entry.queue.size() >= state_->config.max_queued_requests) {
+                    entry.stats.failures++;
+                    actions.fail(std::move(pending.handler), "outbound queue full for " + upstream);
+                }
+                else {
+                    pending.payload = payload;
+                    entry.queue.push_back(std::move(pending));
+                    topUp(*state_, entry, actions);
+                }
+            }
+        }
+        actions.run();
+    }
+
+    /**
+     * @brief Expire requests, run health checks and maintain warm connections
+     *
+     * @note Call periodically (e.g. every 100ms) from any thread
+     */
+    void tick() {
+        Actions actions;
+        {
+            std::lock_guard lock(state_->mutex);
+            if (state_->stopped) {
+                return;
+            }
+            const Timestamp now = state_->now();
+            state_->graveyard.clear();
+            for (auto& [name, entry] : state_->upstreams) {
+                tickUpstream(*state_, *entry, now, actions);
+            }
+        }
+        actions.run();
+    }
+
+    /**
+     * @brief Close every connection and fail outstanding requests
+     */
+    void shutdown() {
+        Actions actions;
+        {
+            std::lock_guard lock(state_->mutex);
+            if (state_->stopped) {
+                return;
+            }
+            state_->stopped = true;
+            for (auto& [name, entry] : state_->upstreams) {
+                while (!entry->channels.empty()) {
+                    closeChannel(*state_, *entry, entry->channels.begin()->first, "manager shut down", actions);
+                }
+                for (auto& pending : entry->queue) {
+                    actions.fail(std::move(pending.handler), "manager shut down");
+                }
+                entry->queue.clear();
+            }
+        }
+        actions.run();
+    }
+
+    /**
+     * @brief Get statistics for one upstream
+     * @param upstream Upstream name
+     * @return Statistics snapshot (zeroed if unknown)
+     */
+    Stats getStats(const std::string& upstream) const {
+        std::lock_guard lock(state_->mutex);
+        auto it = state_->upstreams.find(upstream);
+        if (it == state_->upstreams.end()) {
+            return Stats{};
+        }
+        const UpstreamEntry& entry = *it->second;
+        Stats stats = entry.stats;
+        stats.connections = entry.channels.size();
+        stats.queued = entry.queue.size();
+        for (const auto& [id, channel] : entry.channels) {
+            stats.in_flight += channel->in_flight.size();
+        }
+        stats.latency_p50_us = entry.latency.percentile(50.0);
+        stats.latency_p99_us = entry.latency.percentile(99.0);
+        return stats;
+    }
+
+private:
+    /// A request waiting to be sent or answered
+    struct Pending {
+        uint64_t id{ 0 };
+        ResponseHandler handler;
+        Timestamp started{};
+        Timestamp deadline{};
+        Buffer payload;         ///< Only kept while queued
+    };
+
+    /// One connection to an upstream
+    struct Channel {
+        enum class Phase { CONNECTING, HANDSHAKING, READY };
+
+        uint64_t id{ 0 };
+        Phase phase{ Phase::CONNECTING };
+        TransportPtr transport;
+        Endpoint endpoint;                          ///< Address connected to, reused by TCP probes
+        Timestamp opened{};
+        Timestamp last_activity{};
+        ClientHandshake handshake;
+        std::string response;                       ///< Handshake response so far
+        Buffer inbound;                             ///< Unparsed stream bytes
+        Buffer message;                             ///< Fragmented message being reassembled
+        std::unordered_map<uint64_t, Pending> in_flight;
+        bool ping_outstanding{ false };             ///< Ping or TCP probe awaiting an answer
+        Timestamp ping_sent{};
+    };
+
+    struct UpstreamEntry {
+        Upstream upstream;
+        std::string metric_name;
+        std::map<uint64_t, std::unique_ptr<Channel>> channels;
+        std::deque<Pending> queue;
+        size_t next_endpoint{ 0 };
+        Timestamp retry_after{};            ///< No warm-up connects before this
+        Stats stats;
+        Metrics::HistogramStats latency;
+    };
+
+    /// State shared with transport, connector and resolver callbacks
+    struct SharedState : std::enable_shared_from_this<SharedState> {
+        SharedState(Connector c, DnsResolver& r, const Config& cfg)
+            : connector(std::move(c)), resolver(r), config(cfg),
+            codec(defaultCodec()), rng(std::random_device{}()) {
+        }
+
+        Timestamp now() const {
+            return config.clock ? config.clock() : std::chrono::steady_clock::now();
+        }
+
+        std::mutex mutex;
+        Connector connector;
+        DnsResolver& resolver;
+        Config config;
+        CorrelationCodec codec;
+        std::mt19937 rng;
+        std::unordered_map<std::string, std::unique_ptr<UpstreamEntry>> upstreams;
+        std::vector<TransportPtr> graveyard;        ///< Closed transports, freed on the next tick
+        uint64_t next_request_id{ 1 };
+        uint64_t next_channel_id{ 1 };
+        bool stopped{ false };
+    };
+
+    /// Work deferred until the lock is released
+    struct Actions {
+        std::vector<std::function<void()>> calls;
+
+        void fail(ResponseHandler handler, const std::string& error) {
+            if (handler) {
+                calls.push_back([handler = std::move(handler), error] { handler(Buffer{}, error); });
+            }
+        }
+
+        void respond(ResponseHandler handler, Buffer payload) {
+            if (handler) {
+                calls.push_back([handler = std::move(handler), payload = std::move(payload)] { handler(payload, ""); });
+            }
+        }
+
+        void run() {
+            for (auto& call : calls) {
+                call();
+            }
+        }
+    };
+
+    static CorrelationCodec defaultCodec() {
+        CorrelationCodec codec;
+        codec.encode = [](uint64_t id, const Buffer& payload) {
+            Buffer message(8 + payload.size());
+            for (int i = 0; i < 8; ++i) {
+                message[i] = static_cast<uint8_t>(id >> (56 - 8 * i));
+            }
+            std::copy(payload.begin(), payload.end(), message.begin() + 8);
+            return message;
+        };
+        codec.decode = [](const Buffer& message, uint64_t& id, Buffer& payload) {
+            if (message.size() < 8) {
+                return false;
+            }
+            id = 0;
+            for (int i = 0; i < 8; ++i) {
+                id = (id << 8) | message[i];
+            }
+            payload.assign(message.begin() + 8, message.end());
+            return true;
+        };
+        return codec;
+    }
+
+    /// Least-loaded ready connection with a free slot, if any
+    static Channel* pickChannel(SharedState& state, UpstreamEntry& entry) {
+        Channel* best = nullptr;
+        for (auto& [id, channel] : entry.channels) {
+            if (channel->phase != Channel::Phase::READY || channel->ping_outstanding ||
+                channel->in_flight.size() >= state.config.max_in_flight_per_connection) {
+                continue;
+            }
+            if (!best || channel->in_flight.size() < best->in_flight.size()) {
+                best = channel.get();
+            }
+        }
+        return best;
+    }
+
+    /// Open connections for queued work and the warm minimum
+    static void topUp(SharedState& state, UpstreamEntry& entry, Actions& actions) {
+        size_t opening = 0;
+        size_t capacity = 0;
+        for (const auto& [id, channel] : entry.channels) {
+            if (channel->phase != Channel::Phase::READY) {
+                opening++;
+            }
+            else {
+                capacity += state.config.max_in_flight_per_connection -
+                    std::min(channel->in_flight.size(), state.config.max_in_flight_per_connection);
+            }
+        }
+        const size_t slots_opening = opening * state.config.max_in_flight_per_connection;
+        size_t wanted = entry.channels.size() < state.config.warm_connections && state.now() >= entry.retry_after ?
+            state.config.warm_connections - entry.channels.size() : 0;
+        if (entry.queue.size() > capacity + slots_opening) {
+            wanted = std::max<size_t>(wanted, 1);
+        }
+        while (wanted-- > 0 && entry.channels.size() < state.config.max_connections) {
+            openChannel(state, entry, actions);
+        }
+    }
+
+    static void openChannel(SharedState& state, UpstreamEntry& entry, Actions& actions) {
+        auto channel = std::make_unique<Channel>();
+        channel->id = state.next_channel_id++;
+        channel->opened = state.now();
+        channel->last_activity = channel->opened;
+        const uint64_t channel_id = channel->id;
+        entry.channels.emplace(channel_id, std::move(channel));
+
+        // Resolution may complete synchronously, so start it after unlocking
+        std::weak_ptr<SharedState> weak = state.weak_from_this();
+        const Upstream upstream = entry.upstream;
+        actions.calls.push_back([weak, upstream, channel_id] {
+            auto locked = weak.lock();
+            if (!locked) {
+                return;
+            }
+            locked->resolver.resolve(upstream.host, upstream.port,
+                [weak, name = upstream.name, channel_id](const std::vector<Endpoint>& endpoints, const std::string& error) {
+                    onResolved(weak, name, channel_id, endpoints, error);
+                });
+        });
+    }
+
+    static void onResolved(const std::weak_ptr<SharedState>& weak, const std::string& name, uint64_t channel_id,
+        const std::vector<Endpoint>& endpoints, const std::string& error) {
+        auto state = weak.lock();
+        if (!state) {
+            return;
+        }
+        Endpoint endpoint;
+        Connector connector;
+        {
+            Actions actions;
+            {
+                std::lock_guard lock(state->mutex);
+                UpstreamEntry* entry = findEntry(*state, name);
+                if (!entry || !entry->channels.count(channel_id)) {
+                    return;
+                }
+                if (endpoints.empty()) {
+                    entry->stats.connect_failures++;
+                    closeChannel(*state, *entry, channel_id, "resolve " + entry->upstream.host + ": " + error, actions);
+                }
+                else {
+                    endpoint = endpoints[entry->next_endpoint++ % endpoints.size()];
+                    entry->channels[channel_id]->endpoint = endpoint;
+                    connector = state->connector;
+                }
+            }
+            actions.run();
+        }
+        if (!connector) {
+            return;
+        }
+        connector(endpoint, [weak, name, channel_id](TransportPtr transport, const std::string& connect_error) {
+            onConnected(weak, name, channel_id, std::move(transport), connect_error);
+        });
+    }
+
+    static void onConnected(const std::weak_ptr<SharedState>& weak, const std::string& name, uint64_t channel_id,
+        TransportPtr transport, const std::string& error) {
+        auto state = weak.lock();
+        if (!state) {
+            if (transport) {
+                transport->close();
+            }
+            return;
+        }
+        Actions actions;
+        TransportPtr unused;
+        {
+            std::lock_guard lock(state->mutex);
+            UpstreamEntry* entry = findEntry(*state, name);
+            Channel* channel = findChannel(entry, channel_id);
+            if (!channel) {
+                unused = std::move(transport); // Timed out or shut down meanwhile
+            }
+            else if (!transport || !transport->isOpen()) {
+                entry->stats.connect_failures++;
+                closeChannel(*state, *entry, channel_id,
+                    "connect " + entry->upstream.name + ": " + (error.empty() ? "refused" : error), actions);
+            }
+            else {
+                channel->transport = std::move(transport);
+                channel->last_activity = state->now();
+                channel->transport->startReading(
+                    [weak, name, channel_id](const Buffer& data) { onData(weak, name, channel_id, data); },
+                    [weak, name, channel_id] { onClosed(weak, name, channel_id); });
+
+                if (entry->upstream.protocol == Protocol::WEBSOCKET) {
+                    channel->phase = Channel::Phase::HANDSHAKING;
+                    const std::string host = entry->upstream.host + ":" + std::to_string(entry->upstream.port);
+                    const std::string request = channel->handshake.createRequest(
+                        host, entry->upstream.path, entry->upstream.subprotocol);
+                    channel->transport->write({ Buffer(request.begin(), request.end()) });
+                }
+                else {
+                    becomeReady(*state, *entry, *channel);
+                }
+            }
+        }
+        if (unused) {
+            unused->close();
+        }
+        actions.run();
+    }
+
+    /// Result of a TCP liveness probe; the probe stream itself is discarded
+    static void onProbed(const std::weak_ptr<SharedState>& weak, const std::string& name, uint64_t channel_id,
+        TransportPtr probe, const std::string& error) {
+        const bool reached = probe && probe->isOpen();
+        if (probe) {
+            probe->close();
+        }
+        auto state = weak.lock();
+        if (!state) {
+            return;
+        }
+        Actions actions;
+        {
+            std::lock_guard lock(state->mutex);
+            UpstreamEntry* entry = findEntry(*state, name);
+            Channel* channel = findChannel(entry, channel_id);
+            if (!channel || !channel->ping_outstanding) {
+                return; // Closed, or already failed by tick()
+            }
+            if (reached) {
+                channel->ping_outstanding = false;
+                channel->last_activity = state->now();
+                drainQueue(*state, *entry);
+            }
+            else {
+                entry->stats.health_check_failures++;
+                closeChannel(*state, *entry, channel_id, "health check of " + name + " failed: " +
+                    (error.empty() ? "refused" : error), actions);
+            }
+        }
+        actions.run();
+    }
+
+    static void becomeReady(SharedState& state, UpstreamEntry& entry, Channel& channel) {
+        channel.phase = Channel::Phase::READY;
+        entry.stats.connects++;
+        drainQueue(state, entry);
+    }
+
+    /// Move queued requests onto ready connections with free slots
+    static void drainQueue(SharedState& state, UpstreamEntry& entry) {
+        while (!entry.queue.empty()) {
+            Channel* channel = pickChannel(state, entry);
+            if (!channel) {
+                return;
+            }
+            Pending pending = std::move(entry.queue.front());
+            entry.queue.pop_front();
+            Buffer payload = std::move(pending.payload);
+            sendRequest(state, entry, *channel, std::move(pending), payload);
+        }
+    }
+
+    static void sendRequest(SharedState& state, UpstreamEntry& entry, Channel& channel, Pending pending, const Buffer& payload) {
+        Buffer message = state.codec.encode(pending.id, payload);
+        pending.payload.clear();
+        channel.in_flight.emplace(pending.id, std::move(pending));
+        writeMessage(state, entry, channel, Opcode::BINARY, message);
+    }
+
+    static void writeMessage(SharedState& state, UpstreamEntry& entry, Channel& channel, Opcode opcode, const Buffer& message) {
+        if (entry.upstream.protocol == Protocol::WEBSOCKET) {
+            // Client frames must be masked (RFC 6455 section 5.3)
+            WebSocketFrame frame(opcode, message, true, true);
+            frame.setMaskingKey(static_cast<uint32_t>(state.rng()));
+            channel.transport->write({ frame.serialize() });
+            return;
+        }
+        Buffer header(4);
+        const auto size = static_cast<uint32_t>(message.size());
+        for (int i = 0; i < 4; ++i) {
+            header[i] = static_cast<uint8_t>(size >> (24 - 8 * i));
+        }
+        channel.transport->write({ std::move(header), message });
+    }
+
+    static void onData(const std::weak_ptr<SharedState>& weak, const std::string& name, uint64_t channel_id, const Buffer& data) {
+        auto state = weak.lock();
+        if (!state) {
+            return;
+        }
+        Actions actions;
+        {
+            std::lock_guard lock(state->mutex);
+            UpstreamEntry* entry = findEntry(*state, name);
+            Channel* found = findChannel(entry, channel_id);
+            if (!found) {
+                return;
+            }
+            Channel& channel = *found;
+            channel.last_activity = state->now();
+
+            if (channel.phase == Channel::Phase::HANDSHAKING) {
+                channel.response.append(data.begin(), data.end());
+                size_t consumed = 0;
+                switch (channel.handshake.parseResponse(channel.response, consumed)) {
+                case ClientHandshake::Result::INCOMPLETE:
+                    if (channel.response.size() > 16384) {
+                        entry->stats.connect_failures++;
+                        closeChannel(*state, *entry, channel_id, "upgrade response too large", actions);
+                    }
+                    break;
+                case ClientHandshake::Result::FAILED:
+                    entry->stats.connect_failures++;
+                    closeChannel(*state, *entry, channel_id, channel.handshake.getErrorMessage(), actions);
+                    break;
+                case ClientHandshake::Result::SUCCESS:
+                    channel.inbound.assign(channel.response.begin() + consumed, channel.response.end());
+                    channel.response.clear();
+                    becomeReady(*state, *entry, channel);
+                    processInbound(*state, *entry, channel, actions);
+                    break;
+                }
+            }
+            else if (channel.phase == Channel::Phase::READY) {
+                channel.inbound.insert(channel.inbound.end(), data.begin(), data.end());
+                processInbound(*state, *entry, channel, actions);
+            }
+        }
+        actions.run();
+    }
+
+    /// Parse complete messages out of the inbound buffer
+    static void processInbound(SharedState& state, UpstreamEntry& entry, Channel& channel, Actions& actions) {
+        const uint64_t channel_id = channel.id;
+        const size_t limit = state.config.max_message_size;
+        std::string error;
+
+        if (entry.upstream.protocol == Protocol::TCP) {
+            size_t offset = 0;
+            while (channel.inbound.size() - offset >= 4) {
+                const uint8_t* p = channel.inbound.data() + offset;
+                const size_t size = (size_t(p[0]) << 24) | (size_t(p[1]) << 16) | (size_t(p[2]) << 8) | p[3];
+                if (size > limit) {
+                    error = "response exceeds max_message_size";
+                    break;
+                }
+                if (channel.inbound.size() - offset < 4 + size) {
+                    break;
+                }
+                deliver(state, entry, channel, Buffer(p + 4, p + 4 + size), actions);
+                offset += 4 + size;
+            }
+            channel.inbound.erase(channel.inbound.begin(), channel.inbound.begin() + offset);
+        }
+        else {
+            while (!channel.inbound.empty() && error.empty()) {
+                WebSocketFrame frame;
+                size_t consumed = 0;
+                try {
+                    consumed = WebSocketFrame::parse(channel.inbound, frame);
+                }
+                catch (const std::exception& e) {
+                    error = std::string("protocol error: ") + e.what();
+                    break;
+                }
+                if (consumed == 0) {
+                    break;
+                }
+                channel.inbound.erase(channel.inbound.begin(), channel.inbound.begin() + consumed);
+                error = handleFrame(state, entry, channel, frame, actions);
+            }
+            if (error.empty() && channel.inbound.size() > limit + 14) {
+                error = "response exceeds max_message_size";
+            }
+        }
+
+        if (!error.empty()) {
+            closeChannel(state, entry, channel_id, error, actions);
+            return;
+        }
+        drainQueue(state, entry);
+    }
+
+    /// Handle one WebSocket frame; returns an error to close the connection
+    static std::string handleFrame(SharedState& state, UpstreamEntry& entry, Channel& channel,
+        const WebSocketFrame& frame, Actions& actions) {
+        switch (frame.getOpcode()) {
+        case Opcode::PING:
+            writeMessage(state, entry, channel, Opcode::PONG, frame.getPayload());
+            return "";
+        case Opcode::PONG:
+            channel.ping_outstanding = false;
+            return "";
+        case Opcode::CLOSE:
+            writeMessage(state, entry, channel, Opcode::CLOSE, frame.getPayload());
+            return "upstream closed the connection";
+        default:
+            break;
+        }
+
+        const Buffer& payload = frame.getPayload();
+        if (channel.message.size() + payload.size() > state.config.max_message_size) {
+            return "response exceeds max_message_size";
+        }
+        if (frame.getFin() && channel.message.empty()) {
+            deliver(state, entry, channel, payload, actions);
+            return "";
+        }
+        channel.message.insert(channel.message.end(), payload.begin(), payload.end());
+        if (frame.getFin()) {
+            Buffer message;
+            message.swap(channel.message);
+            deliver(state, entry, channel, message, actions);
+        }
+        return "";
+    }
+
+    /// Match a response to its request
+    static void deliver(SharedState& state, UpstreamEntry& entry, Channel& channel, const Buffer& message, Actions& actions) {
+        uint64_t id = 0;
+        Buffer payload;
+        if (!state.codec.decode(message, id, payload)) {
+            entry.stats.late_responses++;
+            return;
+        }
+        auto it = channel.in_flight.find(id);
+        if (it == channel.in_flight.end()) {
+            entry.stats.late_responses++;
+            return;
+        }
+        const auto latency_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            state.now() - it->second.started).count();
+        entry.latency.record(latency_us);
+        const std::string metric = entry.metric_name;
+        actions.calls.push_back([metric, latency_us] {
+            Metrics::getInstance().recordHistogram(metric, latency_us);
+        });
+        entry.stats.responses++;
+        actions.respond(std::move(it->second.handler), std::move(payload));
+        channel.in_flight.erase(it);
+    }
+
+    static void onClosed(const std::weak_ptr<SharedState>& weak, const std::string& name, uint64_t channel_id) {
+        auto state = weak.lock();
+        if (!state) {
+            return;
+        }
+        Actions actions;
+        {
+            std::lock_guard lock(state->mutex);
+            UpstreamEntry* entry = findEntry(*state, name);
+            if (!entry || !entry->channels.count(channel_id)) {
+                return;
+            }
+            if (entry->channels[channel_id]->phase != Channel::Phase::READY) {
+                entry->stats.connect_failures++;
+            }
+            closeChannel(*state, *entry, channel_id, "connection to " + name + " closed", actions);
+        }
+        actions.run();
+    }
+
+    /**
+     * @brief Remove a connection, failing what was sent on it
+     *
+     * In-flight requests are not retried: the upstream may have acted on them.
+     * Queued requests stay queued unless no connection can be opened.
+     */
+    static void closeChannel(SharedState& state, UpstreamEntry& entry, uint64_t channel_id,
+        const std::string& error, Actions& actions) {
+        auto it = entry.channels.find(channel_id);
+        if (it == entry.channels.end()) {
+            return;
+        }
+        std::unique_ptr<Channel> channel = std::move(it->second);
+        entry.channels.erase(it);
+
+        const bool was_ready = channel->phase == Channel::Phase::READY;
+        for (auto& [id, pending] : channel->in_flight) {
+            entry.stats.failures++;
+            actions.fail(std::move(pending.handler), error);
+        }
+        if (channel->transport) {
+            channel->transport->close();
+            // May be inside this transport's own callback; free it later
+            state.graveyard.push_back(std::move(channel->transport));
+        }
+
+        if (state.stopped) {
+            return;
+        }
+        if (!was_ready && entry.channels.empty()) {
+            // Nothing can serve the queue right now; fail fast instead of waiting for timeouts
+            entry.retry_after = state.now() + state.config.reconnect_delay;
+            for (auto& pending : entry.queue) {
+                entry.stats.failures++;
+                actions.fail(std::move(pending.handler), error);
+            }
+            entry.queue.clear();
+            return;
+        }
+        topUp(state, entry, actions);
+    }
+
+    static void tickUpstream(SharedState& state, UpstreamEntry& entry, Timestamp now, Actions& actions) {
+        // Expired requests, queued and in flight
+        for (auto it = entry.queue.begin(); it != entry.queue.end();) {
+            if (now >= it->deadline) {
+                entry.stats.timeouts++;
+                actions.fail(std::move(it->handler), "request to " + entry.upstream.name + " timed out");
+                it = entry.queue.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        std::vector<std::pair<uint64_t, std::string>> to_close;
+        size_t idle_surplus = entry.channels.size() > state.config.warm_connections ?
+            entry.channels.size() - state.config.warm_connections : 0;
+        for (auto& [id, channel] : entry.channels) {
+            for (auto it = channel->in_flight.begin(); it != channel->in_flight.end();) {
+                if (now >= it->second.deadline) {
+                    entry.stats.timeouts++;
+                    actions.fail(std::move(it->second.handler), "request to " + entry.upstream.name + " timed out");
+                    it = channel->in_flight.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+
+            if (channel->phase != Channel::Phase::READY) {
+                if (now - channel->opened >= state.config.connect_timeout) {
+                    entry.stats.connect_failures++;
+                    to_close.emplace_back(id, "connect to " + entry.upstream.name + " timed out");
+                }
+                continue;
+            }
+            if (!channel->transport->isOpen()) {
+                to_close.emplace_back(id, "connection to " + entry.upstream.name + " closed");
+                continue;
+            }
+            if (channel->ping_outstanding) {
+                if (now - channel->ping_sent >= state.config.health_check_timeout) {
+                    entry.stats.health_check_failures++;
+                    to_close.emplace_back(id, "health check of " + entry.upstream.name + " timed out");
+                }
+                continue;
+            }
+            const Duration idle = now - channel->last_activity;
+            if (channel->in_flight.empty() && idle_surplus > 0 && idle >= state.config.idle_timeout) {
+                idle_surplus--;
+                to_close.emplace_back(id, "idle");
+                continue;
+            }
+            if (idle >= state.config.health_check_interval) {
+                channel->ping_outstanding = true;
+                channel->ping_sent = now;
+                if (entry.upstream.protocol == Protocol::WEBSOCKET) {
+                    writeMessage(state, entry, *channel, Opcode::PING, Buffer{});
+                    continue;
+                }
+                // A quiet TCP stream looks the same whether the peer is idle or
+                // gone; a fresh connect to the same address tells them apart
+                actions.calls.push_back([weak = state.weak_from_this(), connector = state.connector,
+                    endpoint = channel->endpoint, name = entry.upstream.name, channel_id = id] {
+                    connector(endpoint, [weak, name, channel_id](TransportPtr probe, const std::string& error) {
+                        onProbed(weak, name, channel_id, std::move(probe), error);
+                    });
+                });
+            }
+        }
+        for (const auto& [id, error] : to_close) {
+            closeChannel(state, entry, id, error, actions);
+        }
+        topUp(state, entry, actions);
+    }
+
+    static UpstreamEntry* findEntry(SharedState& state, const std::string& name) {
+        auto it = state.upstreams.find(name);
+        return it != state.upstreams.end() ? it->second.get() : nullptr;
+    }
+
+    static Channel* findChannel(UpstreamEntry* entry, uint64_t channel_id) {
+        if (!entry) {
+            return nullptr;
+        }
+        auto it = entry->channels.find(channel_id);
+        return it != entry->channels.end() ? it->second.get() : nullptr;
+    }
+
+    std::shared_ptr<SharedState> state_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_OUTBOUND_CONNECTION_MANAGER_HPP
@@ -0,0 +1,190 @@
+#pragma once
+#ifndef WEBSOCKET_RTT_ESTIMATOR_HPP
+#define WEBSOCKET_RTT_ESTIMATOR_HPP
+
+#include "../common/Types.hpp"
+#include "../constants/WebSocketConstants.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class RttEstimator
+ * @brief Per-session round-trip time estimator driven by ping/pong frames
+ *
+ * The server embeds a probe (magic, sequence number, send timestamp) in the
+ * payload of its own PING frames. RFC 6455 Section 5.5.3 requires the peer to
+ * echo that payload verbatim in the PONG, so the RTT can be computed when the
+ * pong arrives without any application-level protocol.
+ *
+ * Smoothing follows RFC 6298: SRTT and RTTVAR are exponentially weighted
+ * moving averages with gains of 1/8 and 1/4.
+ *
+ * Threading: samples are recorded from the session's I/O thread only, while
+ * snapshots may be read from any thread (all state is atomic).
+ */
+class RttEstimator {
+public:
+    /**
+     * @brief Size of the probe payload carried in PING frames
+     */
+    static constexpr size_t PROBE_SIZE = 16;
+
+    /**
+     * @brief Probe marker ("RTTP") used to tell our probes apart from application pings
+     */
+    static constexpr uint32_t PROBE_MAGIC = 0x52545450;
+
+    static_assert(PROBE_SIZE <= WebSocketConstants::MAX_PING_PONG_PAYLOAD,
+        "RTT probe must fit in a control frame");
+
+    /**
+     * @brief Point-in-time view of the estimator
+     */
+    struct Snapshot {
+        std::chrono::nanoseconds last{ 0 };     ///< Most recent RTT sample
+        std::chrono::nanoseconds smoothed{ 0 }; ///< Smoothed RTT (SRTT)
+        std::chrono::nanoseconds jitter{ 0 };   ///< RTT variation (RTTVAR)
+        std::chrono::nanoseconds min{ 0 };      ///< Lowest RTT observed
+        uint64_t samples{ 0 };                  ///< Number of samples recorded
+    };
+
+    /**
+     * @brief Build the payload for the next probe ping
+     * @param now Send time
+     * @return 16-byte ping payload
+     */
+    Buffer createProbe(Timestamp now = std::chrono::steady_clock::now()) {
+        const uint32_t sequence = next_sequence_.fetch_add(1, std::memory_order_relaxed);
+        const uint64_t sent_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count());
+
+        Buffer payload(PROBE_SIZE);
+        writeBigEndian(payload.data(), PROBE_MAGIC, 4);
+        writeBigEndian(payload.data() + 4, sequence, 4);
+        writeBigEndian(payload.data() + 8, sent_ns, 8);
+        return payload;
+    }
+
+    /**
+     * @brief Extract the send timestamp from a pong payload
+     * @param payload PONG frame payload
+     * @return Send time if the payload is one of our probes, empty otherwise
+     */
+    static std::optional<Timestamp> parseProbe(const Buffer& payload) {
+        if (payload.size() != PROBE_SIZE ||
+            readBigEndian(payload.data(), 4) != PROBE_MAGIC) {
+            return std::nullopt;
+        }
+        const auto sent_ns = static_cast<int64_t>(readBigEndian(payload.data() + 8, 8));
+        return Timestamp(std::chrono::duration_cast<Duration>(std::chrono::nanoseconds(sent_ns)));
+    }
+
+    /**
+     * @brief Record a sample from a received pong
+     * @param payload PONG frame payload
+     * @param now Receive time
+     * @return Measured RTT, or empty if the pong did not carry a valid probe
+     */
+    std::optional<std::chrono::nanoseconds> onPong(const Buffer& payload,
+        Timestamp now = std::chrono::steady_clock::now()) {
+        auto sent = parseProbe(payload);
+        if (!sent || *sent > now) {
+            return std::nullopt;
+        }
+        auto rtt = std::chrono::duration_cast<std::chrono::nanoseconds>(now - *sent);
+        addSample(rtt);
+        return rtt;
+    }
+
+    /**
+     * @brief Feed a raw RTT sample into the smoothed estimates
+     * @param rtt Measured round-trip time
+     */
+    void addSample(std::chrono::nanoseconds rtt) {
+        const int64_t r = rtt.count();
+        const int64_t srtt = srtt_ns_.load(std::memory_order_relaxed);
+
+        if (samples_.load(std::memory_order_relaxed) == 0) {
+            // First measurement (RFC 6298 Section 2.2)
+            srtt_ns_.store(r, std::memory_order_relaxed);
+            rttvar_ns_.store(r / 2, std::memory_order_relaxed);
+            min_ns_.store(r, std::memory_order_relaxed);
+        }
+        else {
+            // Subsequent measurements (RFC 6298 Section 2.3)
+            const int64_t delta = r > srtt ? r - srtt : srtt - r;
+            const int64_t rttvar = rttvar_ns_.load(std::memory_order_relaxed);
+            rttvar_ns_.store(rttvar + (delta - rttvar) / 4, std::memory_order_relaxed);
+            srtt_ns_.store(srtt + (r - srtt) / 8, std::memory_order_relaxed);
+            if (r < min_ns_.load(std::memory_order_relaxed)) {
+                min_ns_.store(r, std::memory_order_relaxed);
+            }
+        }
+
+        last_ns_.store(r, std::memory_order_relaxed);
+        samples_.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Check whether at least one sample has been recorded
+     * @return true if RTT values are meaningful
+     */
+    bool hasSamples() const {
+        return samples_.load(std::memory_order_acquire) > 0;
+    }
+
+    /**
+     * @brief Get current estimates
+     * @return Snapshot of RTT statistics
+     */
+    Snapshot getSnapshot() const {
+        Snapshot snapshot;
+        snapshot.samples = samples_.load(std::memory_order_acquire);
+        snapshot.last = std::chrono::nanoseconds(last_ns_.load(std::memory_order_relaxed));
+        snapshot.smoothed = std::chrono::nanoseconds(srtt_ns_.load(std::memory_order_relaxed));
+        snapshot.jitter = std::chrono::nanoseconds(rttvar_ns_.load(std::memory_order_relaxed));
+        snapshot.min = std::chrono::nanoseconds(min_ns_.load(std::memory_order_relaxed));
+        return snapshot;
+    }
+
+    /**
+     * @brief Reset estimator (when a pooled session is reused)
+     */
+    void reset() {
+        samples_.store(0, std::memory_order_relaxed);
+        last_ns_.store(0, std::memory_order_relaxed);
+        srtt_ns_.store(0, std::memory_order_relaxed);
+        rttvar_ns_.store(0, std::memory_order_relaxed);
+        min_ns_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static void writeBigEndian(Byte* out, uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; ++i) {
+            out[i] = static_cast<Byte>(value >> (8 * (bytes - 1 - i)));
+        }
+    }
+
+    static uint64_t readBigEndian(const Byte* in, size_t bytes) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            value = (value << 8) | in[i];
+        }
+        return value;
+    }
+
+    std::atomic<uint32_t> next_sequence_{ 0 };
+    std::atomic<uint64_t> samples_{ 0 };
+    std::atomic<int64_t> last_ns_{ 0 };
+    std::atomic<int64_t> srtt_ns_{ 0 };
+    std::atomic<int64_t> rttvar_ns_{ 0 };
+    std::atomic<int64_t> min_ns_{ 0 };
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_RTT_ESTIMATOR_HPP
@@ -65,6 +65,7 @@ public:
 
     // Configuration
     void setMaxSessions(size_t maxSessions);
+    void reserve(size_t expectedSessions); // Pre-size session tables so ramp-up does not rehash
     void setSessionTimeout(uint32_t timeoutMs);
     void enableSessionPing(bool enable);
 
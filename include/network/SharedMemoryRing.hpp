@@ -0,0 +1,536 @@
+#pragma once
+#ifndef WEBSOCKET_SHARED_MEMORY_RING_HPP
+#define WEBSOCKET_SHARED_MEMORY_RING_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class SharedMemoryRing
+ * @brief Single-producer, single-consumer record ring in shared memory
+ *
+ * Records are written in place: the producer reserves space, fills the
+ * payload directly in the mapping and publishes it; the consumer reads the
+ * payload where it lies and releases it. Nothing is copied in between.
+ *
+ * Layout: a control block (head, tail and the consumer's sleep flag on
+ * separate cache lines) followed by a power-of-two data area. Each record is
+ * a 16-byte header plus payload, padded to 16 bytes; a record never wraps,
+ * a padding record fills the tail end instead. Positions only grow, so
+ * tail - head is the bytes in use.
+ *
+ * The ring holds no pointers and needs only address-free atomics, so both
+ * processes may map it at different addresses.
+ */
+class SharedMemoryRing {
+public:
+    /**
+     * @brief Record types carried between server and workers
+     */
+    enum class RecordType : uint8_t {
+        PADDING = 0,    ///< Filler up to the end of the data area
+        CONNECT,        ///< Client connected (server -> worker)
+        DISCONNECT,     ///< Client disconnected (server -> worker)
+        MESSAGE,        ///< Inbound message (server -> worker)
+        SEND,           ///< Outbound message (worker -> server)
+        CLOSE           ///< Close a client, code in the header (worker -> server)
+    };
+
+    static constexpr uint8_t FLAG_TEXT = 0x01;     ///< Message is TEXT, not BINARY
+
+    /**
+     * @brief Record as seen by the consumer
+     *
+     * @note data points into shared memory and is valid until release()
+     */
+    struct Record {
+        RecordType type{ RecordType::PADDING };
+        uint8_t flags{ 0 };
+        uint16_t code{ 0 };         ///< Close code for CLOSE records
+        ClientID client{ 0 };
+        const uint8_t* data{ nullptr };
+        size_t size{ 0 };
+    };
+
+    static constexpr size_t RECORD_HEADER_SIZE = 16;
+    static constexpr size_t RECORD_ALIGNMENT = 16;
+
+    /**
+     * @brief Memory needed for a ring with the given data capacity
+     * @param capacity Data area size (power of two, at least 4096)
+     * @return Bytes to map
+     */
+    static constexpr size_t requiredSize(size_t capacity) {
+        return sizeof(Control) + capacity;
+    }
+
+    /**
+     * @brief Initialise a ring in fresh memory
+     * @param memory Mapping of requiredSize(capacity) bytes
+     * @param capacity Data area size (power of two, at least 4096)
+     */
+    static void initialize(void* memory, size_t capacity) {
+        auto* control = new (memory) Control();
+        control->capacity = capacity;
+        control->magic = MAGIC;
+    }
+
+    /**
+     * @brief Attach to an initialised ring
+     * @param memory Start of the ring's mapping
+     */
+    explicit SharedMemoryRing(void* memory)
+        : control_(static_cast<Control*>(memory)),
+        data_(static_cast<uint8_t*>(memory) + sizeof(Control)),
+        capacity_(control_->capacity), mask_(capacity_ - 1) {
+    }
+
+    /**
+     * @brief Check the ring was initialised by initialize()
+     * @return true if the magic value and capacity are sane
+     */
+    bool isValid() const {
+        return control_->magic == MAGIC && capacity_ >= 4096 && (capacity_ & mask_) == 0;
+    }
+
+    /**
+     * @brief Largest payload a single record can carry
+     * @return Payload limit in bytes
+     */
+    size_t maxPayloadSize() const {
+        return capacity_ / 4 - RECORD_HEADER_SIZE;
+    }
+
+    // ===== PRODUCER =====
+
+    /**
+     * @brief Reserve a record and return its payload area
+     * @param type Record type
+     * @param client Client the record concerns
+     * @param size Payload size
+     * @param flags Record flags
+     * @param code Close code (CLOSE records)
+     * @return Payload area to fill, or nullptr if the ring is full or size exceeds maxPayloadSize()
+     *
+     * @note Nothing is visible to the consumer until publish()
+     */
+    uint8_t* reserve(RecordType type, ClientID client, size_t size, uint8_t flags = 0, uint16_t code = 0) {
+        if (size > maxPayloadSize()) {
+            return nullptr;
+        }
+        const size_t total = alignUp(RECORD_HEADER_SIZE + size);
+        const uint64_t head = control_->head.load(std::memory_order_acquire);
+        uint64_t tail = pending_tail_ = control_->tail.load(std::memory_order_relaxed);
+
+        const size_t offset = static_cast<size_t>(tail & mask_);
+        const size_t padding = offset + total > capacity_ ? capacity_ - offset : 0;
+        if (capacity_ - (tail - head) < padding + total) {
+            return nullptr;
+        }
+        if (padding > 0) {
+            writeHeader(offset, RecordType::PADDING, 0, 0, 0, static_cast<uint32_t>(padding - RECORD_HEADER_SIZE));
+            tail += padding;
+        }
+
+        uint8_t* header = writeHeader(static_cast<size_t>(tail & mask_), type, flags, code, client, static_cast<uint32_t>(size));
+        pending_tail_ = tail + total;
+        return header + RECORD_HEADER_SIZE;
+    }
+
+    /**
+     * @brief Make the last reserved record visible
+     * @return true if the consumer is asleep and needs a wake-up
+     */
+    bool publish() {
+        control_->tail.store(pending_tail_, std::memory_order_release);
+        // Pairs with the fence in prepareWait(): either we see the flag or it sees the record
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return control_->consumer_waiting.load(std::memory_order_relaxed) != 0;
+    }
+
+    /**
+     * @brief Bytes free for new records
+     * @return Free bytes (ignoring padding at the wrap point)
+     */
+    size_t freeSpace() const {
+        return capacity_ - static_cast<size_t>(control_->tail.load(std::memory_order_relaxed) -
+            control_->head.load(std::memory_order_acquire));
+    }
+
+    // ===== CONSUMER =====
+
+    /**
+     * @brief Look at the next record without consuming it
+     * @param record Filled with a view of the record
+     * @return false if the ring is empty
+     */
+    bool peek(Record& record) {
+        uint64_t head = control_->head.load(std::memory_order_relaxed);
+        for (;;) {
+            if (head == control_->tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            const uint8_t* header = data_ + (head & mask_);
+            uint32_t size;
+            std::memcpy(&size, header, 4);
+            const auto type = static_cast<RecordType>(header[4]);
+            // The peer may be buggy or dying; never trust a size that leaves the data area
+            if ((head & mask_) + RECORD_HEADER_SIZE + size > capacity_ ||
+                (type != RecordType::PADDING && size > maxPayloadSize())) {
+                corrupted_ = true;
+                return false;
+            }
+            if (type == RecordType::PADDING) {
+                head += RECORD_HEADER_SIZE + size;
+                control_->head.store(head, std::memory_order_release);
+                continue;
+            }
+            record.type = type;
+            record.flags = header[5];
+            std::memcpy(&record.code, header + 6, 2);
+            uint64_t client;
+            std::memcpy(&client, header + 8, 8);
+            record.client = static_cast<ClientID>(client);
+            record.data = header + RECORD_HEADER_SIZE;
+            record.size = size;
+            peeked_size_ = alignUp(RECORD_HEADER_SIZE + size);
+            return true;
+        }
+    }
+
+    /**
+     * @brief Check for unconsumed records (consumer side)
+     * @return true if nothing is waiting
+     */
+    bool empty() const {
+        return control_->head.load(std::memory_order_relaxed) == control_->tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Check if peek() found a malformed record
+     * @return true if the ring must be discarded
+     */
+    bool isCorrupted() const { return corrupted_; }
+
+    /**
+     * @brief Consume the record returned by the last peek()
+     */
+    void release() {
+        control_->head.store(control_->head.load(std::memory_order_relaxed) + peeked_size_, std::memory_order_release);
+        peeked_size_ = 0;
+    }
+
+    /**
+     * @brief Announce that the consumer is about to sleep
+     * @return false if records arrived meanwhile (do not sleep)
+     */
+    bool prepareWait() {
+        control_->consumer_waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (control_->head.load(std::memory_order_relaxed) != control_->tail.load(std::memory_order_acquire)) {
+            control_->consumer_waiting.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Clear the sleep flag after waking
+     */
+    void finishWait() {
+        control_->consumer_waiting.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr uint32_t MAGIC = 0x52575343; // "CSWR"
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring needs address-free 64-bit atomics");
+
+    struct Control {
+        alignas(64) std::atomic<uint64_t> head{ 0 };            ///< Consumer position
+        alignas(64) std::atomic<uint64_t> tail{ 0 };            ///< Producer position
+        alignas(64) std::atomic<uint32_t> consumer_waiting{ 0 };///< Consumer sleeps on its eventfd
+        uint32_t magic{ 0 };
+        uint64_t capacity{ 0 };
+    };
+
+    static constexpr size_t alignUp(size_t size) {
+        return (size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+    }
+
+    uint8_t* writeHeader(size_t offset, RecordType type, uint8_t flags, uint16_t code, ClientID client, uint32_t size) {
+        uint8_t* header = data_ + offset;
+        std::memcpy(header, &size, 4);
+        header[4] = static_cast<uint8_t>(type);
+        header[5] = flags;
+        std::memcpy(header + 6, &code, 2);
+        const uint64_t id = client;
+        std::memcpy(header + 8, &id, 8);
+        return header;
+    }
+
+    Control* control_;
+    uint8_t* data_;
+    size_t capacity_;
+    size_t mask_;
+    uint64_t pending_tail_{ 0 };    ///< Producer-local
+    size_t peeked_size_{ 0 };       ///< Consumer-local
+    bool corrupted_{ false };       ///< Consumer-local
+};
+
+/**
+ * @class SharedMemoryChannel
+ * @brief Two SharedMemoryRings in one memfd, with eventfd wake-ups
+ *
+ * One ring carries records from the server to a worker process, the other
+ * back. Each direction has an eventfd the consumer sleeps on; producers only
+ * write to it when the consumer announced it is sleeping, so a busy pair
+ * exchanges records without system calls.
+ *
+ * The server creates the channel and passes the three descriptors to the
+ * worker (see WorkerHost), which attaches with the same capacity.
+ */
+class SharedMemoryChannel : public NonCopyable {
+public:
+    /**
+     * @brief Which end of the channel this process is
+     */
+    enum class Side {
+        SERVER,     ///< Sends to the worker, receives from it
+        WORKER      ///< Sends to the server, receives from it
+    };
+
+    /**
+     * @brief Create a channel
+     * @param ring_capacity Data bytes per direction (rounded up to a power of two)
+     * @param error Set on failure
+     * @return Server side of the channel, or nullptr
+     */
+    static std::unique_ptr<SharedMemoryChannel> create(size_t ring_capacity, std::string& error) {
+        size_t capacity = 4096;
+        while (capacity < ring_capacity) {
+            capacity <<= 1;
+        }
+
+        const int memfd = memfd_create("cppws-worker", MFD_CLOEXEC);
+        if (memfd < 0) {
+            error = std::string("memfd_create: ") + std::strerror(errno);
+            return nullptr;
+        }
+        const int to_worker = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        const int to_server = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (to_worker < 0 || to_server < 0 ||
+            ftruncate(memfd, static_cast<off_t>(2 * SharedMemoryRing::requiredSize(capacity))) != 0) {
+            error = std::string("channel setup: ") + std::strerror(errno);
+            closeAll({ memfd, to_worker, to_server });
+            return nullptr;
+        }
+
+        auto channel = map(Side::SERVER, memfd, to_worker, to_server, capacity, error);
+        if (channel) {
+            SharedMemoryRing::initialize(channel->ringMemory(0), capacity);
+            SharedMemoryRing::initialize(channel->ringMemory(1), capacity);
+            channel->attachRings();
+        }
+        return channel;
+    }
+
+    /**
+     * @brief Attach to a channel created by the server
+     * @param memfd Shared memory descriptor
+     * @param to_worker_event Eventfd signalled when the worker has records
+     * @param to_server_event Eventfd signalled when the server has records
+     * @param ring_capacity Capacity the server used
+     * @param error Set on failure
+     * @return Worker side of the channel, or nullptr
+     */
+    static std::unique_ptr<SharedMemoryChannel> attach(int memfd, int to_worker_event, int to_server_event,
+        size_t ring_capacity, std::string& error) {
+        auto channel = map(Side::WORKER, memfd, to_worker_event, to_server_event, ring_capacity, error);
+        if (channel) {
+            channel->attachRings();
+            if (!channel->send_->isValid() || !channel->receive_->isValid()) {
+                error = "shared memory does not hold an initialised channel";
+                return nullptr;
+            }
+        }
+        return channel;
+    }
+
+    ~SharedMemoryChannel() {
+        if (memory_ != MAP_FAILED) {
+            munmap(memory_, size_);
+        }
+        closeAll({ memfd_, to_worker_, to_server_ });
+    }
+
+    /**
+     * @brief Ring this side produces into
+     */
+    SharedMemoryRing& send() { return *send_; }
+
+    /**
+     * @brief Ring this side consumes from
+     */
+    SharedMemoryRing& receive() { return *receive_; }
+
+    /**
+     * @brief Publish the last reserved record and wake the peer if it sleeps
+     */
+    void publish() {
+        if (send_->publish()) {
+            const uint64_t one = 1;
+            ssize_t written = ::write(peerEvent(), &one, sizeof(one));
+            (void)written; // EAGAIN means a wake-up is already pending
+        }
+    }
+
+    /**
+     * @brief Sleep until records arrive on the receive ring
+     * @param timeout_ms Poll timeout (-1 = forever)
+     * @param spin Time to poll the ring before sleeping
+     * @return true if records may be available
+     *
+     * @note A short spin catches the next record of a busy peer without
+     *       a sleep/wake-up pair of system calls on either side
+     */
+    bool wait(int timeout_ms, std::chrono::microseconds spin = std::chrono::microseconds(20)) {
+        if (spinUntilReady(spin)) {
+            return true;
+        }
+        if (!receive_->prepareWait()) {
+            return true;
+        }
+        pollfd pfd{ ownEvent(), POLLIN, 0 };
+        const int ready = ::poll(&pfd, 1, timeout_ms);
+        receive_->finishWait();
+        drainEvent();
+        return ready > 0;
+    }
+
+    /**
+     * @brief Poll the receive ring for a bounded time
+     * @param spin Time to poll
+     * @return true if records arrived
+     */
+    bool spinUntilReady(std::chrono::microseconds spin) {
+        if (!receive_->empty()) {
+            return true;
+        }
+        if (spin.count() <= 0 || !spinningHelps()) {
+            return false;
+        }
+        const auto deadline = std::chrono::steady_clock::now() + spin;
+        do {
+            for (int i = 0; i < 64; ++i) {
+                if (!receive_->empty()) {
+                    return true;
+                }
+            }
+        } while (std::chrono::steady_clock::now() < deadline);
+        return false;
+    }
+
+    /**
+     * @brief Check if spinning can pay off on this machine
+     * @return false on a single CPU, where a spinning consumer only delays its producer
+     */
+    static bool spinningHelps() {
+        static const bool helps = std::thread::hardware_concurrency() > 1;
+        return helps;
+    }
+
+    /**
+     * @brief Clear pending wake-ups (after an external poll/epoll on eventFd())
+     */
+    void drainEvent() {
+        uint64_t count;
+        while (::read(ownEvent(), &count, sizeof(count)) > 0) {
+        }
+    }
+
+    /**
+     * @brief Descriptor this side sleeps on, for integration into a poll loop
+     */
+    int eventFd() const { return ownEvent(); }
+
+    int memoryFd() const { return memfd_; }
+    int toWorkerEventFd() const { return to_worker_; }
+    int toServerEventFd() const { return to_server_; }
+    size_t ringCapacity() const { return capacity_; }
+
+private:
+    SharedMemoryChannel(Side side, int memfd, int to_worker, int to_server, size_t capacity)
+        : side_(side), memfd_(memfd), to_worker_(to_worker), to_server_(to_server), capacity_(capacity),
+        size_(2 * SharedMemoryRing::requiredSize(capacity)) {
+    }
+
+    static std::unique_ptr<SharedMemoryChannel> map(Side side, int memfd, int to_worker, int to_server,
+        size_t capacity, std::string& error) {
+        std::unique_ptr<SharedMemoryChannel> channel(new SharedMemoryChannel(side, memfd, to_worker, to_server, capacity));
+        channel->memory_ = mmap(nullptr, channel->size_, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+        if (channel->memory_ == MAP_FAILED) {
+            error = std::string("mmap: ") + std::strerror(errno);
+            return nullptr;
+        }
+        return channel;
+    }
+
+    void* ringMemory(int index) const {
+        return static_cast<uint8_t*>(memory_) + index * SharedMemoryRing::requiredSize(capacity_);
+    }
+
+    void attachRings() {
+        // Ring 0 runs server -> worker, ring 1 worker -> server
+        auto to_worker = std::make_unique<SharedMemoryRing>(ringMemory(0));
+        auto to_server = std::make_unique<SharedMemoryRing>(ringMemory(1));
+        if (side_ == Side::SERVER) {
+            send_ = std::move(to_worker);
+            receive_ = std::move(to_server);
+        }
+        else {
+            send_ = std::move(to_server);
+            receive_ = std::move(to_worker);
+        }
+    }
+
+    int ownEvent() const { return side_ == Side::SERVER ? to_server_ : to_worker_; }
+    int peerEvent() const { return side_ == Side::SERVER ? to_worker_ : to_server_; }
+
+    static void closeAll(std::initializer_list<int> fds) {
+        for (int fd : fds) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+
+    Side side_;
+    int memfd_;
+    int to_worker_;
+    int to_server_;
+    size_t capacity_;
+    size_t size_;
+    void* memory_{ MAP_FAILED };
+    std::unique_ptr<SharedMemoryRing> send_;
+    std::unique_ptr<SharedMemoryRing> receive_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_SHARED_MEMORY_RING_HPP
@@ -0,0 +1,69 @@
+#pragma once
+#ifndef WEBSOCKET_TRANSPORT_HPP
+#define WEBSOCKET_TRANSPORT_HPP
+
+#include "../common/Types.hpp"
+#include "../common/Macros.hpp"
+#include "EndPoint.hpp"
+#include <functional>
+#include <vector>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class Transport
+ * @brief Byte-stream transport underneath WebSocketConnection
+ *
+ * WebSocketConnection talks to its peer through this interface when it is
+ * constructed with a transport instead of an io_context. Implementations
+ * must deliver bytes in order and report the peer closing, like a TCP
+ * stream; message boundaries are not preserved.
+ *
+ * Implementations:
+ * - ASIO TCP socket (default, used when constructed from an io_context)
+ * - InMemoryTransport (simulation and benchmarking, see InMemoryTransport.hpp)
+ */
+class Transport {
+    WEBSOCKET_INTERFACE(Transport)
+
+public:
+    using ReceiveHandler = std::function<void(const Buffer&)>;
+    using CloseHandler = std::function<void()>;
+
+    /**
+     * @brief Start delivering received data
+     * @param on_data Called with each received chunk
+     * @param on_close Called once when the peer closes or the stream fails
+     */
+    virtual void startReading(ReceiveHandler on_data, CloseHandler on_close) = 0;
+
+    /**
+     * @brief Write buffers as one gathered write
+     * @param buffers Buffers to send, in order
+     * @return true if the write was accepted
+     */
+    virtual bool write(std::vector<Buffer> buffers) = 0;
+
+    /**
+     * @brief Close the stream
+     *
+     * @note Data already accepted by write() is still delivered to the peer
+     */
+    virtual void close() = 0;
+
+    /**
+     * @brief Check if the stream is open
+     * @return true if writes are accepted
+     */
+    virtual bool isOpen() const = 0;
+
+    /**
+     * @brief Get remote endpoint
+     * @return Peer address
+     */
+    virtual Endpoint getRemoteEndpoint() const = 0;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_TRANSPORT_HPP
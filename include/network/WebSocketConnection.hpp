@@ -4,7 +4,8 @@
 
 #include "../common/Types.hpp"
 #include "../common/NonCopyable.hpp"
-#include "Endpoint.hpp"
+#include "EndPoint.hpp"
+#include "Transport.hpp"
 #include <memory>
 #include <atomic>
 
@@ -52,6 +53,15 @@ WEBSOCKET_NAMESPACE_BEGIN
          * @param io_context ASIO I/O context
          */
         explicit WebSocketConnection(asio::io_context& io_context);
+
+        /**
+         * @brief Construct a connection over a custom transport
+         * @param transport Byte-stream transport (e.g. InMemoryTransport)
+         *
+         * @note Reads, writes and close go through the transport; getSocket()
+         *       and migrateTo() are not available on such connections
+         */
+        explicit WebSocketConnection(std::unique_ptr<Transport> transport);
         ~WebSocketConnection();
 
         /**
@@ -85,6 +95,23 @@ WEBSOCKET_NAMESPACE_BEGIN
          */
         bool send(const std::string& data);
 
+        /**
+         * @brief Queue data without starting a write
+         * @param data Data to send
+         * @return true if data queued
+         *
+         * @note Data is written with the next flush() or send(), in a single
+         *       gathered write together with anything already queued
+         */
+        bool sendDeferred(const Buffer& data);
+
+        /**
+         * @brief Start writing all queued data
+         *
+         * @note No-op if the queue is empty or a write is already in flight
+         */
+        void flush();
+
         /**
          * @brief Get connection endpoint
          * @return Remote endpoint information
@@ -121,6 +148,17 @@ WEBSOCKET_NAMESPACE_BEGIN
          */
         void setCloseCallback(std::function<void()> callback);
 
+        /**
+         * @brief Move the connection to another I/O thread
+         * @param target io_context of the destination thread
+         * @return true if the socket was re-registered with target
+         *
+         * @note Must be called on the owning thread. Pending reads are
+         *       cancelled and restarted on the target; queued writes move with
+         *       the connection.
+         */
+        bool migrateTo(asio::io_context& target);
+
         /**
          * @brief Reset connection for reuse (when returning to pool)
          */
@@ -159,8 +197,9 @@ WEBSOCKET_NAMESPACE_BEGIN
         void closeWithError(const asio::error_code& error);
 
         // Member variables
-        asio::io_context& io_context_;
+        asio::io_context* io_context_;   ///< Owning I/O context (changes on migration)
         std::unique_ptr<Socket> socket_;
+        std::unique_ptr<Transport> transport_;   ///< Set instead of socket_ for custom transports
         std::atomic<State> state_{ State::DISCONNECTED };
 
         // I/O buffers
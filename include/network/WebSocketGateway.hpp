@@ -0,0 +1,637 @@
+#pragma once
+#ifndef WEBSOCKET_GATEWAY_HPP
+#define WEBSOCKET_GATEWAY_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include "../protocol/FrameRelay.hpp"
+#include "EndPoint.hpp"
+#include "Transport.hpp"
+#include "WebSocketConnection.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class WebSocketGateway
+ * @brief Reverse-proxy mode: relays upgraded sessions to upstream WebSocket servers
+ *
+ * WebSocketServer consults the gateway before creating a local session. When
+ * the request path or one of the requested subprotocols matches a route, the
+ * raw client connection is handed over:
+ *
+ * 1. An upstream stream is taken from the route's warm pool (or connected)
+ * 2. The client's upgrade request is forwarded with Host rewritten and
+ *    X-Forwarded-For added; Sec-WebSocket-Key is untouched, so the upstream's
+ *    101 response (accept key, subprotocol, extensions) is relayed verbatim
+ * 3. Frames are then relayed in both directions by FrameRelay, header by
+ *    header, without reassembly or a parse/serialise cycle
+ *
+ * Either side closing closes the other after its queued data is delivered.
+ * Upstream streams are produced by the connector, so the gateway works over
+ * TCP, TLS or InMemoryTransport alike.
+ */
+class WebSocketGateway : public NonCopyable {
+public:
+    using TransportPtr = std::unique_ptr<Transport>;
+    using ConnectHandler = std::function<void(TransportPtr transport, const std::string& error)>;
+    using UpstreamConnector = std::function<void(const Endpoint& upstream, ConnectHandler handler)>;
+
+    /**
+     * @brief Routing rule
+     *
+     * A route matches when the request path starts with path_prefix (empty
+     * matches any path) and, if subprotocol is set, the client offered it.
+     * The longest matching prefix wins; subprotocol routes win ties.
+     */
+    struct Route {
+        std::string name;                   ///< Route name (stats, logs)
+        std::string path_prefix;            ///< Path prefix to match
+        std::string subprotocol;            ///< Required subprotocol (empty = any)
+        std::vector<Endpoint> upstreams;    ///< Upstream servers, used round-robin
+        bool remask{ false };               ///< Give client frames fresh masking keys
+    };
+
+    /**
+     * @brief Gateway configuration
+     */
+    struct Config {
+        size_t warm_connections_per_upstream{ 2 };      ///< Idle upstream streams kept ready
+        size_t max_response_header_size{ 16384 };        ///< Upstream 101 response limit
+        uint64_t max_frame_size{ 16 * 1024 * 1024 };    ///< Relay frame size limit (0 = unlimited)
+    };
+
+    /**
+     * @brief Gateway statistics
+     */
+    struct Stats {
+        uint64_t routed{ 0 };               ///< Sessions handed to an upstream
+        uint64_t upstream_failures{ 0 };    ///< Connect or upgrade failures
+        uint64_t warm_hits{ 0 };            ///< Sessions that used a pre-warmed stream
+        uint64_t active{ 0 };               ///< Relays currently open
+        uint64_t frames_up{ 0 };            ///< Frames relayed client -> upstream
+        uint64_t frames_down{ 0 };          ///< Frames relayed upstream -> client
+        uint64_t bytes_up{ 0 };             ///< Payload bytes client -> upstream
+        uint64_t bytes_down{ 0 };           ///< Payload bytes upstream -> client
+    };
+
+    /**
+     * @brief Construct gateway
+     * @param connector Opens byte streams to upstream endpoints
+     * @param config Gateway configuration
+     */
+    WebSocketGateway(UpstreamConnector connector, const Config& config)
+        : connector_(std::move(connector)), config_(config),
+        state_(std::make_shared<SharedState>()) {
+    }
+
+    /**
+     * @brief Add a routing rule
+     * @param route Route (must name at least one upstream)
+     * @return false if the route has no upstreams
+     */
+    bool addRoute(const Route& route) {
+        if (route.upstreams.empty()) {
+            return false;
+        }
+        std::lock_guard lock(routes_mutex_);
+        routes_.push_back(std::make_unique<RouteEntry>(route));
+        return true;
+    }
+
+    /**
+     * @brief Find the route for an upgrade request
+     * @param path Request path
+     * @param subprotocols Subprotocols offered by the client
+     * @return Matching route, or nullptr to serve the session locally
+     */
+    const Route* match(const std::string& path, const std::vector<std::string>& subprotocols) const {
+        std::lock_guard lock(routes_mutex_);
+        const RouteEntry* best = matchEntry(path, subprotocols);
+        return best ? &best->route : nullptr;
+    }
+
+    /**
+     * @brief Relay a client connection to the route's upstream
+     * @param client Client connection (upgrade request read, no response sent)
+     * @param request Raw upgrade request including the blank line
+     * @param route Route returned by match() (matched by identity, not by name)
+     * @return false if the route is unknown
+     *
+     * @note On upstream failure the client receives 502 Bad Gateway
+     */
+    bool attach(std::shared_ptr<WebSocketConnection> client, const std::string& request, const Route& route) {
+        RouteEntry* entry = findEntry(route);
+        if (!entry) {
+            return false;
+        }
+        const Endpoint upstream = entry->route.upstreams[
+            entry->next.fetch_add(1, std::memory_order_relaxed) % entry->route.upstreams.size()];
+
+        auto relay = std::make_shared<Relay>(std::move(client), state_, config_, entry->route.remask);
+        relay->request = rewriteRequest(request, upstream, relay->client->getRemoteEndpoint());
+        relay->start();
+
+        {
+            std::lock_guard lock(state_->mutex);
+            state_->stats.routed++;
+        }
+        acquireUpstream(upstream, relay);
+        return true;
+    }
+
+    /**
+     * @brief Top up warm pools for every route's upstreams
+     *
+     * @note Called at start and periodically; connects happen asynchronously
+     */
+    void prewarm() {
+        std::vector<Endpoint> upstreams;
+        {
+            std::lock_guard lock(routes_mutex_);
+            for (const auto& entry : routes_) {
+                upstreams.insert(upstreams.end(), entry->route.upstreams.begin(), entry->route.upstreams.end());
+            }
+        }
+        for (const auto& upstream : upstreams) {
+            const std::string key = upstream.toString();
+            size_t missing = 0;
+            {
+                std::lock_guard lock(state_->mutex);
+                const size_t have = state_->warm[key].size() + state_->warming[key];
+                if (have < config_.warm_connections_per_upstream) {
+                    missing = config_.warm_connections_per_upstream - have;
+                }
+                state_->warming[key] += missing;
+            }
+            for (size_t i = 0; i < missing; ++i) {
+                std::weak_ptr<SharedState> weak = state_;
+                connector_(upstream, [weak, key](TransportPtr transport, const std::string&) {
+                    auto state = weak.lock();
+                    if (!state) {
+                        return;
+                    }
+                    std::lock_guard lock(state->mutex);
+                    state->warming[key]--;
+                    if (transport && transport->isOpen()) {
+                        state->warm[key].push_back(std::move(transport));
+                    }
+                });
+            }
+        }
+    }
+
+    /**
+     * @brief Get gateway statistics
+     * @return Statistics snapshot
+     */
+    Stats getStats() const {
+        std::lock_guard lock(state_->mutex);
+        return state_->stats;
+    }
+
+private:
+    struct RouteEntry {
+        explicit RouteEntry(const Route& r) : route(r) {}
+        Route route;
+        std::atomic<size_t> next{ 0 };
+    };
+
+    /// State shared with in-flight relays and connect callbacks
+    struct SharedState {
+        mutable std::mutex mutex;
+        Stats stats;
+        std::unordered_map<std::string, std::deque<TransportPtr>> warm;
+        std::unordered_map<std::string, size_t> warming;
+    };
+
+    /**
+     * @brief One relayed session
+     *
+     * Client callbacks arrive on the client's I/O thread, upstream callbacks
+     * on the transport's; the mutex serialises them. The relay owns itself
+     * from start() until it closes; callbacks hold it only weakly.
+     *
+     * Sends and closes can call straight back into the relay (a client close
+     * fires its close callback, which enters closeBoth()), so none of them run
+     * under the mutex: each entry point decides under the lock, queues the
+     * transport calls, and runs them with runActions() after unlocking.
+     */
+    struct Relay : std::enable_shared_from_this<Relay> {
+        enum class Phase { CONNECTING, UPGRADING, RELAYING, CLOSED };
+
+        Relay(std::shared_ptr<WebSocketConnection> c, std::shared_ptr<SharedState> s, const Config& config, bool remask)
+            : client(std::move(c)), state(std::move(s)),
+            max_response_header_size(config.max_response_header_size),
+            up(FrameRelay::Options{ remask, config.max_frame_size, FrameRelay::Masking::REQUIRED }),
+            down(FrameRelay::Options{ false, config.max_frame_size, FrameRelay::Masking::FORBIDDEN }) {
+        }
+
+        void start() {
+            self = shared_from_this();
+            std::weak_ptr<Relay> weak = self;
+            client->setReceiveCallback([weak](const Buffer& data) {
+                if (auto self = weak.lock()) {
+                    self->onClientData(data);
+                }
+            });
+            client->setCloseCallback([weak] {
+                if (auto self = weak.lock()) {
+                    self->closeBoth();
+                }
+            });
+        }
+
+        void onUpstream(TransportPtr transport) {
+            {
+                std::lock_guard lock(mutex);
+                if (phase == Phase::CLOSED) {
+                    std::shared_ptr<Transport> late(std::move(transport));
+                    actions.push_back([late] { late->close(); });
+                }
+                else {
+                    upstream = std::move(transport);
+                    phase = Phase::UPGRADING;
+                    if (!counted_active) {
+                        counted_active = true;
+                        std::lock_guard state_lock(state->mutex);
+                        state->stats.active++;
+                    }
+                    std::weak_ptr<Relay> weak = shared_from_this();
+                    actions.push_back([target = upstream.get(), weak, request = request] {
+                        target->startReading(
+                            [weak](const Buffer& data) {
+                                if (auto relay = weak.lock()) {
+                                    relay->onUpstreamData(data);
+                                }
+                            },
+                            [weak] {
+                                if (auto relay = weak.lock()) {
+                                    relay->onUpstreamClosed();
+                                }
+                            });
+                        target->write({ Buffer(request.begin(), request.end()) });
+                    });
+                }
+            }
+            runActions();
+        }
+
+        void onClientData(const Buffer& data) {
+            {
+                std::lock_guard lock(mutex);
+                if (phase == Phase::RELAYING) {
+                    relayUp(data.data(), data.size());
+                }
+                else if (phase != Phase::CLOSED) {
+                    // A client may pipeline frames behind its request
+                    pending_client.insert(pending_client.end(), data.begin(), data.end());
+                }
+            }
+            runActions();
+        }
+
+        void onUpstreamData(const Buffer& data) {
+            {
+                std::lock_guard lock(mutex);
+                upstreamDataLocked(data);
+            }
+            runActions();
+        }
+
+        void upstreamDataLocked(const Buffer& data) {
+            if (phase == Phase::RELAYING) {
+                relayDown(data.data(), data.size());
+                return;
+            }
+            if (phase != Phase::UPGRADING) {
+                return;
+            }
+
+            response.append(data.begin(), data.end());
+            const size_t end = response.find("\r\n\r\n");
+            if (end == std::string::npos) {
+                if (response.size() > max_response_header_size) {
+                    failLocked("upstream response header too large");
+                }
+                return;
+            }
+
+            const size_t header_size = end + 4;
+            const bool upgraded = response.compare(0, 12, "HTTP/1.1 101") == 0;
+            actions.push_back([connection = client, header = response.substr(0, header_size)] {
+                connection->send(header);
+            });
+            if (!upgraded) {
+                // Upstream refused (401, 403, 404...): pass its answer on and stop
+                countFailure();
+                closeLocked();
+                return;
+            }
+
+            phase = Phase::RELAYING;
+            if (response.size() > header_size) {
+                relayDown(reinterpret_cast<const uint8_t*>(response.data()) + header_size, response.size() - header_size);
+            }
+            response.clear();
+            response.shrink_to_fit();
+            if (!pending_client.empty()) {
+                Buffer pending;
+                pending.swap(pending_client);
+                relayUp(pending.data(), pending.size());
+            }
+        }
+
+        void onUpstreamClosed() {
+            std::function<void()> retry;
+            {
+                std::lock_guard lock(mutex);
+                if (phase == Phase::UPGRADING && response.empty() && reconnect) {
+                    // A warm stream the upstream had already dropped; try a fresh one
+                    retry = std::move(reconnect);
+                    reconnect = nullptr;
+                    retired = std::move(upstream);
+                    phase = Phase::CONNECTING;
+                }
+                else {
+                    if (phase == Phase::UPGRADING) {
+                        countFailure();
+                    }
+                    closeLocked();
+                }
+            }
+            runActions();
+            if (retry) {
+                retry();
+            }
+        }
+
+        void relayUp(const uint8_t* data, size_t size) {
+            out.clear();
+            const auto frames_before = up.getStats().frames;
+            const auto bytes_before = up.getStats().payload_bytes;
+            if (up.feed(data, size, out) != FrameRelay::Status::OK) {
+                closeLocked();
+                return;
+            }
+            if (!out.empty()) {
+                actions.push_back([target = upstream.get(), data = std::move(out)] { target->write({ data }); });
+            }
+            std::lock_guard lock(state->mutex);
+            state->stats.frames_up += up.getStats().frames - frames_before;
+            state->stats.bytes_up += up.getStats().payload_bytes - bytes_before;
+        }
+
+        void relayDown(const uint8_t* data, size_t size) {
+            out.clear();
+            const auto frames_before = down.getStats().frames;
+            const auto bytes_before = down.getStats().payload_bytes;
+            if (down.feed(data, size, out) != FrameRelay::Status::OK) {
+                closeLocked();
+                return;
+            }
+            if (!out.empty()) {
+                actions.push_back([connection = client, data = std::move(out)] { connection->send(data); });
+            }
+            std::lock_guard lock(state->mutex);
+            state->stats.frames_down += down.getStats().frames - frames_before;
+            state->stats.bytes_down += down.getStats().payload_bytes - bytes_before;
+        }
+
+        void fail(const std::string& reason) {
+            {
+                std::lock_guard lock(mutex);
+                failLocked(reason);
+            }
+            runActions();
+        }
+
+        void failLocked(const std::string& reason) {
+            if (phase == Phase::CLOSED) {
+                return;
+            }
+            countFailure();
+            actions.push_back([connection = client, response = "HTTP/1.1 502 Bad Gateway\r\nContent-Type: text/plain\r\n"
+                "Content-Length: " + std::to_string(reason.size()) + "\r\nConnection: close\r\n\r\n" + reason] {
+                connection->send(response);
+            });
+            closeLocked();
+        }
+
+        void countFailure() {
+            std::lock_guard lock(state->mutex);
+            state->stats.upstream_failures++;
+        }
+
+        void closeBoth() {
+            {
+                std::lock_guard lock(mutex);
+                closeLocked();
+            }
+            runActions();
+        }
+
+        void closeLocked() {
+            if (phase == Phase::CLOSED) {
+                return;
+            }
+            phase = Phase::CLOSED;
+            reconnect = nullptr;
+            self.reset(); // Callers hold their own reference for the rest of the call
+            actions.push_back([target = upstream.get(), connection = client] {
+                if (target) {
+                    target->close();
+                }
+                connection->close(true);
+            });
+            if (counted_active) {
+                counted_active = false;
+                std::lock_guard lock(state->mutex);
+                state->stats.active--;
+            }
+        }
+
+        /**
+         * @brief Run queued transport calls in the order they were decided
+         *
+         * Called without the lock at the end of every entry point. One thread
+         * runs the queue at a time, so writes to a peer keep their order even
+         * when both I/O threads produce them; a call that re-enters the relay
+         * queues behind the current batch instead of deadlocking.
+         */
+        void runActions() {
+            std::unique_lock lock(mutex);
+            if (running_actions) {
+                return;     // The running thread picks up what was just queued
+            }
+            running_actions = true;
+            while (!actions.empty()) {
+                std::vector<std::function<void()>> batch;
+                batch.swap(actions);
+                lock.unlock();
+                for (auto& call : batch) {
+                    call();
+                }
+                lock.lock();
+            }
+            running_actions = false;
+        }
+
+        std::shared_ptr<Relay> self;
+        std::shared_ptr<WebSocketConnection> client;
+        std::shared_ptr<SharedState> state;
+        size_t max_response_header_size;
+        std::mutex mutex;
+        Phase phase{ Phase::CONNECTING };
+        bool counted_active{ false };
+        std::function<void()> reconnect;    ///< Set while using a warm stream
+        std::string request;
+        std::string response;
+        Buffer pending_client;
+        Buffer out;
+        std::vector<std::function<void()>> actions;    ///< Transport calls waiting for the lock to be released
+        bool running_actions{ false };
+        TransportPtr upstream;
+        TransportPtr retired;               ///< Dead warm stream, kept until the relay ends
+        FrameRelay up;
+        FrameRelay down;
+    };
+
+    const RouteEntry* matchEntry(const std::string& path, const std::vector<std::string>& subprotocols) const {
+        const RouteEntry* best = nullptr;
+        for (const auto& entry : routes_) {
+            const Route& route = entry->route;
+            if (path.compare(0, route.path_prefix.size(), route.path_prefix) != 0) {
+                continue;
+            }
+            if (!route.subprotocol.empty() &&
+                std::find(subprotocols.begin(), subprotocols.end(), route.subprotocol) == subprotocols.end()) {
+                continue;
+            }
+            if (!best || route.path_prefix.size() > best->route.path_prefix.size() ||
+                (route.path_prefix.size() == best->route.path_prefix.size() &&
+                    !route.subprotocol.empty() && best->route.subprotocol.empty())) {
+                best = entry.get();
+            }
+        }
+        return best;
+    }
+
+    RouteEntry* findEntry(const Route& route) {
+        std::lock_guard lock(routes_mutex_);
+        for (auto& entry : routes_) {
+            if (&entry->route == &route) {   // names are optional and need not be unique
+                return entry.get();
+            }
+        }
+        return nullptr;
+    }
+
+    void acquireUpstream(const Endpoint& upstream, const std::shared_ptr<Relay>& relay) {
+        TransportPtr warm;
+        {
+            std::lock_guard lock(state_->mutex);
+            auto& pool = state_->warm[upstream.toString()];
+            while (!pool.empty() && !warm) {
+                warm = std::move(pool.front());
+                pool.pop_front();
+                if (!warm->isOpen()) {
+                    warm.reset();
+                }
+            }
+            if (warm) {
+                state_->stats.warm_hits++;
+            }
+        }
+
+        if (warm) {
+            {
+                std::lock_guard lock(relay->mutex);
+                relay->reconnect = [connector = connector_, upstream, relay] {
+                    connectFresh(connector, upstream, relay);
+                };
+            }
+            relay->onUpstream(std::move(warm));
+            prewarm();
+            return;
+        }
+        connectFresh(connector_, upstream, relay);
+    }
+
+    static void connectFresh(const UpstreamConnector& connector, const Endpoint& upstream,
+        const std::shared_ptr<Relay>& relay) {
+        connector(upstream, [relay](TransportPtr transport, const std::string& error) {
+            if (!transport) {
+                relay->fail(error.empty() ? "upstream unavailable" : error);
+                return;
+            }
+            relay->onUpstream(std::move(transport));
+        });
+    }
+
+    static std::string rewriteRequest(const std::string& request, const Endpoint& upstream, const Endpoint& client) {
+        std::string rewritten;
+        rewritten.reserve(request.size() + 64);
+        size_t pos = 0;
+        bool forwarded = false;
+        while (pos < request.size()) {
+            size_t end = request.find("\r\n", pos);
+            if (end == std::string::npos) {
+                end = request.size();
+            }
+            const std::string line = request.substr(pos, end - pos);
+            pos = end + 2;
+            if (line.empty()) {
+                break;
+            }
+            const std::string name = line.substr(0, line.find(':'));
+            if (equalsIgnoreCase(name, "Host")) {
+                rewritten += "Host: " + upstream.toString() + "\r\n";
+            }
+            else if (equalsIgnoreCase(name, "X-Forwarded-For")) {
+                rewritten += line + ", " + client.getAddress() + "\r\n";
+                forwarded = true;
+            }
+            else {
+                rewritten += line + "\r\n";
+            }
+        }
+        if (!forwarded) {
+            rewritten += "X-Forwarded-For: " + client.getAddress() + "\r\n";
+        }
+        rewritten += "\r\n";
+        return rewritten;
+    }
+
+    static bool equalsIgnoreCase(const std::string& a, const char* b) {
+        const size_t length = std::char_traits<char>::length(b);
+        if (a.size() != length) {
+            return false;
+        }
+        for (size_t i = 0; i < length; ++i) {
+            if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    UpstreamConnector connector_;
+    Config config_;
+    std::shared_ptr<SharedState> state_;
+    mutable std::mutex routes_mutex_;
+    std::vector<std::unique_ptr<RouteEntry>> routes_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_GATEWAY_HPP
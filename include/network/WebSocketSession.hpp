@@ -5,6 +5,10 @@
 #include "../common/Types.hpp"
 #include "../protocol/WebSocketFrame.hpp"
 #include "../protocol/WebSocketMessage.hpp"
+#include "../protocol/MessageBatcher.hpp"
+#include "../protocol/ExtensionPipeline.hpp"
+#include "../protocol/CompressionPolicy.hpp"
+#include "RttEstimator.hpp"
 #include <memory>
 #include <atomic>
 #include <string>
@@ -22,7 +26,7 @@ class SessionManager;
  * Handles:
  * - Session lifecycle (connecting, connected, closing, closed)
  * - Message fragmentation and reassembly
- * - Ping/Pong heartbeat mechanism
+ * - Ping/Pong heartbeat mechanism and RTT measurement
  * - Session-specific data and metadata
  */
 class WebSocketSession : public std::enable_shared_from_this<WebSocketSession> {
@@ -84,6 +88,74 @@ public:
      */
     bool sendPing(const Buffer& data = {});
 
+    /**
+     * @brief Send a ping carrying an RTT probe
+     * @return true if ping sent successfully
+     *
+     * @note The matching pong updates the session RTT estimate. Heartbeat
+     *       pings use this instead of empty pings.
+     */
+    bool sendLatencyProbe();
+
+    /**
+     * @brief Queue an RTT probe ping without flushing
+     * @return true if ping queued
+     *
+     * @note Called by the HeartbeatScheduler for each session in a batch;
+     *       the scheduler flushes the whole batch once per tick
+     */
+    bool queueHeartbeat();
+
+    /**
+     * @brief Flush writes queued on the underlying connection
+     *
+     * @note With batching enabled, first emits the messages batched since
+     *       the last flush as one frame
+     */
+    void flushWrites();
+
+    /**
+     * @brief Switch to the batching subprotocol
+     * @param config Batch size limit
+     *
+     * @note Call once MessageBatcher::negotiate() accepted it. From then on
+     *       sendText()/sendBinary() append to a batch sent by flushWrites()
+     *       (or early, once max_batch_bytes is reached), and inbound data
+     *       frames are split into their messages before delivery.
+     */
+    void enableBatching(const MessageBatcher::Config& config = MessageBatcher::Config{});
+
+    /**
+     * @brief Check if the batching subprotocol is in use
+     */
+    bool isBatching() const { return batcher_ != nullptr; }
+
+    /**
+     * @brief Install the extensions negotiated at handshake
+     * @param extensions Pipeline from ExtensionPipeline::negotiate()
+     *
+     * @note Outbound data messages pass through the pipeline before framing
+     *       and take its RSV bits; inbound messages pass back through it
+     *       before delivery. Unclaimed RSV bits close the session with 1002,
+     *       a rejected payload with 1007.
+     */
+    void setExtensions(ExtensionPipeline extensions);
+
+    /**
+     * @brief Consult a compression policy before compressing outbound messages
+     * @param policy Server-wide policy (nullptr to compress every message)
+     *
+     * @note The session keeps its own ratio state and reports each
+     *       compression back to the policy
+     */
+    void setCompressionPolicy(CompressionPolicy* policy) { compression_policy_ = policy; }
+
+    /**
+     * @brief Get round-trip time estimates measured via ping/pong
+     * @return RTT snapshot (samples == 0 if no probe has been answered yet)
+     */
+    RttEstimator::Snapshot getRttStats() const;
+
     /**
      * @brief Handle incoming WebSocket frame
      * @param frame Parsed WebSocket frame
@@ -150,6 +222,9 @@ private:
     /**
      * @brief Handle pong frame
      * @param frame Received pong frame
+     *
+     * @note Pongs carrying an RTT probe feed the session estimator and the
+     *       server-wide "websocket_ping_rtt_us" histogram.
      */
     void handlePongFrame(const WebSocketFrame& frame);
 
@@ -160,16 +235,6 @@ private:
      */
     bool sendFrame(const WebSocketFrame& frame);
 
-    /**
-     * @brief Start ping timer for heartbeat
-     */
-    void startPingTimer();
-
-    /**
-     * @brief Handle ping timeout
-     */
-    void onPingTimeout();
-
     // Member variables
     ClientID session_id_;
     std::shared_ptr<WebSocketConnection> connection_;
@@ -184,9 +249,21 @@ private:
     std::unordered_map<std::string, std::string> user_data_;
     SessionStats stats_;
 
-    // Timers and timeouts
+    // Activity tracking (heartbeats are driven by the I/O thread's HeartbeatScheduler)
     std::chrono::steady_clock::time_point last_activity_;
-    std::unique_ptr<asio::steady_timer> ping_timer_;
+
+    // Round-trip time measurement
+    RttEstimator rtt_estimator_;
+
+    // Batching subprotocol (null when not negotiated)
+    std::unique_ptr<MessageBatcher> batcher_;
+
+    // Negotiated extensions (empty = none)
+    ExtensionPipeline extensions_;
+
+    // Per-message compression decisions (null = compress everything)
+    CompressionPolicy* compression_policy_{ nullptr };
+    CompressionPolicy::SessionState compression_state_;
 };
 
 WEBSOCKET_NAMESPACE_END
@@ -0,0 +1,438 @@
+#pragma once
+#ifndef WEBSOCKET_BINARY_CODEC_HPP
+#define WEBSOCKET_BINARY_CODEC_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Declare a struct as a typed binary message
+ * @param Id Message id (uint16_t) written in the header
+ * @param ... Fields in wire order
+ *
+ * Placed inside the struct body:
+ *
+ * struct ChatPost {
+ *     uint32_t room;
+ *     uint64_t sent_at;
+ *     std::string_view text;
+ *     WEBSOCKET_MESSAGE(7, room, sent_at, text)
+ * };
+ */
+#define WEBSOCKET_MESSAGE(Id, ...) \
+    static constexpr uint16_t MESSAGE_ID = (Id); \
+    template<typename Visitor> void visitFields(Visitor&& visitor) { visitor(__VA_ARGS__); } \
+    template<typename Visitor> void visitFields(Visitor&& visitor) const { visitor(__VA_ARGS__); }
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class BinaryCodec
+ * @brief Encoding and decoding of WEBSOCKET_MESSAGE structs
+ *
+ * Wire format:
+ *   u16 message id (little-endian)
+ *   fixed block:    every integer, floating-point, bool and enum field in
+ *                   declaration order, little-endian, at offsets fixed by
+ *                   the struct definition
+ *   variable block: every std::string_view, std::string, std::span<const
+ *                   uint8_t> and Buffer field in declaration order, as a
+ *                   varint length followed by the bytes
+ *
+ * Decoding std::string_view and span fields points them into the payload
+ * (no copy, no allocation); they are valid as long as the payload is.
+ * std::string and Buffer fields copy. A payload that is truncated, has
+ * bytes left over or carries a different id fails to decode.
+ */
+class BinaryCodec {
+public:
+    static constexpr size_t HEADER_SIZE = 2;        ///< Message id
+    static constexpr size_t MAX_VARINT_SIZE = 10;
+
+    /**
+     * @brief Read the message id from a payload
+     * @return Id, or nullopt if the payload is shorter than the header
+     */
+    static std::optional<uint16_t> peekId(const uint8_t* data, size_t size) {
+        if (size < HEADER_SIZE) {
+            return std::nullopt;
+        }
+        return load<uint16_t>(data);
+    }
+
+    /**
+     * @brief Exact encoded size of a message
+     */
+    template<typename T>
+    static size_t encodedSize(const T& message) {
+        size_t size = HEADER_SIZE;
+        message.visitFields([&](const auto&... fields) {
+            ((size += fieldSize(fields)), ...);
+        });
+        return size;
+    }
+
+    /**
+     * @brief Encode a message into caller-provided memory
+     * @param message Message
+     * @param out At least encodedSize(message) bytes
+     * @return Bytes written
+     */
+    template<typename T>
+    static size_t encodeInto(const T& message, uint8_t* out) {
+        uint8_t* p = out;
+        store<uint16_t>(p, T::MESSAGE_ID);
+        p += HEADER_SIZE;
+        message.visitFields([&](const auto&... fields) {
+            (writeFixed(fields, p), ...);
+            (writeVariable(fields, p), ...);
+        });
+        return static_cast<size_t>(p - out);
+    }
+
+    /**
+     * @brief Encode a message into a new buffer
+     */
+    template<typename T>
+    static Buffer encode(const T& message) {
+        Buffer out(encodedSize(message));
+        encodeInto(message, out.data());
+        return out;
+    }
+
+    /**
+     * @brief Decode a message
+     * @param data Payload including the header
+     * @param size Payload size
+     * @param out Decoded message; views refer into data
+     * @return false if the id does not match or the payload is malformed
+     */
+    template<typename T>
+    static bool decode(const uint8_t* data, size_t size, T& out) {
+        if (peekId(data, size) != T::MESSAGE_ID) {
+            return false;
+        }
+        const uint8_t* p = data + HEADER_SIZE;
+        const uint8_t* end = data + size;
+        bool ok = true;
+        out.visitFields([&](auto&... fields) {
+            size_t fixed = 0;
+            ((fixed += fixedFieldSize(fields)), ...);
+            if (static_cast<size_t>(end - p) < fixed) {
+                ok = false;
+                return;
+            }
+            (readFixed(fields, p), ...);
+            ((ok = ok && readVariable(fields, p, end)), ...);
+        });
+        return ok && p == end;
+    }
+
+    /**
+     * @brief Decode a message from a buffer
+     */
+    template<typename T>
+    static bool decode(const Buffer& payload, T& out) {
+        return decode(payload.data(), payload.size(), out);
+    }
+
+    /**
+     * @brief Encoded size of a LEB128 varint
+     */
+    static size_t varintSize(uint64_t value) {
+        size_t size = 1;
+        while (value >= 0x80) {
+            value >>= 7;
+            ++size;
+        }
+        return size;
+    }
+
+    /**
+     * @brief Write a LEB128 varint and advance p
+     */
+    static void writeVarint(uint64_t value, uint8_t*& p) {
+        while (value >= 0x80) {
+            *p++ = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        *p++ = static_cast<uint8_t>(value);
+    }
+
+    /**
+     * @brief Read a LEB128 varint and advance p
+     * @return false if truncated or longer than MAX_VARINT_SIZE
+     */
+    static bool readVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+        value = 0;
+        for (size_t i = 0; i < MAX_VARINT_SIZE && p < end; ++i) {
+            const uint8_t byte = *p++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    template<typename F>
+    static constexpr bool isFixed = std::is_arithmetic_v<F> || std::is_enum_v<F>;
+
+    template<typename F>
+    static constexpr bool isVariable =
+        std::is_same_v<F, std::string_view> || std::is_same_v<F, std::string> ||
+        std::is_same_v<F, std::span<const uint8_t>> || std::is_same_v<F, Buffer>;
+
+    template<typename F>
+    static constexpr void checkField() {
+        static_assert(isFixed<F> || isVariable<F>,
+            "message fields must be arithmetic, enum, std::string_view, std::string, std::span<const uint8_t> or Buffer");
+    }
+
+    /// Unsigned integer of the same width, for byte order handling
+    template<typename F>
+    using Bits = std::conditional_t<sizeof(F) == 1, uint8_t,
+        std::conditional_t<sizeof(F) == 2, uint16_t,
+        std::conditional_t<sizeof(F) == 4, uint32_t, uint64_t>>>;
+
+    template<typename F>
+    static void store(uint8_t* p, F value) {
+        Bits<F> bits;
+        if constexpr (std::is_same_v<F, bool>) {
+            bits = value ? 1 : 0;
+        }
+        else {
+            bits = std::bit_cast<Bits<F>>(value);
+        }
+        if constexpr (std::endian::native == std::endian::little) {
+            std::memcpy(p, &bits, sizeof(bits));
+        }
+        else {
+            for (size_t i = 0; i < sizeof(bits); ++i) {
+                p[i] = static_cast<uint8_t>(bits >> (8 * i));
+            }
+        }
+    }
+
+    template<typename F>
+    static F load(const uint8_t* p) {
+        Bits<F> bits = 0;
+        if constexpr (std::endian::native == std::endian::little) {
+            std::memcpy(&bits, p, sizeof(bits));
+        }
+        else {
+            for (size_t i = 0; i < sizeof(bits); ++i) {
+                bits |= static_cast<Bits<F>>(static_cast<Bits<F>>(p[i]) << (8 * i));
+            }
+        }
+        if constexpr (std::is_same_v<F, bool>) {
+            return bits != 0;
+        }
+        else {
+            return std::bit_cast<F>(bits);
+        }
+    }
+
+    template<typename F>
+    static size_t fixedFieldSize(const F&) {
+        checkField<F>();
+        if constexpr (isFixed<F>) {
+            return sizeof(F);
+        }
+        else {
+            return 0;
+        }
+    }
+
+    template<typename F>
+    static size_t fieldSize(const F& field) {
+        checkField<F>();
+        if constexpr (isFixed<F>) {
+            return sizeof(F);
+        }
+        else {
+            return varintSize(field.size()) + field.size();
+        }
+    }
+
+    template<typename F>
+    static void writeFixed(const F& field, uint8_t*& p) {
+        if constexpr (isFixed<F>) {
+            if constexpr (std::is_enum_v<F>) {
+                store(p, static_cast<std::underlying_type_t<F>>(field));
+            }
+            else {
+                store(p, field);
+            }
+            p += sizeof(F);
+        }
+    }
+
+    template<typename F>
+    static void writeVariable(const F& field, uint8_t*& p) {
+        if constexpr (isVariable<F>) {
+            writeVarint(field.size(), p);
+            if (!field.empty()) {
+                std::memcpy(p, field.data(), field.size());
+            }
+            p += field.size();
+        }
+    }
+
+    template<typename F>
+    static void readFixed(F& field, const uint8_t*& p) {
+        if constexpr (isFixed<F>) {
+            if constexpr (std::is_enum_v<F>) {
+                field = static_cast<F>(load<std::underlying_type_t<F>>(p));
+            }
+            else {
+                field = load<F>(p);
+            }
+            p += sizeof(F);
+        }
+    }
+
+    template<typename F>
+    static bool readVariable(F& field, const uint8_t*& p, const uint8_t* end) {
+        if constexpr (isVariable<F>) {
+            uint64_t length = 0;
+            if (!readVarint(p, end, length) || length > static_cast<uint64_t>(end - p)) {
+                return false;
+            }
+            const size_t size = static_cast<size_t>(length);
+            if constexpr (std::is_same_v<F, std::string_view>) {
+                field = std::string_view(reinterpret_cast<const char*>(p), size);
+            }
+            else if constexpr (std::is_same_v<F, std::span<const uint8_t>>) {
+                field = std::span<const uint8_t>(p, size);
+            }
+            else {
+                field.assign(p, p + size);
+            }
+            p += size;
+        }
+        return true;
+    }
+};
+
+/**
+ * @class TypedMessageRouter
+ * @brief Dispatches binary messages to handlers by message id
+ *
+ * Reads the id header of each binary message, decodes the payload into the
+ * registered type on the stack and calls that type's handler. Views in the
+ * decoded message refer to the received payload, so the common path does
+ * not allocate.
+ *
+ * Text messages, unknown ids and payloads that fail to decode go to the
+ * fallback handler, so it can take the place of a plain onMessage handler.
+ *
+ * Register handlers before messages start arriving; dispatch() itself may
+ * be called from any number of threads.
+ *
+ * Usage:
+ * auto router = std::make_shared<TypedMessageRouter>();
+ * router->on<ChatPost>([](ClientID client, const ChatPost& post) { ... });
+ * server.routeMessages(router);
+ * server.sendBinary(client, BinaryCodec::encode(ChatPost{ 1, now, "hi" }));
+ */
+class TypedMessageRouter : public NonCopyable {
+public:
+    using FallbackHandler = std::function<void(ClientID, const Message&)>;
+
+    /**
+     * @brief Dispatch counters
+     */
+    struct Stats {
+        uint64_t routed{ 0 };           ///< Decoded and delivered to a handler
+        uint64_t unknown{ 0 };          ///< Text message, or no handler for the id
+        uint64_t malformed{ 0 };        ///< Handler found but the payload did not decode
+    };
+
+    /**
+     * @brief Register the handler for a message type
+     * @param handler Handler; replaces any existing one for T::MESSAGE_ID
+     */
+    template<typename T>
+    void on(std::function<void(ClientID, const T&)> handler) {
+        if (handlers_.size() <= T::MESSAGE_ID) {
+            handlers_.resize(static_cast<size_t>(T::MESSAGE_ID) + 1);
+        }
+        handlers_[T::MESSAGE_ID] = [handler = std::move(handler)](ClientID client_id, const uint8_t* data, size_t size) {
+            T message{};
+            if (!BinaryCodec::decode(data, size, message)) {
+                return false;
+            }
+            handler(client_id, message);
+            return true;
+        };
+    }
+
+    /**
+     * @brief Set the handler for messages no typed handler takes
+     * @param handler Fallback handler
+     */
+    void otherwise(FallbackHandler handler) {
+        fallback_ = std::move(handler);
+    }
+
+    /**
+     * @brief Route one message
+     * @param client_id Sending client
+     * @param message Received message
+     * @return true if a typed handler ran
+     */
+    bool dispatch(ClientID client_id, const Message& message) {
+        const auto id = message.isText ? std::nullopt : BinaryCodec::peekId(message.data.data(), message.data.size());
+        if (id && *id < handlers_.size() && handlers_[*id]) {
+            if (handlers_[*id](client_id, message.data.data(), message.data.size())) {
+                routed_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            malformed_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            unknown_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (fallback_) {
+            fallback_(client_id, message);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Get dispatch counters
+     */
+    Stats getStats() const {
+        Stats stats;
+        stats.routed = routed_.load(std::memory_order_relaxed);
+        stats.unknown = unknown_.load(std::memory_order_relaxed);
+        stats.malformed = malformed_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    using Decoder = std::function<bool(ClientID, const uint8_t*, size_t)>;
+
+    std::vector<Decoder> handlers_;     ///< Indexed by message id
+    FallbackHandler fallback_;
+
+    std::atomic<uint64_t> routed_{ 0 };
+    std::atomic<uint64_t> unknown_{ 0 };
+    std::atomic<uint64_t> malformed_{ 0 };
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_BINARY_CODEC_HPP
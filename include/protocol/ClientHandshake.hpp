@@ -0,0 +1,150 @@
+#pragma once
+#ifndef WEBSOCKET_CLIENT_HANDSHAKE_HPP
+#define WEBSOCKET_CLIENT_HANDSHAKE_HPP
+
+#include "../common/Types.hpp"
+#include "../utils/Crypto.hpp"
+#include <cctype>
+#include <string>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class ClientHandshake
+ * @brief Client side of the RFC 6455 opening handshake
+ *
+ * Counterpart to WebSocketHandshake for outbound connections: builds the
+ * upgrade request with a fresh Sec-WebSocket-Key and checks the server's
+ * 101 response, including the Sec-WebSocket-Accept value. One instance per
+ * connection attempt.
+ */
+class ClientHandshake {
+public:
+    /**
+     * @brief Response parsing result
+     */
+    enum class Result {
+        INCOMPLETE,     ///< Header block not fully received yet
+        SUCCESS,        ///< Upgrade accepted
+        FAILED          ///< Server refused or answered incorrectly
+    };
+
+    /**
+     * @brief Build the upgrade request
+     * @param host Host header value (host or host:port)
+     * @param path Request target
+     * @param subprotocol Offered subprotocol (empty = none)
+     * @return Raw request including the blank line
+     */
+    std::string createRequest(const std::string& host, const std::string& path,
+        const std::string& subprotocol = "") {
+        key_ = Crypto::base64Encode(Crypto::generateRandomBytes(16));
+        subprotocol_ = subprotocol;
+
+        std::string request;
+        request.reserve(256);
+        request += "GET " + (path.empty() ? std::string("/") : path) + " HTTP/1.1\r\n";
+        request += "Host: " + host + "\r\n";
+        request += "Upgrade: websocket\r\n";
+        request += "Connection: Upgrade\r\n";
+        request += "Sec-WebSocket-Key: " + key_ + "\r\n";
+        request += "Sec-WebSocket-Version: 13\r\n";
+        if (!subprotocol.empty()) {
+            request += "Sec-WebSocket-Protocol: " + subprotocol + "\r\n";
+        }
+        request += "\r\n";
+        return request;
+    }
+
+    /**
+     * @brief Parse the server response
+     * @param response Bytes received so far
+     * @param consumed Set to the header block size on SUCCESS; bytes after it are frames
+     * @return Parsing result
+     */
+    Result parseResponse(const std::string& response, size_t& consumed) {
+        const size_t end = response.find("\r\n\r\n");
+        if (end == std::string::npos) {
+            return Result::INCOMPLETE;
+        }
+        consumed = end + 4;
+
+        if (response.compare(0, 12, "HTTP/1.1 101") != 0) {
+            const size_t line_end = response.find("\r\n");
+            error_ = "upgrade refused: " + response.substr(0, line_end);
+            return Result::FAILED;
+        }
+
+        std::string upgrade;
+        std::string accept;
+        std::string protocol;
+        size_t pos = response.find("\r\n") + 2;
+        while (pos < end) {
+            size_t line_end = response.find("\r\n", pos);
+            const std::string line = response.substr(pos, line_end - pos);
+            pos = line_end + 2;
+            const size_t colon = line.find(':');
+            if (colon == std::string::npos) {
+                continue;
+            }
+            std::string name = line.substr(0, colon);
+            for (auto& c : name) {
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+            size_t value_start = colon + 1;
+            while (value_start < line.size() && line[value_start] == ' ') {
+                ++value_start;
+            }
+            const std::string value = line.substr(value_start);
+            if (name == "upgrade") {
+                upgrade = value;
+            }
+            else if (name == "sec-websocket-accept") {
+                accept = value;
+            }
+            else if (name == "sec-websocket-protocol") {
+                protocol = value;
+            }
+        }
+
+        for (auto& c : upgrade) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        if (upgrade != "websocket") {
+            error_ = "missing Upgrade: websocket";
+            return Result::FAILED;
+        }
+        if (!Crypto::verifyWebSocketKey(key_, accept)) {
+            error_ = "Sec-WebSocket-Accept mismatch";
+            return Result::FAILED;
+        }
+        if (!protocol.empty() && protocol != subprotocol_) {
+            error_ = "server selected unoffered subprotocol " + protocol;
+            return Result::FAILED;
+        }
+        accepted_subprotocol_ = protocol;
+        return Result::SUCCESS;
+    }
+
+    /**
+     * @brief Get the subprotocol the server selected
+     * @return Subprotocol, empty if none
+     */
+    const std::string& getAcceptedSubprotocol() const { return accepted_subprotocol_; }
+
+    /**
+     * @brief Get the reason for a FAILED result
+     * @return Error message
+     */
+    const std::string& getErrorMessage() const { return error_; }
+
+private:
+    std::string key_;
+    std::string subprotocol_;
+    std::string accepted_subprotocol_;
+    std::string error_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_CLIENT_HANDSHAKE_HPP
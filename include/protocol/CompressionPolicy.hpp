@@ -0,0 +1,280 @@
+#pragma once
+#ifndef WEBSOCKET_COMPRESSION_POLICY_HPP
+#define WEBSOCKET_COMPRESSION_POLICY_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include "../utils/Metrics.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <string_view>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class CompressionPolicy
+ * @brief Decides per message whether (and how hard) to compress
+ *
+ * Compressing everything wastes CPU on payloads that are tiny or already
+ * compressed, and under CPU saturation sending more bytes is cheaper than
+ * compressing them. With compression enabled (RuntimeConfig), the session
+ * asks decide() before compressing each outbound message and reports the
+ * result with record():
+ *
+ * - payloads under min_size are sent as they are
+ * - a rolling compression ratio is kept per session and per message type;
+ *   when either is poor the message is sent as is, with an occasional probe
+ *   so a session or type whose payloads become compressible again recovers
+ * - updateUtilization() (fed from the event-loop utilisation sample) lowers
+ *   the compression level step by step while the loops are busy, suspends
+ *   compression when they are saturated, and restores it when they are idle
+ *
+ * Codecs that cannot change level per message (zstd with a digested
+ * dictionary) only use the compress/skip decision.
+ *
+ * decide() and record() are lock-free. Per-session state lives in the
+ * session; per-type ratios are shared by all sessions in a small hashed
+ * table where colliding types share a slot. Counters are exported as
+ * "compression.*" metrics by exportMetrics().
+ */
+class CompressionPolicy : public NonCopyable {
+public:
+    /**
+     * @brief Policy configuration
+     */
+    struct Config {
+        size_t min_size{ 128 };                 ///< Smaller payloads are never compressed
+        uint32_t poor_ratio_permille{ 900 };    ///< Skip when compressed/original averages above this
+        uint32_t min_samples{ 4 };              ///< Samples before a ratio is trusted
+        uint32_t probe_interval{ 32 };          ///< While skipping for ratio, compress every Nth message anyway
+        int max_level{ 6 };                     ///< Level when the event loops have headroom
+        int min_level{ 1 };                     ///< Lowest level before compression is suspended
+        double busy_utilization{ 0.80 };        ///< Lower the level one step per sample above this
+        double saturated_utilization{ 0.95 };   ///< Suspend compression above this
+        double idle_utilization{ 0.50 };        ///< Raise the level one step per sample below this
+    };
+
+    /**
+     * @brief Outcome of decide()
+     */
+    enum class Reason : uint8_t {
+        COMPRESS,           ///< Compress at Decision::level
+        PROBE,              ///< Ratio is poor, but compress to re-measure it
+        SKIP_SMALL,         ///< Payload under min_size
+        SKIP_RATIO,         ///< Session or type compresses poorly
+        SKIP_CPU            ///< Event loops saturated
+    };
+
+    /**
+     * @brief Per-message decision
+     */
+    struct Decision {
+        Reason reason{ Reason::COMPRESS };
+        int level{ 0 };                         ///< Compression level to use (0 when skipping)
+        bool compress() const { return reason == Reason::COMPRESS || reason == Reason::PROBE; }
+    };
+
+    /**
+     * @brief Per-session ratio tracking (owned by the session, not thread-safe)
+     */
+    struct SessionState {
+        uint32_t ratio_permille{ 0 };           ///< Rolling compressed/original, in 1/1000
+        uint32_t samples{ 0 };                  ///< Messages measured (saturates)
+        uint32_t since_probe{ 0 };              ///< Ratio skips since the last probe
+    };
+
+    /**
+     * @brief Decision and savings counters
+     */
+    struct Stats {
+        uint64_t compressed{ 0 };               ///< Messages compressed (including probes)
+        uint64_t probes{ 0 };                   ///< Compressed only to re-measure the ratio
+        uint64_t skipped_small{ 0 };            ///< Skipped: under min_size
+        uint64_t skipped_ratio{ 0 };            ///< Skipped: poor ratio
+        uint64_t skipped_cpu{ 0 };              ///< Skipped: event loops saturated
+        uint64_t bytes_in{ 0 };                 ///< Original size of compressed messages
+        uint64_t bytes_out{ 0 };                ///< Size actually sent for them
+        int level{ 0 };                         ///< Current level (0 = suspended)
+    };
+
+    CompressionPolicy() : CompressionPolicy(Config{}) {}
+
+    /**
+     * @brief Create a policy
+     * @param config Thresholds and level range
+     */
+    explicit CompressionPolicy(const Config& config)
+        : config_(config), level_(config.max_level) {
+    }
+
+    /**
+     * @brief Hash a message type name into a type key
+     * @param type Type name (e.g. the JSON "type" member)
+     * @return Key for decide()/record(); 0 is reserved for untyped messages
+     */
+    static uint32_t typeKey(std::string_view type) {
+        uint32_t hash = 2166136261u;
+        for (const char c : type) {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+        }
+        return hash | 1;
+    }
+
+    /**
+     * @brief Decide whether to compress an outbound message
+     * @param session Session's ratio state
+     * @param type Message type key (typeKey(), a BinaryCodec message id, or 0)
+     * @param size Payload size
+     * @return Decision; call record() after compressing
+     */
+    Decision decide(SessionState& session, uint32_t type, size_t size) {
+        if (size < config_.min_size) {
+            stats_.skipped_small.fetch_add(1, std::memory_order_relaxed);
+            return Decision{ Reason::SKIP_SMALL, 0 };
+        }
+        const int level = level_.load(std::memory_order_relaxed);
+        if (level == 0) {
+            stats_.skipped_cpu.fetch_add(1, std::memory_order_relaxed);
+            return Decision{ Reason::SKIP_CPU, 0 };
+        }
+        const uint32_t slot = types_[slotOf(type)].load(std::memory_order_relaxed);
+        const bool poor = isPoor(session.ratio_permille, session.samples) ||
+            (type != 0 && isPoor(slot >> 16, slot & 0xFFFF));
+        if (!poor) {
+            session.since_probe = 0;
+            return Decision{ Reason::COMPRESS, level };
+        }
+        if (++session.since_probe >= config_.probe_interval) {
+            session.since_probe = 0;
+            stats_.probes.fetch_add(1, std::memory_order_relaxed);
+            return Decision{ Reason::PROBE, level };
+        }
+        stats_.skipped_ratio.fetch_add(1, std::memory_order_relaxed);
+        return Decision{ Reason::SKIP_RATIO, 0 };
+    }
+
+    /**
+     * @brief Report the result of a compression decide() asked for
+     * @param session Session's ratio state
+     * @param type Message type key passed to decide()
+     * @param original Payload size
+     * @param compressed Compressed size (original if the codec gave up)
+     */
+    void record(SessionState& session, uint32_t type, size_t original, size_t compressed) {
+        if (original == 0) {
+            return;
+        }
+        const uint32_t ratio = static_cast<uint32_t>(std::min<uint64_t>(compressed, original) * 1000 / original);
+        session.ratio_permille = blend(session.ratio_permille, session.samples, ratio);
+        session.samples = std::min<uint32_t>(session.samples + 1, 0xFFFF);
+
+        if (type != 0) {
+            // Racing updates may drop a sample; the average stays representative
+            auto& slot = types_[slotOf(type)];
+            const uint32_t current = slot.load(std::memory_order_relaxed);
+            const uint32_t samples = current & 0xFFFF;
+            const uint32_t updated = (blend(current >> 16, samples, ratio) << 16) | std::min<uint32_t>(samples + 1, 0xFFFF);
+            slot.store(updated, std::memory_order_relaxed);
+        }
+
+        stats_.compressed.fetch_add(1, std::memory_order_relaxed);
+        stats_.bytes_in.fetch_add(original, std::memory_order_relaxed);
+        stats_.bytes_out.fetch_add(std::min(compressed, original), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Adjust the level from event-loop load
+     * @param utilization Busy fraction of the I/O threads, 0.0 - 1.0 (e.g. IOThreadPool::getUtilization())
+     * @return Level now in effect (0 = compression suspended)
+     */
+    int updateUtilization(double utilization) {
+        int level = level_.load(std::memory_order_relaxed);
+        if (utilization >= config_.saturated_utilization) {
+            level = 0;
+        } else if (utilization >= config_.busy_utilization) {
+            level = level == 0 ? config_.min_level : std::max(config_.min_level, level - 1);
+        } else if (utilization <= config_.idle_utilization) {
+            level = level == 0 ? config_.min_level : std::min(config_.max_level, level + 1);
+        }
+        level_.store(level, std::memory_order_relaxed);
+        return level;
+    }
+
+    /**
+     * @brief Get the level decide() currently hands out
+     * @return Level (0 = compression suspended)
+     */
+    int getLevel() const { return level_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get decision and savings counters
+     */
+    Stats getStats() const {
+        Stats stats;
+        stats.compressed = stats_.compressed.load(std::memory_order_relaxed);
+        stats.probes = stats_.probes.load(std::memory_order_relaxed);
+        stats.skipped_small = stats_.skipped_small.load(std::memory_order_relaxed);
+        stats.skipped_ratio = stats_.skipped_ratio.load(std::memory_order_relaxed);
+        stats.skipped_cpu = stats_.skipped_cpu.load(std::memory_order_relaxed);
+        stats.bytes_in = stats_.bytes_in.load(std::memory_order_relaxed);
+        stats.bytes_out = stats_.bytes_out.load(std::memory_order_relaxed);
+        stats.level = getLevel();
+        return stats;
+    }
+
+    /**
+     * @brief Publish counters as "compression.*" metrics
+     *
+     * @note Call from a maintenance timer, not per message
+     */
+    void exportMetrics() const {
+        const Stats stats = getStats();
+        Metrics& metrics = Metrics::getInstance();
+        metrics.setCounter("compression.compressed", static_cast<int64_t>(stats.compressed));
+        metrics.setCounter("compression.probes", static_cast<int64_t>(stats.probes));
+        metrics.setCounter("compression.skipped_small", static_cast<int64_t>(stats.skipped_small));
+        metrics.setCounter("compression.skipped_ratio", static_cast<int64_t>(stats.skipped_ratio));
+        metrics.setCounter("compression.skipped_cpu", static_cast<int64_t>(stats.skipped_cpu));
+        metrics.setCounter("compression.bytes_saved", static_cast<int64_t>(stats.bytes_in - stats.bytes_out));
+        metrics.setGauge("compression.level", stats.level);
+        metrics.setGauge("compression.ratio", stats.bytes_in == 0 ? 1.0 :
+            static_cast<double>(stats.bytes_out) / static_cast<double>(stats.bytes_in));
+    }
+
+private:
+    static constexpr size_t TYPE_SLOTS = 256;
+
+    struct Counters {
+        std::atomic<uint64_t> compressed{ 0 };
+        std::atomic<uint64_t> probes{ 0 };
+        std::atomic<uint64_t> skipped_small{ 0 };
+        std::atomic<uint64_t> skipped_ratio{ 0 };
+        std::atomic<uint64_t> skipped_cpu{ 0 };
+        std::atomic<uint64_t> bytes_in{ 0 };
+        std::atomic<uint64_t> bytes_out{ 0 };
+    };
+
+    static size_t slotOf(uint32_t type) {
+        return (type * 2654435761u) >> 24;
+    }
+
+    /// Rolling average: plain mean for the first 8 samples, then 1/8 weight per sample
+    static uint32_t blend(uint32_t average, uint32_t samples, uint32_t sample) {
+        const uint32_t weight = std::min<uint32_t>(samples + 1, 8);
+        return (average * (weight - 1) + sample) / weight;
+    }
+
+    bool isPoor(uint32_t ratio_permille, uint32_t samples) const {
+        return samples >= config_.min_samples && ratio_permille > config_.poor_ratio_permille;
+    }
+
+    Config config_;
+    std::atomic<int> level_;
+    std::array<std::atomic<uint32_t>, TYPE_SLOTS> types_{};    ///< ratio_permille << 16 | samples
+    Counters stats_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_COMPRESSION_POLICY_HPP
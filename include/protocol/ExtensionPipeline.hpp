@@ -0,0 +1,380 @@
+#pragma once
+#ifndef WEBSOCKET_EXTENSION_PIPELINE_HPP
+#define WEBSOCKET_EXTENSION_PIPELINE_HPP
+
+#include "../common/Types.hpp"
+#include "../common/Macros.hpp"
+#include "WebSocketHandshake.hpp"
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @struct ExtensionOffer
+ * @brief One element of a Sec-WebSocket-Extensions header: name and parameters
+ */
+struct ExtensionOffer {
+    std::string name;                                           ///< Extension token
+    std::vector<std::pair<std::string, std::string>> params;    ///< Parameters in order (value empty if none)
+
+    /**
+     * @brief Check if a parameter is present
+     * @param param Parameter name
+     */
+    bool has(const std::string& param) const {
+        for (const auto& entry : params) {
+            if (entry.first == param) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Get a parameter value
+     * @param param Parameter name
+     * @return Value with quotes removed (empty if absent or valueless)
+     */
+    std::string get(const std::string& param) const {
+        for (const auto& entry : params) {
+            if (entry.first == param) {
+                return entry.second;
+            }
+        }
+        return std::string();
+    }
+
+    /**
+     * @brief Split a Sec-WebSocket-Extensions header into elements
+     * @param header Header value, e.g. "a; x=1, b"
+     * @return Elements in header order (empty names are dropped)
+     */
+    static std::vector<ExtensionOffer> parse(const std::string& header) {
+        std::vector<ExtensionOffer> offers;
+        ExtensionOffer current;
+        std::string token, value;
+        bool in_value = false, quoted = false;
+
+        auto trim = [](const std::string& text) {
+            const size_t first = text.find_first_not_of(" \t");
+            const size_t last = text.find_last_not_of(" \t");
+            return first == std::string::npos ? std::string() : text.substr(first, last - first + 1);
+        };
+        auto endParam = [&]() {
+            const std::string name = trim(token);
+            if (current.name.empty()) {
+                current.name = name;
+            } else if (!name.empty()) {
+                std::string v = trim(value);
+                if (v.size() >= 2 && v.front() == '"' && v.back() == '"') {
+                    v = v.substr(1, v.size() - 2);
+                }
+                current.params.emplace_back(name, v);
+            }
+            token.clear();
+            value.clear();
+            in_value = false;
+        };
+
+        for (const char c : header) {
+            if (c == '"') {
+                quoted = !quoted;
+            }
+            if (!quoted && (c == ';' || c == ',')) {
+                endParam();
+                if (c == ',') {
+                    if (!current.name.empty()) {
+                        offers.push_back(std::move(current));
+                    }
+                    current = ExtensionOffer{};
+                }
+            } else if (!quoted && c == '=' && !in_value) {
+                in_value = true;
+            } else {
+                (in_value ? value : token) += c;
+            }
+        }
+        endParam();
+        if (!current.name.empty()) {
+            offers.push_back(std::move(current));
+        }
+        return offers;
+    }
+};
+
+/**
+ * @class ExtensionPayload
+ * @brief Message payload as it moves through the extension pipeline
+ *
+ * Starts as a view of the caller's bytes. A stage either rewrites the bytes
+ * in place (mutableData(), then shrink() if it got shorter) or writes its
+ * result into the pipeline's scratch memory (output(), then commit()). The
+ * two scratch buffers are used alternately, so no stage copies its input
+ * into an intermediate Buffer; a read-only input is copied once, and only
+ * if a stage asks to modify it in place.
+ */
+class ExtensionPayload {
+public:
+    /// RSV bits as they appear in the first frame header byte
+    static constexpr uint8_t RSV1 = 0x40;
+    static constexpr uint8_t RSV2 = 0x20;
+    static constexpr uint8_t RSV3 = 0x10;
+
+    /**
+     * @brief Scratch memory reused from message to message (one per I/O thread or session)
+     */
+    struct Scratch {
+        Buffer buffers[2];
+    };
+
+    /**
+     * @brief View a payload
+     * @param data Payload bytes
+     * @param size Payload size
+     * @param writable true if stages may modify data in place
+     * @param scratch Scratch memory for stages that need new output
+     */
+    ExtensionPayload(const uint8_t* data, size_t size, bool writable, Scratch& scratch)
+        : data_(data), size_(size), writable_(writable), scratch_(scratch) {
+    }
+
+    ExtensionPayload(const ExtensionPayload&) = delete;
+    ExtensionPayload& operator=(const ExtensionPayload&) = delete;
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    bool text{ false };             ///< TEXT (true) or BINARY message
+    uint8_t rsv{ 0 };               ///< RSV bits of the (first) frame
+
+    /**
+     * @brief Get the payload for in-place modification
+     * @return Writable bytes (size() of them)
+     */
+    uint8_t* mutableData() {
+        if (!writable_) {
+            uint8_t* copy = output(size_);
+            if (size_ != 0) {
+                std::memcpy(copy, data_, size_);
+            }
+            commit(size_);
+        }
+        return const_cast<uint8_t*>(data_);
+    }
+
+    /**
+     * @brief Shorten the payload after an in-place rewrite
+     * @param size New size (not larger than the current size)
+     */
+    void shrink(size_t size) {
+        if (size < size_) {
+            size_ = size;
+        }
+    }
+
+    /**
+     * @brief Get scratch memory for a stage's output
+     * @param capacity Bytes the stage may write
+     * @return Writable memory that does not overlap data()
+     */
+    uint8_t* output(size_t capacity) {
+        Buffer& target = scratch_.buffers[next()];
+        if (target.size() < capacity) {
+            target.resize(capacity);
+        }
+        return target.data();
+    }
+
+    /**
+     * @brief Make the stage's output the payload
+     * @param size Bytes written to the memory returned by output()
+     */
+    void commit(size_t size) {
+        current_ = next();
+        data_ = scratch_.buffers[current_].data();
+        size_ = size;
+        writable_ = true;
+    }
+
+private:
+    int next() const { return current_ == 0 ? 1 : 0; }
+
+    const uint8_t* data_;
+    size_t size_;
+    bool writable_;
+    int current_{ -1 };             ///< Scratch buffer holding data_ (-1 = caller's memory)
+    Scratch& scratch_;
+};
+
+/**
+ * @class ExtensionSession
+ * @brief Per-connection state of one negotiated extension
+ */
+class ExtensionSession {
+    WEBSOCKET_INTERFACE(ExtensionSession)
+
+public:
+    /**
+     * @brief Transform an outbound message
+     * @param payload Message payload; set the extension's RSV bits if it applied
+     * @return false to fail the message
+     */
+    virtual bool outbound(ExtensionPayload& payload) = 0;
+
+    /**
+     * @brief Undo the transform on an inbound message
+     * @param payload Message payload with the RSV bits it arrived with; clear the extension's bits once handled
+     * @return false if the payload is invalid (the connection closes with 1007)
+     */
+    virtual bool inbound(ExtensionPayload& payload) = 0;
+};
+
+/**
+ * @class WebSocketExtension
+ * @brief Server-wide extension: negotiates and creates per-connection sessions
+ */
+class WebSocketExtension {
+    WEBSOCKET_INTERFACE(WebSocketExtension)
+
+public:
+    /**
+     * @brief Get the extension token matched against offers
+     */
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Get the RSV bits this extension uses (ExtensionPayload::RSV1 etc.)
+     */
+    virtual uint8_t rsvBits() const = 0;
+
+    /**
+     * @brief Accept or decline one offer element
+     * @param offer Client's offer for this extension
+     * @param response Set to the response element (name and parameters)
+     * @return Session for the connection, or nullptr to decline this element
+     */
+    virtual std::unique_ptr<ExtensionSession> negotiate(const ExtensionOffer& offer, std::string& response) = 0;
+};
+
+/**
+ * @class ExtensionPipeline
+ * @brief Ordered extensions negotiated for one connection
+ *
+ * Offer elements are considered in the client's order; an element is
+ * accepted when a registered extension of that name accepts it, no
+ * extension of that name was accepted yet, and its RSV bits are still
+ * free. Outbound messages pass through the extensions in the order they
+ * appear in the response header, inbound messages in reverse.
+ *
+ * Frames with RSV bits no negotiated extension claimed are protocol
+ * errors (1002); check them with allowsRsv() while parsing.
+ */
+class ExtensionPipeline {
+public:
+    ExtensionPipeline() = default;
+    ExtensionPipeline(ExtensionPipeline&&) = default;
+    ExtensionPipeline& operator=(ExtensionPipeline&&) = default;
+
+    /**
+     * @brief Negotiate extensions from the client's handshake
+     * @param available Extensions the server offers
+     * @param handshake Parsed client handshake (its accepted extensions are set)
+     * @return Pipeline for the connection (empty if nothing was accepted)
+     */
+    static ExtensionPipeline negotiate(const std::vector<std::shared_ptr<WebSocketExtension>>& available,
+        WebSocketHandshake& handshake) {
+        ExtensionPipeline pipeline;
+        std::string header;
+        for (const ExtensionOffer& offer : ExtensionOffer::parse(handshake.getRequestedExtensions())) {
+            for (const auto& extension : available) {
+                if (offer.name != extension->name() || pipeline.has(offer.name) ||
+                    (pipeline.rsv_bits_ & extension->rsvBits()) != 0) {
+                    continue;
+                }
+                std::string response;
+                std::unique_ptr<ExtensionSession> session = extension->negotiate(offer, response);
+                if (session) {
+                    header += header.empty() ? response : ", " + response;
+                    pipeline.rsv_bits_ |= extension->rsvBits();
+                    pipeline.stages_.push_back(Stage{ offer.name, std::move(session) });
+                }
+                break;
+            }
+        }
+        handshake.setAcceptedExtensions(header);
+        return pipeline;
+    }
+
+    /**
+     * @brief Check if no extension was negotiated
+     */
+    bool empty() const { return stages_.empty(); }
+
+    /**
+     * @brief Check if an extension was negotiated
+     * @param name Extension token
+     */
+    bool has(const std::string& name) const {
+        for (const Stage& stage : stages_) {
+            if (stage.name == name) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Check a frame's RSV bits against the negotiated extensions
+     * @param rsv RSV bits from the first header byte (masked with 0x70)
+     * @return false if a bit is set that no extension claimed
+     */
+    bool allowsRsv(uint8_t rsv) const { return (rsv & ~rsv_bits_ & 0x70) == 0; }
+
+    /**
+     * @brief Run an outbound message through every extension
+     * @param payload Message; on return its bytes and RSV bits are what to send
+     * @return false if an extension failed
+     */
+    bool outbound(ExtensionPayload& payload) {
+        for (Stage& stage : stages_) {
+            if (!stage.session->outbound(payload)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Run an inbound message back through every extension
+     * @param payload Message as received; on return the original bytes
+     * @return false if an extension rejected it (close with 1007)
+     */
+    bool inbound(ExtensionPayload& payload) {
+        if (!allowsRsv(payload.rsv)) {
+            return false;
+        }
+        for (auto it = stages_.rbegin(); it != stages_.rend(); ++it) {
+            if (!it->session->inbound(payload)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct Stage {
+        std::string name;
+        std::unique_ptr<ExtensionSession> session;
+    };
+
+    std::vector<Stage> stages_;
+    uint8_t rsv_bits_{ 0 };        ///< Union of the negotiated extensions' RSV bits
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_EXTENSION_PIPELINE_HPP
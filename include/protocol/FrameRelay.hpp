@@ -0,0 +1,276 @@
+#pragma once
+#ifndef WEBSOCKET_FRAME_RELAY_HPP
+#define WEBSOCKET_FRAME_RELAY_HPP
+
+#include "../common/Types.hpp"
+#include <cstring>
+#include <functional>
+#include <random>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class FrameRelay
+ * @brief Forwards one direction of a WebSocket stream frame by frame without reassembly
+ *
+ * Only frame headers are decoded; payload bytes are streamed to the output
+ * as they arrive, so a 16 MB frame costs no more memory than a 16 byte one
+ * and nothing is parsed into WebSocketFrame/Message objects.
+ *
+ * A client's masking key is as valid towards an upstream server as it was
+ * towards us, so by default masked payloads pass through untouched (no
+ * unmask/re-mask). With remask enabled, each frame gets a fresh key and the
+ * payload is re-keyed in a single XOR pass (keys come from a per-relay PRNG;
+ * the upstream hop is internal, so they need to vary, not to be secret).
+ * RSV bits are preserved, so
+ * extensions negotiated end-to-end keep working.
+ *
+ * Control frames (CLOSE, PING, PONG) are still forwarded, and additionally
+ * reported unmasked through the control callback so the caller can observe
+ * the close handshake.
+ */
+class FrameRelay {
+public:
+    /**
+     * @brief Masking rule for the relayed direction (RFC 6455 5.1)
+     */
+    enum class Masking {
+        ANY,                ///< Accept masked and unmasked frames
+        REQUIRED,           ///< Client to server: every frame must be masked
+        FORBIDDEN           ///< Server to client: no frame may be masked
+    };
+
+    /**
+     * @brief Relay options
+     */
+    struct Options {
+        bool remask{ false };               ///< Replace masking keys on masked frames
+        uint64_t max_frame_size{ 0 };       ///< Reject larger payloads (0 = unlimited)
+        Masking masking{ Masking::ANY };    ///< Masking the peer must use
+    };
+
+    /**
+     * @brief Outcome of feeding bytes
+     */
+    enum class Status {
+        OK,                 ///< Bytes forwarded (possibly mid-frame)
+        PROTOCOL_ERROR,     ///< Malformed header (e.g. fragmented control frame, wrong masking)
+        FRAME_TOO_LARGE     ///< Payload exceeds max_frame_size
+    };
+
+    /**
+     * @brief Relay statistics
+     */
+    struct Stats {
+        uint64_t frames{ 0 };           ///< Complete frames forwarded
+        uint64_t control_frames{ 0 };   ///< Control frames among them
+        uint64_t payload_bytes{ 0 };    ///< Payload bytes forwarded
+    };
+
+    using ControlCallback = std::function<void(Opcode opcode, const Buffer& payload)>;
+
+    FrameRelay() : FrameRelay(Options{}) {}
+
+    /**
+     * @brief Construct relay
+     * @param options Relay options
+     */
+    explicit FrameRelay(const Options& options)
+        : options_(options), rng_(std::random_device{}()) {
+    }
+
+    /**
+     * @brief Set control frame observer
+     * @param callback Called with each complete control frame's unmasked payload
+     */
+    void setControlCallback(ControlCallback callback) {
+        control_callback_ = std::move(callback);
+    }
+
+    /**
+     * @brief Forward a chunk of the incoming stream
+     * @param data Incoming bytes (any split across frames)
+     * @param size Number of bytes
+     * @param out Output stream bytes are appended here
+     * @return Status; after an error the relay must not be fed again
+     */
+    Status feed(const uint8_t* data, size_t size, Buffer& out) {
+        while (size > 0) {
+            if (payload_remaining_ == 0 && !in_payload_) {
+                const size_t taken = takeHeaderBytes(data, size);
+                data += taken;
+                size -= taken;
+                if (!header_complete_) {
+                    return Status::OK; // Header split across reads
+                }
+                const Status status = beginFrame(out);
+                if (status != Status::OK) {
+                    return status;
+                }
+                if (payload_remaining_ == 0) {
+                    finishFrame();
+                }
+                continue;
+            }
+
+            const size_t chunk = static_cast<size_t>(std::min<uint64_t>(payload_remaining_, size));
+            forwardPayload(data, chunk, out);
+            data += chunk;
+            size -= chunk;
+            payload_remaining_ -= chunk;
+            if (payload_remaining_ == 0) {
+                finishFrame();
+            }
+        }
+        return Status::OK;
+    }
+
+    /**
+     * @brief Check if the relay is between frames
+     * @return true if no partial frame is pending
+     */
+    bool atFrameBoundary() const {
+        return header_size_ == 0 && !in_payload_;
+    }
+
+    /**
+     * @brief Get relay statistics
+     * @return Statistics snapshot
+     */
+    const Stats& getStats() const { return stats_; }
+
+private:
+    size_t takeHeaderBytes(const uint8_t* data, size_t size) {
+        size_t taken = 0;
+        header_complete_ = false;
+        while (taken < size) {
+            header_[header_size_++] = data[taken++];
+            const size_t needed = requiredHeaderSize();
+            if (needed != 0 && header_size_ == needed) {
+                header_complete_ = true;
+                break;
+            }
+        }
+        return taken;
+    }
+
+    /// Full header size once known from the bytes so far, 0 if not yet known
+    size_t requiredHeaderSize() const {
+        if (header_size_ < 2) {
+            return 0;
+        }
+        const uint8_t length_code = header_[1] & 0x7F;
+        const size_t extended = length_code == 126 ? 2 : length_code == 127 ? 8 : 0;
+        return 2 + extended + ((header_[1] & 0x80) ? 4 : 0);
+    }
+
+    Status beginFrame(Buffer& out) {
+        opcode_ = static_cast<Opcode>(header_[0] & 0x0F);
+        const bool fin = (header_[0] & 0x80) != 0;
+        masked_ = (header_[1] & 0x80) != 0;
+
+        const uint8_t length_code = header_[1] & 0x7F;
+        size_t offset = 2;
+        uint64_t length = length_code;
+        if (length_code == 126) {
+            length = (static_cast<uint64_t>(header_[2]) << 8) | header_[3];
+            offset = 4;
+        }
+        else if (length_code == 127) {
+            if (header_[2] & 0x80) {
+                return Status::PROTOCOL_ERROR;  // 64-bit length with the most significant bit set
+            }
+            length = 0;
+            for (int i = 0; i < 8; ++i) {
+                length = (length << 8) | header_[2 + i];
+            }
+            offset = 10;
+        }
+
+        if ((options_.masking == Masking::REQUIRED && !masked_) ||
+            (options_.masking == Masking::FORBIDDEN && masked_)) {
+            return Status::PROTOCOL_ERROR;
+        }
+        control_ = (static_cast<uint8_t>(opcode_) & 0x08) != 0;
+        if (control_ && (!fin || length > 125)) {
+            return Status::PROTOCOL_ERROR;
+        }
+        if (options_.max_frame_size > 0 && length > options_.max_frame_size) {
+            return Status::FRAME_TOO_LARGE;
+        }
+
+        if (masked_) {
+            std::memcpy(in_key_, header_ + offset, 4);
+            if (options_.remask) {
+                const uint32_t key = static_cast<uint32_t>(rng_());
+                std::memcpy(out_key_, &key, 4);
+                std::memcpy(header_ + offset, out_key_, 4);
+            }
+        }
+        out.insert(out.end(), header_, header_ + header_size_);
+
+        payload_remaining_ = length;
+        payload_offset_ = 0;
+        in_payload_ = length > 0;
+        control_payload_.clear();
+        return Status::OK;
+    }
+
+    void forwardPayload(const uint8_t* data, size_t size, Buffer& out) {
+        const size_t start = out.size();
+        out.insert(out.end(), data, data + size);
+
+        if (masked_ && options_.remask) {
+            uint8_t rekey[4];
+            for (int i = 0; i < 4; ++i) {
+                rekey[i] = in_key_[i] ^ out_key_[i];
+            }
+            for (size_t i = 0; i < size; ++i) {
+                out[start + i] ^= rekey[(payload_offset_ + i) & 3];
+            }
+        }
+        if (control_) {
+            for (size_t i = 0; i < size; ++i) {
+                control_payload_.push_back(masked_ ? data[i] ^ in_key_[(payload_offset_ + i) & 3] : data[i]);
+            }
+        }
+        payload_offset_ += size;
+        stats_.payload_bytes += size;
+    }
+
+    void finishFrame() {
+        stats_.frames++;
+        if (control_) {
+            stats_.control_frames++;
+            if (control_callback_) {
+                control_callback_(opcode_, control_payload_);
+            }
+        }
+        header_size_ = 0;
+        header_complete_ = false;
+        in_payload_ = false;
+    }
+
+    Options options_;
+    std::mt19937 rng_;
+    ControlCallback control_callback_;
+    Stats stats_;
+
+    // Current frame
+    uint8_t header_[14]{};
+    size_t header_size_{ 0 };
+    bool header_complete_{ false };
+    bool in_payload_{ false };
+    bool masked_{ false };
+    bool control_{ false };
+    Opcode opcode_{ Opcode::CONTINUATION };
+    uint8_t in_key_[4]{};
+    uint8_t out_key_[4]{};
+    uint64_t payload_remaining_{ 0 };
+    uint64_t payload_offset_{ 0 };
+    Buffer control_payload_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_FRAME_RELAY_HPP
@@ -0,0 +1,498 @@
+#pragma once
+#ifndef WEBSOCKET_HPACK_HPP
+#define WEBSOCKET_HPACK_HPP
+
+#include "../common/Types.hpp"
+#include <cstring>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @namespace Hpack
+ * @brief HTTP/2 header compression (RFC 7541)
+ *
+ * The decoder implements the full format: static and dynamic tables,
+ * Huffman-coded strings and table size updates, since peers use all of
+ * them. The encoder only writes static-table references and plain
+ * literals without indexing, which every decoder accepts and which leaves
+ * no encoder state to keep in step with the peer.
+ */
+namespace Hpack {
+
+    using Header = std::pair<std::string, std::string>;
+
+    constexpr size_t STATIC_TABLE_SIZE = 61;
+    constexpr size_t ENTRY_OVERHEAD = 32;       ///< Per-entry size overhead in the dynamic table
+
+    /**
+     * @brief Static table entry
+     */
+    struct StaticEntry {
+        const char* name;
+        const char* value;
+    };
+
+    /**
+     * @brief Static table (RFC 7541 Appendix A); index 1 is element 0
+     */
+    inline const StaticEntry* staticTable() {
+        static const StaticEntry table[STATIC_TABLE_SIZE] = {
+            { ":authority", "" },
+            { ":method", "GET" },
+            { ":method", "POST" },
+            { ":path", "/" },
+            { ":path", "/index.html" },
+            { ":scheme", "http" },
+            { ":scheme", "https" },
+            { ":status", "200" },
+            { ":status", "204" },
+            { ":status", "206" },
+            { ":status", "304" },
+            { ":status", "400" },
+            { ":status", "404" },
+            { ":status", "500" },
+            { "accept-charset", "" },
+            { "accept-encoding", "gzip, deflate" },
+            { "accept-language", "" },
+            { "accept-ranges", "" },
+            { "accept", "" },
+            { "access-control-allow-origin", "" },
+            { "age", "" },
+            { "allow", "" },
+            { "authorization", "" },
+            { "cache-control", "" },
+            { "content-disposition", "" },
+            { "content-encoding", "" },
+            { "content-language", "" },
+            { "content-length", "" },
+            { "content-location", "" },
+            { "content-range", "" },
+            { "content-type", "" },
+            { "cookie", "" },
+            { "date", "" },
+            { "etag", "" },
+            { "expect", "" },
+            { "expires", "" },
+            { "from", "" },
+            { "host", "" },
+            { "if-match", "" },
+            { "if-modified-since", "" },
+            { "if-none-match", "" },
+            { "if-range", "" },
+            { "if-unmodified-since", "" },
+            { "last-modified", "" },
+            { "link", "" },
+            { "location", "" },
+            { "max-forwards", "" },
+            { "proxy-authenticate", "" },
+            { "proxy-authorization", "" },
+            { "range", "" },
+            { "referer", "" },
+            { "refresh", "" },
+            { "retry-after", "" },
+            { "server", "" },
+            { "set-cookie", "" },
+            { "strict-transport-security", "" },
+            { "transfer-encoding", "" },
+            { "user-agent", "" },
+            { "vary", "" },
+            { "via", "" },
+            { "www-authenticate", "" },
+        };
+        return table;
+    }
+
+    /**
+     * @brief Huffman code (RFC 7541 Appendix B)
+     */
+    struct HuffmanCode {
+        uint32_t code;
+        uint8_t bits;
+    };
+
+    /**
+     * @brief Huffman codes for symbols 0-255 and EOS (256)
+     */
+    inline const HuffmanCode* huffmanCodes() {
+        static const HuffmanCode codes[257] = {
+            { 0x1ff8, 13 }, { 0x7fffd8, 23 }, { 0xfffffe2, 28 }, { 0xfffffe3, 28 }, { 0xfffffe4, 28 }, { 0xfffffe5, 28 },
+            { 0xfffffe6, 28 }, { 0xfffffe7, 28 }, { 0xfffffe8, 28 }, { 0xffffea, 24 }, { 0x3ffffffc, 30 }, { 0xfffffe9, 28 },
+            { 0xfffffea, 28 }, { 0x3ffffffd, 30 }, { 0xfffffeb, 28 }, { 0xfffffec, 28 }, { 0xfffffed, 28 }, { 0xfffffee, 28 },
+            { 0xfffffef, 28 }, { 0xffffff0, 28 }, { 0xffffff1, 28 }, { 0xffffff2, 28 }, { 0x3ffffffe, 30 }, { 0xffffff3, 28 },
+            { 0xffffff4, 28 }, { 0xffffff5, 28 }, { 0xffffff6, 28 }, { 0xffffff7, 28 }, { 0xffffff8, 28 }, { 0xffffff9, 28 },
+            { 0xffffffa, 28 }, { 0xffffffb, 28 }, { 0x14, 6 }, { 0x3f8, 10 }, { 0x3f9, 10 }, { 0xffa, 12 },
+            { 0x1ff9, 13 }, { 0x15, 6 }, { 0xf8, 8 }, { 0x7fa, 11 }, { 0x3fa, 10 }, { 0x3fb, 10 },
+            { 0xf9, 8 }, { 0x7fb, 11 }, { 0xfa, 8 }, { 0x16, 6 }, { 0x17, 6 }, { 0x18, 6 },
+            { 0x0, 5 }, { 0x1, 5 }, { 0x2, 5 }, { 0x19, 6 }, { 0x1a, 6 }, { 0x1b, 6 },
+            { 0x1c, 6 }, { 0x1d, 6 }, { 0x1e, 6 }, { 0x1f, 6 }, { 0x5c, 7 }, { 0xfb, 8 },
+            { 0x7ffc, 15 }, { 0x20, 6 }, { 0xffb, 12 }, { 0x3fc, 10 }, { 0x1ffa, 13 }, { 0x21, 6 },
+            { 0x5d, 7 }, { 0x5e, 7 }, { 0x5f, 7 }, { 0x60, 7 }, { 0x61, 7 }, { 0x62, 7 },
+            { 0x63, 7 }, { 0x64, 7 }, { 0x65, 7 }, { 0x66, 7 }, { 0x67, 7 }, { 0x68, 7 },
+            { 0x69, 7 }, { 0x6a, 7 }, { 0x6b, 7 }, { 0x6c, 7 }, { 0x6d, 7 }, { 0x6e, 7 },
+            { 0x6f, 7 }, { 0x70, 7 }, { 0x71, 7 }, { 0x72, 7 }, { 0xfc, 8 }, { 0x73, 7 },
+            { 0xfd, 8 }, { 0x1ffb, 13 }, { 0x7fff0, 19 }, { 0x1ffc, 13 }, { 0x3ffc, 14 }, { 0x22, 6 },
+            { 0x7ffd, 15 }, { 0x3, 5 }, { 0x23, 6 }, { 0x4, 5 }, { 0x24, 6 }, { 0x5, 5 },
+            { 0x25, 6 }, { 0x26, 6 }, { 0x27, 6 }, { 0x6, 5 }, { 0x74, 7 }, { 0x75, 7 },
+            { 0x28, 6 }, { 0x29, 6 }, { 0x2a, 6 }, { 0x7, 5 }, { 0x2b, 6 }, { 0x76, 7 },
+            { 0x2c, 6 }, { 0x8, 5 }, { 0x9, 5 }, { 0x2d, 6 }, { 0x77, 7 }, { 0x78, 7 },
+            { 0x79, 7 }, { 0x7a, 7 }, { 0x7b, 7 }, { 0x7ffe, 15 }, { 0x7fc, 11 }, { 0x3ffd, 14 },
+            { 0x1ffd, 13 }, { 0xffffffc, 28 }, { 0xfffe6, 20 }, { 0x3fffd2, 22 }, { 0xfffe7, 20 }, { 0xfffe8, 20 },
+            { 0x3fffd3, 22 }, { 0x3fffd4, 22 }, { 0x3fffd5, 22 }, { 0x7fffd9, 23 }, { 0x3fffd6, 22 }, { 0x7fffda, 23 },
+            { 0x7fffdb, 23 }, { 0x7fffdc, 23 }, { 0x7fffdd, 23 }, { 0x7fffde, 23 }, { 0xffffeb, 24 }, { 0x7fffdf, 23 },
+            { 0xffffec, 24 }, { 0xffffed, 24 }, { 0x3fffd7, 22 }, { 0x7fffe0, 23 }, { 0xffffee, 24 }, { 0x7fffe1, 23 },
+            { 0x7fffe2, 23 }, { 0x7fffe3, 23 }, { 0x7fffe4, 23 }, { 0x1fffdc, 21 }, { 0x3fffd8, 22 }, { 0x7fffe5, 23 },
+            { 0x3fffd9, 22 }, { 0x7fffe6, 23 }, { 0x7fffe7, 23 }, { 0xffffef, 24 }, { 0x3fffda, 22 }, { 0x1fffdd, 21 },
+            { 0xfffe9, 20 }, { 0x3fffdb, 22 }, { 0x3fffdc, 22 }, { 0x7fffe8, 23 }, { 0x7fffe9, 23 }, { 0x1fffde, 21 },
+            { 0x7fffea, 23 }, { 0x3fffdd, 22 }, { 0x3fffde, 22 }, { 0xfffff0, 24 }, { 0x1fffdf, 21 }, { 0x3fffdf, 22 },
+            { 0x7fffeb, 23 }, { 0x7fffec, 23 }, { 0x1fffe0, 21 }, { 0x1fffe1, 21 }, { 0x3fffe0, 22 }, { 0x1fffe2, 21 },
+            { 0x7fffed, 23 }, { 0x3fffe1, 22 }, { 0x7fffee, 23 }, { 0x7fffef, 23 }, { 0xfffea, 20 }, { 0x3fffe2, 22 },
+            { 0x3fffe3, 22 }, { 0x3fffe4, 22 }, { 0x7ffff0, 23 }, { 0x3fffe5, 22 }, { 0x3fffe6, 22 }, { 0x7ffff1, 23 },
+            { 0x3ffffe0, 26 }, { 0x3ffffe1, 26 }, { 0xfffeb, 20 }, { 0x7fff1, 19 }, { 0x3fffe7, 22 }, { 0x7ffff2, 23 },
+            { 0x3fffe8, 22 }, { 0x1ffffec, 25 }, { 0x3ffffe2, 26 }, { 0x3ffffe3, 26 }, { 0x3ffffe4, 26 }, { 0x7ffffde, 27 },
+            { 0x7ffffdf, 27 }, { 0x3ffffe5, 26 }, { 0xfffff1, 24 }, { 0x1ffffed, 25 }, { 0x7fff2, 19 }, { 0x1fffe3, 21 },
+            { 0x3ffffe6, 26 }, { 0x7ffffe0, 27 }, { 0x7ffffe1, 27 }, { 0x3ffffe7, 26 }, { 0x7ffffe2, 27 }, { 0xfffff2, 24 },
+            { 0x1fffe4, 21 }, { 0x1fffe5, 21 }, { 0x3ffffe8, 26 }, { 0x3ffffe9, 26 }, { 0xffffffd, 28 }, { 0x7ffffe3, 27 },
+            { 0x7ffffe4, 27 }, { 0x7ffffe5, 27 }, { 0xfffec, 20 }, { 0xfffff3, 24 }, { 0xfffed, 20 }, { 0x1fffe6, 21 },
+            { 0x3fffe9, 22 }, { 0x1fffe7, 21 }, { 0x1fffe8, 21 }, { 0x7ffff3, 23 }, { 0x3fffea, 22 }, { 0x3fffeb, 22 },
+            { 0x1ffffee, 25 }, { 0x1ffffef, 25 }, { 0xfffff4, 24 }, { 0xfffff5, 24 }, { 0x3ffffea, 26 }, { 0x7ffff4, 23 },
+            { 0x3ffffeb, 26 }, { 0x7ffffe6, 27 }, { 0x3ffffec, 26 }, { 0x3ffffed, 26 }, { 0x7ffffe7, 27 }, { 0x7ffffe8, 27 },
+            { 0x7ffffe9, 27 }, { 0x7ffffea, 27 }, { 0x7ffffeb, 27 }, { 0xffffffe, 28 }, { 0x7ffffec, 27 }, { 0x7ffffed, 27 },
+            { 0x7ffffee, 27 }, { 0x7ffffef, 27 }, { 0x7fffff0, 27 }, { 0x3ffffee, 26 }, { 0x3fffffff, 30 },
+        };
+        return codes;
+    }
+
+    /**
+     * @class HuffmanDecoder
+     * @brief Bitwise walk of the Huffman code tree, built once
+     */
+    class HuffmanDecoder {
+    public:
+        /**
+         * @brief Decode a Huffman-coded string
+         * @param data Coded bytes
+         * @param size Coded size
+         * @param out Decoded string (appended)
+         * @return false on EOS, overlong or non-EOS padding
+         */
+        static bool decode(const uint8_t* data, size_t size, std::string& out) {
+            const Tree& tree = instance();
+            int node = 0;
+            unsigned depth = 0;     // bits since the last symbol
+            bool all_ones = true;   // those bits were all 1 (valid padding so far)
+            for (size_t i = 0; i < size; ++i) {
+                for (int bit = 7; bit >= 0; --bit) {
+                    const int one = (data[i] >> bit) & 1;
+                    const int16_t next = tree.nodes[node][one];
+                    ++depth;
+                    all_ones = all_ones && one;
+                    if (next < 0) {
+                        const int symbol = -next - 1;
+                        if (symbol == 256) {
+                            return false;
+                        }
+                        out += static_cast<char>(symbol);
+                        node = 0;
+                        depth = 0;
+                        all_ones = true;
+                    } else if (next == 0) {
+                        return false;
+                    } else {
+                        node = next;
+                    }
+                }
+            }
+            return depth < 8 && all_ones;
+        }
+
+    private:
+        struct Tree {
+            int16_t nodes[256][2]{};    ///< Child per bit: >0 inner node, <0 -(symbol + 1), 0 none
+        };
+
+        static const Tree& instance() {
+            static const Tree tree = build();
+            return tree;
+        }
+
+        static Tree build() {
+            Tree tree;
+            int16_t used = 1;
+            const HuffmanCode* codes = huffmanCodes();
+            for (int symbol = 0; symbol < 257; ++symbol) {
+                int node = 0;
+                for (int bit = codes[symbol].bits - 1; bit >= 0; --bit) {
+                    const int one = (codes[symbol].code >> bit) & 1;
+                    if (bit == 0) {
+                        tree.nodes[node][one] = static_cast<int16_t>(-symbol - 1);
+                    } else {
+                        if (tree.nodes[node][one] == 0) {
+                            tree.nodes[node][one] = used++;
+                        }
+                        node = tree.nodes[node][one];
+                    }
+                }
+            }
+            return tree;
+        }
+    };
+
+    /**
+     * @class Decoder
+     * @brief Header block decoder with its dynamic table (one per connection)
+     */
+    class Decoder {
+    public:
+        /**
+         * @brief Decoding outcome
+         */
+        enum class Status {
+            OK,             ///< Headers decoded
+            TOO_LARGE,      ///< Block decoded, but the header list exceeded the limit (headers incomplete)
+            ERROR           ///< Malformed block: a connection error (COMPRESSION_ERROR)
+        };
+
+        /**
+         * @brief Create a decoder
+         * @param max_table_size SETTINGS_HEADER_TABLE_SIZE we advertised
+         * @param max_header_list_size Largest decoded header list accepted (RFC 7540 sizing)
+         */
+        explicit Decoder(size_t max_table_size = 4096, size_t max_header_list_size = 64 * 1024)
+            : max_table_size_(max_table_size), table_limit_(max_table_size),
+            max_header_list_size_(max_header_list_size) {
+        }
+
+        /**
+         * @brief Decode one complete header block
+         * @param data Block (HEADERS plus CONTINUATION fragments, concatenated)
+         * @param size Block size
+         * @param headers Decoded headers, in order
+         * @return Status
+         */
+        Status decode(const uint8_t* data, size_t size, std::vector<Header>& headers) {
+            const uint8_t* p = data;
+            const uint8_t* end = data + size;
+            size_t list_size = 0;
+            bool too_large = false;
+            bool block_start = true;
+
+            while (p < end) {
+                const uint8_t first = *p;
+                Header header;
+                if (first & 0x80) {
+                    // Indexed header field
+                    uint64_t index = 0;
+                    if (!readInteger(p, end, 7, index) || !lookup(index, header.first, &header.second)) {
+                        return Status::ERROR;
+                    }
+                } else if ((first & 0xE0) == 0x20) {
+                    // Dynamic table size update: only at the start of a block
+                    uint64_t limit = 0;
+                    if (!block_start || !readInteger(p, end, 5, limit) || limit > max_table_size_) {
+                        return Status::ERROR;
+                    }
+                    table_limit_ = static_cast<size_t>(limit);
+                    evict(0);
+                    continue;
+                } else {
+                    // Literal: with incremental indexing (01), without (0000) or never indexed (0001)
+                    const bool indexing = (first & 0xC0) == 0x40;
+                    uint64_t index = 0;
+                    if (!readInteger(p, end, indexing ? 6 : 4, index)) {
+                        return Status::ERROR;
+                    }
+                    if (index == 0 ? !readString(p, end, header.first) : !lookup(index, header.first, nullptr)) {
+                        return Status::ERROR;
+                    }
+                    if (!readString(p, end, header.second)) {
+                        return Status::ERROR;
+                    }
+                    if (indexing) {
+                        insert(header);
+                    }
+                }
+                block_start = false;
+
+                list_size += header.first.size() + header.second.size() + ENTRY_OVERHEAD;
+                if (list_size > max_header_list_size_) {
+                    too_large = true;   // keep decoding so the dynamic table stays in step
+                } else {
+                    headers.push_back(std::move(header));
+                }
+            }
+            return too_large ? Status::TOO_LARGE : Status::OK;
+        }
+
+        /**
+         * @brief Get the dynamic table's current size (RFC 7541 accounting)
+         */
+        size_t getTableSize() const { return table_size_; }
+
+    private:
+        static bool readInteger(const uint8_t*& p, const uint8_t* end, int prefix_bits, uint64_t& value) {
+            if (p >= end) {
+                return false;
+            }
+            const uint8_t mask = static_cast<uint8_t>((1u << prefix_bits) - 1);
+            value = *p++ & mask;
+            if (value < mask) {
+                return true;
+            }
+            for (int shift = 0; shift <= 28; shift += 7) {
+                if (p >= end) {
+                    return false;
+                }
+                const uint8_t byte = *p++;
+                value += static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return value <= 0x7FFFFFFF;
+                }
+            }
+            return false;
+        }
+
+        static bool readString(const uint8_t*& p, const uint8_t* end, std::string& out) {
+            if (p >= end) {
+                return false;
+            }
+            const bool huffman = (*p & 0x80) != 0;
+            uint64_t length = 0;
+            if (!readInteger(p, end, 7, length) || length > static_cast<uint64_t>(end - p)) {
+                return false;
+            }
+            const size_t size = static_cast<size_t>(length);
+            if (huffman) {
+                out.reserve(size * 8 / 5);
+                if (!HuffmanDecoder::decode(p, size, out)) {
+                    return false;
+                }
+            } else {
+                out.assign(reinterpret_cast<const char*>(p), size);
+            }
+            p += size;
+            return true;
+        }
+
+        bool lookup(uint64_t index, std::string& name, std::string* value) const {
+            if (index == 0) {
+                return false;
+            }
+            if (index <= STATIC_TABLE_SIZE) {
+                const StaticEntry& entry = staticTable()[index - 1];
+                name = entry.name;
+                if (value) {
+                    *value = entry.value;
+                }
+                return true;
+            }
+            const uint64_t dynamic = index - STATIC_TABLE_SIZE - 1;
+            if (dynamic >= dynamic_.size()) {
+                return false;
+            }
+            name = dynamic_[static_cast<size_t>(dynamic)].first;
+            if (value) {
+                *value = dynamic_[static_cast<size_t>(dynamic)].second;
+            }
+            return true;
+        }
+
+        void insert(const Header& header) {
+            const size_t size = header.first.size() + header.second.size() + ENTRY_OVERHEAD;
+            if (size > table_limit_) {
+                // Larger than the whole table: empties it (RFC 7541 4.4)
+                dynamic_.clear();
+                table_size_ = 0;
+                return;
+            }
+            evict(size);
+            dynamic_.push_front(header);
+            table_size_ += size;
+        }
+
+        /// Evict oldest entries until size more bytes fit
+        void evict(size_t size) {
+            while (!dynamic_.empty() && table_size_ + size > table_limit_) {
+                const Header& oldest = dynamic_.back();
+                table_size_ -= oldest.first.size() + oldest.second.size() + ENTRY_OVERHEAD;
+                dynamic_.pop_back();
+            }
+        }
+
+        size_t max_table_size_;             ///< Upper bound for size updates (our setting)
+        size_t table_limit_;                ///< Current limit chosen by the encoder
+        size_t max_header_list_size_;
+        size_t table_size_{ 0 };
+        std::deque<Header> dynamic_;        ///< Newest first
+    };
+
+    /**
+     * @class Encoder
+     * @brief Stateless header block encoder
+     */
+    class Encoder {
+    public:
+        /**
+         * @brief Encode headers as one block
+         * @param headers Headers (names must be lowercase)
+         * @param out Block (appended)
+         */
+        static void encode(const std::vector<Header>& headers, Buffer& out) {
+            for (const Header& header : headers) {
+                size_t name_index = 0;
+                size_t full_index = 0;
+                for (size_t i = 0; i < STATIC_TABLE_SIZE; ++i) {
+                    const StaticEntry& entry = staticTable()[i];
+                    if (header.first == entry.name) {
+                        if (name_index == 0) {
+                            name_index = i + 1;
+                        }
+                        if (header.second == entry.value) {
+                            full_index = i + 1;
+                            break;
+                        }
+                    }
+                }
+                if (full_index != 0) {
+                    writeInteger(out, 0x80, 7, full_index);
+                    continue;
+                }
+                // Literal without indexing
+                writeInteger(out, 0x00, 4, name_index);
+                if (name_index == 0) {
+                    writeString(out, header.first);
+                }
+                writeString(out, header.second);
+            }
+        }
+
+    private:
+        static void writeInteger(Buffer& out, uint8_t flags, int prefix_bits, uint64_t value) {
+            const uint64_t mask = (1u << prefix_bits) - 1;
+            if (value < mask) {
+                out.push_back(static_cast<uint8_t>(flags | value));
+                return;
+            }
+            out.push_back(static_cast<uint8_t>(flags | mask));
+            value -= mask;
+            while (value >= 0x80) {
+                out.push_back(static_cast<uint8_t>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        static void writeString(Buffer& out, const std::string& text) {
+            writeInteger(out, 0x00, 7, text.size());
+            out.insert(out.end(), text.begin(), text.end());
+        }
+    };
+
+} // namespace Hpack
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_HPACK_HPP
@@ -0,0 +1,1005 @@
+#pragma once
+#ifndef WEBSOCKET_HTTP2_CONNECTION_HPP
+#define WEBSOCKET_HTTP2_CONNECTION_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include "Hpack.hpp"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class Http2Connection
+ * @brief Server side of one HTTP/2 connection (RFC 9113), without I/O
+ *
+ * Bytes read from the socket go into receive(); frames to send collect in
+ * an output buffer the caller drains with takeOutput() after every call.
+ * Requests are handed to on_request, which answers with a response; a 2xx
+ * answer to a CONNECT keeps the stream open as a tunnel, which is how
+ * WebSockets run over HTTP/2 (RFC 8441 extended CONNECT). The server
+ * advertises SETTINGS_ENABLE_CONNECT_PROTOCOL so clients may send
+ * ":protocol".
+ *
+ * Flow control:
+ * - outbound DATA is limited by the peer's stream and connection windows
+ *   and by its maximum frame size; streams with queued data are served
+ *   round-robin, one frame per stream per pass
+ * - the inbound stream window is only credited when the application calls
+ *   consume(), so a stream whose data is not being processed stops the
+ *   peer from sending more on that stream; the connection window is
+ *   credited as data arrives, since per-stream windows already bound what
+ *   is buffered
+ *
+ * Protocol violations that affect the whole connection queue a GOAWAY and
+ * make receive() return false; the caller then flushes and closes.
+ * Violations confined to a stream reset only that stream.
+ *
+ * @note Not thread-safe; callbacks run inside the call that triggered them
+ *       and may call back into the connection.
+ */
+class Http2Connection : public NonCopyable {
+public:
+    /**
+     * @brief Frame types
+     */
+    enum class FrameType : uint8_t {
+        DATA = 0x0,
+        HEADERS = 0x1,
+        PRIORITY = 0x2,
+        RST_STREAM = 0x3,
+        SETTINGS = 0x4,
+        PUSH_PROMISE = 0x5,
+        PING = 0x6,
+        GOAWAY = 0x7,
+        WINDOW_UPDATE = 0x8,
+        CONTINUATION = 0x9
+    };
+
+    /**
+     * @brief Error codes carried by RST_STREAM and GOAWAY
+     */
+    enum class ErrorCode : uint32_t {
+        NONE = 0x0,                 ///< NO_ERROR (graceful)
+        PROTOCOL_ERROR = 0x1,
+        INTERNAL_ERROR = 0x2,
+        FLOW_CONTROL_ERROR = 0x3,
+        SETTINGS_TIMEOUT = 0x4,
+        STREAM_CLOSED = 0x5,
+        FRAME_SIZE_ERROR = 0x6,
+        REFUSED_STREAM = 0x7,
+        CANCEL = 0x8,
+        COMPRESSION_ERROR = 0x9,
+        CONNECT_ERROR = 0xa,
+        ENHANCE_YOUR_CALM = 0xb,
+        INADEQUATE_SECURITY = 0xc,
+        HTTP_1_1_REQUIRED = 0xd
+    };
+
+    /**
+     * @brief Connection configuration
+     */
+    struct Config {
+        uint32_t max_concurrent_streams{ 100 };         ///< Open streams the peer may have
+        uint32_t initial_window_size{ 64 * 1024 };      ///< Per-stream inbound window (at least 65535)
+        uint32_t connection_window_size{ 1024 * 1024 }; ///< Connection inbound window
+        uint32_t max_frame_size{ 16384 };               ///< Largest inbound frame payload (16384 - 16777215)
+        size_t max_header_list_size{ 16 * 1024 };       ///< Largest decoded request header list
+        size_t stream_buffer_limit{ 1024 * 1024 };      ///< Outbound bytes queued per stream before send() fails
+        size_t stream_high_water{ 64 * 1024 };          ///< on_writable fires once queued bytes drop below this
+    };
+
+    /**
+     * @brief Decoded request
+     */
+    struct Request {
+        uint32_t stream_id{ 0 };
+        std::string method;                             ///< :method
+        std::string protocol;                           ///< :protocol (extended CONNECT only)
+        std::string scheme;                             ///< :scheme
+        std::string authority;                          ///< :authority
+        std::string path;                               ///< :path
+        std::vector<Hpack::Header> headers;             ///< Regular headers, in order (lowercase names)
+
+        /**
+         * @brief Get a header value
+         * @param name Lowercase header name
+         * @return Values of every field with that name joined by ", " (empty if absent)
+         */
+        std::string header(const std::string& name) const {
+            std::string value;
+            for (const auto& field : headers) {
+                if (field.first == name) {
+                    value += value.empty() ? field.second : ", " + field.second;
+                }
+            }
+            return value;
+        }
+    };
+
+    /**
+     * @brief Response to a request
+     */
+    struct Response {
+        int status{ 200 };                              ///< 2xx to a CONNECT opens a tunnel
+        std::vector<Hpack::Header> headers;             ///< Lowercase names
+    };
+
+    /**
+     * @brief Application callbacks
+     */
+    struct Callbacks {
+        std::function<Response(const Request&)> on_request;                         ///< Required
+        std::function<void(uint32_t stream, const uint8_t* data, size_t size)> on_data; ///< Tunnel data; call consume() once processed
+        std::function<void(uint32_t stream, ErrorCode code)> on_stream_close;       ///< Peer ended (NONE) or reset a tunnel; fires once
+        std::function<void(uint32_t stream)> on_writable;                           ///< Queued output dropped below stream_high_water
+    };
+
+    /**
+     * @brief Connection statistics
+     */
+    struct Stats {
+        uint64_t streams_opened{ 0 };                   ///< Tunnels accepted
+        uint64_t streams_rejected{ 0 };                 ///< Requests answered with a non-tunnel response
+        uint64_t streams_refused{ 0 };                  ///< Refused over max_concurrent_streams or after GOAWAY
+        uint64_t streams_reset{ 0 };                    ///< RST_STREAM sent
+        uint64_t bytes_in{ 0 };                         ///< DATA payload received
+        uint64_t bytes_out{ 0 };                        ///< DATA payload sent
+        uint64_t window_updates{ 0 };                   ///< WINDOW_UPDATE frames sent
+        uint64_t flow_blocked{ 0 };                     ///< Passes where queued data waited for a peer window
+    };
+
+    /// Client connection preface
+    static constexpr char PREFACE[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+    static constexpr size_t PREFACE_SIZE = sizeof(PREFACE) - 1;
+
+    /**
+     * @brief Create a connection and queue the server preface (SETTINGS)
+     * @param callbacks Application callbacks
+     * @param config Limits and windows
+     */
+    Http2Connection(Callbacks callbacks, const Config& config)
+        : callbacks_(std::move(callbacks)), config_(config),
+        decoder_(4096, config.max_header_list_size) {
+        config_.initial_window_size = std::clamp<uint32_t>(config_.initial_window_size, 65535, MAX_WINDOW);
+        config_.connection_window_size = std::clamp<uint32_t>(config_.connection_window_size, 65535, MAX_WINDOW);
+        config_.max_frame_size = std::clamp<uint32_t>(config_.max_frame_size, 16384, 16777215);
+        conn_recv_window_ = config_.connection_window_size;
+
+        Buffer settings;
+        auto setting = [&settings](uint16_t id, uint32_t value) {
+            appendUint16(settings, id);
+            appendUint32(settings, value);
+        };
+        setting(SETTINGS_MAX_CONCURRENT_STREAMS, config_.max_concurrent_streams);
+        setting(SETTINGS_INITIAL_WINDOW_SIZE, config_.initial_window_size);
+        setting(SETTINGS_MAX_FRAME_SIZE, config_.max_frame_size);
+        setting(SETTINGS_MAX_HEADER_LIST_SIZE, static_cast<uint32_t>(config_.max_header_list_size));
+        setting(SETTINGS_ENABLE_CONNECT_PROTOCOL, 1);
+        writeFrame(FrameType::SETTINGS, 0, 0, settings.data(), settings.size());
+        if (config_.connection_window_size > 65535) {
+            writeWindowUpdate(0, config_.connection_window_size - 65535);
+        }
+    }
+
+    explicit Http2Connection(Callbacks callbacks) : Http2Connection(std::move(callbacks), Config{}) {}
+
+    /**
+     * @brief Process bytes received from the peer
+     * @param data Received bytes
+     * @param size Byte count
+     * @return false if the connection failed (flush the output, then close)
+     */
+    bool receive(const uint8_t* data, size_t size) {
+        if (failed_) {
+            return false;
+        }
+        input_.insert(input_.end(), data, data + size);
+        size_t offset = 0;
+
+        if (!preface_received_) {
+            const size_t compare = std::min(input_.size(), PREFACE_SIZE);
+            if (std::memcmp(input_.data(), PREFACE, compare) != 0) {
+                fail(ErrorCode::PROTOCOL_ERROR);
+                return false;
+            }
+            if (input_.size() < PREFACE_SIZE) {
+                return true;
+            }
+            preface_received_ = true;
+            offset = PREFACE_SIZE;
+        }
+
+        while (!failed_ && input_.size() - offset >= FRAME_HEADER_SIZE) {
+            const uint8_t* header = input_.data() + offset;
+            const uint32_t length = (static_cast<uint32_t>(header[0]) << 16) | (header[1] << 8) | header[2];
+            if (length > config_.max_frame_size) {
+                fail(ErrorCode::FRAME_SIZE_ERROR);
+                break;
+            }
+            if (input_.size() - offset < FRAME_HEADER_SIZE + length) {
+                break;
+            }
+            const FrameType type = static_cast<FrameType>(header[3]);
+            const uint8_t flags = header[4];
+            const uint32_t stream = readUint32(header + 5) & 0x7FFFFFFF;
+            processFrame(type, flags, stream, header + FRAME_HEADER_SIZE, length);
+            offset += FRAME_HEADER_SIZE + length;
+        }
+        input_.erase(input_.begin(), input_.begin() + static_cast<std::ptrdiff_t>(std::min(offset, input_.size())));
+        flush();
+        return !failed_;
+    }
+
+    /**
+     * @brief Take the frames queued for the peer
+     * @return Bytes to write (empty if nothing is queued)
+     */
+    Buffer takeOutput() {
+        Buffer output;
+        output.swap(output_);
+        return output;
+    }
+
+    /**
+     * @brief Check if frames are queued for the peer
+     */
+    bool hasOutput() const { return !output_.empty(); }
+
+    /**
+     * @brief Queue tunnel data for a stream
+     * @param stream Stream id
+     * @param data Bytes
+     * @param size Byte count
+     * @return false if the stream is not open for sending or its queue is over stream_buffer_limit
+     */
+    bool send(uint32_t stream, const uint8_t* data, size_t size) {
+        auto it = streams_.find(stream);
+        if (it == streams_.end() || it->second.local_closed ||
+            it->second.pending.size() - it->second.pending_offset + size > config_.stream_buffer_limit) {
+            return false;
+        }
+        Stream& state = it->second;
+        state.pending.insert(state.pending.end(), data, data + size);
+        if (state.pending.size() - state.pending_offset >= config_.stream_high_water) {
+            state.above_high_water = true;
+        }
+        flush();
+        return true;
+    }
+
+    /**
+     * @brief Report tunnel data as processed, crediting the stream's inbound window
+     * @param stream Stream id
+     * @param size Bytes processed (as delivered to on_data)
+     */
+    void consume(uint32_t stream, size_t size) {
+        auto it = streams_.find(stream);
+        if (it == streams_.end() || it->second.remote_closed || size == 0) {
+            return;
+        }
+        Stream& state = it->second;
+        state.recv_credit += size;
+        // Batch updates; the peer still has most of its window meanwhile
+        if (state.recv_credit >= config_.initial_window_size / 4) {
+            state.recv_window += static_cast<int64_t>(state.recv_credit);
+            writeWindowUpdate(stream, static_cast<uint32_t>(state.recv_credit));
+            state.recv_credit = 0;
+        }
+    }
+
+    /**
+     * @brief End a tunnel from our side once its queued data is sent (END_STREAM)
+     * @param stream Stream id
+     */
+    void closeStream(uint32_t stream) {
+        auto it = streams_.find(stream);
+        if (it == streams_.end() || it->second.local_closed) {
+            return;
+        }
+        it->second.local_closed = true;
+        flush();
+    }
+
+    /**
+     * @brief Abort a stream (RST_STREAM), dropping its queued data
+     * @param stream Stream id
+     * @param code Error code sent to the peer
+     *
+     * @note on_stream_close does not fire for a stream the application resets
+     */
+    void resetStream(uint32_t stream, ErrorCode code) {
+        auto it = streams_.find(stream);
+        if (it == streams_.end()) {
+            return;
+        }
+        it->second.notified = true;
+        sendReset(stream, code);
+    }
+
+    /**
+     * @brief Stop accepting streams (graceful GOAWAY); open tunnels keep running
+     */
+    void goAway() {
+        if (!goaway_sent_) {
+            writeGoAway(ErrorCode::NONE);
+        }
+    }
+
+    /**
+     * @brief Check if a tunnel accepts send()
+     * @param stream Stream id
+     */
+    bool isOpen(uint32_t stream) const {
+        auto it = streams_.find(stream);
+        return it != streams_.end() && it->second.responded && !it->second.local_closed;
+    }
+
+    /**
+     * @brief Get the bytes queued on a stream and not yet sent
+     * @param stream Stream id
+     */
+    size_t pendingBytes(uint32_t stream) const {
+        auto it = streams_.find(stream);
+        return it == streams_.end() ? 0 : it->second.pending.size() - it->second.pending_offset;
+    }
+
+    /**
+     * @brief Get the number of streams not yet closed in both directions
+     */
+    size_t activeStreams() const { return streams_.size(); }
+
+    /**
+     * @brief Check if the connection failed or was shut down
+     */
+    bool isFailed() const { return failed_; }
+
+    /**
+     * @brief Get connection statistics
+     */
+    const Stats& getStats() const { return stats_; }
+
+private:
+    static constexpr size_t FRAME_HEADER_SIZE = 9;
+    static constexpr uint32_t MAX_WINDOW = 0x7FFFFFFF;
+
+    static constexpr uint8_t FLAG_END_STREAM = 0x1;
+    static constexpr uint8_t FLAG_ACK = 0x1;
+    static constexpr uint8_t FLAG_END_HEADERS = 0x4;
+    static constexpr uint8_t FLAG_PADDED = 0x8;
+    static constexpr uint8_t FLAG_PRIORITY = 0x20;
+
+    static constexpr uint16_t SETTINGS_HEADER_TABLE_SIZE = 0x1;
+    static constexpr uint16_t SETTINGS_ENABLE_PUSH = 0x2;
+    static constexpr uint16_t SETTINGS_MAX_CONCURRENT_STREAMS = 0x3;
+    static constexpr uint16_t SETTINGS_INITIAL_WINDOW_SIZE = 0x4;
+    static constexpr uint16_t SETTINGS_MAX_FRAME_SIZE = 0x5;
+    static constexpr uint16_t SETTINGS_MAX_HEADER_LIST_SIZE = 0x6;
+    static constexpr uint16_t SETTINGS_ENABLE_CONNECT_PROTOCOL = 0x8;
+
+    struct Stream {
+        int64_t send_window{ 0 };           ///< Peer's window for our DATA
+        int64_t recv_window{ 0 };           ///< What the peer may still send us
+        size_t recv_credit{ 0 };            ///< Consumed, not yet returned in a WINDOW_UPDATE
+        Buffer pending;                     ///< Queued outbound data
+        size_t pending_offset{ 0 };         ///< Already sent prefix of pending
+        bool responded{ false };            ///< Tunnel response sent; DATA may follow
+        bool local_closed{ false };         ///< closeStream() called
+        bool end_sent{ false };             ///< Our END_STREAM is out
+        bool remote_closed{ false };        ///< Peer's END_STREAM received
+        bool notified{ false };             ///< on_stream_close fired (or suppressed)
+        bool above_high_water{ false };     ///< on_writable owed once pending drains
+    };
+
+    static void appendUint16(Buffer& out, uint16_t value) {
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static void appendUint32(Buffer& out, uint32_t value) {
+        out.push_back(static_cast<uint8_t>(value >> 24));
+        out.push_back(static_cast<uint8_t>(value >> 16));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static uint32_t readUint32(const uint8_t* p) {
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+            (static_cast<uint32_t>(p[2]) << 8) | p[3];
+    }
+
+    void writeFrame(FrameType type, uint8_t flags, uint32_t stream, const uint8_t* payload, size_t size) {
+        output_.push_back(static_cast<uint8_t>(size >> 16));
+        output_.push_back(static_cast<uint8_t>(size >> 8));
+        output_.push_back(static_cast<uint8_t>(size));
+        output_.push_back(static_cast<uint8_t>(type));
+        output_.push_back(flags);
+        appendUint32(output_, stream);
+        if (size != 0) {
+            output_.insert(output_.end(), payload, payload + size);
+        }
+    }
+
+    void writeWindowUpdate(uint32_t stream, uint32_t increment) {
+        Buffer payload;
+        appendUint32(payload, increment);
+        writeFrame(FrameType::WINDOW_UPDATE, 0, stream, payload.data(), payload.size());
+        ++stats_.window_updates;
+    }
+
+    void writeGoAway(ErrorCode code) {
+        Buffer payload;
+        appendUint32(payload, last_stream_id_);
+        appendUint32(payload, static_cast<uint32_t>(code));
+        writeFrame(FrameType::GOAWAY, 0, 0, payload.data(), payload.size());
+        goaway_sent_ = true;
+    }
+
+    void writeHeaders(uint32_t stream, const Response& response, bool end_stream) {
+        std::vector<Hpack::Header> fields;
+        fields.reserve(response.headers.size() + 1);
+        fields.emplace_back(":status", std::to_string(response.status));
+        fields.insert(fields.end(), response.headers.begin(), response.headers.end());
+        Buffer block;
+        Hpack::Encoder::encode(fields, block);
+
+        // HEADERS, then CONTINUATION for whatever exceeds the peer's frame size
+        size_t offset = 0;
+        FrameType type = FrameType::HEADERS;
+        do {
+            const size_t chunk = std::min<size_t>(block.size() - offset, peer_max_frame_size_);
+            uint8_t flags = offset + chunk == block.size() ? FLAG_END_HEADERS : 0;
+            if (type == FrameType::HEADERS && end_stream) {
+                flags |= FLAG_END_STREAM;
+            }
+            writeFrame(type, flags, stream, block.data() + offset, chunk);
+            offset += chunk;
+            type = FrameType::CONTINUATION;
+        } while (offset < block.size());
+    }
+
+    /// Connection error: GOAWAY, then every tunnel is closed
+    void fail(ErrorCode code) {
+        if (failed_) {
+            return;
+        }
+        failed_ = true;
+        writeGoAway(code);
+        std::vector<uint32_t> tunnels;
+        for (const auto& entry : streams_) {
+            if (entry.second.responded && !entry.second.notified) {
+                tunnels.push_back(entry.first);
+            }
+        }
+        streams_.clear();
+        for (const uint32_t id : tunnels) {
+            if (callbacks_.on_stream_close) {
+                callbacks_.on_stream_close(id, ErrorCode::CANCEL);
+            }
+        }
+    }
+
+    /// Stream error: RST_STREAM and forget the stream
+    void sendReset(uint32_t stream, ErrorCode code) {
+        Buffer payload;
+        appendUint32(payload, static_cast<uint32_t>(code));
+        writeFrame(FrameType::RST_STREAM, 0, stream, payload.data(), payload.size());
+        ++stats_.streams_reset;
+        finishStream(stream, code);
+    }
+
+    /// Forget a stream, telling the application if it was a tunnel it has not heard closing
+    void finishStream(uint32_t stream, ErrorCode code) {
+        auto it = streams_.find(stream);
+        if (it == streams_.end()) {
+            return;
+        }
+        const bool notify = it->second.responded && !it->second.notified;
+        streams_.erase(it);
+        if (notify && callbacks_.on_stream_close) {
+            callbacks_.on_stream_close(stream, code);
+        }
+    }
+
+    /// An id at or below the highest opened one that is not in streams_ is closed
+    bool isIdle(uint32_t stream) const { return stream > last_stream_id_; }
+
+    void processFrame(FrameType type, uint8_t flags, uint32_t stream, const uint8_t* payload, uint32_t length) {
+        if (!settings_received_ && type != FrameType::SETTINGS) {
+            fail(ErrorCode::PROTOCOL_ERROR);    // the preface must be followed by SETTINGS
+            return;
+        }
+        if (continuation_stream_ != 0 && (type != FrameType::CONTINUATION || stream != continuation_stream_)) {
+            fail(ErrorCode::PROTOCOL_ERROR);    // header blocks may not be interleaved
+            return;
+        }
+
+        switch (type) {
+        case FrameType::DATA:
+            onData(flags, stream, payload, length);
+            break;
+        case FrameType::HEADERS:
+            onHeaders(flags, stream, payload, length);
+            break;
+        case FrameType::CONTINUATION:
+            if (continuation_stream_ == 0) {
+                fail(ErrorCode::PROTOCOL_ERROR);
+                return;
+            }
+            appendHeaderBlock(payload, length, flags);
+            break;
+        case FrameType::PRIORITY:
+            if (stream == 0) {
+                fail(ErrorCode::PROTOCOL_ERROR);
+            } else if (length != 5) {
+                sendReset(stream, ErrorCode::FRAME_SIZE_ERROR);
+            }
+            break;  // prioritisation is not implemented; the frame is otherwise ignored
+        case FrameType::RST_STREAM:
+            if (stream == 0 || isIdle(stream)) {
+                fail(ErrorCode::PROTOCOL_ERROR);
+            } else if (length != 4) {
+                fail(ErrorCode::FRAME_SIZE_ERROR);
+            } else {
+                finishStream(stream, static_cast<ErrorCode>(readUint32(payload)));
+            }
+            break;
+        case FrameType::SETTINGS:
+            onSettings(flags, stream, payload, length);
+            break;
+        case FrameType::PUSH_PROMISE:
+            fail(ErrorCode::PROTOCOL_ERROR);    // clients never push
+            break;
+        case FrameType::PING:
+            if (stream != 0) {
+                fail(ErrorCode::PROTOCOL_ERROR);
+            } else if (length != 8) {
+                fail(ErrorCode::FRAME_SIZE_ERROR);
+            } else if ((flags & FLAG_ACK) == 0) {
+                writeFrame(FrameType::PING, FLAG_ACK, 0, payload, length);
+            }
+            break;
+        case FrameType::GOAWAY:
+            if (stream != 0) {
+                fail(ErrorCode::PROTOCOL_ERROR);
+            } else if (length < 8) {
+                fail(ErrorCode::FRAME_SIZE_ERROR);
+            }
+            break;  // the client opens no new streams; existing tunnels finish normally
+        case FrameType::WINDOW_UPDATE:
+            onWindowUpdate(stream, payload, length);
+            break;
+        default:
+            break;  // unknown frame types are ignored
+        }
+    }
+
+    void onSettings(uint8_t flags, uint32_t stream, const uint8_t* payload, uint32_t length) {
+        if (stream != 0) {
+            fail(ErrorCode::PROTOCOL_ERROR);
+            return;
+        }
+        if (flags & FLAG_ACK) {
+            if (length != 0) {
+                fail(ErrorCode::FRAME_SIZE_ERROR);
+            }
+            return;
+        }
+        if (length % 6 != 0) {
+            fail(ErrorCode::FRAME_SIZE_ERROR);
+            return;
+        }
+        for (uint32_t i = 0; i < length; i += 6) {
+            const uint16_t id = static_cast<uint16_t>((payload[i] << 8) | payload[i + 1]);
+            const uint32_t value = readUint32(payload + i + 2);
+            switch (id) {
+            case SETTINGS_ENABLE_PUSH:
+                if (value > 1) {
+                    fail(ErrorCode::PROTOCOL_ERROR);
+                    return;
+                }
+                break;
+            case SETTINGS_INITIAL_WINDOW_SIZE: {
+                if (value > MAX_WINDOW) {
+                    fail(ErrorCode::FLOW_CONTROL_ERROR);
+                    return;
+                }
+                // Applies to open streams as a delta (RFC 9113 6.9.2)
+                const int64_t delta = static_cast<int64_t>(value) - peer_initial_window_;
+                peer_initial_window_ = value;
+                for (auto& entry : streams_) {
+                    entry.second.send_window += delta;
+                    if (entry.second.send_window > MAX_WINDOW) {
+                        fail(ErrorCode::FLOW_CONTROL_ERROR);
+                        return;
+                    }
+                }
+                break;
+            }
+            case SETTINGS_MAX_FRAME_SIZE:
+                if (value < 16384 || value > 16777215) {
+                    fail(ErrorCode::PROTOCOL_ERROR);
+                    return;
+                }
+                peer_max_frame_size_ = value;
+                break;
+            default:
+                break;  // HEADER_TABLE_SIZE is moot (the encoder never indexes); others are advisory
+            }
+        }
+        settings_received_ = true;
+        writeFrame(FrameType::SETTINGS, FLAG_ACK, 0, nullptr, 0);
+    }
+
+    void onWindowUpdate(uint32_t stream, const uint8_t* payload, uint32_t length) {
+        if (length != 4) {
+            fail(ErrorCode::FRAME_SIZE_ERROR);
+            return;
+        }
+        const uint32_t increment = readUint32(payload) & 0x7FFFFFFF;
+        if (stream == 0) {
+            if (increment == 0) {
+                fail(ErrorCode::PROTOCOL_ERROR);
+            } else if ((conn_send_window_ += increment) > MAX_WINDOW) {
+                fail(ErrorCode::FLOW_CONTROL_ERROR);
+            }
+            return;
+        }
+        if (isIdle(stream)) {
+            fail(ErrorCode::PROTOCOL_ERROR);
+            return;
+        }
+        auto it = streams_.find(stream);
+        if (it == streams_.end()) {
+            return;     // may race with the stream closing
+        }
+        if (increment == 0) {
+            sendReset(stream, ErrorCode::PROTOCOL_ERROR);
+        } else if ((it->second.send_window += increment) > MAX_WINDOW) {
+            sendReset(stream, ErrorCode::FLOW_CONTROL_ERROR);
+        }
+    }
+
+    /// Strip padding from a DATA or HEADERS payload; false if the padding is invalid
+    static bool stripPadding(uint8_t flags, const uint8_t*& payload, uint32_t& length) {
+        if ((flags & FLAG_PADDED) == 0) {
+            return true;
+        }
+        if (length < 1 || payload[0] >= length) {
+            return false;
+        }
+        length -= 1 + payload[0];
+        payload += 1;
+        return true;
+    }
+
+    void onData(uint8_t flags, uint32_t stream, const uint8_t* payload, uint32_t length) {
+        if (stream == 0 || isIdle(stream)) {
+            fail(ErrorCode::PROTOCOL_ERROR);
+            return;
+        }
+        // The whole frame, padding included, counts against the connection window
+        if (length > conn_recv_window_) {
+            fail(ErrorCode::FLOW_CONTROL_ERROR);
+            return;
+        }
+        conn_recv_window_ -= length;
+        conn_recv_consumed_ += length;
+        if (conn_recv_consumed_ >= config_.connection_window_size / 2) {
+            writeWindowUpdate(0, conn_recv_consumed_);
+            conn_recv_window_ += conn_recv_consumed_;
+            conn_recv_consumed_ = 0;
+        }
+
+        auto it = streams_.find(stream);
+        if (it == streams_.end() || it->second.remote_closed) {
+            sendReset(stream, ErrorCode::STREAM_CLOSED);
+            return;
+        }
+        Stream& state = it->second;
+        if (length > state.recv_window) {
+            sendReset(stream, ErrorCode::FLOW_CONTROL_ERROR);
+            return;
+        }
+        state.recv_window -= length;
+        const uint32_t frame_length = length;
+        if (!stripPadding(flags, payload, length)) {
+            fail(ErrorCode::PROTOCOL_ERROR);
+            return;
+        }
+        // Padding never reaches the application, so it is credited right away
+        state.recv_credit += frame_length - length;
+
+        const bool end_stream = (flags & FLAG_END_STREAM) != 0;
+        if (end_stream) {
+            state.remote_closed = true;
+        }
+        if (!state.responded) {
+            if (length != 0 || !end_stream) {
+                sendReset(stream, ErrorCode::PROTOCOL_ERROR);   // no request body before the tunnel exists
+            }
+            return;
+        }
+        stats_.bytes_in += length;
+        if (length != 0 && callbacks_.on_data) {
+            callbacks_.on_data(stream, payload, length);
+        }
+        if (end_stream) {
+            endRemote(stream);
+        }
+    }
+
+    /// Peer finished sending on a tunnel: like a TCP FIN (RFC 8441 4)
+    void endRemote(uint32_t stream) {
+        auto it = streams_.find(stream);
+        if (it == streams_.end() || it->second.notified) {
+            return;
+        }
+        it->second.notified = true;
+        if (callbacks_.on_stream_close) {
+            callbacks_.on_stream_close(stream, ErrorCode::NONE);
+        }
+    }
+
+    void onHeaders(uint8_t flags, uint32_t stream, const uint8_t* payload, uint32_t length) {
+        if (stream == 0 || (stream & 1) == 0) {
+            fail(ErrorCode::PROTOCOL_ERROR);
+            return;
+        }
+        if (!stripPadding(flags, payload, length)) {
+            fail(ErrorCode::PROTOCOL_ERROR);
+            return;
+        }
+        if (flags & FLAG_PRIORITY) {
+            if (length < 5) {
+                fail(ErrorCode::FRAME_SIZE_ERROR);
+                return;
+            }
+            payload += 5;
+            length -= 5;
+        }
+        if (!isIdle(stream) && streams_.find(stream) == streams_.end()) {
+            fail(ErrorCode::STREAM_CLOSED);
+            return;
+        }
+        continuation_stream_ = stream;
+        continuation_end_stream_ = (flags & FLAG_END_STREAM) != 0;
+        header_block_.clear();
+        appendHeaderBlock(payload, length, flags);
+    }
+
+    void appendHeaderBlock(const uint8_t* payload, uint32_t length, uint8_t flags) {
+        // A block far beyond the header list limit is not worth buffering
+        if (header_block_.size() + length > config_.max_header_list_size * 2 + 4096) {
+            fail(ErrorCode::ENHANCE_YOUR_CALM);
+            return;
+        }
+        header_block_.insert(header_block_.end(), payload, payload + length);
+        if (flags & FLAG_END_HEADERS) {
+            const uint32_t stream = continuation_stream_;
+            continuation_stream_ = 0;
+            onHeaderBlock(stream, continuation_end_stream_);
+        }
+    }
+
+    void onHeaderBlock(uint32_t stream, bool end_stream) {
+        std::vector<Hpack::Header> fields;
+        const Hpack::Decoder::Status status = decoder_.decode(header_block_.data(), header_block_.size(), fields);
+        header_block_.clear();
+        if (status == Hpack::Decoder::Status::ERROR) {
+            fail(ErrorCode::COMPRESSION_ERROR);
+            return;
+        }
+
+        if (!isIdle(stream)) {
+            // Trailers on an open stream: only valid as the stream's last frame
+            auto it = streams_.find(stream);
+            if (!end_stream || it->second.remote_closed) {
+                sendReset(stream, ErrorCode::PROTOCOL_ERROR);
+                return;
+            }
+            it->second.remote_closed = true;
+            if (it->second.responded) {
+                endRemote(stream);
+            }
+            return;
+        }
+
+        last_stream_id_ = stream;
+        if (goaway_sent_ || streams_.size() >= config_.max_concurrent_streams) {
+            ++stats_.streams_refused;
+            Buffer payload;
+            appendUint32(payload, static_cast<uint32_t>(ErrorCode::REFUSED_STREAM));
+            writeFrame(FrameType::RST_STREAM, 0, stream, payload.data(), payload.size());
+            return;
+        }
+
+        Stream& state = streams_[stream];
+        state.send_window = peer_initial_window_;
+        state.recv_window = config_.initial_window_size;
+        state.remote_closed = end_stream;
+
+        Request request;
+        request.stream_id = stream;
+        if (status == Hpack::Decoder::Status::TOO_LARGE) {
+            respond(stream, Response{ 431, {} }, false);
+            return;
+        }
+        if (!parseRequest(fields, request)) {
+            sendReset(stream, ErrorCode::PROTOCOL_ERROR);   // malformed (RFC 9113 8.1.1)
+            return;
+        }
+
+        Response response = callbacks_.on_request ? callbacks_.on_request(request) : Response{ 501, {} };
+        const bool tunnel = request.method == "CONNECT" && response.status >= 200 && response.status < 300;
+        respond(stream, response, tunnel);
+    }
+
+    void respond(uint32_t stream, const Response& response, bool tunnel) {
+        auto it = streams_.find(stream);
+        if (it == streams_.end()) {
+            return;
+        }
+        if (tunnel) {
+            it->second.responded = true;
+            writeHeaders(stream, response, false);
+            ++stats_.streams_opened;
+            if (it->second.remote_closed) {
+                endRemote(stream);
+            }
+            return;
+        }
+        // Complete response; a request still sending is told to stop
+        ++stats_.streams_rejected;
+        const bool remote_closed = it->second.remote_closed;
+        writeHeaders(stream, response, true);
+        if (remote_closed) {
+            finishStream(stream, ErrorCode::NONE);
+        } else {
+            it->second.notified = true;
+            sendReset(stream, ErrorCode::NONE);
+        }
+    }
+
+    static bool parseRequest(std::vector<Hpack::Header>& fields, Request& request) {
+        bool regular_seen = false;
+        for (auto& field : fields) {
+            const std::string& name = field.first;
+            for (const char c : name) {
+                if (c >= 'A' && c <= 'Z') {
+                    return false;
+                }
+            }
+            if (!name.empty() && name[0] == ':') {
+                if (regular_seen) {
+                    return false;
+                }
+                std::string* target = name == ":method" ? &request.method
+                    : name == ":protocol" ? &request.protocol
+                    : name == ":scheme" ? &request.scheme
+                    : name == ":authority" ? &request.authority
+                    : name == ":path" ? &request.path
+                    : nullptr;
+                if (!target || !target->empty() || field.second.empty()) {
+                    return false;   // unknown, repeated or empty pseudo-header
+                }
+                *target = std::move(field.second);
+                continue;
+            }
+            regular_seen = true;
+            if (name == "connection" || name == "upgrade" || name == "keep-alive" ||
+                name == "proxy-connection" || name == "transfer-encoding" ||
+                (name == "te" && field.second != "trailers")) {
+                return false;   // connection-specific fields are not allowed in HTTP/2
+            }
+            if (name == "host" && request.authority.empty()) {
+                request.authority = field.second;
+            }
+            request.headers.push_back(std::move(field));
+        }
+        if (request.method.empty()) {
+            return false;
+        }
+        if (request.method == "CONNECT") {
+            // Extended CONNECT (RFC 8441 4) carries :scheme and :path; plain CONNECT must not
+            return request.protocol.empty()
+                ? request.scheme.empty() && request.path.empty() && !request.authority.empty()
+                : !request.scheme.empty() && !request.path.empty() && !request.authority.empty();
+        }
+        return request.protocol.empty() && !request.scheme.empty() && !request.path.empty();
+    }
+
+    /// Send queued DATA within the peer's windows; then retire finished streams
+    void flush() {
+        bool progress = true;
+        while (progress && !failed_) {
+            progress = false;
+            for (auto& entry : streams_) {
+                Stream& state = entry.second;
+                if (!state.responded || state.end_sent) {
+                    continue;
+                }
+                const size_t available = state.pending.size() - state.pending_offset;
+                if (available == 0) {
+                    if (state.local_closed) {
+                        writeFrame(FrameType::DATA, FLAG_END_STREAM, entry.first, nullptr, 0);
+                        state.end_sent = true;
+                    }
+                    continue;
+                }
+                if (state.send_window <= 0 || conn_send_window_ <= 0) {
+                    ++stats_.flow_blocked;
+                    continue;
+                }
+                const size_t chunk = static_cast<size_t>(std::min<int64_t>(
+                    { static_cast<int64_t>(available), state.send_window, conn_send_window_, peer_max_frame_size_ }));
+                const bool last = state.local_closed && chunk == available;
+                writeFrame(FrameType::DATA, last ? FLAG_END_STREAM : 0, entry.first,
+                    state.pending.data() + state.pending_offset, chunk);
+                state.end_sent = last;
+                state.send_window -= static_cast<int64_t>(chunk);
+                conn_send_window_ -= static_cast<int64_t>(chunk);
+                stats_.bytes_out += chunk;
+                state.pending_offset += chunk;
+                if (state.pending_offset == state.pending.size()) {
+                    state.pending.clear();
+                    state.pending_offset = 0;
+                } else if (state.pending_offset > state.pending.size() / 2) {
+                    state.pending.erase(state.pending.begin(),
+                        state.pending.begin() + static_cast<std::ptrdiff_t>(state.pending_offset));
+                    state.pending_offset = 0;
+                }
+                progress = true;
+            }
+        }
+
+        std::vector<uint32_t> finished, writable;
+        for (auto& entry : streams_) {
+            Stream& state = entry.second;
+            if (state.end_sent && state.remote_closed) {
+                finished.push_back(entry.first);
+            } else if (state.above_high_water && state.pending.size() - state.pending_offset < config_.stream_high_water) {
+                state.above_high_water = false;
+                writable.push_back(entry.first);
+            }
+        }
+        for (const uint32_t id : finished) {
+            finishStream(id, ErrorCode::NONE);
+        }
+        for (const uint32_t id : writable) {
+            if (callbacks_.on_writable && streams_.count(id) != 0) {
+                callbacks_.on_writable(id);
+            }
+        }
+    }
+
+    Callbacks callbacks_;
+    Config config_;
+    Hpack::Decoder decoder_;
+    std::map<uint32_t, Stream> streams_;            ///< Open and half-closed streams
+    Buffer input_;                                  ///< Unparsed received bytes
+    Buffer output_;                                 ///< Frames queued for the peer
+    Buffer header_block_;                           ///< HEADERS + CONTINUATION being assembled
+    uint32_t continuation_stream_{ 0 };             ///< Stream whose header block is incomplete (0 = none)
+    bool continuation_end_stream_{ false };
+    uint32_t last_stream_id_{ 0 };                  ///< Highest client stream id seen
+    int64_t conn_send_window_{ 65535 };
+    int64_t peer_initial_window_{ 65535 };
+    int64_t peer_max_frame_size_{ 16384 };
+    uint32_t conn_recv_window_{ 65535 };
+    uint32_t conn_recv_consumed_{ 0 };              ///< Received since the last connection WINDOW_UPDATE
+    bool preface_received_{ false };
+    bool settings_received_{ false };
+    bool goaway_sent_{ false };
+    bool failed_{ false };
+    Stats stats_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_HTTP2_CONNECTION_HPP
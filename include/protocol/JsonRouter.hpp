@@ -0,0 +1,729 @@
+#pragma once
+#ifndef WEBSOCKET_JSON_ROUTER_HPP
+#define WEBSOCKET_JSON_ROUTER_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WEBSOCKET_JSON_SSE2 1
+#else
+#define WEBSOCKET_JSON_SSE2 0
+#endif
+
+#if WEBSOCKET_JSON_SSE2 && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class JsonScanner
+ * @brief Structural scanning of JSON text without building a document
+ *
+ * Finds string and container boundaries 16 bytes at a time (SSE2, scalar
+ * elsewhere) so values that are not asked for are skipped rather than
+ * parsed. Checks structure only as far as needed to find boundaries; it is
+ * not a validator.
+ */
+class JsonScanner {
+public:
+    /**
+     * @brief Skip JSON whitespace
+     */
+    static const char* skipWhitespace(const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+            ++p;
+        }
+        return p;
+    }
+
+    /**
+     * @brief Find the closing quote of a string
+     * @param p First byte after the opening quote
+     * @param end End of input
+     * @param escaped Set to true if the string contains escapes
+     * @return Closing quote, or nullptr if unterminated
+     */
+    static const char* scanString(const char* p, const char* end, bool& escaped) {
+        for (;;) {
+            p = findQuoteOrBackslash(p, end);
+            if (p >= end) {
+                return nullptr;
+            }
+            if (*p == '"') {
+                return p;
+            }
+            escaped = true;
+            p += 2;
+        }
+    }
+
+    /**
+     * @brief Skip one value
+     * @param p First byte of the value
+     * @param end End of input
+     * @return One past the value, or nullptr if malformed
+     */
+    static const char* skipValue(const char* p, const char* end) {
+        if (p >= end) {
+            return nullptr;
+        }
+        bool escaped = false;
+        switch (*p) {
+        case '"': {
+            const char* close = scanString(p + 1, end, escaped);
+            return close ? close + 1 : nullptr;
+        }
+        case '{':
+        case '[':
+            return skipContainer(p, end);
+        default: {
+            const char* start = p;
+            while (p < end && *p != ',' && *p != '}' && *p != ']' &&
+                *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t') {
+                ++p;
+            }
+            return p == start ? nullptr : p;
+        }
+        }
+    }
+
+    /**
+     * @brief Find a top-level member of an object
+     * @param json Document text
+     * @param key Member name
+     * @return Raw value text (strings keep their quotes), or nullopt if absent or malformed
+     *
+     * @note Stops at the first match; members after it are never looked at
+     */
+    static std::optional<std::string_view> findMember(std::string_view json, std::string_view key) {
+        const char* end = json.data() + json.size();
+        const char* p = skipWhitespace(json.data(), end);
+        if (p >= end || *p != '{') {
+            return std::nullopt;
+        }
+        p = skipWhitespace(p + 1, end);
+        if (p < end && *p == '}') {
+            return std::nullopt;
+        }
+        std::string unescaped;
+        for (;;) {
+            if (p >= end || *p != '"') {
+                return std::nullopt;
+            }
+            bool escaped = false;
+            const char* close = scanString(p + 1, end, escaped);
+            if (!close) {
+                return std::nullopt;
+            }
+            const std::string_view name(p + 1, static_cast<size_t>(close - p - 1));
+            bool match = name == key;
+            if (!match && escaped && unescape(name, unescaped)) {
+                match = unescaped == key;
+            }
+
+            p = skipWhitespace(close + 1, end);
+            if (p >= end || *p != ':') {
+                return std::nullopt;
+            }
+            p = skipWhitespace(p + 1, end);
+            const char* value_end = skipValue(p, end);
+            if (!value_end) {
+                return std::nullopt;
+            }
+            if (match) {
+                return std::string_view(p, static_cast<size_t>(value_end - p));
+            }
+
+            p = skipWhitespace(value_end, end);
+            if (p >= end || *p != ',') {
+                return std::nullopt;
+            }
+            p = skipWhitespace(p + 1, end);
+        }
+    }
+
+    /**
+     * @brief Decode the escapes in a string body
+     * @param body String contents without the quotes
+     * @param out Decoded UTF-8
+     * @return false on a malformed escape
+     */
+    static bool unescape(std::string_view body, std::string& out) {
+        out.clear();
+        out.reserve(body.size());
+        for (size_t i = 0; i < body.size(); ++i) {
+            const char c = body[i];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (++i >= body.size()) {
+                return false;
+            }
+            switch (body[i]) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t code = 0;
+                if (!hex4(body, i + 1, code)) {
+                    return false;
+                }
+                i += 4;
+                if (code >= 0xD800 && code < 0xDC00) {
+                    uint32_t low = 0;
+                    if (i + 2 >= body.size() || body[i + 1] != '\\' || body[i + 2] != 'u' ||
+                        !hex4(body, i + 3, low) || low < 0xDC00 || low > 0xDFFF) {
+                        return false;
+                    }
+                    i += 6;
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(code, out);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    /**
+     * @brief Skip a nested object or array
+     *
+     * Walks every structural byte of each 16-byte block from one mask, so
+     * dense documents do not pay a call per string.
+     */
+    static const char* skipContainer(const char* p, const char* end) {
+        size_t depth = 0;
+        bool in_string = false;
+        const char* resume = p;     // Bytes before this are escaped characters
+
+        auto step = [&](const char* q) -> const char* {
+            if (q < resume) {
+                return nullptr;
+            }
+            const char c = *q;
+            if (in_string) {
+                if (c == '"') {
+                    in_string = false;
+                }
+                else if (c == '\\') {
+                    resume = q + 2;
+                }
+                return nullptr;
+            }
+            switch (c) {
+            case '"': in_string = true; return nullptr;
+            case '{':
+            case '[': ++depth; return nullptr;
+            case '}':
+            case ']': return --depth == 0 ? q + 1 : nullptr;
+            default: return nullptr;
+            }
+        };
+
+#if WEBSOCKET_JSON_SSE2
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i open = _mm_set1_epi8('{');
+        const __m128i close = _mm_set1_epi8('}');
+        const __m128i case_bit = _mm_set1_epi8(0x20);
+        while (end - p >= 16) {
+            // '[' and ']' are '{' and '}' without bit 5, so one OR covers all four brackets
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i folded = _mm_or_si128(block, case_bit);
+            const __m128i hits = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)),
+                _mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+            while (mask != 0) {
+                if (const char* done = step(p + lowestBit(mask))) {
+                    return done;
+                }
+                mask &= mask - 1;
+            }
+            p += 16;
+        }
+#endif
+        for (; p < end; ++p) {
+            if (const char* done = step(p)) {
+                return done;
+            }
+        }
+        return nullptr;
+    }
+
+#if WEBSOCKET_JSON_SSE2
+    static unsigned lowestBit(unsigned mask) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+#endif
+
+    /// Next '"' or '\\'
+    static const char* findQuoteOrBackslash(const char* p, const char* end) {
+#if WEBSOCKET_JSON_SSE2
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        while (end - p >= 16) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+                _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash))));
+            if (mask != 0) {
+                return p + lowestBit(mask);
+            }
+            p += 16;
+        }
+#endif
+        while (p < end && *p != '"' && *p != '\\') {
+            ++p;
+        }
+        return p;
+    }
+
+    static bool hex4(std::string_view text, size_t pos, uint32_t& value) {
+        if (pos + 4 > text.size()) {
+            return false;
+        }
+        const auto result = std::from_chars(text.data() + pos, text.data() + pos + 4, value, 16);
+        return result.ec == std::errc() && result.ptr == text.data() + pos + 4;
+    }
+
+    static void appendUtf8(uint32_t code, std::string& out) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        }
+        else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+};
+
+/**
+ * @class JsonView
+ * @brief Lazily parsed view of a JSON object
+ *
+ * Nothing is parsed until a member is asked for. The first lookup indexes
+ * the top-level members in one structural pass (nested values are skipped,
+ * not parsed); later lookups use the index. Values are converted on access.
+ *
+ * The view refers to the message payload and is only valid while the
+ * message is.
+ */
+class JsonView {
+public:
+    JsonView() = default;
+
+    /**
+     * @brief Create a view over JSON text
+     * @param json Document text (must outlive the view)
+     */
+    explicit JsonView(std::string_view json) : json_(json) {}
+
+    /**
+     * @brief Get the document text
+     */
+    std::string_view text() const { return json_; }
+
+    /**
+     * @brief Check if the document is a well-formed object at the top level
+     */
+    bool isObject() const {
+        index();
+        return !malformed_;
+    }
+
+    /**
+     * @brief Check if a member exists
+     */
+    bool has(std::string_view key) const {
+        return raw(key).has_value();
+    }
+
+    /**
+     * @brief Get a member's raw value text
+     * @param key Member name
+     * @return Value text (strings keep their quotes), or nullopt if absent
+     */
+    std::optional<std::string_view> raw(std::string_view key) const {
+        index();
+        std::string unescaped;
+        for (const auto& field : fields_) {
+            if (field.key == key ||
+                (field.escaped && JsonScanner::unescape(field.key, unescaped) && unescaped == key)) {
+                return field.value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Get a string member
+     * @return Decoded string, or nullopt if absent or not a string
+     */
+    std::optional<std::string> getString(std::string_view key) const {
+        const auto value = raw(key);
+        if (!value || value->size() < 2 || value->front() != '"') {
+            return std::nullopt;
+        }
+        std::string out;
+        if (!JsonScanner::unescape(value->substr(1, value->size() - 2), out)) {
+            return std::nullopt;
+        }
+        return out;
+    }
+
+    /**
+     * @brief Get an integer member
+     * @return Value, or nullopt if absent or not an integer
+     */
+    std::optional<int64_t> getInt(std::string_view key) const {
+        const auto value = raw(key);
+        int64_t out = 0;
+        if (!value || !parseWhole(*value, out)) {
+            return std::nullopt;
+        }
+        return out;
+    }
+
+    /**
+     * @brief Get a numeric member
+     * @return Value, or nullopt if absent or not a number
+     */
+    std::optional<double> getDouble(std::string_view key) const {
+        const auto value = raw(key);
+        double out = 0.0;
+        if (!value || !parseWhole(*value, out)) {
+            return std::nullopt;
+        }
+        return out;
+    }
+
+    /**
+     * @brief Get a boolean member
+     * @return Value, or nullopt if absent or not a boolean
+     */
+    std::optional<bool> getBool(std::string_view key) const {
+        const auto value = raw(key);
+        if (value == "true") {
+            return true;
+        }
+        if (value == "false") {
+            return false;
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Get a nested object member
+     * @return View of the nested object, or nullopt if absent or not an object
+     */
+    std::optional<JsonView> getObject(std::string_view key) const {
+        const auto value = raw(key);
+        if (!value || value->front() != '{') {
+            return std::nullopt;
+        }
+        return JsonView(*value);
+    }
+
+private:
+    struct Field {
+        std::string_view key;       ///< Name as written (escapes not decoded)
+        std::string_view value;     ///< Raw value text
+        bool escaped{ false };      ///< Name contains escapes
+    };
+
+    template<typename T>
+    static bool parseWhole(std::string_view text, T& out) {
+        const auto result = std::from_chars(text.data(), text.data() + text.size(), out);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    void index() const {
+        if (indexed_) {
+            return;
+        }
+        indexed_ = true;
+        malformed_ = true;
+
+        const char* end = json_.data() + json_.size();
+        const char* p = JsonScanner::skipWhitespace(json_.data(), end);
+        if (p >= end || *p != '{') {
+            return;
+        }
+        p = JsonScanner::skipWhitespace(p + 1, end);
+        if (p < end && *p == '}') {
+            malformed_ = false;
+            return;
+        }
+        for (;;) {
+            if (p >= end || *p != '"') {
+                return;
+            }
+            Field field;
+            const char* close = JsonScanner::scanString(p + 1, end, field.escaped);
+            if (!close) {
+                return;
+            }
+            field.key = std::string_view(p + 1, static_cast<size_t>(close - p - 1));
+            p = JsonScanner::skipWhitespace(close + 1, end);
+            if (p >= end || *p != ':') {
+                return;
+            }
+            p = JsonScanner::skipWhitespace(p + 1, end);
+            const char* value_end = JsonScanner::skipValue(p, end);
+            if (!value_end) {
+                return;
+            }
+            field.value = std::string_view(p, static_cast<size_t>(value_end - p));
+            fields_.push_back(field);
+
+            p = JsonScanner::skipWhitespace(value_end, end);
+            if (p < end && *p == '}') {
+                malformed_ = false;
+                return;
+            }
+            if (p >= end || *p != ',') {
+                return;
+            }
+            p = JsonScanner::skipWhitespace(p + 1, end);
+        }
+    }
+
+    std::string_view json_;
+    mutable std::vector<Field> fields_;
+    mutable bool indexed_{ false };
+    mutable bool malformed_{ false };
+};
+
+/**
+ * @class JsonRouter
+ * @brief Dispatches JSON text messages by the value of one member
+ *
+ * Pulls the routing member (default "type") out of each text message with
+ * JsonScanner, without parsing the rest of the document, and calls the
+ * handler registered for that value. Handlers are found through a perfect
+ * hash table rebuilt on registration: one hash and one key compare per
+ * message, no probing. The handler gets a JsonView for reading the
+ * remaining members on demand.
+ *
+ * Binary messages, messages without the member and values with no handler
+ * go to the fallback handler, so it can take the place of a plain
+ * onMessage handler.
+ *
+ * Register handlers before messages start arriving; dispatch() itself may
+ * be called from any number of threads.
+ *
+ * Usage:
+ * auto router = std::make_shared<JsonRouter>();
+ * router->on("chat", [](ClientID client, const Message& message, const JsonView& json) {
+ *     auto text = json.getString("text");
+ * });
+ * server.routeMessages(router);
+ */
+class JsonRouter : public NonCopyable {
+public:
+    using Handler = std::function<void(ClientID, const Message&, const JsonView&)>;
+    using FallbackHandler = std::function<void(ClientID, const Message&)>;
+
+    /**
+     * @brief Router configuration
+     */
+    struct Config {
+        std::string key{ "type" };      ///< Top-level member to route on
+    };
+
+    /**
+     * @brief Dispatch counters
+     */
+    struct Stats {
+        uint64_t routed{ 0 };           ///< Delivered to a type handler
+        uint64_t unmatched{ 0 };        ///< Routing value with no handler
+        uint64_t unroutable{ 0 };       ///< Binary, not an object, or routing member missing
+    };
+
+    JsonRouter() : JsonRouter(Config{}) {}
+
+    /**
+     * @brief Create a router
+     * @param config Routing member
+     */
+    explicit JsonRouter(const Config& config) : config_(config) {}
+
+    /**
+     * @brief Register the handler for a routing value
+     * @param type Routing value (string contents, or the literal text of a number/boolean)
+     * @param handler Handler; replaces any existing one for the value
+     */
+    void on(const std::string& type, Handler handler) {
+        for (auto& route : routes_) {
+            if (route.type == type) {
+                route.handler = std::move(handler);
+                return;
+            }
+        }
+        routes_.push_back({ type, std::move(handler) });
+        rebuild();
+    }
+
+    /**
+     * @brief Set the handler for messages no type handler takes
+     * @param handler Fallback handler
+     */
+    void otherwise(FallbackHandler handler) {
+        fallback_ = std::move(handler);
+    }
+
+    /**
+     * @brief Route one message
+     * @param client_id Sending client
+     * @param message Received message
+     * @return true if a type handler ran
+     */
+    bool dispatch(ClientID client_id, const Message& message) {
+        if (message.isText) {
+            const std::string_view json(reinterpret_cast<const char*>(message.data.data()), message.data.size());
+            if (const auto value = JsonScanner::findMember(json, config_.key)) {
+                if (const Route* route = find(*value)) {
+                    routed_.fetch_add(1, std::memory_order_relaxed);
+                    route->handler(client_id, message, JsonView(json));
+                    return true;
+                }
+                unmatched_.fetch_add(1, std::memory_order_relaxed);
+            }
+            else {
+                unroutable_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        else {
+            unroutable_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (fallback_) {
+            fallback_(client_id, message);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Get dispatch counters
+     */
+    Stats getStats() const {
+        Stats stats;
+        stats.routed = routed_.load(std::memory_order_relaxed);
+        stats.unmatched = unmatched_.load(std::memory_order_relaxed);
+        stats.unroutable = unroutable_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    struct Route {
+        std::string type;
+        Handler handler;
+    };
+
+    static uint64_t hash(std::string_view key, uint64_t seed) {
+        uint64_t h = 0xcbf29ce484222325ULL ^ (seed * 0x9E3779B97F4A7C15ULL);
+        for (const char c : key) {
+            h = (h ^ static_cast<uint8_t>(c)) * 0x100000001b3ULL;
+        }
+        return h ^ (h >> 29);
+    }
+
+    /**
+     * @brief Pick a seed under which every registered value gets its own slot
+     */
+    void rebuild() {
+        size_t size = 1;
+        while (size < routes_.size() * 2) {
+            size <<= 1;
+        }
+        for (;;) {
+            for (uint64_t seed = 1; seed <= 256; ++seed) {
+                std::vector<int32_t> slots(size, -1);
+                bool collision = false;
+                for (size_t i = 0; i < routes_.size() && !collision; ++i) {
+                    int32_t& slot = slots[hash(routes_[i].type, seed) & (size - 1)];
+                    collision = slot >= 0;
+                    slot = static_cast<int32_t>(i);
+                }
+                if (!collision) {
+                    seed_ = seed;
+                    slots_ = std::move(slots);
+                    return;
+                }
+            }
+            size <<= 1;
+        }
+    }
+
+    const Route* find(std::string_view value) const {
+        if (routes_.empty()) {
+            return nullptr;
+        }
+        std::string unescaped;
+        if (value.size() >= 2 && value.front() == '"') {
+            value = value.substr(1, value.size() - 2);
+            if (value.find('\\') != std::string_view::npos) {
+                if (!JsonScanner::unescape(value, unescaped)) {
+                    return nullptr;
+                }
+                value = unescaped;
+            }
+        }
+        const int32_t slot = slots_[hash(value, seed_) & (slots_.size() - 1)];
+        if (slot < 0 || routes_[static_cast<size_t>(slot)].type != value) {
+            return nullptr;
+        }
+        return &routes_[static_cast<size_t>(slot)];
+    }
+
+    Config config_;
+    std::vector<Route> routes_;
+    std::vector<int32_t> slots_;        ///< Perfect hash: slot -> index into routes_
+    uint64_t seed_{ 0 };
+    FallbackHandler fallback_;
+
+    std::atomic<uint64_t> routed_{ 0 };
+    std::atomic<uint64_t> unmatched_{ 0 };
+    std::atomic<uint64_t> unroutable_{ 0 };
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_JSON_ROUTER_HPP
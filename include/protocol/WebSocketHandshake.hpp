@@ -74,6 +74,18 @@ WEBSOCKET_NAMESPACE_BEGIN
          */
         void setAcceptedSubprotocol(const std::string& protocol);
 
+        /**
+         * @brief Get the client's Sec-WebSocket-Extensions offer
+         * @return Header value (empty if none offered)
+         */
+        std::string getRequestedExtensions() const;
+
+        /**
+         * @brief Set the Sec-WebSocket-Extensions response value
+         * @param extensions Accepted extensions with their parameters (empty for none)
+         */
+        void setAcceptedExtensions(const std::string& extensions);
+
         /**
          * @brief Get handshake error message
          * @return Error description if handshake failed
@@ -98,6 +110,12 @@ WEBSOCKET_NAMESPACE_BEGIN
          */
         int getClientVersion() const;
 
+        /**
+         * @brief Get request path
+         * @return Path from the request line (including any query string)
+         */
+        const std::string& getPath() const { return path_; }
+
     private:
         /**
          * @brief Parse HTTP request line
@@ -157,6 +175,7 @@ WEBSOCKET_NAMESPACE_BEGIN
         std::unordered_map<std::string, std::string> headers_;  ///< HTTP headers
         std::string error_message_;                     ///< Error description
         std::string accepted_subprotocol_;              ///< Accepted subprotocol
+        std::string accepted_extensions_;               ///< Accepted extensions
         Result result_{ Result::SUCCESS };                ///< Handshake result
 };
 
@@ -0,0 +1,377 @@
+#pragma once
+#ifndef WEBSOCKET_ZSTD_DICTIONARY_EXTENSION_HPP
+#define WEBSOCKET_ZSTD_DICTIONARY_EXTENSION_HPP
+
+#ifdef WEBSOCKET_ZSTD_SUPPORT
+
+#include "../common/Types.hpp"
+#include "../utils/Metrics.hpp"
+#include "ExtensionPipeline.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <zstd.h>
+#include <zdict.h>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class ZstdDictionaryExtension
+ * @brief "x-cppws-zstd" message compression with pre-trained dictionaries
+ *
+ * permessage-deflate gets little out of short JSON messages because each
+ * message has too little history of its own. With a dictionary trained on
+ * the application's traffic (tools/cppws-zstd-train), zstd finds the
+ * repeated keys and values in the dictionary instead.
+ *
+ * Negotiation (Sec-WebSocket-Extensions), in the client's preference order:
+ *   client: x-cppws-zstd; dict=7, x-cppws-zstd; dict=3
+ *   server: x-cppws-zstd; dict=7
+ * The server accepts the first dictionary id it has loaded. As a
+ * WebSocketExtension it claims RSV1 and runs in the connection's
+ * ExtensionPipeline, compressing straight into pipeline scratch memory;
+ * compress() and decompress() serve callers outside a pipeline. Each message
+ * is compressed on its own (no context takeover), so both sides keep only
+ * the shared dictionary per connection. Compressed messages set RSV1;
+ * messages that would not shrink are sent as they are with RSV1 clear.
+ *
+ * One instance serves every connection: dictionaries are digested once and
+ * compression contexts are pooled, so an idle connection holds no zstd
+ * state at all.
+ *
+ * Metrics: "zstd.ratio_pct" (compressed size as % of original),
+ * "zstd.compress_ns" and "zstd.decompress_ns" per message.
+ *
+ * Only built with WEBSOCKET_ZSTD_SUPPORT (set by CMake when libzstd is found).
+ */
+class ZstdDictionaryExtension : public WebSocketExtension {
+public:
+    static constexpr const char* NAME = "x-cppws-zstd";
+
+    /**
+     * @brief Extension configuration
+     */
+    struct Config {
+        int level{ 3 };                                 ///< zstd compression level
+        size_t min_size{ 24 };                          ///< Smaller messages are sent uncompressed
+        size_t max_message_size{ 16 * 1024 * 1024 };    ///< Decompressed size limit
+    };
+
+    /**
+     * @brief Compression counters
+     */
+    struct Stats {
+        uint64_t compressed{ 0 };           ///< Messages sent compressed
+        uint64_t skipped{ 0 };              ///< Messages sent as is (small or incompressible)
+        uint64_t bytes_in{ 0 };             ///< Original size of compressed messages
+        uint64_t bytes_out{ 0 };            ///< Compressed size of compressed messages
+        uint64_t decompressed{ 0 };         ///< Messages decompressed
+        uint64_t decompress_failures{ 0 };  ///< Corrupt, oversized or wrong-dictionary messages
+    };
+
+    /**
+     * @brief Dictionary used by a connection (for compress() and decompress())
+     */
+    struct Session {
+        uint32_t dictionary_id{ 0 };        ///< 0 = extension not in use
+        bool active() const { return dictionary_id != 0; }
+    };
+
+    ZstdDictionaryExtension() : ZstdDictionaryExtension(Config{}) {}
+
+    /**
+     * @brief Create the extension
+     * @param config Compression level and size limits
+     */
+    explicit ZstdDictionaryExtension(const Config& config) : config_(config) {}
+
+    ~ZstdDictionaryExtension() override {
+        for (ZSTD_CCtx* context : compressors_) {
+            ZSTD_freeCCtx(context);
+        }
+        for (ZSTD_DCtx* context : decompressors_) {
+            ZSTD_freeDCtx(context);
+        }
+    }
+
+    /**
+     * @brief Load a dictionary
+     * @param dictionary Dictionary in zstd format (its header carries the id)
+     * @param error Failure reason
+     * @return Dictionary id, or 0 on failure
+     *
+     * @note Load dictionaries before connections negotiate
+     */
+    uint32_t addDictionary(const Buffer& dictionary, std::string& error) {
+        const uint32_t id = ZDICT_getDictID(dictionary.data(), dictionary.size());
+        if (id == 0) {
+            error = "not a zstd dictionary (or dictionary id 0)";
+            return 0;
+        }
+        auto entry = std::make_unique<Dictionary>();
+        entry->compress = ZSTD_createCDict(dictionary.data(), dictionary.size(), config_.level);
+        entry->decompress = ZSTD_createDDict(dictionary.data(), dictionary.size());
+        if (!entry->compress || !entry->decompress) {
+            error = "zstd rejected the dictionary";
+            return 0;
+        }
+        std::lock_guard lock(mutex_);
+        dictionaries_[id] = std::move(entry);
+        return id;
+    }
+
+    /**
+     * @brief Load a dictionary file written by cppws-zstd-train
+     * @param path Dictionary file
+     * @param error Failure reason
+     * @return Dictionary id, or 0 on failure
+     */
+    uint32_t loadDictionary(const std::string& path, std::string& error) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            error = "cannot open " + path;
+            return 0;
+        }
+        Buffer data;
+        uint8_t chunk[65536];
+        size_t n;
+        while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            data.insert(data.end(), chunk, chunk + n);
+        }
+        std::fclose(file);
+        return addDictionary(data, error);
+    }
+
+    const char* name() const override { return NAME; }
+
+    uint8_t rsvBits() const override { return ExtensionPayload::RSV1; }
+
+    /**
+     * @brief Accept an offer element naming a loaded dictionary
+     * @param offer "x-cppws-zstd; dict=<id>"
+     * @param response Set to "x-cppws-zstd; dict=<id>"
+     * @return Session for the connection, or nullptr if the dictionary is not loaded
+     */
+    std::unique_ptr<ExtensionSession> negotiate(const ExtensionOffer& offer, std::string& response) override {
+        const std::string value = offer.get("dict");
+        char* end = nullptr;
+        const unsigned long id = std::strtoul(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || id == 0 || id > UINT32_MAX || !find(static_cast<uint32_t>(id))) {
+            return nullptr;
+        }
+        response = std::string(NAME) + "; dict=" + std::to_string(id);
+        return std::make_unique<PipelineSession>(*this, Session{ static_cast<uint32_t>(id) });
+    }
+
+    /**
+     * @brief Compress an outbound message
+     * @param session Connection state
+     * @param data Message payload
+     * @param size Payload size
+     * @param out Compressed payload
+     * @return true to send out with RSV1 set; false to send the original uncompressed
+     */
+    bool compress(const Session& session, const uint8_t* data, size_t size, Buffer& out) {
+        out.resize(ZSTD_compressBound(size));
+        const size_t written = compressInto(session, data, size, out.data(), out.size());
+        out.resize(written);
+        return written != 0;
+    }
+
+    /**
+     * @brief Decompress an inbound message that arrived with RSV1 set
+     * @param session Connection state
+     * @param data Compressed payload
+     * @param size Payload size
+     * @param out Original payload
+     * @return false if the message is corrupt, too large or uses another dictionary (close with 1007)
+     */
+    bool decompress(const Session& session, const uint8_t* data, size_t size, Buffer& out) {
+        const size_t original = originalSize(session, data, size);
+        if (original == 0) {
+            return false;
+        }
+        out.resize(original);
+        return decompressInto(session, data, size, out.data(), original);
+    }
+
+    /**
+     * @brief Get compression counters
+     */
+    Stats getStats() const {
+        Stats stats;
+        stats.compressed = stats_.compressed.load(std::memory_order_relaxed);
+        stats.skipped = stats_.skipped.load(std::memory_order_relaxed);
+        stats.bytes_in = stats_.bytes_in.load(std::memory_order_relaxed);
+        stats.bytes_out = stats_.bytes_out.load(std::memory_order_relaxed);
+        stats.decompressed = stats_.decompressed.load(std::memory_order_relaxed);
+        stats.decompress_failures = stats_.decompress_failures.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    struct Dictionary {
+        ZSTD_CDict* compress{ nullptr };
+        ZSTD_DDict* decompress{ nullptr };
+
+        Dictionary() = default;
+        Dictionary(const Dictionary&) = delete;
+        Dictionary& operator=(const Dictionary&) = delete;
+
+        ~Dictionary() {
+            ZSTD_freeCDict(compress);
+            ZSTD_freeDDict(decompress);
+        }
+    };
+
+    struct Counters {
+        std::atomic<uint64_t> compressed{ 0 };
+        std::atomic<uint64_t> skipped{ 0 };
+        std::atomic<uint64_t> bytes_in{ 0 };
+        std::atomic<uint64_t> bytes_out{ 0 };
+        std::atomic<uint64_t> decompressed{ 0 };
+        std::atomic<uint64_t> decompress_failures{ 0 };
+    };
+
+    /// Connection's stage in its ExtensionPipeline
+    class PipelineSession : public ExtensionSession {
+    public:
+        PipelineSession(ZstdDictionaryExtension& extension, Session session)
+            : extension_(extension), session_(session) {
+        }
+
+        bool outbound(ExtensionPayload& payload) override {
+            const size_t capacity = ZSTD_compressBound(payload.size());
+            const size_t written = extension_.compressInto(session_, payload.data(), payload.size(),
+                payload.output(capacity), capacity);
+            if (written != 0) {
+                payload.commit(written);
+                payload.rsv |= ExtensionPayload::RSV1;
+            }
+            return true;
+        }
+
+        bool inbound(ExtensionPayload& payload) override {
+            if ((payload.rsv & ExtensionPayload::RSV1) == 0) {
+                return true;
+            }
+            const size_t original = extension_.originalSize(session_, payload.data(), payload.size());
+            if (original == 0 || !extension_.decompressInto(session_, payload.data(), payload.size(),
+                payload.output(original), original)) {
+                return false;
+            }
+            payload.commit(original);
+            payload.rsv &= static_cast<uint8_t>(~ExtensionPayload::RSV1);
+            return true;
+        }
+
+    private:
+        ZstdDictionaryExtension& extension_;
+        Session session_;
+    };
+
+    /// Compress into out; returns the compressed size, or 0 to send the original
+    size_t compressInto(const Session& session, const uint8_t* data, size_t size, uint8_t* out, size_t capacity) {
+        const Dictionary* dictionary = session.active() && size >= config_.min_size ? find(session.dictionary_id) : nullptr;
+        ZSTD_CCtx* context = dictionary ? acquire(compressors_, ZSTD_createCCtx) : nullptr;
+        if (!context) {
+            stats_.skipped.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const size_t written = ZSTD_compress_usingCDict(context, out, capacity, data, size, dictionary->compress);
+        release(compressors_, context);
+        const auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        if (ZSTD_isError(written) || written >= size) {
+            stats_.skipped.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+        stats_.compressed.fetch_add(1, std::memory_order_relaxed);
+        stats_.bytes_in.fetch_add(size, std::memory_order_relaxed);
+        stats_.bytes_out.fetch_add(written, std::memory_order_relaxed);
+        Metrics::getInstance().recordHistogram("zstd.ratio_pct", static_cast<int64_t>(written * 100 / size));
+        Metrics::getInstance().recordHistogram("zstd.compress_ns", elapsed_ns);
+        return written;
+    }
+
+    /// Decompressed size declared by a frame; 0 if unusable (counted as a failure)
+    size_t originalSize(const Session& session, const uint8_t* data, size_t size) {
+        const unsigned long long original = ZSTD_getFrameContentSize(data, size);
+        if (!session.active() || original == 0 || original == ZSTD_CONTENTSIZE_UNKNOWN ||
+            original == ZSTD_CONTENTSIZE_ERROR || original > config_.max_message_size) {
+            stats_.decompress_failures.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+        return static_cast<size_t>(original);
+    }
+
+    /// Decompress exactly original bytes into out
+    bool decompressInto(const Session& session, const uint8_t* data, size_t size, uint8_t* out, size_t original) {
+        const Dictionary* dictionary = find(session.dictionary_id);
+        ZSTD_DCtx* context = dictionary ? acquire(decompressors_, ZSTD_createDCtx) : nullptr;
+        if (!context) {
+            stats_.decompress_failures.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const size_t written = ZSTD_decompress_usingDDict(context, out, original, data, size, dictionary->decompress);
+        release(decompressors_, context);
+        const auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        if (ZSTD_isError(written) || written != original) {
+            stats_.decompress_failures.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        stats_.decompressed.fetch_add(1, std::memory_order_relaxed);
+        Metrics::getInstance().recordHistogram("zstd.decompress_ns", elapsed_ns);
+        return true;
+    }
+
+    const Dictionary* find(uint32_t id) const {
+        std::lock_guard lock(mutex_);
+        auto found = dictionaries_.find(id);
+        return found == dictionaries_.end() ? nullptr : found->second.get();
+    }
+
+    template<typename Context>
+    Context* acquire(std::vector<Context*>& pool, Context* (*create)()) {
+        {
+            std::lock_guard lock(mutex_);
+            if (!pool.empty()) {
+                Context* context = pool.back();
+                pool.pop_back();
+                return context;
+            }
+        }
+        return create();
+    }
+
+    template<typename Context>
+    void release(std::vector<Context*>& pool, Context* context) {
+        std::lock_guard lock(mutex_);
+        pool.push_back(context);
+    }
+
+    Config config_;
+    mutable std::mutex mutex_;
+    std::map<uint32_t, std::unique_ptr<Dictionary>> dictionaries_;
+    std::vector<ZSTD_CCtx*> compressors_;       ///< Idle contexts, shared by all connections
+    std::vector<ZSTD_DCtx*> decompressors_;
+    Counters stats_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_ZSTD_SUPPORT
+
+#endif // WEBSOCKET_ZSTD_DICTIONARY_EXTENSION_HPP
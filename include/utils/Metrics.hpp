@@ -8,9 +8,11 @@
 #include <unordered_map>
 #include <string>
 #include <chrono>
+#include <mutex>
 #include <shared_mutex>
 #include <sstream>
 #include <iomanip>
+#include <array>
 
 WEBSOCKET_NAMESPACE_BEGIN
 
@@ -26,6 +28,7 @@ WEBSOCKET_NAMESPACE_BEGIN
  * - Gauge metrics for current values
  * - Timer metrics for duration measurements
  * - Throughput metrics for rate calculations
+ * - Histogram metrics for latency distributions
  * - System resource monitoring
  * - Multiple export formats (Prometheus, JSON)
  */
@@ -62,6 +65,76 @@ WEBSOCKET_NAMESPACE_BEGIN
             ThroughputStats() : last_reset(std::chrono::steady_clock::now()) {}
         };
 
+        /**
+         * @brief Histogram statistics structure
+         *
+         * Values are counted in power-of-two buckets: bucket i holds values in
+         * [2^(i-1), 2^i), bucket 0 holds zero. Recording is a single relaxed
+         * atomic increment, so it is cheap enough for per-message paths.
+         */
+        struct HistogramStats {
+            static constexpr size_t BUCKET_COUNT = 64;
+
+            std::array<std::atomic<int64_t>, BUCKET_COUNT> buckets{}; ///< Per-bucket counts
+            std::atomic<int64_t> count{ 0 };           ///< Number of recorded values
+            std::atomic<int64_t> sum{ 0 };             ///< Sum of recorded values
+
+            /**
+             * @brief Get bucket index for a value
+             * @param value Recorded value (negative values count as zero)
+             * @return Bucket index
+             */
+            static size_t bucketFor(int64_t value) {
+                size_t index = 0;
+                auto v = static_cast<uint64_t>(value > 0 ? value : 0);
+                while (v != 0 && index < BUCKET_COUNT - 1) {
+                    v >>= 1;
+                    ++index;
+                }
+                return index;
+            }
+
+            /**
+             * @brief Get upper bound of a bucket
+             * @param index Bucket index
+             * @return Exclusive upper bound of values in the bucket
+             */
+            static int64_t bucketUpperBound(size_t index) {
+                return index == 0 ? 1 : (index >= 63 ? INT64_MAX : (int64_t{ 1 } << index));
+            }
+
+            /**
+             * @brief Record a value
+             * @param value Value to record
+             */
+            void record(int64_t value) {
+                buckets[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+                count.fetch_add(1, std::memory_order_relaxed);
+                sum.fetch_add(value, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Estimate a percentile (bucket upper bound)
+             * @param p Percentile in range [0, 100]
+             * @return Upper bound of the bucket containing the percentile, or 0 if empty
+             */
+            int64_t percentile(double p) const {
+                auto total = count.load(std::memory_order_relaxed);
+                if (total == 0) {
+                    return 0;
+                }
+                auto target = static_cast<int64_t>(total * p / 100.0);
+                int64_t seen = 0;
+                for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+                    seen += buckets[i].load(std::memory_order_relaxed);
+                    if (seen > target) {
+                        return bucketUpperBound(i);
+                    }
+                }
+                return bucketUpperBound(BUCKET_COUNT - 1);
+            }
+        };
+
         /**
          * @brief RAII timer for automatic duration measurement
          *
@@ -172,6 +245,22 @@ WEBSOCKET_NAMESPACE_BEGIN
          */
         TimerStats getTimerStats(const std::string& name) const;
 
+        // ===== HISTOGRAM METRICS =====
+
+        /**
+         * @brief Record a value into a histogram metric
+         * @param name Histogram name
+         * @param value Value to record (e.g. latency in microseconds)
+         */
+        void recordHistogram(const std::string& name, int64_t value);
+
+        /**
+         * @brief Get histogram statistics
+         * @param name Histogram name
+         * @return Pointer to histogram statistics, or nullptr if not found
+         */
+        const HistogramStats* getHistogramStats(const std::string& name) const;
+
         // ===== THROUGHPUT METRICS =====
 
         /**
@@ -233,6 +322,12 @@ WEBSOCKET_NAMESPACE_BEGIN
          */
         void resetTimer(const std::string& name);
 
+        /**
+         * @brief Reset specific histogram
+         * @param name Histogram name
+         */
+        void resetHistogram(const std::string& name);
+
         /**
          * @brief Reset specific throughput metric
          * @param name Throughput metric name
@@ -307,6 +402,9 @@ WEBSOCKET_NAMESPACE_BEGIN
         // Throughput: for rate calculations
         std::unordered_map<std::string, ThroughputStats> throughput_;
 
+        // Histograms: for latency and size distributions
+        std::unordered_map<std::string, HistogramStats> histograms_;
+
         // Singleton instance
         static std::unique_ptr<Metrics> instance_;
         static std::once_flag initFlag_;
@@ -329,6 +427,9 @@ WEBSOCKET_NAMESPACE_BEGIN
 #define METRICS_TIMER(name) CppWebSocket::Metrics::Timer timer_##__LINE__(name)
 #define METRICS_RECORD_TIMER(name, duration) CppWebSocket::Metrics::getInstance().recordTimer(name, duration)
 
+// Histogram macros
+#define METRICS_RECORD_HISTOGRAM(name, value) CppWebSocket::Metrics::getInstance().recordHistogram(name, value)
+
 // Throughput macros
 #define METRICS_RECORD_THROUGHPUT(name) CppWebSocket::Metrics::getInstance().recordThroughput(name)
 #define METRICS_RECORD_THROUGHPUT_BY(name, count) CppWebSocket::Metrics::getInstance().recordThroughput(name, count)
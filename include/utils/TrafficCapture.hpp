@@ -0,0 +1,399 @@
+#pragma once
+#ifndef WEBSOCKET_TRAFFIC_CAPTURE_HPP
+#define WEBSOCKET_TRAFFIC_CAPTURE_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @namespace TrafficCapture
+ * @brief Compact binary capture of inbound session traffic
+ *
+ * A capture is a directory of segment files (capture-000000.cwsc, ...).
+ * Each segment starts with a 16-byte header:
+ *
+ *   magic "CWSC" | version u16 | reserved u16 | segment index u32 | reserved u32
+ *
+ * followed by records:
+ *
+ *   varint time delta (us since previous record) | varint ClientID |
+ *   kind u8 | varint length | payload
+ *
+ * OPEN records carry the client's upgrade request, FRAME records the raw
+ * inbound frame bytes exactly as received (still masked), CLOSE records are
+ * empty. Segments are written through a memory mapping and truncated to their
+ * used length when rotated or closed.
+ */
+namespace TrafficCapture {
+
+    constexpr char SEGMENT_MAGIC[4] = { 'C', 'W', 'S', 'C' };
+    constexpr uint16_t FORMAT_VERSION = 1;
+    constexpr size_t SEGMENT_HEADER_SIZE = 16;
+
+    /**
+     * @brief Record kinds
+     */
+    enum class RecordKind : uint8_t {
+        OPEN = 1,       ///< Session opened; payload is the upgrade request
+        FRAME = 2,      ///< Inbound frame; payload is the raw frame
+        CLOSE = 3       ///< Session closed
+    };
+
+    /**
+     * @brief Decoded record
+     */
+    struct Record {
+        std::chrono::microseconds offset{ 0 };  ///< Time since capture start
+        ClientID client_id{ 0 };                ///< Session identifier
+        RecordKind kind{ RecordKind::FRAME };   ///< Record kind
+        Buffer payload;                         ///< Request or frame bytes
+    };
+
+    /**
+     * @brief Segment file name for an index
+     * @param directory Capture directory
+     * @param index Segment index
+     * @return Path of the segment file
+     */
+    inline std::string segmentPath(const std::string& directory, uint32_t index) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "capture-%06u.cwsc", index);
+        return (std::filesystem::path(directory) / name).string();
+    }
+
+    /**
+     * @class Writer
+     * @brief Appends records to memory-mapped segment files
+     *
+     * Thread-safe: sessions on different I/O threads record concurrently.
+     */
+    class Writer : public NonCopyable {
+    public:
+        /**
+         * @brief Writer options
+         */
+        struct Options {
+            size_t segment_size{ 64 * 1024 * 1024 };   ///< Bytes per segment file
+            size_t max_segments{ 0 };                   ///< Stop capturing after this many (0 = unlimited)
+        };
+
+        /**
+         * @brief Open a capture directory for writing
+         * @param directory Directory (created if missing)
+         * @param options Writer options
+         * @note Segments left by an earlier capture in the same directory are
+         *       removed, so the Reader never splices them onto this one
+         */
+        Writer(std::string directory, const Options& options)
+            : directory_(std::move(directory)), options_(options),
+            started_(std::chrono::steady_clock::now()), last_record_(started_) {
+            options_.segment_size = std::max<size_t>(options_.segment_size, 64 * 1024);
+            std::error_code ec;
+            std::filesystem::create_directories(directory_, ec);
+            removeStaleSegments();
+        }
+
+        ~Writer() {
+            std::lock_guard lock(mutex_);
+            closeSegment();
+        }
+
+        /**
+         * @brief Record a session opening
+         * @param id Session identifier
+         * @param request Client upgrade request
+         * @return true if recorded
+         */
+        bool recordOpen(ClientID id, const std::string& request) {
+            return append(id, RecordKind::OPEN,
+                reinterpret_cast<const uint8_t*>(request.data()), request.size());
+        }
+
+        /**
+         * @brief Record an inbound frame
+         * @param id Session identifier
+         * @param frame Raw frame bytes as received
+         * @return true if recorded
+         */
+        bool recordFrame(ClientID id, const Buffer& frame) {
+            return append(id, RecordKind::FRAME, frame.data(), frame.size());
+        }
+
+        /**
+         * @brief Record a session closing
+         * @param id Session identifier
+         * @return true if recorded
+         */
+        bool recordClose(ClientID id) {
+            return append(id, RecordKind::CLOSE, nullptr, 0);
+        }
+
+        /**
+         * @brief Get number of records written
+         * @return Record count
+         */
+        uint64_t getRecordCount() const {
+            std::lock_guard lock(mutex_);
+            return records_;
+        }
+
+    private:
+        bool append(ClientID id, RecordKind kind, const uint8_t* data, size_t size) {
+            std::lock_guard lock(mutex_);
+            if (full_) {
+                return false;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(now - last_record_);
+
+            uint8_t header[32];
+            size_t header_size = 0;
+            header_size += writeVarint(header + header_size, static_cast<uint64_t>(std::max<int64_t>(delta.count(), 0)));
+            header_size += writeVarint(header + header_size, id);
+            header[header_size++] = static_cast<uint8_t>(kind);
+            header_size += writeVarint(header + header_size, size);
+
+            const size_t needed = header_size + size;
+            if (needed > options_.segment_size - SEGMENT_HEADER_SIZE) {
+                return false; // Larger than a segment; never fits
+            }
+            if (!mapping_ || used_ + needed > options_.segment_size) {
+                closeSegment();
+                if (!openSegment()) {
+                    full_ = true;
+                    return false;
+                }
+            }
+
+            std::memcpy(mapping_ + used_, header, header_size);
+            if (size > 0) {
+                std::memcpy(mapping_ + used_ + header_size, data, size);
+            }
+            used_ += needed;
+            last_record_ = now;
+            records_++;
+            return true;
+        }
+
+        static size_t writeVarint(uint8_t* out, uint64_t value) {
+            size_t n = 0;
+            while (value >= 0x80) {
+                out[n++] = static_cast<uint8_t>(value | 0x80);
+                value >>= 7;
+            }
+            out[n++] = static_cast<uint8_t>(value);
+            return n;
+        }
+
+        void removeStaleSegments() {
+            std::error_code ec;
+            for (const auto& entry : std::filesystem::directory_iterator(directory_, ec)) {
+                const std::string name = entry.path().filename().string();
+                if (name.size() > 13 && name.compare(0, 8, "capture-") == 0 &&
+                    name.compare(name.size() - 5, 5, ".cwsc") == 0) {
+                    std::error_code remove_ec;
+                    std::filesystem::remove(entry.path(), remove_ec);
+                }
+            }
+        }
+
+        bool openSegment() {
+            if (options_.max_segments > 0 && segment_index_ >= options_.max_segments) {
+                return false;
+            }
+            const std::string path = segmentPath(directory_, segment_index_);
+#ifndef _WIN32
+            fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd_ < 0 || ::ftruncate(fd_, static_cast<off_t>(options_.segment_size)) != 0) {
+                closeSegment();
+                return false;
+            }
+            void* mapping = ::mmap(nullptr, options_.segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            if (mapping == MAP_FAILED) {
+                closeSegment();
+                return false;
+            }
+            mapping_ = static_cast<uint8_t*>(mapping);
+#else
+            file_ = std::fopen(path.c_str(), "wb");
+            if (!file_) {
+                return false;
+            }
+            heap_.assign(options_.segment_size, 0);
+            mapping_ = heap_.data();
+#endif
+            std::memcpy(mapping_, SEGMENT_MAGIC, 4);
+            mapping_[4] = static_cast<uint8_t>(FORMAT_VERSION >> 8);
+            mapping_[5] = static_cast<uint8_t>(FORMAT_VERSION);
+            std::memset(mapping_ + 6, 0, SEGMENT_HEADER_SIZE - 6);
+            for (int i = 0; i < 4; ++i) {
+                mapping_[8 + i] = static_cast<uint8_t>(segment_index_ >> (24 - 8 * i));
+            }
+            used_ = SEGMENT_HEADER_SIZE;
+            segment_index_++;
+            return true;
+        }
+
+        void closeSegment() {
+#ifndef _WIN32
+            if (mapping_) {
+                ::munmap(mapping_, options_.segment_size);
+            }
+            if (fd_ >= 0) {
+                // Drop the unused tail of the preallocated segment
+                [[maybe_unused]] int rc = ::ftruncate(fd_, static_cast<off_t>(used_));
+                ::close(fd_);
+                fd_ = -1;
+            }
+#else
+            if (file_) {
+                std::fwrite(heap_.data(), 1, used_, file_);
+                std::fclose(file_);
+                file_ = nullptr;
+            }
+#endif
+            mapping_ = nullptr;
+            used_ = 0;
+        }
+
+        std::string directory_;
+        Options options_;
+        mutable std::mutex mutex_;
+        Timestamp started_;
+        Timestamp last_record_;
+        uint8_t* mapping_{ nullptr };
+        size_t used_{ 0 };
+        uint32_t segment_index_{ 0 };
+        uint64_t records_{ 0 };
+        bool full_{ false };
+#ifndef _WIN32
+        int fd_{ -1 };
+#else
+        std::FILE* file_{ nullptr };
+        std::vector<uint8_t> heap_;
+#endif
+    };
+
+    /**
+     * @class Reader
+     * @brief Reads records from a capture directory in order
+     */
+    class Reader : public NonCopyable {
+    public:
+        /**
+         * @brief Open a capture directory
+         * @param directory Directory written by Writer
+         */
+        explicit Reader(std::string directory)
+            : directory_(std::move(directory)) {
+        }
+
+        /**
+         * @brief Read the next record
+         * @param record Output record
+         * @return false at end of capture or on a corrupt segment
+         *
+         * @note A segment the writer never closed (crash, kill -9) keeps its
+         *       preallocated zero tail; reading stops at the first kind-0 record
+         */
+        bool next(Record& record) {
+            uint64_t delta = 0, id = 0, length = 0;
+            uint8_t kind = 0;
+            for (;;) {
+                while (position_ >= segment_.size()) {
+                    if (!loadSegment()) {
+                        return false;
+                    }
+                }
+                if (!readVarint(delta) || !readVarint(id) || position_ >= segment_.size()) {
+                    return false;
+                }
+                kind = segment_[position_++];
+                if (!readVarint(length)) {
+                    return false;
+                }
+                if (kind != 0) {
+                    break;
+                }
+                if (length != 0) {
+                    return false;
+                }
+                // Zero tail: nothing more was written to this segment
+                position_ = segment_.size();
+            }
+            if (kind > static_cast<uint8_t>(RecordKind::CLOSE) || length > segment_.size() - position_) {
+                return false;
+            }
+
+            offset_ += std::chrono::microseconds(delta);
+            record.offset = offset_;
+            record.client_id = id;
+            record.kind = static_cast<RecordKind>(kind);
+            record.payload.assign(segment_.begin() + position_, segment_.begin() + position_ + length);
+            position_ += length;
+            return true;
+        }
+
+    private:
+        bool loadSegment() {
+            std::FILE* file = std::fopen(segmentPath(directory_, next_segment_).c_str(), "rb");
+            if (!file) {
+                return false;
+            }
+            segment_.clear();
+            uint8_t chunk[65536];
+            size_t n;
+            while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+                segment_.insert(segment_.end(), chunk, chunk + n);
+            }
+            std::fclose(file);
+
+            if (segment_.size() < SEGMENT_HEADER_SIZE || std::memcmp(segment_.data(), SEGMENT_MAGIC, 4) != 0) {
+                return false;
+            }
+            position_ = SEGMENT_HEADER_SIZE;
+            next_segment_++;
+            return true;
+        }
+
+        bool readVarint(uint64_t& value) {
+            value = 0;
+            for (int shift = 0; shift < 64 && position_ < segment_.size(); shift += 7) {
+                const uint8_t byte = segment_[position_++];
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::string directory_;
+        Buffer segment_;
+        size_t position_{ 0 };
+        uint32_t next_segment_{ 0 };
+        std::chrono::microseconds offset_{ 0 };
+    };
+
+} // namespace TrafficCapture
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_TRAFFIC_CAPTURE_HPP
@@ -0,0 +1,151 @@
+#pragma once
+#ifndef WEBSOCKET_VIRTUAL_CLOCK_HPP
+#define WEBSOCKET_VIRTUAL_CLOCK_HPP
+
+#include "../common/Types.hpp"
+#include "../common/NonCopyable.hpp"
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+/**
+ * @class VirtualClock
+ * @brief Deterministic simulated time with a timer queue
+ *
+ * Time only moves when the owner advances it, and timers due at the same
+ * instant fire in scheduling order, so a simulation driven by one clock and
+ * one seed replays identically. Components that already take an explicit
+ * "now" (HeartbeatScheduler::tick, DrainController::takeDue, RttEstimator)
+ * are driven by passing clock.now().
+ *
+ * Not thread-safe: a simulation runs on a single thread.
+ */
+class VirtualClock : public NonCopyable {
+public:
+    using TimerId = uint64_t;
+    using Callback = std::function<void()>;
+
+    /**
+     * @brief Construct clock
+     * @param start Initial time (non-zero by default, so "unset" timestamps stand out)
+     */
+    explicit VirtualClock(Timestamp start = Timestamp(std::chrono::hours(1)))
+        : now_(start) {
+    }
+
+    /**
+     * @brief Get current simulated time
+     * @return Current time
+     */
+    Timestamp now() const { return now_; }
+
+    /**
+     * @brief Schedule a callback at an absolute time
+     * @param when Fire time (clamped to now)
+     * @param callback Callback
+     * @return Timer identifier for cancel()
+     */
+    TimerId schedule(Timestamp when, Callback callback) {
+        const TimerId id = next_id_++;
+        const Key key{ std::max(when, now_), id };
+        timers_.emplace(key, std::move(callback));
+        index_.emplace(id, key);
+        return id;
+    }
+
+    /**
+     * @brief Schedule a callback after a delay
+     * @param delay Delay from now
+     * @param callback Callback
+     * @return Timer identifier for cancel()
+     */
+    TimerId scheduleAfter(Duration delay, Callback callback) {
+        return schedule(now_ + delay, std::move(callback));
+    }
+
+    /**
+     * @brief Cancel a pending timer
+     * @param id Timer identifier
+     * @return true if the timer was pending
+     */
+    bool cancel(TimerId id) {
+        auto it = index_.find(id);
+        if (it == index_.end()) {
+            return false;
+        }
+        timers_.erase(it->second);
+        index_.erase(it);
+        return true;
+    }
+
+    /**
+     * @brief Advance time, firing every timer due up to and including target
+     * @param target New time
+     * @return Number of timers fired
+     */
+    size_t advanceTo(Timestamp target) {
+        size_t fired = 0;
+        while (!timers_.empty() && timers_.begin()->first.first <= target) {
+            fired += fireNext();
+        }
+        now_ = std::max(now_, target);
+        return fired;
+    }
+
+    /**
+     * @brief Advance time by a duration
+     * @param delta Time to advance
+     * @return Number of timers fired
+     */
+    size_t advance(Duration delta) {
+        return advanceTo(now_ + delta);
+    }
+
+    /**
+     * @brief Jump from timer to timer until none are left
+     * @param max_timers Safety limit on timers fired
+     * @return Number of timers fired
+     *
+     * @note Periodic timers re-arm forever; use advanceTo() for those
+     */
+    size_t runUntilIdle(size_t max_timers = std::numeric_limits<size_t>::max()) {
+        size_t fired = 0;
+        while (!timers_.empty() && fired < max_timers) {
+            fired += fireNext();
+        }
+        return fired;
+    }
+
+    /**
+     * @brief Get number of pending timers
+     * @return Pending timer count
+     */
+    size_t pending() const { return timers_.size(); }
+
+private:
+    using Key = std::pair<Timestamp, TimerId>;
+
+    size_t fireNext() {
+        auto it = timers_.begin();
+        now_ = std::max(now_, it->first.first);
+        Callback callback = std::move(it->second);
+        index_.erase(it->first.second);
+        timers_.erase(it);
+        callback();
+        return 1;
+    }
+
+    Timestamp now_;
+    TimerId next_id_{ 1 };
+    std::map<Key, Callback> timers_;
+    std::unordered_map<TimerId, Key> index_;
+};
+
+WEBSOCKET_NAMESPACE_END
+
+#endif // WEBSOCKET_VIRTUAL_CLOCK_HPP
@@ -0,0 +1,217 @@
+#include "network/EndPoint.hpp"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <tuple>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+WEBSOCKET_NAMESPACE_BEGIN
+
+Endpoint::Endpoint() = default;
+
+Endpoint::Endpoint(const std::string& address, uint16_t port)
+    : port_(port), address_string_(address) {
+    // IP literals are parsed; anything else is kept as a host name with an
+    // unspecified family (resolution is left to resolve() / DnsResolver)
+    if (!parseIPv4(address) && !parseIPv6(address)) {
+        family_ = Family::UNSPECIFIED;
+        address_data_.clear();
+    }
+}
+
+Endpoint::Endpoint(Family family, const Buffer& data, uint16_t port)
+    : port_(port) {
+    if ((family == Family::IPv4 && data.size() == 4) || (family == Family::IPv6 && data.size() == 16)) {
+        family_ = family;
+        address_data_ = data;
+        normalize();
+    }
+}
+
+std::optional<Endpoint> Endpoint::fromString(const std::string& endpoint_string) {
+    std::string address;
+    std::string port;
+    if (!endpoint_string.empty() && endpoint_string.front() == '[') {
+        // [IPv6]:port
+        const size_t close = endpoint_string.find(']');
+        if (close == std::string::npos || close + 1 >= endpoint_string.size() || endpoint_string[close + 1] != ':') {
+            return std::nullopt;
+        }
+        address = endpoint_string.substr(1, close - 1);
+        port = endpoint_string.substr(close + 2);
+    }
+    else {
+        const size_t colon = endpoint_string.rfind(':');
+        if (colon == std::string::npos || endpoint_string.find(':') != colon) {
+            return std::nullopt; // No port, or a bare IPv6 address without brackets
+        }
+        address = endpoint_string.substr(0, colon);
+        port = endpoint_string.substr(colon + 1);
+    }
+
+    if (address.empty() || port.empty() || port.size() > 5 ||
+        !std::all_of(port.begin(), port.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        return std::nullopt;
+    }
+    const unsigned long value = std::stoul(port);
+    if (value > 65535) {
+        return std::nullopt;
+    }
+    return Endpoint(address, static_cast<uint16_t>(value));
+}
+
+std::vector<Endpoint> Endpoint::resolve(const std::string& hostname, const std::string& service, Family family) {
+    addrinfo hints{};
+    hints.ai_family = family == Family::IPv4 ? AF_INET : family == Family::IPv6 ? AF_INET6 : AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* results = nullptr;
+    if (::getaddrinfo(hostname.c_str(), service.empty() ? nullptr : service.c_str(), &hints, &results) != 0) {
+        return {};
+    }
+
+    std::vector<Endpoint> endpoints;
+    for (const addrinfo* info = results; info; info = info->ai_next) {
+        if (info->ai_family == AF_INET) {
+            const auto* address = reinterpret_cast<const sockaddr_in*>(info->ai_addr);
+            const auto* bytes = reinterpret_cast<const uint8_t*>(&address->sin_addr);
+            endpoints.emplace_back(Family::IPv4, Buffer(bytes, bytes + 4), ntohs(address->sin_port));
+        }
+        else if (info->ai_family == AF_INET6) {
+            const auto* address = reinterpret_cast<const sockaddr_in6*>(info->ai_addr);
+            const auto* bytes = reinterpret_cast<const uint8_t*>(&address->sin6_addr);
+            endpoints.emplace_back(Family::IPv6, Buffer(bytes, bytes + 16), ntohs(address->sin6_port));
+        }
+        else {
+            continue;
+        }
+        // The same address is returned once per protocol on some systems
+        if (std::find(endpoints.begin(), endpoints.end() - 1, endpoints.back()) != endpoints.end() - 1) {
+            endpoints.pop_back();
+        }
+    }
+    ::freeaddrinfo(results);
+    return endpoints;
+}
+
+std::string Endpoint::toString() const {
+    if (family_ == Family::IPv6) {
+        return "[" + address_string_ + "]:" + std::to_string(port_);
+    }
+    return address_string_ + ":" + std::to_string(port_);
+}
+
+std::string Endpoint::getAddress() const {
+    return address_string_;
+}
+
+uint16_t Endpoint::getPort() const {
+    return port_;
+}
+
+Endpoint::Family Endpoint::getFamily() const {
+    return family_;
+}
+
+bool Endpoint::isValid() const {
+    return family_ != Family::UNSPECIFIED;
+}
+
+bool Endpoint::isIPv4() const {
+    return family_ == Family::IPv4;
+}
+
+bool Endpoint::isIPv6() const {
+    return family_ == Family::IPv6;
+}
+
+bool Endpoint::isLoopback() const {
+    if (family_ == Family::IPv4) {
+        return address_data_[0] == 127;
+    }
+    if (family_ == Family::IPv6) {
+        static const uint8_t loopback[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+        return std::memcmp(address_data_.data(), loopback, 16) == 0;
+    }
+    return false;
+}
+
+bool Endpoint::isPrivate() const {
+    if (family_ == Family::IPv4) {
+        return address_data_[0] == 10 ||
+            (address_data_[0] == 172 && (address_data_[1] & 0xF0) == 16) ||
+            (address_data_[0] == 192 && address_data_[1] == 168);
+    }
+    if (family_ == Family::IPv6) {
+        return (address_data_[0] & 0xFE) == 0xFC; // Unique local fc00::/7 (RFC 4193)
+    }
+    return false;
+}
+
+bool Endpoint::operator==(const Endpoint& other) const {
+    return family_ == other.family_ && port_ == other.port_ &&
+        (family_ == Family::UNSPECIFIED ? address_string_ == other.address_string_ : address_data_ == other.address_data_);
+}
+
+bool Endpoint::operator!=(const Endpoint& other) const {
+    return !(*this == other);
+}
+
+bool Endpoint::operator<(const Endpoint& other) const {
+    if (family_ == Family::UNSPECIFIED && other.family_ == Family::UNSPECIFIED) {
+        return std::tie(address_string_, port_) < std::tie(other.address_string_, other.port_);
+    }
+    return std::tie(family_, address_data_, port_) < std::tie(other.family_, other.address_data_, other.port_);
+}
+
+std::size_t Endpoint::Hash::operator()(const Endpoint& endpoint) const {
+    std::size_t hash = std::hash<std::string>{}(endpoint.family_ == Family::UNSPECIFIED
+        ? endpoint.address_string_
+        : std::string(endpoint.address_data_.begin(), endpoint.address_data_.end()));
+    hash ^= (static_cast<std::size_t>(endpoint.port_) << 1) ^ static_cast<std::size_t>(endpoint.family_);
+    return hash;
+}
+
+bool Endpoint::parseIPv4(const std::string& address) {
+    in_addr parsed{};
+    if (::inet_pton(AF_INET, address.c_str(), &parsed) != 1) {
+        return false;
+    }
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&parsed);
+    family_ = Family::IPv4;
+    address_data_.assign(bytes, bytes + 4);
+    normalize();
+    return true;
+}
+
+bool Endpoint::parseIPv6(const std::string& address) {
+    in6_addr parsed{};
+    if (::inet_pton(AF_INET6, address.c_str(), &parsed) != 1) {
+        return false;
+    }
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&parsed);
+    family_ = Family::IPv6;
+    address_data_.assign(bytes, bytes + 16);
+    normalize();
+    return true;
+}
+
+void Endpoint::normalize() {
+    // Canonical text form, e.g. "::1" for "0:0:0:0:0:0:0:1"
+    char text[INET6_ADDRSTRLEN] = {};
+    const int af = family_ == Family::IPv6 ? AF_INET6 : AF_INET;
+    if (::inet_ntop(af, address_data_.data(), text, sizeof(text))) {
+        address_string_ = text;
+    }
+}
+
+WEBSOCKET_NAMESPACE_END
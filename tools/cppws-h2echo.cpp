@@ -0,0 +1,364 @@
+/**
+ * @file cppws-h2echo.cpp
+ * @brief WebSocket echo server over HTTP/2 (RFC 8441), cleartext, for loopback testing
+ *
+ * Accepts h2c connections with prior knowledge on 127.0.0.1, runs each
+ * through Http2FrontEnd and echoes every WebSocket data frame back on its
+ * stream. Any HTTP/2 client that speaks extended CONNECT can drive it,
+ * e.g. a script using Python's h2 package or nghttp2; many WebSocket
+ * streams can share one connection.
+ *
+ * Usage:
+ *   cppws-h2echo [--port N] [--window BYTES] [--high-water BYTES] [--streams N]
+ *
+ * --window sets the per-stream receive window; a small window together
+ * with a client that stops reading shows flow control pushing back on the
+ * sender. Per-connection HTTP/2 statistics are printed when a connection
+ * closes.
+ */
+
+#include "network/Http2Transport.hpp"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace CppWebSocket;
+
+namespace {
+
+    volatile std::sig_atomic_t g_stop = 0;
+
+    struct EchoOptions {
+        uint16_t port{ 8080 };
+        Http2Connection::Config http2;
+    };
+
+    /**
+     * @brief Non-blocking socket driven by the poll loop
+     */
+    class SocketTransport final : public Transport {
+    public:
+        SocketTransport(int fd, Endpoint remote) : fd_(fd), remote_(std::move(remote)) {}
+
+        ~SocketTransport() override {
+            if (fd_ >= 0) {
+                ::close(fd_);
+            }
+        }
+
+        void startReading(ReceiveHandler on_data, CloseHandler on_close) override {
+            on_data_ = std::move(on_data);
+            on_close_ = std::move(on_close);
+        }
+
+        bool write(std::vector<Buffer> buffers) override {
+            if (!open_) {
+                return false;
+            }
+            for (const Buffer& buffer : buffers) {
+                output_.insert(output_.end(), buffer.begin(), buffer.end());
+            }
+            flush();
+            return true;
+        }
+
+        void close() override {
+            open_ = false;
+            flush();
+        }
+
+        bool isOpen() const override { return open_; }
+
+        Endpoint getRemoteEndpoint() const override { return remote_; }
+
+        int fd() const { return fd_; }
+
+        /// Done once closed (either side) and everything written
+        bool finished() const { return fd_ < 0; }
+
+        short events() const { return static_cast<short>(POLLIN | (output_.empty() ? 0 : POLLOUT)); }
+
+        void onReadable() {
+            uint8_t chunk[16384];
+            const ssize_t received = ::recv(fd_, chunk, sizeof(chunk), 0);
+            if (received > 0) {
+                if (!open_) {
+                    return;                 // closed locally: discard until the peer closes too
+                }
+                auto handler = on_data_;    // the handler may close us and drop on_data_
+                if (handler) {
+                    handler(Buffer(chunk, chunk + received));
+                }
+                return;
+            }
+            if (received < 0 && (errno == EAGAIN || errno == EINTR)) {
+                return;
+            }
+            open_ = false;
+            output_.clear();
+            finish();
+        }
+
+        void flush() {
+            while (fd_ >= 0 && !output_.empty()) {
+                const ssize_t sent = ::send(fd_, output_.data(), output_.size(), MSG_NOSIGNAL);
+                if (sent < 0) {
+                    if (errno == EAGAIN || errno == EINTR) {
+                        return;
+                    }
+                    output_.clear();
+                    open_ = false;
+                    break;
+                }
+                output_.erase(output_.begin(), output_.begin() + sent);
+            }
+            if (!open_ && output_.empty() && !draining_ && fd_ >= 0) {
+                // Half-close, then read until the peer closes; closing with unread
+                // input would reset the connection and could lose the GOAWAY
+                ::shutdown(fd_, SHUT_WR);
+                draining_ = true;
+            }
+        }
+
+    private:
+        void finish() {
+            if (fd_ < 0) {
+                return;
+            }
+            ::close(fd_);
+            fd_ = -1;
+            // Never fires again; don't keep the front end alive
+            auto on_close = std::move(on_close_);
+            on_data_ = nullptr;
+            on_close_ = nullptr;
+            if (on_close) {
+                on_close();
+            }
+        }
+
+        int fd_;
+        Endpoint remote_;
+        ReceiveHandler on_data_;
+        CloseHandler on_close_;
+        Buffer output_;
+        bool open_{ true };
+        bool draining_{ false };
+    };
+
+    /**
+     * @brief Echoes WebSocket frames on one stream; keeps itself alive through its handlers
+     */
+    class EchoSession : public std::enable_shared_from_this<EchoSession> {
+    public:
+        explicit EchoSession(std::unique_ptr<Transport> transport) : transport_(std::move(transport)) {}
+
+        void start() {
+            auto self = shared_from_this();
+            transport_->startReading(
+                [self](const Buffer& data) { self->onData(data); },
+                [self]() { self->transport_->close(); });
+        }
+
+    private:
+        void onData(const Buffer& data) {
+            input_.insert(input_.end(), data.begin(), data.end());
+            size_t offset = 0;
+            for (;;) {
+                const size_t available = input_.size() - offset;
+                if (available < 2) {
+                    break;
+                }
+                const uint8_t* frame = input_.data() + offset;
+                uint64_t length = frame[1] & 0x7F;
+                size_t header = 2;
+                if (length == 126 || length == 127) {
+                    const size_t bytes = length == 126 ? 2 : 8;
+                    if (available < header + bytes) {
+                        break;
+                    }
+                    length = 0;
+                    for (size_t i = 0; i < bytes; ++i) {
+                        length = (length << 8) | frame[header + i];
+                    }
+                    header += bytes;
+                }
+                if ((frame[1] & 0x80) == 0 || length > (1u << 24)) {
+                    transport_->close();    // client frames must be masked; oversized frames are refused
+                    return;
+                }
+                if (available < header + 4 + length) {
+                    break;
+                }
+                const uint8_t* mask = frame + header;
+                Buffer payload(frame + header + 4, frame + header + 4 + length);
+                for (size_t i = 0; i < payload.size(); ++i) {
+                    payload[i] ^= mask[i & 3];
+                }
+                offset += header + 4 + static_cast<size_t>(length);
+
+                const uint8_t opcode = frame[0] & 0x0F;
+                if (opcode == 0x9) {
+                    reply(0x80 | 0xA, payload);     // ping -> pong
+                } else if (opcode == 0x8) {
+                    reply(0x80 | 0x8, payload);     // close handshake, then END_STREAM
+                    transport_->close();
+                    return;
+                } else if (opcode <= 0x2) {
+                    reply(frame[0], payload);       // data and continuation frames, FIN as received
+                }
+            }
+            input_.erase(input_.begin(), input_.begin() + static_cast<std::ptrdiff_t>(offset));
+        }
+
+        void reply(uint8_t first, const Buffer& payload) {
+            Buffer header{ first };
+            if (payload.size() < 126) {
+                header.push_back(static_cast<uint8_t>(payload.size()));
+            } else if (payload.size() <= 0xFFFF) {
+                header.push_back(126);
+                header.push_back(static_cast<uint8_t>(payload.size() >> 8));
+                header.push_back(static_cast<uint8_t>(payload.size()));
+            } else {
+                header.push_back(127);
+                for (int shift = 56; shift >= 0; shift -= 8) {
+                    header.push_back(static_cast<uint8_t>(static_cast<uint64_t>(payload.size()) >> shift));
+                }
+            }
+            std::vector<Buffer> buffers;
+            buffers.push_back(std::move(header));
+            buffers.push_back(payload);
+            if (!transport_->write(std::move(buffers))) {
+                transport_->close();        // stream queue over its limit: the client is not reading
+            }
+        }
+
+        std::unique_ptr<Transport> transport_;
+        Buffer input_;
+    };
+
+    struct Client {
+        SocketTransport* transport;
+        std::shared_ptr<Http2FrontEnd> front_end;
+    };
+
+    bool parseArgs(int argc, char** argv, EchoOptions& options) {
+        for (int i = 1; i + 1 < argc; i += 2) {
+            const std::string flag = argv[i];
+            const unsigned long value = std::strtoul(argv[i + 1], nullptr, 10);
+            if (flag == "--port" && value != 0 && value <= 0xFFFF) {
+                options.port = static_cast<uint16_t>(value);
+            } else if (flag == "--window" && value >= 65535 && value <= 0x7FFFFFFF) {
+                options.http2.initial_window_size = static_cast<uint32_t>(value);
+            } else if (flag == "--high-water" && value != 0) {
+                options.http2.stream_high_water = value;
+            } else if (flag == "--streams" && value != 0) {
+                options.http2.max_concurrent_streams = static_cast<uint32_t>(value);
+            } else {
+                return false;
+            }
+        }
+        return (argc - 1) % 2 == 0;
+    }
+
+    void printStats(const Http2Connection::Stats& stats) {
+        std::cout << "connection closed: streams opened=" << stats.streams_opened
+                  << " rejected=" << stats.streams_rejected << " refused=" << stats.streams_refused
+                  << " reset=" << stats.streams_reset << " bytes in=" << stats.bytes_in
+                  << " out=" << stats.bytes_out << " window updates=" << stats.window_updates
+                  << " flow blocked=" << stats.flow_blocked << std::endl;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    EchoOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        std::cerr << "usage: cppws-h2echo [--port N] [--window BYTES] [--high-water BYTES] [--streams N]\n";
+        return 2;
+    }
+    std::signal(SIGINT, [](int) { g_stop = 1; });
+    std::signal(SIGTERM, [](int) { g_stop = 1; });
+
+    const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    const int reuse = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, 64) != 0) {
+        std::cerr << "cppws-h2echo: cannot listen on 127.0.0.1:" << options.port << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    std::cout << "listening on 127.0.0.1:" << options.port << " (h2c, prior knowledge)" << std::endl;
+
+    Http2FrontEnd::Config config;
+    config.http2 = options.http2;
+    std::list<Client> clients;
+    std::vector<pollfd> fds;
+
+    while (!g_stop) {
+        fds.assign(1, pollfd{ listener, POLLIN, 0 });
+        for (const Client& client : clients) {
+            fds.push_back(pollfd{ client.transport->fd(), client.transport->events(), 0 });
+        }
+        if (::poll(fds.data(), fds.size(), 200) < 0) {
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            sockaddr_in peer{};
+            socklen_t peer_size = sizeof(peer);
+            const int fd = ::accept(listener, reinterpret_cast<sockaddr*>(&peer), &peer_size);
+            if (fd >= 0) {
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+                const int nodelay = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+                char host[INET_ADDRSTRLEN] = {};
+                ::inet_ntop(AF_INET, &peer.sin_addr, host, sizeof(host));
+                auto transport = std::make_unique<SocketTransport>(fd, Endpoint(host, ntohs(peer.sin_port)));
+                SocketTransport* raw = transport.get();
+                auto front_end = Http2FrontEnd::create(std::move(transport),
+                    [](std::unique_ptr<Transport> stream, const Http2FrontEnd::Request&) {
+                        std::make_shared<EchoSession>(std::move(stream))->start();
+                    }, config);
+                front_end->start();
+                clients.push_back(Client{ raw, front_end });
+            }
+        }
+
+        size_t index = 1;
+        for (Client& client : clients) {
+            const short revents = index < fds.size() ? fds[index++].revents : 0;
+            if (revents & POLLOUT) {
+                client.transport->flush();
+            }
+            if (!client.transport->finished() && (revents & (POLLIN | POLLHUP | POLLERR))) {
+                client.transport->onReadable();
+            }
+        }
+        for (auto it = clients.begin(); it != clients.end();) {
+            if (it->transport->finished()) {
+                printStats(it->front_end->getStats());
+                it = clients.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    ::close(listener);
+    return 0;
+}
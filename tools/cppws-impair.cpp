@@ -0,0 +1,522 @@
+/**
+ * @file cppws-impair.cpp
+ * @brief Userspace TCP proxy that degrades the link between a load client and a server
+ *
+ * Sits between a loopback benchmark client (cppws-replay or any other) and
+ * the server and applies a NetworkImpairment per direction: delay
+ * distributions, bandwidth caps, loss recovery stalls, link stalls and
+ * connection resets. No root or netem is needed.
+ *
+ * Usage:
+ *   cppws-impair <listen-port> <upstream-host> <upstream-port>
+ *                [--up SPEC] [--down SPEC] [--seed N] [--report-every SECONDS]
+ *
+ * SPEC is a comma-separated list, applied client->server (--up) or
+ * server->client (--down):
+ *   delay=80ms          base one-way delay (us, ms, s)
+ *   jitter=30ms         spread of the distribution
+ *   dist=pareto         constant | uniform | normal | pareto
+ *   shape=1.5           pareto tail index
+ *   bw=2mbit            bandwidth cap (bytes/s, or kbit, mbit, kb, mb suffix)
+ *   loss=0.01           per-chunk retransmission probability
+ *   rto=200ms           cost of one retransmission
+ *   stall=0.001:2s      per-chunk stall probability and stall length
+ *   reset=0.0001        per-chunk reset probability
+ *   reset-after=1mb     reset once this many bytes passed
+ *
+ * Example: 3G-like downlink with a heavy latency tail
+ *   cppws-impair 9000 127.0.0.1 8080 --down delay=100ms,jitter=40ms,dist=pareto,bw=1mbit,loss=0.02
+ */
+
+#include "network/NetworkImpairment.hpp"
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace CppWebSocket;
+
+namespace {
+
+    /// Stop reading from a side while this much is queued towards the other
+    constexpr size_t MAX_QUEUED_BYTES = 4 * 1024 * 1024;
+
+    volatile sig_atomic_t g_stop = 0;
+
+    bool parseDuration(const std::string& text, Duration& out) {
+        char* end = nullptr;
+        const double value = std::strtod(text.c_str(), &end);
+        const std::string unit(end);
+        double seconds;
+        if (unit == "us") seconds = value / 1e6;
+        else if (unit == "ms" || unit.empty()) seconds = value / 1e3;
+        else if (unit == "s") seconds = value;
+        else return false;
+        out = std::chrono::duration_cast<Duration>(std::chrono::duration<double>(seconds));
+        return value >= 0.0;
+    }
+
+    bool parseBytes(const std::string& text, uint64_t& out) {
+        char* end = nullptr;
+        const double value = std::strtod(text.c_str(), &end);
+        const std::string unit(end);
+        double scale;
+        if (unit.empty() || unit == "b") scale = 1;
+        else if (unit == "kbit") scale = 1000.0 / 8;
+        else if (unit == "mbit") scale = 1000.0 * 1000.0 / 8;
+        else if (unit == "kb") scale = 1024;
+        else if (unit == "mb") scale = 1024 * 1024;
+        else return false;
+        out = static_cast<uint64_t>(value * scale);
+        return value >= 0.0;
+    }
+
+    bool parseProfile(const std::string& spec, NetworkImpairment::Profile& profile, std::string& error) {
+        std::stringstream stream(spec);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            const size_t eq = item.find('=');
+            if (eq == std::string::npos) {
+                error = "expected key=value: " + item;
+                return false;
+            }
+            const std::string key = item.substr(0, eq);
+            const std::string value = item.substr(eq + 1);
+            bool ok = true;
+
+            if (key == "delay") ok = parseDuration(value, profile.delay);
+            else if (key == "jitter") ok = parseDuration(value, profile.jitter);
+            else if (key == "rto") ok = parseDuration(value, profile.retransmit_timeout);
+            else if (key == "bw") ok = parseBytes(value, profile.bandwidth_bytes_per_sec);
+            else if (key == "reset-after") ok = parseBytes(value, profile.reset_after_bytes);
+            else if (key == "loss") profile.loss_rate = std::atof(value.c_str());
+            else if (key == "reset") profile.reset_probability = std::atof(value.c_str());
+            else if (key == "shape") profile.pareto_shape = std::atof(value.c_str());
+            else if (key == "stall") {
+                const size_t colon = value.find(':');
+                profile.stall_probability = std::atof(value.substr(0, colon).c_str());
+                if (colon != std::string::npos) {
+                    ok = parseDuration(value.substr(colon + 1), profile.stall_duration);
+                }
+            }
+            else if (key == "dist") {
+                using Dist = NetworkImpairment::DelayDistribution;
+                if (value == "constant") profile.distribution = Dist::CONSTANT;
+                else if (value == "uniform") profile.distribution = Dist::UNIFORM;
+                else if (value == "normal") profile.distribution = Dist::NORMAL;
+                else if (value == "pareto") profile.distribution = Dist::PARETO;
+                else ok = false;
+            }
+            else {
+                error = "unknown key: " + key;
+                return false;
+            }
+
+            if (!ok) {
+                error = "invalid value for " + key + ": " + value;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief One direction of a proxied connection
+     */
+    struct Direction {
+        struct Chunk {
+            Timestamp deliver_at;
+            Buffer data;
+            size_t sent{ 0 };
+        };
+
+        NetworkImpairment impairment;
+        std::deque<Chunk> queue;
+        size_t queued_bytes{ 0 };
+        bool source_closed{ false };    ///< Sender half-closed; forward once drained
+        bool shutdown_sent{ false };
+
+        Direction(const NetworkImpairment::Profile& profile, uint64_t seed)
+            : impairment(profile, seed) {
+        }
+    };
+
+    struct Connection {
+        int client_fd;
+        int upstream_fd;
+        Direction up;       ///< client -> upstream
+        Direction down;     ///< upstream -> client
+        bool reset{ false };
+
+        Connection(int client, int upstream, const NetworkImpairment::Profile& up_profile,
+            const NetworkImpairment::Profile& down_profile, uint64_t seed)
+            : client_fd(client), upstream_fd(upstream),
+            up(up_profile, seed * 2 + 1), down(down_profile, seed * 2 + 2) {
+        }
+    };
+
+    struct ProxyStats {
+        uint64_t accepted{ 0 };
+        uint64_t upstream_failures{ 0 };
+        uint64_t closed{ 0 };
+        uint64_t resets{ 0 };
+        uint64_t stalls{ 0 };
+        uint64_t losses{ 0 };
+        uint64_t bytes_up{ 0 };
+        uint64_t bytes_down{ 0 };
+        size_t max_queued_bytes{ 0 };
+    };
+
+    int listenOn(uint16_t port) {
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(fd, 1024) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    struct ResolvedAddress {
+        sockaddr_storage storage{};
+        socklen_t length{ 0 };
+    };
+
+    /**
+     * @brief Resolve a host name or IPv4/IPv6 literal once, up front
+     */
+    std::vector<ResolvedAddress> resolve(const std::string& host, uint16_t port) {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* results = nullptr;
+        if (::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &results) != 0) {
+            return {};
+        }
+        std::vector<ResolvedAddress> addresses;
+        for (const addrinfo* info = results; info; info = info->ai_next) {
+            ResolvedAddress address;
+            std::memcpy(&address.storage, info->ai_addr, info->ai_addrlen);
+            address.length = info->ai_addrlen;
+            addresses.push_back(address);
+        }
+        ::freeaddrinfo(results);
+        return addresses;
+    }
+
+    int connectTo(const std::vector<ResolvedAddress>& addresses) {
+        for (const auto& address : addresses) {
+            const int fd = ::socket(address.storage.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0) {
+                continue;
+            }
+            if (::connect(fd, reinterpret_cast<const sockaddr*>(&address.storage), address.length) == 0) {
+                return fd;
+            }
+            ::close(fd);
+        }
+        return -1;
+    }
+
+    void configure(int fd) {
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    /// Close with RST instead of FIN
+    void abortive(int fd) {
+        linger hard{ 1, 0 };
+        ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &hard, sizeof(hard));
+        ::close(fd);
+    }
+
+    class Proxy {
+    public:
+        Proxy(int listen_fd, std::vector<ResolvedAddress> upstream,
+            NetworkImpairment::Profile up, NetworkImpairment::Profile down, uint64_t seed)
+            : listen_fd_(listen_fd), upstream_(std::move(upstream)),
+            up_(up), down_(down), seed_(seed) {
+        }
+
+        void run(Duration report_every) {
+            auto next_report = std::chrono::steady_clock::now() + report_every;
+            while (!g_stop) {
+                const Timestamp now = std::chrono::steady_clock::now();
+                pollOnce(timeoutUntilNextDelivery(now));
+                flushDue(std::chrono::steady_clock::now());
+                reap();
+
+                if (report_every.count() > 0 && std::chrono::steady_clock::now() >= next_report) {
+                    report(std::cerr);
+                    next_report += report_every;
+                }
+            }
+            report(std::cout);
+        }
+
+    private:
+        int timeoutUntilNextDelivery(Timestamp now) const {
+            Timestamp earliest = now + std::chrono::milliseconds(100);
+            for (const auto& connection : connections_) {
+                for (const Direction* direction : { &connection.up, &connection.down }) {
+                    // Due chunks wait on POLLOUT instead
+                    if (!direction->queue.empty() && direction->queue.front().deliver_at > now) {
+                        earliest = std::min(earliest, direction->queue.front().deliver_at);
+                    }
+                }
+            }
+            const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(earliest - now).count();
+            return static_cast<int>(std::max<int64_t>(wait, 0));
+        }
+
+        void pollOnce(int timeout_ms) {
+            const Timestamp now = std::chrono::steady_clock::now();
+            fds_.clear();
+            fds_.push_back({ listen_fd_, POLLIN, 0 });
+            for (const auto& connection : connections_) {
+                // Backpressure: stop reading a side whose output is backed up
+                const short client_events = readEvents(connection.up) | writeEvents(connection.down, now);
+                const short upstream_events = readEvents(connection.down) | writeEvents(connection.up, now);
+                fds_.push_back({ connection.client_fd, client_events, 0 });
+                fds_.push_back({ connection.upstream_fd, upstream_events, 0 });
+            }
+            if (::poll(fds_.data(), fds_.size(), timeout_ms) <= 0) {
+                return;
+            }
+
+            if (fds_[0].revents & POLLIN) {
+                accept();
+            }
+            size_t index = 1;
+            for (auto& connection : connections_) {
+                if (index + 1 >= fds_.size()) {
+                    break; // Accepted during this round
+                }
+                const short client = fds_[index++].revents;
+                const short upstream = fds_[index++].revents;
+                if (client & (POLLIN | POLLHUP | POLLERR)) {
+                    readInto(connection, connection.client_fd, connection.up);
+                }
+                if (upstream & (POLLIN | POLLHUP | POLLERR)) {
+                    readInto(connection, connection.upstream_fd, connection.down);
+                }
+            }
+        }
+
+        static short readEvents(const Direction& direction) {
+            return (!direction.source_closed && direction.queued_bytes < MAX_QUEUED_BYTES) ? POLLIN : 0;
+        }
+
+        static short writeEvents(const Direction& direction, Timestamp now) {
+            return (!direction.queue.empty() && direction.queue.front().deliver_at <= now) ? POLLOUT : 0;
+        }
+
+        void accept() {
+            const int client = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0) {
+                return;
+            }
+            const int upstream = connectTo(upstream_);
+            if (upstream < 0) {
+                stats_.upstream_failures++;
+                ::close(client);
+                return;
+            }
+            configure(client);
+            configure(upstream);
+            stats_.accepted++;
+            connections_.emplace_back(client, upstream, up_, down_, seed_ + stats_.accepted);
+        }
+
+        void readInto(Connection& connection, int fd, Direction& direction) {
+            if (connection.reset || direction.source_closed) {
+                return;
+            }
+            Buffer data(65536);
+            const ssize_t n = ::recv(fd, data.data(), data.size(), MSG_DONTWAIT);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                return;
+            }
+            if (n <= 0) {
+                direction.source_closed = true;
+                return;
+            }
+            data.resize(static_cast<size_t>(n));
+
+            const auto decision = direction.impairment.schedule(data.size(), std::chrono::steady_clock::now());
+            if (decision.reset) {
+                connection.reset = true;
+                return;
+            }
+            direction.queued_bytes += data.size();
+            stats_.max_queued_bytes = std::max(stats_.max_queued_bytes, direction.queued_bytes);
+            direction.queue.push_back({ decision.deliver_at, std::move(data), 0 });
+        }
+
+        void flushDue(Timestamp now) {
+            for (auto& connection : connections_) {
+                if (connection.reset) {
+                    continue;
+                }
+                flushDirection(connection, connection.up, connection.upstream_fd, now, stats_.bytes_up);
+                flushDirection(connection, connection.down, connection.client_fd, now, stats_.bytes_down);
+            }
+        }
+
+        void flushDirection(Connection& connection, Direction& direction, int fd, Timestamp now, uint64_t& counter) {
+            while (!direction.queue.empty() && direction.queue.front().deliver_at <= now) {
+                auto& chunk = direction.queue.front();
+                const ssize_t n = ::send(fd, chunk.data.data() + chunk.sent,
+                    chunk.data.size() - chunk.sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+                if (n < 0) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                        connection.reset = true;
+                    }
+                    return; // Receiver is slow; retry on POLLOUT
+                }
+                chunk.sent += static_cast<size_t>(n);
+                counter += static_cast<uint64_t>(n);
+                if (chunk.sent < chunk.data.size()) {
+                    return;
+                }
+                direction.queued_bytes -= chunk.data.size();
+                direction.queue.pop_front();
+            }
+            if (direction.queue.empty() && direction.source_closed && !direction.shutdown_sent) {
+                ::shutdown(fd, SHUT_WR);
+                direction.shutdown_sent = true;
+            }
+        }
+
+        void reap() {
+            for (auto it = connections_.begin(); it != connections_.end();) {
+                if (it->reset) {
+                    stats_.resets++;
+                    abortive(it->client_fd);
+                    abortive(it->upstream_fd);
+                }
+                else if (it->up.shutdown_sent && it->down.shutdown_sent) {
+                    stats_.closed++;
+                    ::close(it->client_fd);
+                    ::close(it->upstream_fd);
+                }
+                else {
+                    ++it;
+                    continue;
+                }
+                for (const Direction* direction : { &it->up, &it->down }) {
+                    stats_.stalls += direction->impairment.getStats().stalls;
+                    stats_.losses += direction->impairment.getStats().losses;
+                }
+                it = connections_.erase(it);
+            }
+        }
+
+        void report(std::ostream& out) const {
+            out << "impair: active=" << connections_.size()
+                << " accepted=" << stats_.accepted
+                << " closed=" << stats_.closed
+                << " resets=" << stats_.resets
+                << " upstream_failures=" << stats_.upstream_failures
+                << " stalls=" << stats_.stalls
+                << " losses=" << stats_.losses
+                << " bytes_up=" << stats_.bytes_up
+                << " bytes_down=" << stats_.bytes_down
+                << " max_queued=" << stats_.max_queued_bytes << std::endl;
+        }
+
+        int listen_fd_;
+        std::vector<ResolvedAddress> upstream_;
+        NetworkImpairment::Profile up_;
+        NetworkImpairment::Profile down_;
+        uint64_t seed_;
+        std::list<Connection> connections_;
+        std::vector<pollfd> fds_;
+        ProxyStats stats_;
+    };
+
+    void printUsage() {
+        std::cerr << "Usage: cppws-impair <listen-port> <upstream-host> <upstream-port> "
+            "[--up SPEC] [--down SPEC] [--seed N] [--report-every SECONDS]" << std::endl;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        printUsage();
+        return 1;
+    }
+
+    const uint16_t listen_port = static_cast<uint16_t>(std::atoi(argv[1]));
+    const std::string upstream_host = argv[2];
+    const uint16_t upstream_port = static_cast<uint16_t>(std::atoi(argv[3]));
+    NetworkImpairment::Profile up, down;
+    uint64_t seed = 1;
+    Duration report_every = std::chrono::seconds(5);
+
+    for (int i = 4; i + 1 < argc; i += 2) {
+        const std::string option = argv[i];
+        const std::string value = argv[i + 1];
+        std::string error;
+        if (option == "--up" && !parseProfile(value, up, error)) {
+            std::cerr << "Error: --up " << error << std::endl;
+            return 1;
+        }
+        else if (option == "--down" && !parseProfile(value, down, error)) {
+            std::cerr << "Error: --down " << error << std::endl;
+            return 1;
+        }
+        else if (option == "--seed") {
+            seed = std::strtoull(value.c_str(), nullptr, 10);
+        }
+        else if (option == "--report-every") {
+            report_every = std::chrono::duration_cast<Duration>(
+                std::chrono::duration<double>(std::atof(value.c_str())));
+        }
+        else if (option != "--up" && option != "--down") {
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::vector<ResolvedAddress> upstream = resolve(upstream_host, upstream_port);
+    if (upstream.empty()) {
+        std::cerr << "Error: cannot resolve " << upstream_host << std::endl;
+        return 1;
+    }
+
+    const int listen_fd = listenOn(listen_port);
+    if (listen_fd < 0) {
+        std::cerr << "Error: cannot listen on port " << listen_port << std::endl;
+        return 1;
+    }
+
+    ::signal(SIGINT, [](int) { g_stop = 1; });
+    ::signal(SIGTERM, [](int) { g_stop = 1; });
+    ::signal(SIGPIPE, SIG_IGN);
+
+    Proxy proxy(listen_fd, std::move(upstream), up, down, seed);
+    proxy.run(report_every);
+    ::close(listen_fd);
+    return 0;
+}
@@ -0,0 +1,968 @@
+/**
+ * @file cppws-perfcheck.cpp
+ * @brief Performance regression gate against a checked-in baseline
+ *
+ * Runs microbenchmarks of the frame parse, masking and handshake paths
+ * (FrameRelay header decoding, its single-pass re-mask, and the server side
+ * of an RFC 8441 extended CONNECT on a fresh Http2Connection), then a short
+ * echo over a loopback socket to a server the tool hosts on its own thread:
+ * throughput with 64 messages in flight and round-trip p50/p99 with one.
+ * Every result is normalised by a fixed calibration loop and compared with
+ * tools/perf_baseline.json.
+ *
+ * With --server, the echo also runs against a running server, measuring
+ * throughput and round-trip latency over a real WebSocket connection. These
+ * server_* metrics are recorded and compared only when --server is given.
+ *
+ * Usage:
+ *   cppws-perfcheck [--baseline FILE] [--write-baseline FILE] [--quick]
+ *                   [--server HOST:PORT] [--path PATH]
+ *
+ * Normalisation: the calibration loop does a fixed amount of integer and
+ * memory work; its rate relative to REFERENCE_SPEED is the machine's speed
+ * factor. Throughputs are divided and latencies multiplied by that factor,
+ * so results read as "on the reference machine" and a baseline recorded on
+ * one machine is comparable on another of a different speed. Tolerances are
+ * per metric; a throughput falling or a latency rising beyond its tolerance
+ * fails the run with exit code 1 and a table showing what moved.
+ *
+ * Numbers from an unoptimised build say nothing about the baseline, so the
+ * tool refuses to run unless it was compiled with optimisation (the CMake
+ * target always builds it at -O2).
+ *
+ * Metrics without a baseline value are reported as new and never fail.
+ * Refresh with --write-baseline on a quiet machine. Baseline entries for
+ * metrics not measured in this run are kept.
+ */
+
+#include "protocol/FrameRelay.hpp"
+#include "protocol/Http2Connection.hpp"
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace CppWebSocket;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    /// Calibration iterations per second of the reference machine
+    constexpr double REFERENCE_SPEED = 5.0e6;
+
+    /// Direction of a metric
+    enum class Better { HIGHER, LOWER };
+
+    struct Metric {
+        std::string name;
+        double raw{ 0.0 };          ///< Measured value in its natural unit
+        std::string unit;
+        Better better{ Better::HIGHER };
+        double tolerance{ 0.10 };   ///< Default tolerance for new baselines
+        double normalised{ 0.0 };   ///< Value on the reference machine
+    };
+
+    struct BaselineEntry {
+        bool recorded{ false };
+        double value{ 0.0 };
+        double tolerance{ 0.10 };
+        Better better{ Better::HIGHER };
+    };
+
+    /// Keep the optimiser from deleting benchmark bodies
+    volatile uint64_t g_sink = 0;
+
+    /// Timed rounds per benchmark; the best one is reported
+    constexpr int ROUNDS = 10;
+
+    /**
+     * @brief One timed round of a benchmark: call it with a round length, get ops/s back
+     *
+     * Preemption and frequency changes only ever slow a round down, so the
+     * fastest of several short rounds is far steadier than one long one. The
+     * rounds of all benchmarks are interleaved over the whole run, so a slow
+     * phase of the machine costs each benchmark a round or two rather than
+     * its entire measurement.
+     */
+    using Round = std::function<double(Duration)>;
+
+    /**
+     * @brief Wrap a benchmark body as a Round
+     * @param body One operation; owns its state
+     * @param scale Units per operation (frames, bytes)
+     */
+    template<typename Fn>
+    Round makeRound(Fn body, double scale = 1.0) {
+        // Warm caches and branch predictors before timing
+        for (int i = 0; i < 1000; ++i) {
+            body();
+        }
+        return [body = std::move(body), scale](Duration length) mutable {
+            uint64_t ops = 0;
+            const auto start = Clock::now();
+            auto elapsed = Duration(0);
+            while (elapsed < length) {
+                for (int i = 0; i < 256; ++i) {
+                    body();
+                }
+                ops += 256;
+                elapsed = Clock::now() - start;
+            }
+            return scale * static_cast<double>(ops) / std::chrono::duration<double>(elapsed).count();
+        };
+    }
+
+    /**
+     * @brief Fixed integer and memory workload; rounds return iterations per second
+     */
+    Round calibration() {
+        return makeRound([table = std::vector<uint64_t>(1 << 16), state = 0x9E3779B97F4A7C15ull]() mutable {
+            for (int i = 0; i < 64; ++i) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                table[state & (table.size() - 1)] += state;
+            }
+            g_sink = g_sink + table[state & 0xFF];
+        });
+    }
+
+    // ========================================================================
+    // Microbenchmarks
+    // ========================================================================
+
+    Buffer pattern(size_t size) {
+        Buffer payload(size);
+        for (size_t i = 0; i < size; ++i) {
+            payload[i] = static_cast<uint8_t>(i * 31);
+        }
+        return payload;
+    }
+
+    /**
+     * @brief Encode one frame as a client (masked) or server (unmasked) would
+     */
+    Buffer encodeFrame(Opcode opcode, const Buffer& payload, bool masked) {
+        Buffer frame;
+        frame.reserve(payload.size() + 14);
+        frame.push_back(static_cast<uint8_t>(0x80 | static_cast<uint8_t>(opcode)));
+        const uint8_t mask_bit = masked ? 0x80 : 0x00;
+        if (payload.size() < 126) {
+            frame.push_back(static_cast<uint8_t>(mask_bit | payload.size()));
+        }
+        else if (payload.size() <= 0xFFFF) {
+            frame.push_back(mask_bit | 126);
+            frame.push_back(static_cast<uint8_t>(payload.size() >> 8));
+            frame.push_back(static_cast<uint8_t>(payload.size()));
+        }
+        else {
+            frame.push_back(mask_bit | 127);
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                frame.push_back(static_cast<uint8_t>(static_cast<uint64_t>(payload.size()) >> shift));
+            }
+        }
+        const uint8_t key[4] = { 0x37, 0xFA, 0x21, 0x3D };
+        if (masked) {
+            frame.insert(frame.end(), key, key + 4);
+        }
+        for (size_t i = 0; i < payload.size(); ++i) {
+            frame.push_back(masked ? payload[i] ^ key[i & 3] : payload[i]);
+        }
+        return frame;
+    }
+
+    /**
+     * @brief FrameRelay header decode and validation over a run of masked client frames
+     * @return Round reporting frames per second
+     *
+     * 64 frames per operation keeps each one well above clock resolution, so
+     * small frames measure the parser rather than the loop.
+     */
+    Round benchFrameParse(size_t size) {
+        constexpr size_t FRAMES = 64;
+        const Buffer frame = encodeFrame(Opcode::BINARY, pattern(size), true);
+        Buffer wire;
+        for (size_t i = 0; i < FRAMES; ++i) {
+            wire.insert(wire.end(), frame.begin(), frame.end());
+        }
+        Buffer out;
+        out.reserve(wire.size());
+        return makeRound([wire = std::move(wire), out = std::move(out),
+            relay = FrameRelay(FrameRelay::Options{ false, 0, FrameRelay::Masking::REQUIRED })]() mutable {
+            out.clear();
+            relay.feed(wire.data(), wire.size(), out);
+            g_sink = g_sink + out.size();
+        }, FRAMES);
+    }
+
+    /**
+     * @brief Re-keying one masked frame in FrameRelay's single XOR pass
+     * @return Round reporting payload bytes per second
+     */
+    Round benchMask(size_t size) {
+        Buffer out;
+        out.reserve(size + 14);
+        return makeRound([wire = encodeFrame(Opcode::BINARY, pattern(size), true), out = std::move(out),
+            relay = FrameRelay(FrameRelay::Options{ true, 0, FrameRelay::Masking::REQUIRED })]() mutable {
+            out.clear();
+            relay.feed(wire.data(), wire.size(), out);
+            g_sink = g_sink + out.size();
+        }, static_cast<double>(size));
+    }
+
+    void appendHttp2Frame(Buffer& out, uint8_t type, uint8_t flags, uint32_t stream, const Buffer& payload) {
+        out.push_back(static_cast<uint8_t>(payload.size() >> 16));
+        out.push_back(static_cast<uint8_t>(payload.size() >> 8));
+        out.push_back(static_cast<uint8_t>(payload.size()));
+        out.push_back(type);
+        out.push_back(flags);
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<uint8_t>(stream >> shift));
+        }
+        out.insert(out.end(), payload.begin(), payload.end());
+    }
+
+    /**
+     * @brief Server side of a WebSocket handshake over HTTP/2 (RFC 8441)
+     * @param round Output Round reporting handshakes per second
+     * @param error Output error if the handshake is not accepted
+     * @return true on success
+     *
+     * Each operation is a fresh Http2Connection receiving the client preface,
+     * SETTINGS and an extended CONNECT HEADERS frame (HPACK decode, request
+     * validation, tunnel setup) and producing its SETTINGS and 200 response.
+     */
+    bool benchHandshake(Round& round, std::string& error) {
+        Buffer block;
+        Hpack::Encoder::encode({
+            { ":method", "CONNECT" }, { ":protocol", "websocket" }, { ":scheme", "https" },
+            { ":path", "/chat" }, { ":authority", "localhost" },
+            { "sec-websocket-version", "13" }, { "origin", "http://localhost" }
+        }, block);
+        Buffer client(Http2Connection::PREFACE, Http2Connection::PREFACE + Http2Connection::PREFACE_SIZE);
+        appendHttp2Frame(client, static_cast<uint8_t>(Http2Connection::FrameType::SETTINGS), 0, 0, {});
+        appendHttp2Frame(client, static_cast<uint8_t>(Http2Connection::FrameType::HEADERS),
+            0x4 /* END_HEADERS */, 1, block);
+
+        Http2Connection::Callbacks callbacks;
+        callbacks.on_request = [](const Http2Connection::Request& request) {
+            Http2Connection::Response response;
+            response.status = request.protocol == "websocket" ? 200 : 400;
+            return response;
+        };
+        {
+            Http2Connection connection(callbacks);
+            if (!connection.receive(client.data(), client.size()) || connection.getStats().streams_opened != 1) {
+                error = "extended CONNECT was not accepted";
+                return false;
+            }
+        }
+        round = makeRound([client = std::move(client), callbacks = std::move(callbacks)] {
+            Http2Connection connection(callbacks);
+            connection.receive(client.data(), client.size());
+            g_sink = g_sink + connection.takeOutput().size();
+        });
+        return true;
+    }
+
+    // ========================================================================
+    // Echo (loopback server, or a running server with --server)
+    // ========================================================================
+
+    struct EchoResult {
+        double messages_per_sec{ 0.0 };
+        double p50_us{ 0.0 };
+        double p99_us{ 0.0 };
+    };
+
+    bool sendAll(int fd, const Buffer& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            const ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * @brief One-connection echo server on an ephemeral 127.0.0.1 port, on its own thread
+     *
+     * Answers the upgrade, then unmasks every client frame and writes it back
+     * unmasked, as a server's echo handler would. Pings get pongs and a close
+     * is answered and ends the connection.
+     */
+    class LoopbackEchoServer {
+    public:
+        ~LoopbackEchoServer() {
+            if (listen_fd_ >= 0) {
+                ::shutdown(listen_fd_, SHUT_RDWR);  // Unblocks accept() if no client came
+            }
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+            if (listen_fd_ >= 0) {
+                ::close(listen_fd_);
+            }
+        }
+
+        bool start(std::string& error) {
+            listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(address);
+            if (listen_fd_ < 0 ||
+                ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+                ::listen(listen_fd_, 1) != 0 ||
+                ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+                error = std::string("cannot listen on 127.0.0.1: ") + std::strerror(errno);
+                return false;
+            }
+            port_ = ntohs(address.sin_port);
+            thread_ = std::thread([this] { serve(); });
+            return true;
+        }
+
+        uint16_t port() const { return port_; }
+
+    private:
+        void serve() {
+            const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) {
+                return;
+            }
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            echo(fd);
+            ::close(fd);
+        }
+
+        void echo(int fd) {
+            Buffer input;
+            uint8_t chunk[65536];
+            std::string request;
+            size_t header_end;
+            while ((header_end = request.find("\r\n\r\n")) == std::string::npos) {
+                const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) {
+                    return;
+                }
+                request.append(reinterpret_cast<const char*>(chunk), static_cast<size_t>(n));
+            }
+            const std::string response =
+                "HTTP/1.1 101 Switching Protocols\r\n"
+                "Upgrade: websocket\r\n"
+                "Connection: Upgrade\r\n\r\n";
+            if (!sendAll(fd, Buffer(response.begin(), response.end()))) {
+                return;
+            }
+            input.assign(request.begin() + static_cast<std::ptrdiff_t>(header_end) + 4, request.end());
+
+            Buffer output;
+            for (;;) {
+                size_t offset = 0;
+                bool closed = false;
+                while (!closed) {
+                    const size_t available = input.size() - offset;
+                    if (available < 2) {
+                        break;
+                    }
+                    const uint8_t* frame = input.data() + offset;
+                    uint64_t length = frame[1] & 0x7F;
+                    size_t header = 2;
+                    if (length == 126 || length == 127) {
+                        const size_t bytes = length == 126 ? 2 : 8;
+                        if (available < header + bytes) {
+                            break;
+                        }
+                        length = 0;
+                        for (size_t i = 0; i < bytes; ++i) {
+                            length = (length << 8) | frame[header + i];
+                        }
+                        header += bytes;
+                    }
+                    if ((frame[1] & 0x80) == 0 || length > (1u << 24)) {
+                        return;     // Client frames must be masked; oversized frames are refused
+                    }
+                    if (available < header + 4 + length) {
+                        break;
+                    }
+                    const uint8_t* mask = frame + header;
+                    const uint8_t* payload = mask + 4;
+                    const uint8_t opcode = frame[0] & 0x0F;
+                    output.push_back(opcode == 0x9 ? 0x80 | 0xA : frame[0]);   // Ping -> pong
+                    output.insert(output.end(), frame + 1, frame + header);
+                    output[output.size() - (header - 1)] &= 0x7F;              // Clear the mask bit
+                    for (size_t i = 0; i < length; ++i) {
+                        output.push_back(payload[i] ^ mask[i & 3]);
+                    }
+                    offset += header + 4 + static_cast<size_t>(length);
+                    closed = opcode == 0x8;
+                }
+                input.erase(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(offset));
+                if (!output.empty() && !sendAll(fd, output)) {
+                    return;
+                }
+                output.clear();
+                if (closed) {
+                    return;
+                }
+                const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) {
+                    return;
+                }
+                input.insert(input.end(), chunk, chunk + n);
+            }
+        }
+
+        int listen_fd_{ -1 };
+        uint16_t port_{ 0 };
+        std::thread thread_;
+    };
+
+    /**
+     * @brief Client side of one server connection; server frames are framed by FrameRelay
+     */
+    class EchoClient {
+    public:
+        ~EchoClient() {
+            if (fd_ >= 0) {
+                ::close(fd_);
+            }
+        }
+
+        bool connect(const std::string& host, uint16_t port, const std::string& path, std::string& error) {
+            addrinfo hints{};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            addrinfo* results = nullptr;
+            if (::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &results) != 0) {
+                error = "cannot resolve " + host;
+                return false;
+            }
+            for (const addrinfo* info = results; info && fd_ < 0; info = info->ai_next) {
+                fd_ = ::socket(info->ai_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+                if (fd_ >= 0 && ::connect(fd_, info->ai_addr, info->ai_addrlen) != 0) {
+                    error = "cannot connect to " + host + ":" + std::to_string(port) + ": " + std::strerror(errno);
+                    ::close(fd_);
+                    fd_ = -1;
+                }
+            }
+            ::freeaddrinfo(results);
+            if (fd_ < 0) {
+                return false;
+            }
+            int one = 1;
+            ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            const std::string request =
+                "GET " + path + " HTTP/1.1\r\n"
+                "Host: " + host + ":" + std::to_string(port) + "\r\n"
+                "Upgrade: websocket\r\n"
+                "Connection: Upgrade\r\n"
+                "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                "Sec-WebSocket-Version: 13\r\n\r\n";
+            if (!sendAll(fd_, Buffer(request.begin(), request.end()))) {
+                error = "cannot send upgrade request";
+                return false;
+            }
+
+            std::string response;
+            char chunk[4096];
+            size_t header_end;
+            while ((header_end = response.find("\r\n\r\n")) == std::string::npos) {
+                const ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+                if (n <= 0) {
+                    error = "connection closed during upgrade";
+                    return false;
+                }
+                response.append(chunk, static_cast<size_t>(n));
+            }
+            if (response.compare(0, 12, "HTTP/1.1 101") != 0) {
+                error = "upgrade refused: " + response.substr(0, response.find("\r\n"));
+                return false;
+            }
+            // Frames that arrived with the 101
+            const auto* early = reinterpret_cast<const uint8_t*>(response.data()) + header_end + 4;
+            return relay_.feed(early, response.size() - header_end - 4, scratch_) == FrameRelay::Status::OK;
+        }
+
+        bool send(const Buffer& frame) {
+            return sendAll(fd_, frame);
+        }
+
+        /**
+         * @brief Read until `count` more complete frames have arrived
+         */
+        bool receive(uint64_t count) {
+            const uint64_t target = received_ + count;
+            uint8_t chunk[65536];
+            while (relay_.getStats().frames < target) {
+                const ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+                if (n <= 0) {
+                    return false;
+                }
+                scratch_.clear();
+                if (relay_.feed(chunk, static_cast<size_t>(n), scratch_) != FrameRelay::Status::OK) {
+                    return false;
+                }
+            }
+            received_ = target;
+            return true;
+        }
+
+    private:
+        int fd_{ -1 };
+        FrameRelay relay_{ FrameRelay::Options{ false, 0, FrameRelay::Masking::FORBIDDEN } };
+        Buffer scratch_;
+        uint64_t received_{ 0 };
+    };
+
+    /**
+     * @brief Round-trip latency and windowed throughput over one connection
+     *
+     * Runs in rounds like the microbenchmarks and keeps each figure's best
+     * round: interference only makes a round worse.
+     */
+    class EchoBenchmark {
+    public:
+        ~EchoBenchmark() {
+            if (connected_) {
+                client_.send(encodeFrame(Opcode::CLOSE, Buffer{ 0x03, 0xE8 }, true));
+            }
+        }
+
+        bool connect(const std::string& host, uint16_t port, const std::string& path, std::string& error) {
+            connected_ = client_.connect(host, port, path, error);
+            return connected_;
+        }
+
+        /**
+         * @brief One round: `pings` one-at-a-time 128-byte round trips, then
+         *        `messages` 1 KiB messages with a window of 64 in flight
+         */
+        bool round(size_t pings, size_t messages, std::string& error) {
+            bool ok = true;
+            rtts_.clear();
+            for (size_t i = 0; i < pings && ok; ++i) {
+                const auto start = Clock::now();
+                ok = client_.send(small_) && client_.receive(1);
+                rtts_.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            }
+
+            constexpr size_t WINDOW = 64;
+            const auto start = Clock::now();
+            size_t sent = 0, received = 0;
+            while (received < messages && ok) {
+                while (sent < messages && sent - received < WINDOW && ok) {
+                    ok = client_.send(large_);
+                    sent++;
+                }
+                ok = ok && client_.receive(1);
+                received++;
+            }
+            const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            if (!ok || rtts_.empty()) {
+                error = "server closed the connection or sent an invalid frame";
+                return false;
+            }
+
+            std::sort(rtts_.begin(), rtts_.end());
+            const double p50 = rtts_[rtts_.size() / 2];
+            const double p99 = rtts_[std::min(rtts_.size() - 1, rtts_.size() * 99 / 100)];
+            const bool first = result_.messages_per_sec == 0.0;
+            result_.p50_us = first ? p50 : std::min(result_.p50_us, p50);
+            result_.p99_us = first ? p99 : std::min(result_.p99_us, p99);
+            result_.messages_per_sec = std::max(result_.messages_per_sec, static_cast<double>(messages) / elapsed);
+            return true;
+        }
+
+        const EchoResult& result() const { return result_; }
+
+    private:
+        EchoClient client_;
+        bool connected_{ false };
+        const Buffer small_{ encodeFrame(Opcode::BINARY, pattern(128), true) };
+        const Buffer large_{ encodeFrame(Opcode::BINARY, pattern(1024), true) };
+        std::vector<double> rtts_;
+        EchoResult result_;
+    };
+
+    // ========================================================================
+    // Baseline file
+    // ========================================================================
+
+    /**
+     * @brief Read {"metrics": {"name": {"value": N|null, "tolerance": N}, ...}}
+     *
+     * Deliberately small: accepts exactly the layout writeBaseline() produces,
+     * plus whitespace and extra string/number fields.
+     */
+    class BaselineReader {
+    public:
+        explicit BaselineReader(std::string text) : text_(std::move(text)) {}
+
+        bool read(std::map<std::string, BaselineEntry>& out, std::string& error) {
+            if (!expect('{')) return fail(error);
+            while (peek() != '}') {
+                std::string key;
+                if (!readString(key) || !expect(':')) return fail(error);
+                if (key == "metrics") {
+                    if (!readMetrics(out)) return fail(error);
+                }
+                else if (!skipValue()) {
+                    return fail(error);
+                }
+                if (peek() == ',') pos_++;
+            }
+            return true;
+        }
+
+    private:
+        bool readMetrics(std::map<std::string, BaselineEntry>& out) {
+            if (!expect('{')) return false;
+            while (peek() != '}') {
+                std::string name;
+                BaselineEntry entry;
+                if (!readString(name) || !expect(':') || !expect('{')) return false;
+                while (peek() != '}') {
+                    std::string field;
+                    if (!readString(field) || !expect(':')) return false;
+                    if (field == "value" && peek() == 'n' && text_.compare(pos_, 4, "null") == 0) {
+                        pos_ += 4;
+                    }
+                    else if (field == "value") {
+                        entry.recorded = readNumber(entry.value);
+                        if (!entry.recorded) return false;
+                    }
+                    else if (field == "tolerance") {
+                        if (!readNumber(entry.tolerance)) return false;
+                    }
+                    else if (field == "better") {
+                        std::string better;
+                        if (!readString(better)) return false;
+                        entry.better = better == "lower" ? Better::LOWER : Better::HIGHER;
+                    }
+                    else if (!skipValue()) {
+                        return false;
+                    }
+                    if (peek() == ',') pos_++;
+                }
+                pos_++;
+                out[name] = entry;
+                if (peek() == ',') pos_++;
+            }
+            pos_++;
+            return true;
+        }
+
+        char peek() {
+            while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) pos_++;
+            return pos_ < text_.size() ? text_[pos_] : '\0';
+        }
+
+        bool expect(char c) {
+            if (peek() != c) return false;
+            pos_++;
+            return true;
+        }
+
+        bool readString(std::string& out) {
+            if (!expect('"')) return false;
+            const size_t end = text_.find('"', pos_);
+            if (end == std::string::npos) return false;
+            out = text_.substr(pos_, end - pos_);
+            pos_ = end + 1;
+            return true;
+        }
+
+        bool readNumber(double& out) {
+            peek();
+            char* end = nullptr;
+            out = std::strtod(text_.c_str() + pos_, &end);
+            const size_t consumed = static_cast<size_t>(end - (text_.c_str() + pos_));
+            pos_ += consumed;
+            return consumed > 0;
+        }
+
+        bool skipValue() {
+            const char c = peek();
+            if (c == '"') {
+                std::string ignored;
+                return readString(ignored);
+            }
+            if (c == '{' || c == '[') {
+                int depth = 0;
+                do {
+                    const char d = text_[pos_++];
+                    depth += (d == '{' || d == '[') - (d == '}' || d == ']');
+                } while (depth > 0 && pos_ < text_.size());
+                return depth == 0;
+            }
+            double ignored;
+            if (readNumber(ignored)) return true;
+            for (const char* word : { "null", "true", "false" }) {
+                if (text_.compare(pos_, std::strlen(word), word) == 0) {
+                    pos_ += std::strlen(word);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool fail(std::string& error) {
+            error = "malformed baseline near offset " + std::to_string(pos_);
+            return false;
+        }
+
+        std::string text_;
+        size_t pos_{ 0 };
+    };
+
+    bool writeBaseline(const std::string& path, const std::vector<Metric>& metrics,
+        const std::map<std::string, BaselineEntry>& previous) {
+        std::ofstream out(path);
+        if (!out) {
+            return false;
+        }
+        out << "{\n"
+            << "  \"note\": \"Values are normalised to the reference machine; regenerate with cppws-perfcheck --write-baseline\",\n"
+            << "  \"metrics\": {\n";
+        // Measured metrics first, then recorded ones this run did not measure
+        std::map<std::string, BaselineEntry> entries;
+        for (const auto& metric : metrics) {
+            auto it = previous.find(metric.name);
+            entries[metric.name] = { true, metric.normalised,
+                it != previous.end() ? it->second.tolerance : metric.tolerance, metric.better };
+        }
+        for (const auto& [name, entry] : previous) {
+            if (entry.recorded) {
+                entries.emplace(name, entry);
+            }
+        }
+        size_t written = 0;
+        for (const auto& [name, entry] : entries) {
+            out << "    \"" << name << "\": { \"value\": " << std::setprecision(6) << entry.value
+                << ", \"tolerance\": " << entry.tolerance
+                << ", \"better\": \"" << (entry.better == Better::HIGHER ? "higher" : "lower") << "\" }"
+                << (++written < entries.size() ? "," : "") << "\n";
+        }
+        out << "  }\n}\n";
+        return static_cast<bool>(out);
+    }
+
+    void printUsage() {
+        std::cerr << "Usage: cppws-perfcheck [--baseline FILE] [--write-baseline FILE] [--quick]"
+            " [--server HOST:PORT] [--path PATH]" << std::endl;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string baseline_path = "tools/perf_baseline.json";
+    std::string write_path;
+    std::string server;
+    std::string path = "/";
+    bool quick = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string option = argv[i];
+        if (option == "--baseline" && i + 1 < argc) baseline_path = argv[++i];
+        else if (option == "--write-baseline" && i + 1 < argc) write_path = argv[++i];
+        else if (option == "--server" && i + 1 < argc) server = argv[++i];
+        else if (option == "--path" && i + 1 < argc) path = argv[++i];
+        else if (option == "--quick") quick = true;
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+#ifndef __OPTIMIZE__
+    std::cerr << "Error: cppws-perfcheck was built without optimisation; its numbers are not"
+        " comparable with the baseline (build the CMake target, which uses -O2)" << std::endl;
+    return 2;
+#endif
+
+    std::string host;
+    uint16_t port = 0;
+    if (!server.empty()) {
+        const size_t colon = server.rfind(':');
+        const int value = colon == std::string::npos ? 0 : std::atoi(server.c_str() + colon + 1);
+        if (value <= 0 || value > 65535) {
+            std::cerr << "Error: --server expects HOST:PORT" << std::endl;
+            return 2;
+        }
+        host = server.substr(0, colon);
+        port = static_cast<uint16_t>(value);
+    }
+
+    // Per benchmark over the whole run, split into ROUNDS interleaved rounds
+    const Duration budget = quick ? std::chrono::milliseconds(100) : std::chrono::milliseconds(500);
+    const size_t pings = (quick ? 2000 : 20000) / ROUNDS;
+    const size_t messages = (quick ? 20000 : 200000) / ROUNDS;
+
+    std::string error;
+    Round handshake;
+    if (!benchHandshake(handshake, error)) {
+        std::cerr << "Error: handshake benchmark failed: " << error << std::endl;
+        return 2;
+    }
+    std::vector<Metric> metrics = {
+        { "frame_parse_125", 0.0, "frame/s", Better::HIGHER, 0.30 },
+        { "frame_parse_64k", 0.0, "frame/s", Better::HIGHER, 0.20 },
+        { "mask_64k", 0.0, "B/s", Better::HIGHER, 0.45 },
+        { "h2_handshake", 0.0, "ops/s", Better::HIGHER, 0.25 }
+    };
+    std::vector<Round> rounds = {
+        benchFrameParse(125), benchFrameParse(64 * 1024), benchMask(64 * 1024), std::move(handshake)
+    };
+
+    LoopbackEchoServer loopback;
+    EchoBenchmark loopback_echo;
+    if (!loopback.start(error) || !loopback_echo.connect("127.0.0.1", loopback.port(), path, error)) {
+        std::cerr << "Error: loopback echo failed: " << error << std::endl;
+        return 2;
+    }
+    EchoBenchmark server_echo;
+    if (!server.empty() && !server_echo.connect(host, port, path, error)) {
+        std::cerr << "Error: echo against " << server << " failed: " << error << std::endl;
+        return 2;
+    }
+
+    // Calibration is interleaved too, so it sees the same machine the benchmarks did
+    Round calibrate = calibration();
+    double speed = 0.0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        speed = std::max(speed, calibrate(budget / ROUNDS));
+        for (size_t i = 0; i < rounds.size(); ++i) {
+            metrics[i].raw = std::max(metrics[i].raw, rounds[i](budget / ROUNDS));
+        }
+        if (!loopback_echo.round(pings, messages, error)) {
+            std::cerr << "Error: loopback echo failed: " << error << std::endl;
+            return 2;
+        }
+        if (!server.empty() && !server_echo.round(pings, messages, error)) {
+            std::cerr << "Error: echo against " << server << " failed: " << error << std::endl;
+            return 2;
+        }
+    }
+
+    metrics.push_back({ "echo_throughput_1k", loopback_echo.result().messages_per_sec, "msg/s", Better::HIGHER, 0.15 });
+    metrics.push_back({ "echo_rtt_p50", loopback_echo.result().p50_us, "us", Better::LOWER, 0.30 });
+    metrics.push_back({ "echo_rtt_p99", loopback_echo.result().p99_us, "us", Better::LOWER, 0.30 });
+    if (!server.empty()) {
+        metrics.push_back({ "server_echo_throughput_1k", server_echo.result().messages_per_sec, "msg/s", Better::HIGHER, 0.15 });
+        metrics.push_back({ "server_echo_rtt_p50", server_echo.result().p50_us, "us", Better::LOWER, 0.30 });
+        metrics.push_back({ "server_echo_rtt_p99", server_echo.result().p99_us, "us", Better::LOWER, 0.30 });
+    }
+
+    const double factor = speed / REFERENCE_SPEED;
+    for (auto& metric : metrics) {
+        metric.normalised = metric.better == Better::HIGHER ? metric.raw / factor : metric.raw * factor;
+    }
+
+    std::map<std::string, BaselineEntry> baseline;
+    {
+        std::ifstream in(baseline_path);
+        if (in) {
+            std::stringstream text;
+            text << in.rdbuf();
+            if (!BaselineReader(text.str()).read(baseline, error)) {
+                std::cerr << "Error: " << baseline_path << ": " << error << std::endl;
+                return 2;
+            }
+        }
+        else if (write_path.empty()) {
+            std::cerr << "Warning: no baseline at " << baseline_path << "; reporting only" << std::endl;
+        }
+    }
+
+    std::cout << "Calibration: " << std::fixed << std::setprecision(0) << speed << " iterations/s"
+        << " (speed factor " << std::setprecision(2) << factor << ")\n\n"
+        << std::left << std::setw(28) << "metric"
+        << std::right << std::setw(16) << "raw"
+        << std::setw(8) << "unit"
+        << std::setw(14) << "baseline"
+        << std::setw(14) << "current"
+        << std::setw(10) << "change"
+        << std::setw(8) << "tol"
+        << "  status\n";
+
+    size_t regressions = 0;
+    for (const auto& metric : metrics) {
+        const auto it = baseline.find(metric.name);
+        std::string status = "new";
+        double change = 0.0;
+        double tolerance = 0.0;
+        if (it != baseline.end() && it->second.recorded && it->second.value > 0.0) {
+            tolerance = it->second.tolerance;
+            change = metric.normalised / it->second.value - 1.0;
+            const bool worse = metric.better == Better::HIGHER ? change < -tolerance : change > tolerance;
+            status = worse ? "REGRESSED" : "ok";
+            regressions += worse ? 1 : 0;
+        }
+
+        std::cout << std::left << std::setw(28) << metric.name << std::right
+            << std::setw(16) << std::setprecision(1) << metric.raw
+            << std::setw(8) << metric.unit
+            << std::setw(14);
+        if (status == "new") {
+            std::cout << "-";
+        }
+        else {
+            std::cout << it->second.value;
+        }
+        std::cout << std::setw(14) << metric.normalised
+            << std::setw(9) << std::showpos << std::setprecision(1) << change * 100.0 << "%" << std::noshowpos
+            << std::setw(7) << std::setprecision(0) << tolerance * 100.0 << "%"
+            << "  " << status << "\n";
+    }
+    for (const auto& [name, entry] : baseline) {
+        const bool measured = std::any_of(metrics.begin(), metrics.end(),
+            [&](const Metric& metric) { return metric.name == name; });
+        if (!measured && entry.recorded) {
+            std::cout << std::left << std::setw(28) << name << std::right
+                << std::setw(16) << "-" << std::setw(8) << "" << std::setw(14) << entry.value
+                << (name.compare(0, 7, "server_") == 0 ? "  skipped (needs --server)\n" : "  not measured\n");
+        }
+    }
+
+    if (!write_path.empty()) {
+        if (!writeBaseline(write_path, metrics, baseline)) {
+            std::cerr << "Error: cannot write " << write_path << std::endl;
+            return 2;
+        }
+        std::cout << "\nBaseline written to " << write_path << std::endl;
+        return 0;
+    }
+
+    if (regressions > 0) {
+        std::cout << "\n" << regressions << " metric(s) regressed beyond tolerance" << std::endl;
+        return 1;
+    }
+    std::cout << "\nNo regressions" << std::endl;
+    return 0;
+}
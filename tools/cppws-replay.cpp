@@ -0,0 +1,441 @@
+/**
+ * @file cppws-replay.cpp
+ * @brief Replays a traffic capture against a WebSocket server
+ *
+ * Reads a capture written by TrafficCapture::Writer and re-sends every
+ * session's upgrade request and inbound frames with the recorded timing,
+ * scaled by --speed (or as fast as possible with --speed max). --multiply
+ * replays each captured session several times concurrently, turning a small
+ * production capture into a realistic load test.
+ *
+ * Usage:
+ *   cppws-replay <capture-dir> <host> <port> [--speed N|max] [--multiply N]
+ *
+ * Frames are sent exactly as captured (already client-masked). Sockets are
+ * non-blocking: bytes the server has not accepted yet wait in a per-session
+ * queue that is flushed as the socket drains, and server output is read and
+ * discarded, so neither side can stall the other on a full socket buffer.
+ */
+
+#include "utils/TrafficCapture.hpp"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace CppWebSocket;
+
+namespace {
+
+    constexpr size_t MAX_OUTBOUND_BYTES = 64 * 1024 * 1024;  ///< Queued bytes before the replay waits
+
+    struct ReplaySession {
+        int fd{ -1 };
+        bool upgraded{ false };
+        std::string response;               ///< Upgrade response read so far
+        std::vector<Buffer> pending;        ///< Frames waiting for the upgrade
+        bool close_pending{ false };        ///< Recorded close arrived before the upgrade
+        Buffer outbound;                    ///< Bytes the socket has not accepted yet
+        size_t outbound_offset{ 0 };        ///< Already-sent prefix of outbound
+        bool closing{ false };              ///< Close once outbound is flushed
+    };
+
+    struct ReplayStats {
+        uint64_t sessions{ 0 };
+        uint64_t connect_failures{ 0 };
+        uint64_t upgrade_failures{ 0 };
+        uint64_t frames_sent{ 0 };
+        uint64_t bytes_sent{ 0 };
+        uint64_t bytes_received{ 0 };
+        std::chrono::microseconds max_lag{ 0 };
+    };
+
+    struct ResolvedAddress {
+        sockaddr_storage storage{};
+        socklen_t length{ 0 };
+    };
+
+    /**
+     * @brief Resolve a host name or IPv4/IPv6 literal once, up front
+     */
+    std::vector<ResolvedAddress> resolve(const std::string& host, uint16_t port) {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* results = nullptr;
+        if (::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &results) != 0) {
+            return {};
+        }
+        std::vector<ResolvedAddress> addresses;
+        for (const addrinfo* info = results; info; info = info->ai_next) {
+            ResolvedAddress address;
+            std::memcpy(&address.storage, info->ai_addr, info->ai_addrlen);
+            address.length = info->ai_addrlen;
+            addresses.push_back(address);
+        }
+        ::freeaddrinfo(results);
+        return addresses;
+    }
+
+    int connectTo(const std::vector<ResolvedAddress>& addresses) {
+        for (const auto& address : addresses) {
+            const int fd = ::socket(address.storage.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0) {
+                continue;
+            }
+            if (::connect(fd, reinterpret_cast<const sockaddr*>(&address.storage), address.length) == 0) {
+                int one = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+                return fd;
+            }
+            ::close(fd);
+        }
+        return -1;
+    }
+
+    class Replayer {
+    public:
+        Replayer(std::vector<ResolvedAddress> server, ReplayStats& stats)
+            : server_(std::move(server)), stats_(stats) {
+        }
+
+        ~Replayer() {
+            for (auto& [id, session] : sessions_) {
+                if (session.fd >= 0) {
+                    ::close(session.fd);
+                }
+            }
+        }
+
+        void open(ClientID id, const Buffer& request) {
+            const int fd = connectTo(server_);
+            if (fd < 0) {
+                stats_.connect_failures++;
+                return;
+            }
+            stats_.sessions++;
+            drop(id);
+            auto& session = sessions_[id];
+            session.fd = fd;
+            queue(id, session, request);
+        }
+
+        void frame(ClientID id, Buffer frame) {
+            auto it = sessions_.find(id);
+            if (it == sessions_.end() || it->second.closing) {
+                return;
+            }
+            if (!it->second.upgraded) {
+                it->second.pending.push_back(std::move(frame));
+                return;
+            }
+            send(id, it->second, frame);
+        }
+
+        void close(ClientID id) {
+            auto it = sessions_.find(id);
+            if (it == sessions_.end()) {
+                return;
+            }
+            if (!it->second.upgraded) {
+                // Slow or impaired link: finish the upgrade and send queued frames first
+                it->second.close_pending = true;
+                return;
+            }
+            // Queued frames go out before the connection is closed
+            it->second.closing = true;
+            flush(id, it->second);
+        }
+
+        /**
+         * @brief Service sockets until the deadline
+         */
+        void pollUntil(std::chrono::steady_clock::time_point deadline) {
+            do {
+                const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now());
+                pollOnce(static_cast<int>(std::max<int64_t>(remaining.count(), 0)));
+            } while (std::chrono::steady_clock::now() < deadline);
+        }
+
+        void pollOnce(int timeout_ms) {
+            fds_.clear();
+            ids_.clear();
+            for (const auto& [id, session] : sessions_) {
+                const short events = session.outbound.empty() ? POLLIN : POLLIN | POLLOUT;
+                fds_.push_back({ session.fd, events, 0 });
+                ids_.push_back(id);
+            }
+            if (fds_.empty()) {
+                if (timeout_ms > 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+                }
+                return;
+            }
+            if (::poll(fds_.data(), fds_.size(), timeout_ms) <= 0) {
+                return;
+            }
+            for (size_t i = 0; i < fds_.size(); ++i) {
+                if (fds_[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                    readFrom(ids_[i]);
+                }
+                if (fds_[i].revents & POLLOUT) {
+                    auto it = sessions_.find(ids_[i]);
+                    if (it != sessions_.end()) {
+                        flush(ids_[i], it->second);
+                    }
+                }
+            }
+        }
+
+        size_t activeSessions() const { return sessions_.size(); }
+
+        /**
+         * @brief Whether the server is so far behind that the replay should wait
+         */
+        bool backlogged() const { return outbound_bytes_ > MAX_OUTBOUND_BYTES; }
+
+    private:
+        void readFrom(ClientID id) {
+            auto it = sessions_.find(id);
+            if (it == sessions_.end()) {
+                return;
+            }
+            auto& session = it->second;
+            char chunk[16384];
+            for (;;) {
+                const ssize_t n = ::recv(session.fd, chunk, sizeof(chunk), 0);
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    return;
+                }
+                if (n <= 0) {
+                    if (!session.upgraded) {
+                        stats_.upgrade_failures++;
+                    }
+                    drop(id);
+                    return;
+                }
+                stats_.bytes_received += static_cast<uint64_t>(n);
+                if (!session.upgraded) {
+                    session.response.append(chunk, static_cast<size_t>(n));
+                    if (session.response.find("\r\n\r\n") != std::string::npos) {
+                        upgrade(id, session);
+                        return;
+                    }
+                }
+            }
+        }
+
+        void upgrade(ClientID id, ReplaySession& session) {
+            if (session.response.compare(0, 12, "HTTP/1.1 101") != 0) {
+                stats_.upgrade_failures++;
+                drop(id);
+                return;
+            }
+            session.upgraded = true;
+            session.response.clear();
+            std::vector<Buffer> pending = std::move(session.pending);
+            for (const auto& frame : pending) {
+                if (!send(id, session, frame)) {
+                    return;
+                }
+            }
+            if (session.close_pending) {
+                close(id);
+            }
+        }
+
+        bool send(ClientID id, ReplaySession& session, const Buffer& frame) {
+            stats_.frames_sent++;
+            stats_.bytes_sent += frame.size();
+            return queue(id, session, frame);
+        }
+
+        /**
+         * @brief Append to the session's outbound queue and write what the socket takes
+         * @return false if the session was dropped
+         */
+        bool queue(ClientID id, ReplaySession& session, const Buffer& data) {
+            const bool idle = session.outbound.empty();
+            session.outbound.insert(session.outbound.end(), data.begin(), data.end());
+            outbound_bytes_ += data.size();
+            // Otherwise already waiting for POLLOUT
+            return idle ? flush(id, session) : true;
+        }
+
+        /**
+         * @brief Write queued bytes until the socket would block
+         * @return false if the session was dropped (write error, or closed once flushed)
+         */
+        bool flush(ClientID id, ReplaySession& session) {
+            while (session.outbound_offset < session.outbound.size()) {
+                const ssize_t n = ::send(session.fd, session.outbound.data() + session.outbound_offset,
+                    session.outbound.size() - session.outbound_offset, MSG_NOSIGNAL);
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    if (session.outbound_offset >= session.outbound.size() / 2) {
+                        session.outbound.erase(session.outbound.begin(),
+                            session.outbound.begin() + static_cast<ptrdiff_t>(session.outbound_offset));
+                        session.outbound_offset = 0;
+                    }
+                    return true;
+                }
+                if (n <= 0) {
+                    if (!session.upgraded) {
+                        stats_.upgrade_failures++;
+                    }
+                    drop(id);
+                    return false;
+                }
+                session.outbound_offset += static_cast<size_t>(n);
+                outbound_bytes_ -= static_cast<size_t>(n);
+            }
+            session.outbound.clear();
+            session.outbound_offset = 0;
+            if (session.closing) {
+                drop(id);
+                return false;
+            }
+            return true;
+        }
+
+        void drop(ClientID id) {
+            auto it = sessions_.find(id);
+            if (it == sessions_.end()) {
+                return;
+            }
+            outbound_bytes_ -= it->second.outbound.size() - it->second.outbound_offset;
+            ::close(it->second.fd);
+            sessions_.erase(it);
+        }
+
+        std::vector<ResolvedAddress> server_;
+        ReplayStats& stats_;
+        std::unordered_map<ClientID, ReplaySession> sessions_;
+        std::vector<pollfd> fds_;
+        std::vector<ClientID> ids_;
+        size_t outbound_bytes_{ 0 };
+    };
+
+    void printUsage() {
+        std::cerr << "Usage: cppws-replay <capture-dir> <host> <port> [--speed N|max] [--multiply N]" << std::endl;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        printUsage();
+        return 1;
+    }
+
+    const std::string capture_dir = argv[1];
+    const std::string host = argv[2];
+    const uint16_t port = static_cast<uint16_t>(std::atoi(argv[3]));
+    double speed = 1.0;
+    bool max_speed = false;
+    uint32_t multiply = 1;
+
+    for (int i = 4; i + 1 < argc; i += 2) {
+        const std::string option = argv[i];
+        const std::string value = argv[i + 1];
+        if (option == "--speed") {
+            max_speed = value == "max";
+            speed = max_speed ? 1.0 : std::atof(value.c_str());
+        }
+        else if (option == "--multiply") {
+            multiply = static_cast<uint32_t>(std::max(1, std::atoi(value.c_str())));
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (speed <= 0.0) {
+        std::cerr << "Error: --speed must be positive" << std::endl;
+        return 1;
+    }
+
+    std::vector<ResolvedAddress> server = resolve(host, port);
+    if (server.empty()) {
+        std::cerr << "Error: cannot resolve " << host << std::endl;
+        return 1;
+    }
+
+    ReplayStats stats;
+    Replayer replayer(std::move(server), stats);
+    TrafficCapture::Reader reader(capture_dir);
+    TrafficCapture::Record record;
+
+    const auto started = std::chrono::steady_clock::now();
+    uint64_t records = 0;
+
+    while (reader.next(record)) {
+        records++;
+        if (!max_speed) {
+            const auto due = started + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::micro>(record.offset.count() / speed));
+            const auto now = std::chrono::steady_clock::now();
+            if (now < due) {
+                replayer.pollUntil(due);
+            }
+            else {
+                stats.max_lag = std::max(stats.max_lag,
+                    std::chrono::duration_cast<std::chrono::microseconds>(now - due));
+            }
+        }
+        else if (records % 256 == 0) {
+            replayer.pollOnce(0);
+        }
+        while (replayer.backlogged()) {
+            replayer.pollOnce(10);
+        }
+
+        // Each copy of a session gets its own ClientID
+        for (uint32_t copy = 0; copy < multiply; ++copy) {
+            const ClientID id = record.client_id * multiply + copy;
+            switch (record.kind) {
+            case TrafficCapture::RecordKind::OPEN:
+                replayer.open(id, record.payload);
+                break;
+            case TrafficCapture::RecordKind::FRAME:
+                replayer.frame(id, record.payload);
+                break;
+            case TrafficCapture::RecordKind::CLOSE:
+                replayer.close(id);
+                break;
+            }
+        }
+    }
+
+    // Give the server a moment to answer what is still in flight
+    replayer.pollUntil(std::chrono::steady_clock::now() + std::chrono::milliseconds(500));
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::cout << "Replay complete\n"
+        << "  Records:          " << records << "\n"
+        << "  Sessions:         " << stats.sessions << "\n"
+        << "  Connect failures: " << stats.connect_failures << "\n"
+        << "  Upgrade failures: " << stats.upgrade_failures << "\n"
+        << "  Frames sent:      " << stats.frames_sent << "\n"
+        << "  Bytes sent:       " << stats.bytes_sent << "\n"
+        << "  Bytes received:   " << stats.bytes_received << "\n"
+        << "  Max lag:          " << stats.max_lag.count() << " us\n"
+        << "  Elapsed:          " << elapsed << " s" << std::endl;
+
+    return stats.connect_failures + stats.upgrade_failures > 0 ? 2 : 0;
+}
@@ -0,0 +1,306 @@
+/**
+ * @file cppws-workerbench.cpp
+ * @brief Latency of out-of-process workers versus in-process handlers
+ *
+ * Echoes messages through three message-handling setups and reports
+ * round-trip latency (one message outstanding) and throughput (a window of
+ * messages outstanding):
+ *
+ *   inline     handler called on the I/O thread, reply copied into a Buffer
+ *   thread     handler on an application thread, queues + condition variables
+ *   shm        WorkerHost -> shared-memory ring -> worker process and back
+ *
+ * The binary re-executes itself as the shm worker.
+ *
+ * Usage:
+ *   cppws-workerbench [--messages N] [--size BYTES] [--window N]
+ */
+
+#include "core/WorkerHost.hpp"
+#include "core/WorkerProcess.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace CppWebSocket;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        size_t messages{ 100000 };
+        size_t size{ 128 };
+        size_t window{ 64 };
+    };
+
+    struct EchoResult {
+        std::string name;
+        double p50_us{ 0.0 };
+        double p99_us{ 0.0 };
+        double mean_us{ 0.0 };
+        double messages_per_sec{ 0.0 };
+    };
+
+    /**
+     * @brief A message-handling setup: submit() a message, replies arrive via the reply callback
+     */
+    struct Echo {
+        virtual ~Echo() = default;
+        virtual void submit(ClientID client, const Buffer& payload) = 0;
+        std::function<void(ClientID, const uint8_t*, size_t)> on_reply;
+    };
+
+    /// Handler runs on the submitting thread
+    struct InlineEcho : Echo {
+        void submit(ClientID client, const Buffer& payload) override {
+            Buffer reply(payload.begin(), payload.end());
+            on_reply(client, reply.data(), reply.size());
+        }
+    };
+
+    /// Handler runs on an application thread, as with an in-process handler pool
+    struct ThreadEcho : Echo {
+        ThreadEcho() : worker_([this] { loop(); }) {}
+
+        ~ThreadEcho() override {
+            {
+                std::lock_guard lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_one();
+            worker_.join();
+        }
+
+        void submit(ClientID client, const Buffer& payload) override {
+            {
+                std::lock_guard lock(mutex_);
+                queue_.emplace_back(client, payload);
+            }
+            cv_.notify_one();
+        }
+
+    private:
+        void loop() {
+            std::unique_lock lock(mutex_);
+            for (;;) {
+                cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                if (queue_.empty()) {
+                    return;
+                }
+                auto [client, payload] = std::move(queue_.front());
+                queue_.pop_front();
+                lock.unlock();
+                Buffer reply(payload.begin(), payload.end());
+                on_reply(client, reply.data(), reply.size());
+                lock.lock();
+            }
+        }
+
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<std::pair<ClientID, Buffer>> queue_;
+        bool stop_{ false };
+        std::thread worker_;
+    };
+
+    /// Handler runs in a worker process behind shared-memory rings
+    struct SharedMemoryEcho : Echo {
+        explicit SharedMemoryEcho(const std::string& executable) {
+            WorkerHost::Config config;
+            config.executable = executable;
+            config.workers = 1;
+            config.ring_capacity = 4 * 1024 * 1024;
+            config.close_on_drop = false;   // submit() retries instead
+            host_ = std::make_unique<WorkerHost>(config,
+                [this](ClientID client, const uint8_t* data, size_t size, bool) { on_reply(client, data, size); },
+                nullptr);
+        }
+
+        bool start() {
+            if (!host_->start()) {
+                std::cerr << "worker start failed: " << host_->getLastError() << "\n";
+                return false;
+            }
+            host_->connect(1);
+            return true;
+        }
+
+        void submit(ClientID client, const Buffer& payload) override {
+            while (!host_->forward(client, payload.data(), payload.size(), false)) {
+                std::this_thread::yield(); // Ring full under the throughput run
+            }
+        }
+
+    private:
+        std::unique_ptr<WorkerHost> host_;
+    };
+
+    double percentile(std::vector<double>& samples, double p) {
+        if (samples.empty()) {
+            return 0.0;
+        }
+        const size_t index = std::min(samples.size() - 1, static_cast<size_t>(samples.size() * p / 100.0));
+        std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+        return samples[index];
+    }
+
+    EchoResult measure(const std::string& name, Echo& echo, const Options& options) {
+        EchoResult result;
+        result.name = name;
+
+        std::atomic<uint64_t> replies{ 0 };
+        std::vector<double> latencies;
+        latencies.reserve(options.messages);
+        echo.on_reply = [&](ClientID, const uint8_t* data, size_t size) {
+            if (size >= sizeof(int64_t)) {
+                int64_t sent;
+                std::memcpy(&sent, data, sizeof(sent));
+                if (sent != 0) {
+                    const auto now = Clock::now().time_since_epoch().count();
+                    latencies.push_back(static_cast<double>(now - sent) / 1000.0);
+                }
+            }
+            replies.fetch_add(1, std::memory_order_release);
+        };
+
+        Buffer payload(std::max(options.size, sizeof(int64_t)), 0x5A);
+        auto stamp = [&](bool timed) {
+            const int64_t now = timed ? Clock::now().time_since_epoch().count() : 0;
+            std::memcpy(payload.data(), &now, sizeof(now));
+        };
+
+        // Warm up
+        for (size_t i = 0; i < 1000; ++i) {
+            stamp(false);
+            echo.submit(1, payload);
+        }
+        while (replies.load(std::memory_order_acquire) < 1000) {
+            std::this_thread::yield();
+        }
+
+        // Round trip: one message outstanding
+        uint64_t expected = replies.load();
+        for (size_t i = 0; i < options.messages; ++i) {
+            stamp(true);
+            echo.submit(1, payload);
+            ++expected;
+            while (replies.load(std::memory_order_acquire) < expected) {
+                std::this_thread::yield();
+            }
+        }
+        std::vector<double> samples = latencies;
+        double sum = 0.0;
+        for (double sample : samples) {
+            sum += sample;
+        }
+        result.mean_us = samples.empty() ? 0.0 : sum / samples.size();
+        result.p50_us = percentile(samples, 50.0);
+        result.p99_us = percentile(samples, 99.0);
+
+        // Throughput: a window of messages outstanding
+        const auto start = Clock::now();
+        const uint64_t base = replies.load();
+        for (size_t i = 0; i < options.messages; ++i) {
+            while (i - (replies.load(std::memory_order_acquire) - base) >= options.window) {
+                std::this_thread::yield();
+            }
+            stamp(false);
+            echo.submit(1, payload);
+        }
+        while (replies.load(std::memory_order_acquire) - base < options.messages) {
+            std::this_thread::yield();
+        }
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.messages_per_sec = options.messages / seconds;
+        return result;
+    }
+
+    int runWorker() {
+        WorkerProcess worker;
+        if (!worker.attach()) {
+            std::cerr << "worker: " << worker.getLastError() << "\n";
+            return 1;
+        }
+        return worker.run([&](const WorkerProcess::Event& event) {
+            if (event.type != WorkerProcess::EventType::MESSAGE) {
+                return;
+            }
+            // Reply serialised straight into the outbound ring
+            uint8_t* reply = worker.beginSend(event.client, event.size, event.text);
+            if (reply) {
+                std::memcpy(reply, event.data, event.size);
+                worker.endSend();
+            }
+        });
+    }
+
+    std::string selfPath() {
+        char path[4096];
+        const ssize_t length = ::readlink("/proc/self/exe", path, sizeof(path) - 1);
+        return length > 0 ? std::string(path, static_cast<size_t>(length)) : std::string();
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (WorkerProcess::isWorker()) {
+        return runWorker();
+    }
+
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--messages" && has_value) {
+            options.messages = std::stoul(argv[++i]);
+        }
+        else if (arg == "--size" && has_value) {
+            options.size = std::stoul(argv[++i]);
+        }
+        else if (arg == "--window" && has_value) {
+            options.window = std::max<size_t>(1, std::stoul(argv[++i]));
+        }
+        else {
+            std::cerr << "usage: " << argv[0] << " [--messages N] [--size BYTES] [--window N]\n";
+            return 2;
+        }
+    }
+
+    std::vector<EchoResult> results;
+    {
+        InlineEcho echo;
+        results.push_back(measure("inline", echo, options));
+    }
+    {
+        ThreadEcho echo;
+        results.push_back(measure("thread", echo, options));
+    }
+    {
+        SharedMemoryEcho echo(selfPath());
+        if (!echo.start()) {
+            return 1;
+        }
+        results.push_back(measure("shm", echo, options));
+    }
+
+    std::printf("%zu messages of %zu bytes, window %zu\n\n", options.messages, options.size, options.window);
+    std::printf("%-8s %10s %10s %10s %14s\n", "mode", "p50 us", "p99 us", "mean us", "msgs/s");
+    for (const auto& result : results) {
+        std::printf("%-8s %10.2f %10.2f %10.2f %14.0f\n", result.name.c_str(),
+            result.p50_us, result.p99_us, result.mean_us, result.messages_per_sec);
+    }
+    return 0;
+}
@@ -0,0 +1,260 @@
+/**
+ * @file cppws-zstd-train.cpp
+ * @brief Trains a zstd dictionary for the x-cppws-zstd extension from a traffic capture
+ *
+ * Reads a capture written by TrafficCapture::Writer, reassembles each
+ * session's inbound data messages and trains a dictionary on them. A share
+ * of the messages (--holdout) is kept out of training and used to report
+ * how well the dictionary compresses traffic it has not seen, against
+ * plain zstd at the same level.
+ *
+ * Usage:
+ *   cppws-zstd-train <capture-dir> <output> [--id N] [--size BYTES] [--level N] [--holdout PCT]
+ *
+ * --id is the dictionary id clients offer in "x-cppws-zstd; dict=N"; give
+ * every new dictionary a new id so old and new clients can coexist.
+ * Frames already compressed by another extension (RSV1) are skipped.
+ */
+
+#include "utils/TrafficCapture.hpp"
+#include <zstd.h>
+#include <zdict.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace CppWebSocket;
+
+namespace {
+
+    struct TrainOptions {
+        std::string capture;
+        std::string output;
+        uint32_t id{ 1 };
+        size_t size{ 64 * 1024 };
+        int level{ 3 };
+        unsigned holdout{ 10 };
+    };
+
+    struct Assembly {
+        Buffer message;                     ///< Data message being reassembled
+        bool active{ false };               ///< A fragmented message is in progress
+        bool skip{ false };                 ///< Current message is compressed; drop it
+    };
+
+    /// Decode one captured client frame; returns false if it is truncated
+    bool parseFrame(const Buffer& frame, bool& fin, bool& rsv1, uint8_t& opcode, Buffer& payload) {
+        if (frame.size() < 2) {
+            return false;
+        }
+        fin = (frame[0] & 0x80) != 0;
+        rsv1 = (frame[0] & 0x40) != 0;
+        opcode = frame[0] & 0x0F;
+        const bool masked = (frame[1] & 0x80) != 0;
+        uint64_t length = frame[1] & 0x7F;
+        size_t offset = 2;
+        if (length == 126 || length == 127) {
+            const size_t bytes = length == 126 ? 2 : 8;
+            if (frame.size() < offset + bytes) {
+                return false;
+            }
+            length = 0;
+            for (size_t i = 0; i < bytes; ++i) {
+                length = (length << 8) | frame[offset + i];
+            }
+            offset += bytes;
+        }
+        uint8_t mask[4] = { 0, 0, 0, 0 };
+        if (masked) {
+            if (frame.size() < offset + 4) {
+                return false;
+            }
+            std::memcpy(mask, frame.data() + offset, 4);
+            offset += 4;
+        }
+        if (length > frame.size() - offset) {
+            return false;
+        }
+        payload.assign(frame.begin() + offset, frame.begin() + offset + static_cast<size_t>(length));
+        for (size_t i = 0; i < payload.size(); ++i) {
+            payload[i] ^= mask[i & 3];
+        }
+        return true;
+    }
+
+    /// Collect every complete inbound data message in the capture
+    std::vector<Buffer> collectMessages(const std::string& directory, uint64_t& skipped) {
+        std::vector<Buffer> messages;
+        std::unordered_map<ClientID, Assembly> sessions;
+        TrafficCapture::Reader reader(directory);
+        TrafficCapture::Record record;
+        Buffer payload;
+
+        while (reader.next(record)) {
+            if (record.kind == TrafficCapture::RecordKind::CLOSE) {
+                sessions.erase(record.client_id);
+                continue;
+            }
+            if (record.kind != TrafficCapture::RecordKind::FRAME) {
+                continue;
+            }
+            bool fin = false, rsv1 = false;
+            uint8_t opcode = 0;
+            if (!parseFrame(record.payload, fin, rsv1, opcode, payload)) {
+                ++skipped;
+                continue;
+            }
+            Assembly& assembly = sessions[record.client_id];
+            if (opcode == 0x1 || opcode == 0x2) {
+                assembly.message.swap(payload);
+                assembly.active = true;
+                assembly.skip = rsv1;
+            } else if (opcode == 0x0 && assembly.active) {
+                assembly.message.insert(assembly.message.end(), payload.begin(), payload.end());
+            } else {
+                continue;   // control frame, or continuation without a start
+            }
+            if (fin) {
+                if (assembly.skip) {
+                    ++skipped;
+                } else if (!assembly.message.empty()) {
+                    messages.push_back(std::move(assembly.message));
+                }
+                assembly = Assembly{};
+            }
+        }
+        return messages;
+    }
+
+    /// Total compressed size of samples, with a dictionary or without (dictionary == nullptr)
+    size_t compressedSize(const std::vector<const Buffer*>& samples, const ZSTD_CDict* dictionary, int level) {
+        ZSTD_CCtx* context = ZSTD_createCCtx();
+        Buffer out;
+        size_t total = 0;
+        for (const Buffer* sample : samples) {
+            out.resize(ZSTD_compressBound(sample->size()));
+            const size_t written = dictionary
+                ? ZSTD_compress_usingCDict(context, out.data(), out.size(), sample->data(), sample->size(), dictionary)
+                : ZSTD_compressCCtx(context, out.data(), out.size(), sample->data(), sample->size(), level);
+            // What the extension would send: never more than the original
+            total += ZSTD_isError(written) ? sample->size() : std::min(written, sample->size());
+        }
+        ZSTD_freeCCtx(context);
+        return total;
+    }
+
+    bool parseArgs(int argc, char** argv, TrainOptions& options) {
+        if (argc < 3) {
+            return false;
+        }
+        options.capture = argv[1];
+        options.output = argv[2];
+        for (int i = 3; i + 1 < argc; i += 2) {
+            const std::string flag = argv[i];
+            const unsigned long value = std::strtoul(argv[i + 1], nullptr, 10);
+            if (flag == "--id" && value != 0 && value <= UINT32_MAX) {
+                options.id = static_cast<uint32_t>(value);
+            } else if (flag == "--size" && value >= 1024) {
+                options.size = value;
+            } else if (flag == "--level" && value >= 1 && value <= static_cast<unsigned long>(ZSTD_maxCLevel())) {
+                options.level = static_cast<int>(value);
+            } else if (flag == "--holdout" && value < 100) {
+                options.holdout = static_cast<unsigned>(value);
+            } else {
+                return false;
+            }
+        }
+        return (argc - 3) % 2 == 0;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    TrainOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        std::cerr << "usage: cppws-zstd-train <capture-dir> <output> [--id N] [--size BYTES] [--level N] [--holdout PCT]\n";
+        return 2;
+    }
+
+    uint64_t skipped = 0;
+    const std::vector<Buffer> messages = collectMessages(options.capture, skipped);
+
+    // Every n-th message is held out, so both sets span the whole capture
+    std::vector<const Buffer*> training, holdout;
+    const size_t stride = options.holdout == 0 ? 0 : 100 / options.holdout;
+    for (size_t i = 0; i < messages.size(); ++i) {
+        (stride != 0 && i % stride == stride - 1 ? holdout : training).push_back(&messages[i]);
+    }
+    if (training.size() < 8) {
+        std::cerr << "cppws-zstd-train: only " << training.size() << " training messages in " << options.capture << "\n";
+        return 1;
+    }
+
+    Buffer samples;
+    std::vector<size_t> sizes;
+    sizes.reserve(training.size());
+    for (const Buffer* message : training) {
+        samples.insert(samples.end(), message->begin(), message->end());
+        sizes.push_back(message->size());
+    }
+
+    // Train, then rewrite the header with our id and level (training picks a random id)
+    Buffer trained(options.size);
+    const size_t trained_size = ZDICT_trainFromBuffer(trained.data(), trained.size(), samples.data(), sizes.data(),
+        static_cast<unsigned>(sizes.size()));
+    if (ZDICT_isError(trained_size)) {
+        std::cerr << "cppws-zstd-train: training failed: " << ZDICT_getErrorName(trained_size) << "\n";
+        return 1;
+    }
+    const size_t header_size = ZDICT_getDictHeaderSize(trained.data(), trained_size);
+    if (ZDICT_isError(header_size)) {
+        std::cerr << "cppws-zstd-train: bad dictionary header: " << ZDICT_getErrorName(header_size) << "\n";
+        return 1;
+    }
+    ZDICT_params_t params{};
+    params.compressionLevel = options.level;
+    params.dictID = options.id;
+    Buffer dictionary(options.size);
+    const size_t dictionary_size = ZDICT_finalizeDictionary(dictionary.data(), dictionary.size(),
+        trained.data() + header_size, trained_size - header_size,
+        samples.data(), sizes.data(), static_cast<unsigned>(sizes.size()), params);
+    if (ZDICT_isError(dictionary_size)) {
+        std::cerr << "cppws-zstd-train: finalizing failed: " << ZDICT_getErrorName(dictionary_size) << "\n";
+        return 1;
+    }
+    dictionary.resize(dictionary_size);
+
+    std::FILE* file = std::fopen(options.output.c_str(), "wb");
+    if (!file || std::fwrite(dictionary.data(), 1, dictionary.size(), file) != dictionary.size()) {
+        std::cerr << "cppws-zstd-train: cannot write " << options.output << "\n";
+        if (file) {
+            std::fclose(file);
+        }
+        return 1;
+    }
+    std::fclose(file);
+
+    std::cout << "messages:   " << messages.size() << " (" << training.size() << " training, "
+              << holdout.size() << " held out, " << skipped << " frames skipped)\n"
+              << "dictionary: " << options.output << " id=" << options.id << " " << dictionary.size() << " bytes\n";
+
+    if (!holdout.empty()) {
+        size_t original = 0;
+        for (const Buffer* message : holdout) {
+            original += message->size();
+        }
+        ZSTD_CDict* digested = ZSTD_createCDict(dictionary.data(), dictionary.size(), options.level);
+        const size_t with_dictionary = compressedSize(holdout, digested, options.level);
+        const size_t without_dictionary = compressedSize(holdout, nullptr, options.level);
+        ZSTD_freeCDict(digested);
+        std::printf("held out:   %zu bytes -> %zu with dictionary (%.1f%%), %zu without (%.1f%%)\n",
+            original, with_dictionary, 100.0 * with_dictionary / original,
+            without_dictionary, 100.0 * without_dictionary / original);
+    }
+    return 0;
+}